@@ -3,7 +3,125 @@
 
 #include "cli/command_line.h"
 
+#include <charconv>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
 #include <string>
+#include <utility>
+
+namespace
+{
+	/**
+	 * @brief Parse a non-negative integer flag value.
+	 *
+	 * @param flag  Name of the flag, for the error message.
+	 * @param value Text given for the flag.
+	 * @return The parsed value.
+	 *
+	 * @throws std::runtime_error if the value is not a valid non-negative number.
+	 */
+	std::size_t parse_size(const char *flag, const char *value)
+	{
+		std::size_t result = 0;
+		const char *end = value + std::strlen(value);
+
+		const auto [ptr, ec] = std::from_chars(value, end, result);
+		if (ec != std::errc() || ptr != end || ptr == value)
+		{
+			throw std::runtime_error(std::string("Invalid value for ") + flag + ": '" + value +
+				"' (expected a non-negative integer)");
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief Throw a usage error for the first flag present in `conflicts`.
+	 *
+	 * @param mode      Flag or mode the others cannot be combined with.
+	 * @param conflicts Pairs of (flag given, flag name).
+	 */
+	void reject_conflicts(const char *mode, std::initializer_list<std::pair<bool, const char *>> conflicts)
+	{
+		for (const auto &[present, flag] : conflicts)
+		{
+			if (present)
+			{
+				throw std::runtime_error(std::string(mode) + " cannot be combined with " + flag);
+			}
+		}
+	}
+
+	/**
+	 * @brief Reject flags that import-csv --where would silently ignore.
+	 *
+	 * A --where import is a single INSERT ... SELECT: it has no batches,
+	 * parser threads, pipeline, checkpoints or fingerprints, and it does not
+	 * follow the file.
+	 *
+	 * @throws std::runtime_error naming the first conflicting flag.
+	 */
+	void reject_where_conflicts(const CommandLineOptions &options)
+	{
+		if (options.where.empty())
+		{
+			return;
+		}
+
+		reject_conflicts("--where", {
+			{options.follow, "--follow"},
+			{options.skip_known, "--skip-known"},
+			{options.resume, "--resume"},
+			{options.pipelined, "--pipeline"},
+			{options.thread_count > 0, "--threads"},
+			{options.batch_size > 0, "--batch-size"}
+		});
+	}
+
+	/**
+	 * @brief Reject flags that import-csv --follow would silently ignore.
+	 *
+	 * The follower tails the file on one thread and commits each batch as it
+	 * arrives; it only honors --batch-size and --skip-known.
+	 *
+	 * @throws std::runtime_error naming the first conflicting flag.
+	 */
+	void reject_follow_conflicts(const CommandLineOptions &options)
+	{
+		if (!options.follow)
+		{
+			return;
+		}
+
+		reject_conflicts("--follow", {
+			{options.resume, "--resume"},
+			{options.pipelined, "--pipeline"},
+			{options.thread_count > 0, "--threads"}
+		});
+	}
+
+	/**
+	 * @brief Reject flags that an import of several remote feeds would silently ignore.
+	 *
+	 * The feeds are read concurrently and their batches committed interleaved,
+	 * so there is no single checkpoint to resume from and no per-feed pipeline.
+	 *
+	 * @throws std::runtime_error naming the first conflicting flag.
+	 */
+	void reject_multi_feed_conflicts(const CommandLineOptions &options)
+	{
+		if (options.feeds_path.empty() && options.remote_csv_urls.size() < 2)
+		{
+			return;
+		}
+
+		reject_conflicts("Importing several feeds", {
+			{options.resume, "--resume"},
+			{options.pipelined, "--pipeline"}
+		});
+	}
+}
 
 CommandLineOptions parse_arguments(int argc, char **argv)
 {
@@ -39,6 +157,14 @@ CommandLineOptions parse_arguments(int argc, char **argv)
 	{
 		options.command = CommandType::ImportCsv;
 	}
+	else if (command == "import-json")
+	{
+		options.command = CommandType::ImportJson;
+	}
+	else if (command == "import-db")
+	{
+		options.command = CommandType::ImportDb;
+	}
 	else if (command == "import-remote-csv")
 	{
 		options.command = CommandType::ImportRemoteCsv;
@@ -47,6 +173,10 @@ CommandLineOptions parse_arguments(int argc, char **argv)
 	{
 		options.command = CommandType::ImportImap;
 	}
+	else if (command == "watch-imap")
+	{
+		options.command = CommandType::WatchImap;
+	}
 	else
 	{
 		options.command = CommandType::Unknown;
@@ -83,12 +213,37 @@ CommandLineOptions parse_arguments(int argc, char **argv)
 				options.csv_path = value;
 			}
 		}
+		else if (arg == "--json")
+		{
+			const char *value = require_value("--json");
+			if (value != nullptr)
+			{
+				options.json_path = value;
+			}
+		}
+		else if (arg == "--json-map")
+		{
+			const char *value = require_value("--json-map");
+			if (value != nullptr)
+			{
+				options.json_mapping = value;
+			}
+		}
+		else if (arg == "--from")
+		{
+			const char *value = require_value("--from");
+			if (value != nullptr)
+			{
+				options.source_database_path = value;
+			}
+		}
 		else if (arg == "--remote-csv-url")
 		{
 			const char *value = require_value("--remote-csv-url");
 			if (value != nullptr)
 			{
 				options.remote_csv_url = value;
+				options.remote_csv_urls.push_back(value);
 			}
 		}
 		else if (arg == "--imap-config")
@@ -99,6 +254,82 @@ CommandLineOptions parse_arguments(int argc, char **argv)
 				options.imap_config_path = value;
 			}
 		}
+		else if (arg == "--batch-size")
+		{
+			const char *value = require_value("--batch-size");
+			if (value != nullptr)
+			{
+				options.batch_size = parse_size("--batch-size", value);
+			}
+		}
+		else if (arg == "--threads")
+		{
+			const char *value = require_value("--threads");
+			if (value != nullptr)
+			{
+				options.thread_count = parse_size("--threads", value);
+			}
+		}
+		else if (arg == "--pipeline")
+		{
+			options.pipelined = true;
+		}
+		else if (arg == "--resume")
+		{
+			options.resume = true;
+		}
+		else if (arg == "--skip-known")
+		{
+			options.skip_known = true;
+		}
+		else if (arg == "--follow")
+		{
+			options.follow = true;
+		}
+		else if (arg == "--where")
+		{
+			const char *value = require_value("--where");
+			if (value != nullptr)
+			{
+				options.where = value;
+			}
+		}
+		else if (arg == "--append-only")
+		{
+			options.append_only = true;
+		}
+		else if (arg == "--connect-timeout")
+		{
+			const char *value = require_value("--connect-timeout");
+			if (value != nullptr)
+			{
+				options.connect_timeout_seconds = parse_size("--connect-timeout", value);
+			}
+		}
+		else if (arg == "--feeds")
+		{
+			const char *value = require_value("--feeds");
+			if (value != nullptr)
+			{
+				options.feeds_path = value;
+			}
+		}
+		else if (arg == "--max-per-host")
+		{
+			const char *value = require_value("--max-per-host");
+			if (value != nullptr)
+			{
+				options.max_connections_per_host = parse_size("--max-per-host", value);
+			}
+		}
+		else if (arg == "--timeout")
+		{
+			const char *value = require_value("--timeout");
+			if (value != nullptr)
+			{
+				options.timeout_seconds = parse_size("--timeout", value);
+			}
+		}
 		else if (arg == "--company")
 		{
 			const char *value = require_value("--company");
@@ -154,5 +385,8 @@ CommandLineOptions parse_arguments(int argc, char **argv)
 		}
 	}
 
+	reject_where_conflicts(options);
+	reject_follow_conflicts(options);
+	reject_multi_feed_conflicts(options);
 	return options;
 }
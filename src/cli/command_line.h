@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -14,8 +15,11 @@ enum class CommandType
 	Stats,
 	Add,
 	ImportCsv,
+	ImportJson,
+	ImportDb,
 	ImportRemoteCsv,
 	ImportImap,
+	WatchImap,
 	Unknown
 };
 
@@ -33,12 +37,60 @@ struct CommandLineOptions
 	/// Optional path to a local CSV file for import.
 	std::string csv_path;
 
-	/// Optional remote CSV URL.
+	/// Optional path to a local NDJSON or JSON file for import.
+	std::string json_path;
+
+	/// Optional JSON field mapping, as accepted by JsonFieldMapping::parse().
+	std::string json_mapping;
+
+	/// Optional path to another jobtracker database to merge (import-db).
+	std::string source_database_path;
+
+	/// Optional remote CSV URL (the last --remote-csv-url given).
 	std::string remote_csv_url;
 
+	/// Every --remote-csv-url given, in order; more than one imports them concurrently.
+	std::vector<std::string> remote_csv_urls;
+
+	/// Optional path to a file listing remote CSV feeds, one per line.
+	std::string feeds_path;
+
 	/// Optional path to an IMAP configuration file.
 	std::string imap_config_path;
 
+	/// Optional number of rows per import batch (0 = use the import default).
+	std::size_t batch_size = 0;
+
+	/// Optional number of parsing threads for import-csv (0 = single-threaded).
+	std::size_t thread_count = 0;
+
+	/// Whether imports run as an overlapping reader/normalizer/writer pipeline.
+	bool pipelined = false;
+
+	/// Whether import-csv continues from the last committed checkpoint.
+	bool resume = false;
+
+	/// Whether imports drop records an earlier import with this flag already wrote.
+	bool skip_known = false;
+
+	/// Whether import-csv keeps running and imports rows appended to the file.
+	bool follow = false;
+
+	/// Optional SQL condition over the csv_source() columns selecting the rows import-csv imports.
+	std::string where;
+
+	/// Whether the remote CSV feed only grows at the end (enables tail fetches).
+	bool append_only = false;
+
+	/// Optional HTTP connect timeout in seconds (0 = use the client default).
+	std::size_t connect_timeout_seconds = 0;
+
+	/// Optional limit in seconds on a whole HTTP request (0 = no limit).
+	std::size_t timeout_seconds = 0;
+
+	/// Optional limit on concurrent connections per host for multi-feed imports (0 = default).
+	std::size_t max_connections_per_host = 0;
+
 	/// Optional company name for add/update commands.
 	std::string company;
 
@@ -67,5 +119,8 @@ struct CommandLineOptions
  * @param argc Argument count.
  * @param argv Argument vector.
  * @return Parsed CommandLineOptions structure.
+ *
+ * @throws std::runtime_error if a numeric flag has an invalid value, or --where
+ *         is combined with a flag the SQL import cannot honor.
  */
 CommandLineOptions parse_arguments(int argc, char **argv);
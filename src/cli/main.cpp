@@ -5,13 +5,30 @@
 #include "core/application.h"
 #include "core/job_tracker.h"
 #include "storage/sqlite_application_repository.h"
+#include "storage/sqlite_http_feed_state_store.h"
+#include "storage/sqlite_imap_sync_state_store.h"
 #include "import/csv_import_source.h"
+#include "import/csv_file_follower.h"
+#include "import/csv_source_table.h"
+#include "import/json_import_source.h"
 #include "import/remote_csv_import_source.h"
 #include "import/import_service.h"
+#include "import/multi_source_import.h"
 #include "import/http_client.h"
+#include "import/imap_email_client.h"
+#include "import/imap_import_source.h"
+#include "import/imap_mailbox_watcher.h"
+
+#include <signal.h>
+#include <unistd.h>
 
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Print a short usage message to stdout.
@@ -28,13 +45,31 @@ static void print_usage()
 		<< "  stats                  Show aggregated statistics\n"
 		<< "  add                    Add a single application from flags\n"
 		<< "  import-csv             Import applications from a local CSV file\n"
+		<< "  import-json            Import applications from a local NDJSON or JSON file\n"
+		<< "  import-db              Merge the applications of another jobtracker database\n"
 		<< "  import-remote-csv      Import applications from a remote CSV URL\n"
-		<< "  import-imap            Import applications from an IMAP mailbox (not implemented yet)\n\n"
+		<< "  import-imap            Import new messages of an IMAP mailbox\n"
+		<< "  watch-imap             Import new messages of an IMAP mailbox as they arrive\n\n"
 		<< "Common options:\n"
 		<< "  --database <path>      Path to SQLite database file (required for most commands)\n"
 		<< "  --csv <path>           Path to local CSV file (import-csv)\n"
-		<< "  --remote-csv-url <url> Remote CSV URL (import-remote-csv)\n"
-		<< "  --imap-config <path>   Path to IMAP config file (import-imap)\n"
+		<< "  --json <path>          Path to local NDJSON or JSON file (import-json)\n"
+		<< "  --json-map <spec>      JSON paths of fields, e.g. company=employer.name,position=title (import-json)\n"
+		<< "  --from <path>          Path to the jobtracker database to merge (import-db)\n"
+		<< "  --remote-csv-url <url> Remote CSV URL; repeat to import several feeds (import-remote-csv)\n"
+		<< "  --feeds <path>         File listing remote CSV feeds, one per line (import-remote-csv)\n"
+		<< "  --max-per-host <n>     Concurrent connections per host for several feeds (import-remote-csv)\n"
+		<< "  --imap-config <path>   Path to IMAP config file (import-imap, watch-imap)\n"
+		<< "  --batch-size <n>       Rows processed per import batch (import commands)\n"
+		<< "  --threads <n>          Threads decoding a CSV file or mapping messages (import-csv, import-imap, watch-imap)\n"
+		<< "  --pipeline             Overlap reading, normalizing and writing (import commands)\n"
+		<< "  --resume               Continue an interrupted import from its checkpoint (import-csv, import-json)\n"
+		<< "  --skip-known           Skip records imported before with this option (import commands)\n"
+		<< "  --follow               Keep importing rows appended to the file until Ctrl+C (import-csv)\n"
+		<< "  --where <expr>         Import only rows matching an SQL condition (import-csv)\n"
+		<< "  --append-only          Only fetch rows appended since the last import (import-remote-csv)\n"
+		<< "  --connect-timeout <s>  Seconds allowed to connect to the server (import-remote-csv)\n"
+		<< "  --timeout <s>          Seconds allowed for the whole download (import-remote-csv)\n"
 		<< "  --company <name>       Company name (add)\n"
 		<< "  --position <title>     Position title (add)\n"
 		<< "  --location <location>  Job location (add)\n"
@@ -43,6 +78,225 @@ static void print_usage()
 		<< "  --notes <text>         Free-form notes (add)\n";
 }
 
+/**
+ * @brief Print per-stage statistics of a pipelined import to stdout.
+ */
+static void print_pipeline_stats(const ImportPipelineStats &stats)
+{
+	const auto print_stage = [](const char *name, const ImportStageStats &stage)
+	{
+		std::cout << "  " << name << ": " << stage.items << " rows, "
+			<< static_cast<long long>(stage.items_per_second()) << " rows/s busy, "
+			<< stage.wait_seconds << " s waiting\n";
+	};
+	const auto print_queue = [](const char *name, const ImportQueueStats &queue)
+	{
+		std::cout << "  " << name << " queue: max " << queue.max_occupancy << "/" << queue.capacity
+			<< ", avg " << queue.average_occupancy << "\n";
+	};
+
+	std::cout << "Pipeline statistics:\n";
+	print_stage("reader", stats.reader);
+	print_stage("normalizer", stats.normalizer);
+	print_stage("writer", stats.writer);
+	print_queue("decoded", stats.decoded_queue);
+	print_queue("normalized", stats.normalized_queue);
+}
+
+/**
+ * @brief Print how many known records an import with --skip-known dropped.
+ */
+static void print_known_records(const ImportResult &result)
+{
+	std::cout << "Skipped " << result.skipped << " previously imported applications ("
+		<< result.known_records.loaded << " fingerprints loaded, Bloom filter false-positive rate "
+		<< result.known_records.false_positive_rate() * 100.0 << "%).\n";
+}
+
+/**
+ * @brief Import several remote CSV feeds concurrently.
+ *
+ * All transfers share one libcurl event loop; parsed batches from every feed
+ * are written by a single writer.
+ *
+ * @return Process exit code: 1 if any feed failed.
+ */
+static int import_remote_feeds(
+	const std::vector<RemoteCsvConfig> &feeds,
+	const HttpClientOptions &client_options,
+	std::size_t max_connections_per_host,
+	SqliteApplicationRepository &repository,
+	const std::string &database_path,
+	const ImportOptions &import_options)
+{
+	LibcurlMultiHttpClient http_client(client_options, static_cast<long>(max_connections_per_host));
+	SqliteHttpFeedStateStore feed_state(database_path);
+
+	std::vector<std::unique_ptr<RemoteCsvImportSource>> sources;
+	std::vector<IImportSource *> source_pointers;
+	for (const auto &feed : feeds)
+	{
+		sources.push_back(std::make_unique<RemoteCsvImportSource>(http_client, feed, &feed_state));
+		source_pointers.push_back(sources.back().get());
+	}
+
+	MultiSourceImportService service(source_pointers, repository, import_options);
+	const MultiSourceImportResult result = service.run_once();
+
+	for (std::size_t i = 0; i < feeds.size(); ++i)
+	{
+		const SourceImportResult &feed = result.sources[i];
+		std::cout << feeds[i].url << ": ";
+		if (!feed.succeeded())
+		{
+			std::cout << "failed (" << feed.error << ")\n";
+		}
+		else if (sources[i]->unchanged())
+		{
+			std::cout << "unchanged\n";
+		}
+		else
+		{
+			std::cout << "imported " << feed.result.imported << " of " << feed.result.total << " applications\n";
+		}
+	}
+
+	std::cout << "Imported " << result.total.imported << " of " << result.total.total
+		<< " applications from " << feeds.size() << " remote CSV feeds";
+	if (result.failed_sources() > 0)
+	{
+		std::cout << "; " << result.failed_sources() << " feeds failed";
+	}
+	std::cout << ".\n";
+
+	if (import_options.skip_known)
+	{
+		print_known_records(result.total);
+	}
+
+	return result.failed_sources() > 0 ? 1 : 0;
+}
+
+/**
+ * @brief Import new mail of an IMAP mailbox as it arrives, until SIGINT or SIGTERM.
+ *
+ * @return Process exit code.
+ */
+static int watch_imap(
+	const ImapImportConfig &config,
+	SqliteApplicationRepository &repository,
+	const std::string &database_path,
+	const ImportOptions &import_options)
+{
+	// Handle the stop signals on this thread only; the watcher thread inherits the mask.
+	sigset_t stop_signals;
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+	SqliteImapSyncStateStore sync_state(database_path);
+	ImapWatchOptions watch_options{};
+	watch_options.import.batch_size = import_options.batch_size;
+	watch_options.import.skip_known = import_options.skip_known;
+	ImapMailboxWatcher watcher(config, sync_state, repository, watch_options);
+
+	std::thread worker([&]()
+	{
+		watcher.run(
+			[](const ImportResult &result, const ImapSyncStats &stats)
+			{
+				if (!stats.unchanged && stats.messages_fetched + stats.messages_filtered_out > 0)
+				{
+					std::cout << "Imported " << result.imported << " of " << result.total
+						<< " new messages (" << stats.messages_filtered_out << " skipped by the filter).\n" << std::flush;
+				}
+			},
+			[](const std::string &error)
+			{
+				std::cerr << "IMAP error: " << error << "; reconnecting.\n";
+			});
+	});
+
+	std::cout << "Watching " << config.connection.mailbox << " on " << config.connection.host
+		<< " for new mail; press Ctrl+C to stop.\n" << std::flush;
+
+	int signal_number = 0;
+	sigwait(&stop_signals, &signal_number);
+
+	watcher.stop();
+	worker.join();
+
+	const ImapWatchStats stats = watcher.stats();
+	std::cout << "Stopped after " << stats.syncs << " syncs; imported " << stats.imported
+		<< " applications (" << stats.reconnects << " reconnects).\n";
+	return 0;
+}
+
+/**
+ * @brief Import rows appended to a local CSV file as they are written, until SIGINT or SIGTERM.
+ *
+ * @return Process exit code.
+ */
+static int follow_csv(
+	const std::string &csv_path,
+	SqliteApplicationRepository &repository,
+	const ImportOptions &import_options)
+{
+	// Handle the stop signals on this thread only; the follower thread inherits the mask.
+	sigset_t stop_signals;
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+	CsvFollowOptions follow_options{};
+	follow_options.import.batch_size = import_options.batch_size;
+	follow_options.import.skip_known = import_options.skip_known;
+	CsvFileFollower follower(csv_path, repository, follow_options);
+
+	std::exception_ptr failure;
+	std::thread worker([&]()
+	{
+		try
+		{
+			follower.run(
+				[](const ImportResult &result)
+				{
+					std::cout << "Imported " << result.imported << " of " << result.total
+						<< " new rows.\n" << std::flush;
+				},
+				[](const std::string &error)
+				{
+					std::cerr << "CSV follow error: " << error << "; retrying.\n";
+				});
+		}
+		catch (...)
+		{
+			failure = std::current_exception();
+			kill(getpid(), SIGTERM);
+		}
+	});
+
+	std::cout << "Following " << csv_path << " for appended rows; press Ctrl+C to stop.\n" << std::flush;
+
+	int signal_number = 0;
+	sigwait(&stop_signals, &signal_number);
+
+	follower.stop();
+	worker.join();
+
+	if (failure)
+	{
+		std::rethrow_exception(failure);
+	}
+
+	const CsvFollowStats stats = follower.stats();
+	std::cout << "Stopped at byte " << stats.offset << "; imported " << stats.imported << " applications ("
+		<< stats.truncations << " truncations, " << stats.rotations << " rotations).\n";
+	return 0;
+}
+
 /**
  * @brief Entry point.
  */
@@ -50,7 +304,16 @@ int main(int argc, char **argv)
 {
 	try
 	{
-		CommandLineOptions options = parse_arguments(argc, argv);
+		CommandLineOptions options;
+		try
+		{
+			options = parse_arguments(argc, argv);
+		}
+		catch (const std::exception &ex)
+		{
+			std::cerr << ex.what() << ". Use 'help' to see available options.\n";
+			return 1;
+		}
 
 		// Help or no command: just print usage and exit.
 		if (options.command == CommandType::Help || options.command == CommandType::None)
@@ -71,8 +334,11 @@ int main(int argc, char **argv)
 			options.command == CommandType::Stats ||
 			options.command == CommandType::Add ||
 			options.command == CommandType::ImportCsv ||
+			options.command == CommandType::ImportJson ||
+			options.command == CommandType::ImportDb ||
 			options.command == CommandType::ImportRemoteCsv ||
-			options.command == CommandType::ImportImap;
+			options.command == CommandType::ImportImap ||
+			options.command == CommandType::WatchImap;
 
 		if (needs_database && options.database_path.empty())
 		{
@@ -84,6 +350,15 @@ int main(int argc, char **argv)
 		SqliteApplicationRepository repository(options.database_path);
 		JobTracker tracker(repository);
 
+		ImportOptions import_options{};
+		if (options.batch_size > 0)
+		{
+			import_options.batch_size = options.batch_size;
+		}
+		import_options.pipelined = options.pipelined;
+		import_options.resume = options.resume;
+		import_options.skip_known = options.skip_known;
+
 		switch (options.command)
 		{
 			case CommandType::List:
@@ -150,11 +425,32 @@ int main(int argc, char **argv)
 					return 1;
 				}
 
-				CsvImportSource source(options.csv_path);
-				ImportService service(source, repository);
+				if (options.follow)
+				{
+					return follow_csv(options.csv_path, repository, import_options);
+				}
+
+				if (!options.where.empty())
+				{
+					register_csv_source(repository.database().handle());
+					const std::size_t imported = import_csv_where(repository.database(), options.csv_path, options.where);
+
+					std::cout << "Imported " << imported << " applications matching the condition from CSV.\n";
+					return 0;
+				}
+
+				const std::size_t thread_count = options.thread_count > 0 ? options.thread_count : 1;
+				CsvImportSource source(options.csv_path, ',', thread_count);
+				ImportService service(source, repository, import_options);
 
 				const ImportResult result = service.run_once();
 
+				if (result.resumed_offset > 0)
+				{
+					std::cout << "Resumed at byte " << result.resumed_offset << " after "
+						<< result.resumed_rows << " previously imported applications.\n";
+				}
+
 				if (result.total == 0)
 				{
 					std::cout << "No applications found in CSV file.\n";
@@ -170,30 +466,154 @@ int main(int argc, char **argv)
 						<< result.total << " applications from CSV.\n";
 				}
 
+				if (import_options.skip_known)
+				{
+					print_known_records(result);
+				}
+
+				if (import_options.pipelined)
+				{
+					print_pipeline_stats(result.pipeline);
+				}
+
+				return 0;
+			}
+
+			case CommandType::ImportJson:
+			{
+				if (options.json_path.empty())
+				{
+					std::cerr << "JSON path is required for import-json. Use --json <path>.\n";
+					return 1;
+				}
+
+				JsonImportSource source(options.json_path, JsonFieldMapping::parse(options.json_mapping));
+				ImportService service(source, repository, import_options);
+
+				const ImportResult result = service.run_once();
+
+				if (result.resumed_offset > 0)
+				{
+					std::cout << "Resumed at byte " << result.resumed_offset << " after "
+						<< result.resumed_rows << " previously imported applications.\n";
+				}
+
+				if (result.total == 0)
+				{
+					std::cout << "No applications found in JSON file.\n";
+				}
+				else if (result.imported == 0)
+				{
+					std::cout << "JSON contained " << result.total
+						<< " records, but none could be imported.\n";
+				}
+				else
+				{
+					std::cout << "Imported " << result.imported << " of "
+						<< result.total << " applications from JSON.\n";
+				}
+
+				if (import_options.skip_known)
+				{
+					print_known_records(result);
+				}
+
+				if (import_options.pipelined)
+				{
+					print_pipeline_stats(result.pipeline);
+				}
+
+				return 0;
+			}
+
+			case CommandType::ImportDb:
+			{
+				if (options.source_database_path.empty())
+				{
+					std::cerr << "Source database is required for import-db. Use --from <path>.\n";
+					return 1;
+				}
+
+				const DatabaseMergeResult result = repository.merge_database(options.source_database_path);
+
+				if (result.source_rows == 0)
+				{
+					std::cout << "No applications found in " << options.source_database_path << ".\n";
+				}
+				else
+				{
+					std::cout << "Merged " << result.imported << " of " << result.source_rows
+						<< " applications from " << options.source_database_path << " ("
+						<< result.duplicates << " already present).\n";
+				}
+
 				return 0;
 			}
 
 			case CommandType::ImportRemoteCsv:
 			{
-				if (options.remote_csv_url.empty())
+				if (options.remote_csv_url.empty() && options.feeds_path.empty())
 				{
 					std::cerr << "Remote CSV URL is required for import-remote-csv. "
-						<< "Use --remote-csv-url <url>.\n";
+						<< "Use --remote-csv-url <url> or --feeds <path>.\n";
 					return 1;
 				}
 
-				LibcurlHttpClient http_client;
+				HttpClientOptions client_options{};
+				if (options.connect_timeout_seconds > 0)
+				{
+					client_options.connect_timeout_ms = static_cast<long>(options.connect_timeout_seconds) * 1000;
+				}
+				client_options.total_timeout_ms = static_cast<long>(options.timeout_seconds) * 1000;
+
+				if (!options.feeds_path.empty() || options.remote_csv_urls.size() > 1)
+				{
+					std::vector<RemoteCsvConfig> feeds;
+					for (const auto &url : options.remote_csv_urls)
+					{
+						RemoteCsvConfig feed{};
+						feed.url = url;
+						feed.append_only = options.append_only;
+						feeds.push_back(feed);
+					}
+
+					if (!options.feeds_path.empty())
+					{
+						std::ifstream feed_list(options.feeds_path);
+						if (!feed_list)
+						{
+							std::cerr << "Cannot open feed list '" << options.feeds_path << "'.\n";
+							return 1;
+						}
+						for (auto &feed : parse_remote_csv_feeds(feed_list))
+						{
+							feed.append_only = feed.append_only || options.append_only;
+							feeds.push_back(std::move(feed));
+						}
+					}
+
+					const std::size_t max_per_host = options.max_connections_per_host > 0 ? options.max_connections_per_host : 4;
+					return import_remote_feeds(feeds, client_options, max_per_host, repository, options.database_path, import_options);
+				}
+
+				LibcurlHttpClient http_client(client_options);
+				SqliteHttpFeedStateStore feed_state(options.database_path);
 
 				RemoteCsvConfig config{};
 				config.url = options.remote_csv_url;
 				config.delimiter = ',';
+				config.append_only = options.append_only;
 
-				RemoteCsvImportSource source(http_client, config);
-				ImportService service(source, repository);
+				RemoteCsvImportSource source(http_client, config, &feed_state);
+				ImportService service(source, repository, import_options);
 
 				const ImportResult result = service.run_once();
 
-				if (result.total == 0)
+				if (source.unchanged())
+				{
+					std::cout << "Remote CSV unchanged since the last import.\n";
+				}
+				else if (result.total == 0)
 				{
 					std::cout << "No applications found in remote CSV.\n";
 				}
@@ -208,13 +628,95 @@ int main(int argc, char **argv)
 						<< result.total << " applications from remote CSV.\n";
 				}
 
+				if (import_options.skip_known)
+				{
+					print_known_records(result);
+				}
+
+				if (import_options.pipelined)
+				{
+					print_pipeline_stats(result.pipeline);
+				}
+
 				return 0;
 			}
 
 			case CommandType::ImportImap:
 			{
-				std::cerr << "IMAP import is not implemented yet.\n";
-				return 1;
+				if (options.imap_config_path.empty())
+				{
+					std::cerr << "IMAP config is required for import-imap. Use --imap-config <path>.\n";
+					return 1;
+				}
+
+				std::ifstream config_file(options.imap_config_path);
+				if (!config_file)
+				{
+					std::cerr << "Cannot open IMAP config '" << options.imap_config_path << "'.\n";
+					return 1;
+				}
+				ImapImportConfig config = parse_imap_config(config_file);
+				if (options.thread_count > 0)
+				{
+					config.source.worker_count = options.thread_count;
+				}
+
+				SqliteImapSyncStateStore sync_state(options.database_path);
+				auto client = std::make_unique<ImapEmailClient>(config.connection, &sync_state, config.fetch);
+				const ImapEmailClient &imap = *client;
+
+				ImapImportSource source(std::move(client), config.source);
+				ImportService service(source, repository, import_options);
+
+				const ImportResult result = service.run_once();
+				const ImapSyncStats &stats = imap.last_sync_stats();
+
+				if (stats.unchanged)
+				{
+					std::cout << "Mailbox unchanged since the last import.\n";
+				}
+				else
+				{
+					std::cout << "Imported " << result.imported << " of " << result.total
+						<< " new messages (" << stats.messages_filtered_out << " skipped by the filter, "
+						<< stats.round_trips << " round trips, " << stats.bytes_received << " bytes received).\n";
+				}
+
+				if (import_options.skip_known)
+				{
+					print_known_records(result);
+				}
+
+				return 0;
+			}
+
+			case CommandType::WatchImap:
+			{
+				if (options.imap_config_path.empty())
+				{
+					std::cerr << "IMAP config is required for watch-imap. Use --imap-config <path>.\n";
+					return 1;
+				}
+
+				std::ifstream config_file(options.imap_config_path);
+				if (!config_file)
+				{
+					std::cerr << "Cannot open IMAP config '" << options.imap_config_path << "'.\n";
+					return 1;
+				}
+				ImapImportConfig config = parse_imap_config(config_file);
+				if (options.thread_count > 0)
+				{
+					config.source.worker_count = options.thread_count;
+				}
+
+				// Arrivals come a few at a time; commit them in small batches unless told otherwise.
+				ImportOptions watch_import = import_options;
+				if (options.batch_size == 0)
+				{
+					watch_import.batch_size = ImapWatchOptions{}.import.batch_size;
+				}
+				return watch_imap(config, repository, options.database_path, watch_import);
 			}
 
 			case CommandType::Help:
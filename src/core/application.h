@@ -7,6 +7,9 @@
  */
 struct Application
 {
+	/// Status given to applications imported or added without one.
+	static constexpr const char *default_status = "applied";
+
 	/// Unique identifier assigned by the storage layer (e.g. SQLite autoincrement).
 	int id = 0;
 
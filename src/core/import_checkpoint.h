@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Progress of an import, committed together with the imported rows.
+ *
+ * A checkpoint identifies the source it belongs to (path plus size and
+ * modification time) so that a resumed import can refuse to continue when
+ * the source changed in the meantime.
+ */
+struct ImportCheckpoint
+{
+	/// Stable identity of the source (e.g. the canonical path of a CSV file).
+	std::string source;
+
+	/// Size of the source in bytes when the import started.
+	std::uint64_t source_size = 0;
+
+	/// Modification time of the source, in file clock ticks.
+	std::int64_t source_mtime = 0;
+
+	/// Byte offset just past the last record whose rows are committed.
+	std::uint64_t offset = 0;
+
+	/// Total number of rows committed for this source so far.
+	std::uint64_t rows_committed = 0;
+
+	/**
+	 * @brief Whether both checkpoints describe the same version of the same source.
+	 */
+	bool same_source(const ImportCheckpoint &other) const
+	{
+		return source == other.source && source_size == other.source_size && source_mtime == other.source_mtime;
+	}
+};
@@ -1,5 +1,9 @@
 #include "core/job_tracker.h"
 
+#include <utility>
+
+#include "util/date_time.h"
+
 JobTracker::JobTracker(IApplicationRepository &repository)
 	: repository_(repository)
 {
@@ -7,18 +11,40 @@ JobTracker::JobTracker(IApplicationRepository &repository)
 
 Application JobTracker::add(const Application &application_template)
 {
-	Application app = application_template;
+	return add(Application(application_template));
+}
 
+Application JobTracker::add(Application &&application_template)
+{
+	Application app = std::move(application_template);
+
+	// Only format today's date when the template actually lacks a date.
+	const bool needs_date = app.applied_date.empty() || app.last_update.empty();
+	apply_defaults(app, needs_date ? datetime::today_iso() : std::string());
+
+	return repository_.insert(std::move(app));
+}
+
+void JobTracker::apply_defaults(Application &application, const std::string &today)
+{
 	// Ensure the storage layer assigns a fresh id.
-	app.id = 0;
+	application.id = 0;
 
 	// Provide a sensible default status if none is set.
-	if (app.status.empty())
+	if (application.status.empty())
 	{
-		app.status = "applied";
+		application.status = Application::default_status;
 	}
 
-	return repository_.insert(app);
+	// Default both dates to today when the caller did not provide them.
+	if (application.applied_date.empty())
+	{
+		application.applied_date = today;
+	}
+	if (application.last_update.empty())
+	{
+		application.last_update = today;
+	}
 }
 
 std::vector<Application> JobTracker::list_all() const
@@ -28,13 +28,36 @@ class JobTracker
 	 *
 	 * The template's id is ignored (it will be reset to 0 so the storage layer
 	 * can assign a primary key). If status is empty, a default value such as
-	 * "applied" may be used.
+	 * "applied" may be used. Missing applied/last-update dates default to today.
 	 *
 	 * @param application_template Template for the new application.
 	 * @return The persisted Application with an assigned id.
 	 */
 	Application add(const Application &application_template);
 
+	/**
+	 * @brief Add a new application, consuming the given template.
+	 *
+	 * Same rules as the const overload, but the template's fields are moved
+	 * into the repository instead of being copied.
+	 *
+	 * @param application_template Template for the new application.
+	 * @return The persisted Application with an assigned id.
+	 */
+	Application add(Application &&application_template);
+
+	/**
+	 * @brief Apply the defaults used by add() without persisting anything.
+	 *
+	 * Resets the id to 0, sets an empty status to "applied" and empty dates
+	 * to `today`. Bulk import paths call this once per row with a date that
+	 * was computed once per batch.
+	 *
+	 * @param application Application to normalize in place.
+	 * @param today       Date used for missing dates (ISO format: YYYY-MM-DD).
+	 */
+	static void apply_defaults(Application &application, const std::string &today);
+
 	/**
 	 * @brief Return all applications from the repository.
 	 */
@@ -0,0 +1,96 @@
+/// \file
+/// \brief Quote-aware splitting of CSV buffers into record-aligned chunks.
+
+#include "import/csv_chunker.h"
+
+#include <algorithm>
+#include <future>
+
+#include "util/thread_pool.h"
+
+namespace csv_chunker
+{
+	std::vector<CsvChunk> split(
+		std::string_view buffer,
+		std::size_t begin,
+		std::size_t chunk_bytes,
+		std::size_t chunk_count,
+		ThreadPool &pool)
+	{
+		const std::size_t size = buffer.size();
+		if (begin >= size)
+		{
+			return {};
+		}
+
+		const std::size_t step = std::max<std::size_t>(chunk_bytes, 1);
+		const std::size_t count = std::max<std::size_t>(chunk_count, 1);
+
+		// Raw cut points, clamped to the buffer.
+		std::vector<std::size_t> cuts;
+		cuts.push_back(begin);
+		for (std::size_t i = 1; i <= count && cuts.back() < size; ++i)
+		{
+			cuts.push_back(std::min(size, begin + i * step));
+		}
+
+		// Pass 1: count quotes between consecutive cuts in parallel.
+		std::vector<std::future<std::size_t>> quote_counts;
+		quote_counts.reserve(cuts.size() - 1);
+		for (std::size_t i = 1; i < cuts.size(); ++i)
+		{
+			const std::string_view piece = buffer.substr(cuts[i - 1], cuts[i] - cuts[i - 1]);
+			quote_counts.push_back(pool.submit([piece]()
+			{
+				return static_cast<std::size_t>(std::count(piece.begin(), piece.end(), '"'));
+			}));
+		}
+
+		// Pass 2: with the quote parity known at every cut, move each cut to
+		// the end of its record. `begin` is a record boundary, so parity starts even.
+		std::vector<CsvChunk> chunks;
+		std::size_t quotes_before_cut = 0;
+		std::size_t chunk_begin = begin;
+
+		for (std::size_t i = 1; i < cuts.size(); ++i)
+		{
+			quotes_before_cut += quote_counts[i - 1].get();
+
+			const bool in_quotes = (quotes_before_cut % 2) != 0;
+			const std::size_t chunk_end = cuts[i] >= size ? size : find_record_end(buffer, cuts[i], in_quotes);
+
+			// A record longer than a chunk swallows the following cuts.
+			if (chunk_end > chunk_begin)
+			{
+				chunks.push_back(CsvChunk{chunk_begin, chunk_end});
+				chunk_begin = chunk_end;
+			}
+		}
+
+		return chunks;
+	}
+
+	std::size_t find_record_end(std::string_view buffer, std::size_t from, bool in_quotes)
+	{
+		const std::size_t size = buffer.size();
+
+		for (std::size_t i = from; i < size; ++i)
+		{
+			const char ch = buffer[i];
+			if (ch == '"')
+			{
+				in_quotes = !in_quotes;
+			}
+			else if (!in_quotes && ch == '\n')
+			{
+				return i + 1;
+			}
+			else if (!in_quotes && ch == '\r')
+			{
+				return (i + 1 < size && buffer[i + 1] == '\n') ? i + 2 : i + 1;
+			}
+		}
+
+		return size;
+	}
+}
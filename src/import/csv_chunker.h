@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief Byte range of a CSV buffer that starts and ends on record boundaries.
+ */
+struct CsvChunk
+{
+	/// Offset of the first byte of the chunk.
+	std::size_t begin = 0;
+
+	/// Offset one past the last byte of the chunk.
+	std::size_t end = 0;
+};
+
+/**
+ * @brief Helpers to split CSV buffers into independently parseable chunks.
+ */
+namespace csv_chunker
+{
+	/**
+	 * @brief Split the buffer after `begin` into record-aligned chunks.
+	 *
+	 * The region [begin, begin + chunk_count * chunk_bytes) is cut into
+	 * chunk_count pieces of roughly chunk_bytes each. Every cut is moved
+	 * forward to the end of the record it falls into. Quotes are counted in
+	 * parallel on the pool to know whether a cut lands inside a quoted field,
+	 * so line breaks inside quotes never split a record.
+	 *
+	 * Malformed quoting (a stray quote in an unquoted field) can shift the cuts
+	 * compared with a sequential parse, just like any quote-parity scheme.
+	 *
+	 * @param buffer      Whole CSV buffer.
+	 * @param begin       Offset of a record boundary to start from.
+	 * @param chunk_bytes Target chunk size in bytes.
+	 * @param chunk_count Maximum number of chunks to produce.
+	 * @param pool        Pool used to count quotes in parallel.
+	 * @return Consecutive, non-empty chunks starting at `begin`; empty if
+	 *         `begin` is at the end of the buffer.
+	 */
+	std::vector<CsvChunk> split(
+		std::string_view buffer,
+		std::size_t begin,
+		std::size_t chunk_bytes,
+		std::size_t chunk_count,
+		ThreadPool &pool);
+
+	/**
+	 * @brief Find the end of the record containing the given offset.
+	 *
+	 * @param buffer     Whole CSV buffer.
+	 * @param from       Offset to scan from.
+	 * @param in_quotes  Whether `from` lies inside a quoted field.
+	 * @return Offset just past the record terminator, or the buffer size.
+	 */
+	std::size_t find_record_end(std::string_view buffer, std::size_t from, bool in_quotes);
+}
@@ -0,0 +1,420 @@
+/// \file
+/// \brief Long-running import of rows appended to a local CSV file, driven by inotify.
+
+#include "import/csv_file_follower.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#include "core/job_tracker.h"
+#include "import/import_pipeline.h"
+#include "util/date_time.h"
+
+namespace
+{
+	/// Bytes read from the file per pread().
+	constexpr std::size_t read_chunk_size = 64 * 1024;
+
+	/**
+	 * @brief Build an error message from the current errno.
+	 */
+	std::runtime_error system_error(const std::string &what)
+	{
+		return std::runtime_error(what + ": " + std::strerror(errno));
+	}
+
+	/**
+	 * @brief Checkpoint source of one file: its device, inode and canonical path.
+	 *
+	 * The inode tells a rotated file apart from its successor at the same path.
+	 */
+	std::string follow_source(const std::string &path, const struct stat &info)
+	{
+		std::error_code error;
+		const auto canonical = std::filesystem::weakly_canonical(path, error);
+
+		return "follow:" + std::to_string(info.st_dev) + ":" + std::to_string(info.st_ino) + ":" +
+			(error ? path : canonical.string());
+	}
+
+	/**
+	 * @brief Directory holding the file, for the directory watch.
+	 */
+	std::string parent_directory(const std::string &path)
+	{
+		const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		return parent.empty() ? std::string(".") : parent.string();
+	}
+}
+
+CsvFileFollower::CsvFileFollower(std::string path, IApplicationRepository &repository, CsvFollowOptions options, char delimiter)
+	: path_(std::move(path))
+	, repository_(repository)
+	, options_(options)
+	, delimiter_(delimiter)
+	, buffer_(read_chunk_size)
+{
+	inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotify_fd_ < 0)
+	{
+		throw system_error("Failed to initialize inotify");
+	}
+
+	stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (stop_fd_ < 0)
+	{
+		const std::runtime_error error = system_error("Failed to create eventfd");
+		::close(inotify_fd_);
+		throw error;
+	}
+}
+
+CsvFileFollower::~CsvFileFollower()
+{
+	close_file();
+	::close(stop_fd_);
+	::close(inotify_fd_);
+}
+
+void CsvFileFollower::run(const ImportCallback &on_import, const ErrorCallback &on_error)
+{
+	// The directory watch reports a file created at the path or renamed onto it.
+	const std::string directory = parent_directory(path_);
+	directory_watch_ = inotify_add_watch(inotify_fd_, directory.c_str(), IN_CREATE | IN_MOVED_TO);
+	if (directory_watch_ < 0)
+	{
+		throw system_error("Failed to watch directory " + directory);
+	}
+
+	while (!stopping_.load())
+	{
+		try
+		{
+			if (options_.import.skip_known && !known_)
+			{
+				known_ = std::make_unique<KnownRecordFilter>(repository_);
+			}
+
+			if (file_fd_ < 0 && !open_file())
+			{
+				wait_for_change(options_.rescan_interval);
+				continue;
+			}
+
+			// Check before reading, so rows written to the old file before it was
+			// replaced are still read from it.
+			const bool replaced = path_replaced();
+
+			const ImportResult result = read_appended();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				++stats_.wakeups;
+				stats_.total += result.total;
+				stats_.imported += result.imported;
+				stats_.skipped += result.skipped;
+				stats_.offset = checkpoint_.offset;
+			}
+			if (on_import && result.total > 0)
+			{
+				on_import(result);
+			}
+
+			if (replaced)
+			{
+				close_file();
+				std::lock_guard<std::mutex> lock(mutex_);
+				++stats_.rotations;
+				continue;
+			}
+
+			wait_for_change(options_.rescan_interval);
+		}
+		catch (const std::exception &ex)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				++stats_.failures;
+				stats_.last_error = ex.what();
+			}
+			if (on_error)
+			{
+				on_error(ex.what());
+			}
+
+			// Reopening continues from the last committed checkpoint.
+			close_file();
+			pause(options_.retry_delay);
+		}
+	}
+
+	close_file();
+	inotify_rm_watch(inotify_fd_, directory_watch_);
+	directory_watch_ = -1;
+}
+
+void CsvFileFollower::stop()
+{
+	stopping_.store(true);
+
+	const std::uint64_t one = 1;
+	[[maybe_unused]] const ssize_t written = ::write(stop_fd_, &one, sizeof(one));
+}
+
+CsvFollowStats CsvFileFollower::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+bool CsvFileFollower::open_file()
+{
+	file_fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file_fd_ < 0)
+	{
+		if (errno == ENOENT)
+		{
+			return false;
+		}
+		throw system_error("Failed to open CSV file " + path_);
+	}
+
+	struct stat info{};
+	if (fstat(file_fd_, &info) != 0)
+	{
+		throw system_error("Failed to inspect CSV file " + path_);
+	}
+	device_ = static_cast<std::uint64_t>(info.st_dev);
+	inode_ = static_cast<std::uint64_t>(info.st_ino);
+
+	file_watch_ = inotify_add_watch(inotify_fd_, path_.c_str(), IN_MODIFY);
+	if (file_watch_ < 0)
+	{
+		throw system_error("Failed to watch CSV file " + path_);
+	}
+
+	checkpoint_ = ImportCheckpoint{};
+	checkpoint_.source = follow_source(path_, info);
+	if (const auto saved = repository_.find_checkpoint(checkpoint_.source))
+	{
+		checkpoint_ = *saved;
+	}
+
+	// A file shorter than its checkpoint was truncated while nobody followed it.
+	if (checkpoint_.offset > static_cast<std::uint64_t>(info.st_size))
+	{
+		checkpoint_.offset = 0;
+		repository_.save_checkpoint(checkpoint_);
+		std::lock_guard<std::mutex> lock(mutex_);
+		++stats_.truncations;
+	}
+
+	reset_reader(checkpoint_.offset);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	stats_.offset = checkpoint_.offset;
+	return true;
+}
+
+void CsvFileFollower::close_file()
+{
+	if (file_watch_ >= 0)
+	{
+		inotify_rm_watch(inotify_fd_, file_watch_);
+		file_watch_ = -1;
+	}
+	if (file_fd_ >= 0)
+	{
+		::close(file_fd_);
+		file_fd_ = -1;
+	}
+	tokenizer_.reset();
+	decoder_.reset();
+}
+
+void CsvFileFollower::reset_reader(std::uint64_t offset)
+{
+	tokenizer_ = std::make_unique<CsvStreamTokenizer>(delimiter_);
+	decoder_.reset();
+	tokenizer_base_ = offset;
+	read_offset_ = offset;
+
+	if (offset == 0)
+	{
+		// The header is the first record the tokenizer hands out.
+		return;
+	}
+
+	// Resuming past the header: read it on its own to build the decoder.
+	CsvStreamTokenizer header(delimiter_);
+	std::uint64_t position = 0;
+	while (!header.next_record(fields_))
+	{
+		const ssize_t count = pread(file_fd_, buffer_.data(), buffer_.size(), static_cast<off_t>(position));
+		if (count < 0)
+		{
+			throw system_error("Failed to read CSV file " + path_);
+		}
+		if (count == 0 || position >= offset)
+		{
+			throw std::runtime_error("CSV file " + path_ + " has no header before byte " + std::to_string(offset));
+		}
+		position += static_cast<std::uint64_t>(count);
+		header.append(std::string_view(buffer_.data(), static_cast<std::size_t>(count)));
+	}
+
+	decoder_ = std::make_unique<CsvRowDecoder>(fields_, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+}
+
+ImportResult CsvFileFollower::read_appended()
+{
+	ImportResult result{};
+
+	struct stat info{};
+	if (fstat(file_fd_, &info) != 0)
+	{
+		throw system_error("Failed to inspect CSV file " + path_);
+	}
+	const auto size = static_cast<std::uint64_t>(info.st_size);
+
+	if (size < read_offset_)
+	{
+		// Truncated in place (e.g. copytruncate rotation): start over at the header.
+		checkpoint_.offset = 0;
+		repository_.save_checkpoint(checkpoint_);
+		reset_reader(0);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		++stats_.truncations;
+	}
+
+	std::vector<Application> batch;
+	while (read_offset_ < size)
+	{
+		const std::size_t wanted = static_cast<std::size_t>(std::min<std::uint64_t>(buffer_.size(), size - read_offset_));
+		const ssize_t count = pread(file_fd_, buffer_.data(), wanted, static_cast<off_t>(read_offset_));
+		if (count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw system_error("Failed to read CSV file " + path_);
+		}
+		if (count == 0)
+		{
+			break;
+		}
+
+		read_offset_ += static_cast<std::uint64_t>(count);
+		tokenizer_->append(std::string_view(buffer_.data(), static_cast<std::size_t>(count)));
+		decode_records(batch, result);
+	}
+
+	if (!batch.empty())
+	{
+		commit_batch(batch, tokenizer_base_ + tokenizer_->offset(), result);
+	}
+
+	if (known_)
+	{
+		result.known_records = known_->stats();
+	}
+	return result;
+}
+
+void CsvFileFollower::decode_records(std::vector<Application> &batch, ImportResult &result)
+{
+	const std::size_t batch_size = std::max<std::size_t>(options_.import.batch_size, 1);
+
+	while (tokenizer_->next_record(fields_))
+	{
+		if (!decoder_)
+		{
+			decoder_ = std::make_unique<CsvRowDecoder>(fields_, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+			continue;
+		}
+
+		batch.emplace_back();
+		if (!decoder_->decode(fields_, batch.back()))
+		{
+			batch.pop_back();
+			continue;
+		}
+
+		if (batch.size() >= batch_size)
+		{
+			commit_batch(batch, tokenizer_base_ + tokenizer_->offset(), result);
+		}
+	}
+}
+
+void CsvFileFollower::commit_batch(std::vector<Application> &batch, std::uint64_t offset, ImportResult &result)
+{
+	result.total += batch.size();
+
+	std::vector<std::uint64_t> fingerprints;
+	if (known_)
+	{
+		record_fingerprints(batch, fingerprints);
+		result.skipped += known_->drop_known(batch, fingerprints);
+	}
+
+	// Computed per batch: a follower runs across midnight.
+	const std::string today = datetime::today_iso();
+	for (auto &app : batch)
+	{
+		JobTracker::apply_defaults(app, today);
+	}
+
+	checkpoint_.offset = offset;
+	ImportPipeline::write_batch(repository_, batch, result, &checkpoint_, known_ ? &fingerprints : nullptr);
+	batch.clear();
+}
+
+bool CsvFileFollower::path_replaced() const
+{
+	struct stat info{};
+	if (::stat(path_.c_str(), &info) != 0)
+	{
+		// Removed without a successor yet: keep reading the open file.
+		return false;
+	}
+	return static_cast<std::uint64_t>(info.st_dev) != device_ || static_cast<std::uint64_t>(info.st_ino) != inode_;
+}
+
+void CsvFileFollower::wait_for_change(std::chrono::milliseconds timeout)
+{
+	pollfd descriptors[2] = {
+		{inotify_fd_, POLLIN, 0},
+		{stop_fd_, POLLIN, 0},
+	};
+
+	if (poll(descriptors, 2, static_cast<int>(timeout.count())) <= 0 || (descriptors[0].revents & POLLIN) == 0)
+	{
+		return;
+	}
+
+	// Which event it was does not matter: the file itself is checked next.
+	alignas(inotify_event) char events[4096];
+	while (::read(inotify_fd_, events, sizeof(events)) > 0)
+	{
+	}
+}
+
+void CsvFileFollower::pause(std::chrono::milliseconds duration)
+{
+	pollfd descriptor{stop_fd_, POLLIN, 0};
+	poll(&descriptor, 1, static_cast<int>(duration.count()));
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/import_checkpoint.h"
+#include "import/csv_row_decoder.h"
+#include "import/csv_stream_tokenizer.h"
+#include "import/import_service.h"
+#include "import/known_record_filter.h"
+#include "storage/application_repository.h"
+
+/**
+ * @brief Tuning options for CsvFileFollower.
+ */
+struct CsvFollowOptions
+{
+	/// Longest wait without a file event before the file is checked anyway.
+	std::chrono::milliseconds rescan_interval{std::chrono::seconds(30)};
+
+	/// Delay before the file is reopened after a failure.
+	std::chrono::milliseconds retry_delay{std::chrono::seconds(1)};
+
+	/// Options of every commit; small batches make appended rows visible early.
+	ImportOptions import{100};
+};
+
+/**
+ * @brief Counters of a CsvFileFollower run.
+ */
+struct CsvFollowStats
+{
+	/// Number of times the follower woke up and read the file.
+	std::size_t wakeups = 0;
+
+	/// Number of rows read, including those that failed to insert.
+	std::size_t total = 0;
+
+	/// Number of applications imported.
+	std::size_t imported = 0;
+
+	/// Number of rows dropped as known (ImportOptions::skip_known).
+	std::size_t skipped = 0;
+
+	/// Number of times the file shrank and was read again from the start.
+	std::size_t truncations = 0;
+
+	/// Number of times a new file replaced the followed one.
+	std::size_t rotations = 0;
+
+	/// Number of failed reads or commits.
+	std::size_t failures = 0;
+
+	/// Byte offset just past the last committed record of the current file.
+	std::uint64_t offset = 0;
+
+	/// Message of the last failure; empty if none.
+	std::string last_error;
+};
+
+/**
+ * @brief Imports rows appended to a local CSV file as they are written.
+ *
+ * The follower sleeps in poll() on an inotify descriptor that watches the
+ * file and its directory, so an idle follower uses no CPU. When the file
+ * grows, only the bytes past the last consumed offset are read and handed
+ * to a CsvStreamTokenizer; complete records are decoded and committed in
+ * transactions of ImportOptions::batch_size rows, together with a
+ * checkpoint of the offset. A partial last line stays unread until its line
+ * break arrives. The checkpoint is keyed by the file's device and inode, so
+ * a restarted follower continues where the previous one stopped.
+ *
+ * - Truncation: when the file becomes shorter than the consumed offset, it
+ *   is read again from its header.
+ * - Rotation: when another file appears at the path (rename or delete and
+ *   recreate), the rest of the old file is read first, then the new file
+ *   is followed from its start.
+ *
+ * A failed read or commit is reported and retried after
+ * CsvFollowOptions::retry_delay from the last committed checkpoint.
+ */
+class CsvFileFollower
+{
+public:
+	/// Called after every wakeup that read new rows, with the counts of that wakeup.
+	using ImportCallback = std::function<void(const ImportResult &)>;
+
+	/// Called after every failure with its message.
+	using ErrorCallback = std::function<void(const std::string &)>;
+
+	/**
+	 * @brief Construct a follower; the file is not opened before run().
+	 *
+	 * @param path       Path of the CSV file; it does not need to exist yet.
+	 * @param repository Repository receiving the applications; must outlive the follower.
+	 * @param options    Rescan, retry and import options.
+	 * @param delimiter  Delimiter character used to separate fields.
+	 *
+	 * @throws std::runtime_error if inotify is unavailable.
+	 */
+	CsvFileFollower(std::string path, IApplicationRepository &repository, CsvFollowOptions options = {}, char delimiter = ',');
+
+	~CsvFileFollower();
+
+	CsvFileFollower(const CsvFileFollower &) = delete;
+	CsvFileFollower &operator=(const CsvFileFollower &) = delete;
+
+	/**
+	 * @brief Import appended rows until stop() is called.
+	 *
+	 * Rows already in the file are imported first, unless a checkpoint shows
+	 * they were committed before. Failures are reported to `on_error` and
+	 * retried; run() itself does not throw on I/O or storage errors.
+	 *
+	 * @param on_import Receives the counts of every wakeup that read rows; may be empty.
+	 * @param on_error  Receives every failure; may be empty.
+	 *
+	 * @throws std::runtime_error if the directory of the file cannot be watched.
+	 */
+	void run(const ImportCallback &on_import = {}, const ErrorCallback &on_error = {});
+
+	/**
+	 * @brief Make run() return soon; safe to call from any thread.
+	 */
+	void stop();
+
+	/**
+	 * @brief Counters so far; safe to call from any thread.
+	 */
+	CsvFollowStats stats() const;
+
+private:
+	/// Path of the CSV file as given.
+	std::string path_;
+
+	/// Repository receiving the applications.
+	IApplicationRepository &repository_;
+
+	/// Rescan, retry and import options.
+	CsvFollowOptions options_;
+
+	/// Delimiter character used to separate fields.
+	char delimiter_;
+
+	/// inotify descriptor watching the file and its directory.
+	int inotify_fd_ = -1;
+
+	/// eventfd written by stop() to end poll().
+	int stop_fd_ = -1;
+
+	/// Watch descriptor of the directory of the file.
+	int directory_watch_ = -1;
+
+	/// Watch descriptor of the open file; -1 if none.
+	int file_watch_ = -1;
+
+	/// Descriptor of the followed file; -1 while it is not open.
+	int file_fd_ = -1;
+
+	/// Device and inode of the open file.
+	std::uint64_t device_ = 0;
+	std::uint64_t inode_ = 0;
+
+	/// Offset of the next byte to read from the file.
+	std::uint64_t read_offset_ = 0;
+
+	/// File offset at which tokenizer_ started.
+	std::uint64_t tokenizer_base_ = 0;
+
+	/// Tokenizer over the bytes read since tokenizer_base_.
+	std::unique_ptr<CsvStreamTokenizer> tokenizer_;
+
+	/// Decoder built from the header; null until the header was read.
+	std::unique_ptr<CsvRowDecoder> decoder_;
+
+	/// Checkpoint of the open file.
+	ImportCheckpoint checkpoint_;
+
+	/// Filter dropping known records; null unless ImportOptions::skip_known.
+	std::unique_ptr<KnownRecordFilter> known_;
+
+	/// Bytes read from the file, handed to tokenizer_.
+	std::vector<char> buffer_;
+
+	/// Fields of the record being decoded.
+	std::vector<std::string_view> fields_;
+
+	/// Set by stop().
+	std::atomic<bool> stopping_{false};
+
+	/// Guards stats_.
+	mutable std::mutex mutex_;
+
+	/// Counters so far.
+	CsvFollowStats stats_;
+
+	/**
+	 * @brief Open the file at the path and position it at its checkpoint.
+	 *
+	 * @return false if no file exists at the path.
+	 */
+	bool open_file();
+
+	/**
+	 * @brief Close the open file and forget its reading state.
+	 */
+	void close_file();
+
+	/**
+	 * @brief Restart reading the open file at `offset`, re-reading the header if needed.
+	 */
+	void reset_reader(std::uint64_t offset);
+
+	/**
+	 * @brief Read what was appended to the open file and commit its complete records.
+	 *
+	 * @return Counts of the rows read; total is 0 if nothing new was complete.
+	 */
+	ImportResult read_appended();
+
+	/**
+	 * @brief Decode the complete records held by the tokenizer into `batch`, committing every full batch.
+	 */
+	void decode_records(std::vector<Application> &batch, ImportResult &result);
+
+	/**
+	 * @brief Commit a batch of decoded rows with the checkpoint at `offset`.
+	 */
+	void commit_batch(std::vector<Application> &batch, std::uint64_t offset, ImportResult &result);
+
+	/**
+	 * @brief Whether the path now names another file than the open one.
+	 */
+	bool path_replaced() const;
+
+	/**
+	 * @brief Wait for a file event, the rescan interval or stop().
+	 */
+	void wait_for_change(std::chrono::milliseconds timeout);
+
+	/**
+	 * @brief Sleep for the given time or until stop() is called.
+	 */
+	void pause(std::chrono::milliseconds duration);
+};
@@ -3,101 +3,357 @@
 
 #include "import/csv_import_source.h"
 
-#include <fstream>
-#include <sstream>
-#include <stdexcept>
-#include <unordered_map>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <optional>
+#include <string_view>
+#include <utility>
 
-#include "util/string_utils.h"
+#include "import/csv_chunker.h"
+#include "import/csv_row_decoder.h"
+#include "import/csv_stream_tokenizer.h"
+#include "import/csv_tokenizer.h"
+#include "import/gzip_file_reader.h"
+#include "util/mapped_file.h"
+#include "util/thread_pool.h"
 
-CsvImportSource::CsvImportSource(const std::string &path, char delimiter)
-	: path_(path)
-	, delimiter_(delimiter)
+namespace
 {
-}
+	/// Target number of bytes decoded by one worker per parallel round.
+	constexpr std::size_t parallel_chunk_bytes = 4U * 1024U * 1024U;
 
-std::vector<Application> CsvImportSource::fetch_applications()
-{
-	std::ifstream file(path_);
-	if (!file.is_open())
+	/**
+	 * @brief Stream that decodes a memory-mapped CSV file record by record.
+	 *
+	 * With more than one thread, the file is decoded in rounds: each round
+	 * splits the next few megabytes into record-aligned chunks, decodes them
+	 * on a thread pool and queues the per-chunk batches in file order.
+	 *
+	 * A non-zero start offset skips straight to that record after reading the
+	 * header; the pages in between are never touched.
+	 */
+	class CsvFileStream : public IApplicationStream
 	{
-		throw std::runtime_error("Failed to open CSV file: " + path_);
-	}
+	public:
+		CsvFileStream(const std::string &path, char delimiter, std::size_t thread_count, std::size_t start_offset)
+			: file_(path)
+			, tokenizer_(file_.view(), delimiter)
+			, delimiter_(delimiter)
+		{
+			if (tokenizer_.next_record(fields_))
+			{
+				decoder_.emplace(fields_, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+			}
 
-	std::string header_line;
-	if (!std::getline(file, header_line))
-	{
-		// Empty file – nothing to import.
-		return {};
-	}
+			if (start_offset > tokenizer_.offset())
+			{
+				tokenizer_.seek(start_offset);
+			}
+			consumed_offset_ = tokenizer_.offset();
 
-	const auto header_parts = string_utils::split(header_line, delimiter_);
+			if (thread_count > 1)
+			{
+				pool_ = std::make_unique<ThreadPool>(thread_count);
+				next_offset_ = tokenizer_.offset();
+			}
+		}
 
-	// Map normalized column names -> index.
-	std::unordered_map<std::string, std::size_t> column_index;
+		bool next_batch(std::vector<Application> &batch, std::size_t max_count) override
+		{
+			// Empty file – nothing to import.
+			if (!decoder_)
+			{
+				batch.clear();
+				return false;
+			}
 
-	for (std::size_t i = 0; i < header_parts.size(); ++i)
-	{
-		const auto name_trimmed = string_utils::trim(header_parts[i]);
-		const auto name_lower = string_utils::to_lower(name_trimmed);
-		if (!name_lower.empty())
+			const std::size_t limit = std::max<std::size_t>(max_count, 1);
+
+			if (pool_)
+			{
+				batch.clear();
+				take_decoded(batch, limit);
+				return !batch.empty();
+			}
+
+			{
+				ApplicationBatchFiller filler(batch);
+				while (filler.size() < limit && tokenizer_.next_record(fields_))
+				{
+					if (decoder_->decode(fields_, filler.slot()))
+					{
+						filler.commit();
+					}
+				}
+			}
+			consumed_offset_ = tokenizer_.offset();
+
+			// Consumed pages are not needed any more; keep the resident set bounded.
+			file_.discard_before(tokenizer_.offset());
+
+			return !batch.empty();
+		}
+
+		std::uint64_t resume_offset() const override
 		{
-			column_index[name_lower] = i;
+			return consumed_offset_;
 		}
-	}
 
-	auto get_column = [&](const std::vector<std::string> &cols, const std::string &name) -> std::string
-	{
-		const auto it = column_index.find(name);
-		if (it == column_index.end())
+	private:
+		/**
+		 * @brief Applications decoded from one chunk, with the end offset of each record.
+		 */
+		struct DecodedChunk
 		{
-			return {};
+			/// Decoded applications in file order.
+			std::vector<Application> applications;
+
+			/// File offset just past the record of each application.
+			std::vector<std::size_t> record_ends;
+
+			/// File offset just past the chunk.
+			std::size_t end = 0;
+		};
+
+		/// Mapped CSV file.
+		MappedFile file_;
+
+		/// Tokenizer over the mapped file (header and sequential mode).
+		CsvTokenizer tokenizer_;
+
+		/// Delimiter character used to separate columns.
+		char delimiter_;
+
+		/// Decoder built from the header row; empty for empty files.
+		std::optional<CsvRowDecoder> decoder_;
+
+		/// Reused field buffer.
+		std::vector<std::string_view> fields_;
+
+		/// Worker pool; only set when decoding in parallel.
+		std::unique_ptr<ThreadPool> pool_;
+
+		/// Offset of the first byte not yet handed to a worker (parallel mode).
+		std::size_t next_offset_ = 0;
+
+		/// File offset just past the last record handed out by next_batch().
+		std::size_t consumed_offset_ = 0;
+
+		/// Decoded chunk batches waiting to be handed out, in file order.
+		std::deque<DecodedChunk> decoded_;
+
+		/// Index of the next application to hand out from decoded_.front().
+		std::size_t decoded_index_ = 0;
+
+		/**
+		 * @brief Move up to `limit` decoded applications into the batch, decoding more as needed.
+		 */
+		void take_decoded(std::vector<Application> &batch, std::size_t limit)
+		{
+			while (batch.size() < limit)
+			{
+				if (decoded_.empty())
+				{
+					if (!decode_round())
+					{
+						return;
+					}
+					continue;
+				}
+
+				auto &front = decoded_.front();
+				while (batch.size() < limit && decoded_index_ < front.applications.size())
+				{
+					batch.push_back(std::move(front.applications[decoded_index_]));
+					consumed_offset_ = front.record_ends[decoded_index_];
+					++decoded_index_;
+				}
+
+				if (decoded_index_ == front.applications.size())
+				{
+					// Rows skipped at the end of the chunk are consumed as well.
+					consumed_offset_ = front.end;
+					decoded_.pop_front();
+					decoded_index_ = 0;
+				}
+			}
 		}
 
-		const std::size_t idx = it->second;
-		if (idx >= cols.size())
+		/**
+		 * @brief Decode the next round of chunks in parallel.
+		 *
+		 * @return false if the whole file has already been decoded.
+		 */
+		bool decode_round()
 		{
-			return {};
+			const std::string_view buffer = file_.view();
+			const auto chunks = csv_chunker::split(buffer, next_offset_, parallel_chunk_bytes, pool_->size(), *pool_);
+			if (chunks.empty())
+			{
+				return false;
+			}
+
+			std::vector<std::future<DecodedChunk>> results;
+			results.reserve(chunks.size());
+
+			for (const auto &chunk : chunks)
+			{
+				results.push_back(pool_->submit([this, buffer, chunk]()
+				{
+					return decode_chunk(buffer, chunk);
+				}));
+			}
+
+			// Collect in submission order so rows keep their file order.
+			for (auto &result : results)
+			{
+				decoded_.push_back(result.get());
+			}
+
+			next_offset_ = chunks.back().end;
+			file_.discard_before(next_offset_);
+			return true;
 		}
 
-		return string_utils::trim(cols[idx]);
-	};
+		/**
+		 * @brief Decode every record of a record-aligned chunk. Runs on a worker.
+		 */
+		DecodedChunk decode_chunk(std::string_view buffer, CsvChunk chunk) const
+		{
+			CsvTokenizer tokenizer(buffer.substr(chunk.begin, chunk.end - chunk.begin), delimiter_);
+			std::vector<std::string_view> fields;
+			DecodedChunk decoded;
+			decoded.end = chunk.end;
+
+			Application app;
+			while (tokenizer.next_record(fields))
+			{
+				if (decoder_->decode(fields, app))
+				{
+					decoded.applications.push_back(std::move(app));
+					decoded.record_ends.push_back(chunk.begin + tokenizer.offset());
+				}
+			}
 
-	std::vector<Application> result;
-	std::string line;
+			return decoded;
+		}
+	};
 
-	while (std::getline(file, line))
+	/**
+	 * @brief Stream that decodes a gzip-compressed CSV file while decompressing it.
+	 *
+	 * Decompressed chunks are fed into a CsvStreamTokenizer, so nothing is
+	 * written to disk and memory stays bounded by the chunk size. Offsets
+	 * (and thus checkpoints) count decompressed bytes. Resuming has to
+	 * decompress the skipped part again, but its records are not decoded.
+	 */
+	class GzipCsvFileStream : public IApplicationStream
 	{
-		if (line.empty())
+	public:
+		GzipCsvFileStream(const std::string &path, char delimiter, std::uint64_t start_offset)
+			: reader_(path)
+			, tokenizer_(delimiter)
+			, skip_until_(start_offset)
 		{
-			continue;
 		}
 
-		const auto parts = string_utils::split(line, delimiter_);
-		if (parts.empty())
+		bool next_batch(std::vector<Application> &batch, std::size_t max_count) override
 		{
-			continue;
-		}
+			const std::size_t limit = std::max<std::size_t>(max_count, 1);
+			ApplicationBatchFiller filler(batch);
 
-		Application app;
+			while (filler.size() < limit)
+			{
+				if (tokenizer_.next_record(fields_))
+				{
+					if (!decoder_)
+					{
+						decoder_.emplace(fields_, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+					}
+					else if (tokenizer_.offset() > skip_until_ && decoder_->decode(fields_, filler.slot()))
+					{
+						filler.commit();
+					}
+					consumed_offset_ = tokenizer_.offset();
+					continue;
+				}
 
-		app.company = get_column(parts, "company");
-		app.position = get_column(parts, "position");
-		app.location = get_column(parts, "location");
-		app.source = get_column(parts, "source");
-		app.status = get_column(parts, "status");
-		app.applied_date = get_column(parts, "applied_date");
-		app.last_update = get_column(parts, "last_update");
-		app.notes = get_column(parts, "notes");
+				if (tokenizer_.exhausted())
+				{
+					break;
+				}
 
-		// Minimal sanity check: we require at least company + position.
-		if (app.company.empty() && app.position.empty())
+				if (reader_.read(chunk_))
+				{
+					tokenizer_.append(chunk_);
+				}
+				else
+				{
+					tokenizer_.finish();
+				}
+			}
+
+			return filler.size() > 0;
+		}
+
+		std::uint64_t resume_offset() const override
 		{
-			continue;
+			return consumed_offset_;
 		}
 
-		result.push_back(app);
-	}
+	private:
+		/// Decompresses the file chunk by chunk.
+		GzipFileReader reader_;
+
+		/// Tokenizer reassembling records across decompressed chunks.
+		CsvStreamTokenizer tokenizer_;
+
+		/// Decoder built from the header row; empty until it was read.
+		std::optional<CsvRowDecoder> decoder_;
+
+		/// Reused field buffer.
+		std::vector<std::string_view> fields_;
+
+		/// Reused decompression buffer.
+		std::string chunk_;
+
+		/// Records ending at or before this decompressed offset were imported before.
+		std::uint64_t skip_until_;
+
+		/// Decompressed offset just past the last record handed out.
+		std::uint64_t consumed_offset_ = 0;
+	};
+}
+
+CsvImportSource::CsvImportSource(const std::string &path, char delimiter, std::size_t thread_count)
+	: path_(path)
+	, delimiter_(delimiter)
+	, thread_count_(thread_count)
+{
+}
+
+std::vector<Application> CsvImportSource::fetch_applications()
+{
+	const auto stream = open_stream();
+	return drain_stream(*stream);
+}
 
-	return result;
+std::unique_ptr<IApplicationStream> CsvImportSource::open_stream()
+{
+	return open_stream_at(0);
+}
+
+std::optional<ImportCheckpoint> CsvImportSource::checkpoint_identity()
+{
+	return file_checkpoint_identity(path_);
+}
+
+std::unique_ptr<IApplicationStream> CsvImportSource::open_stream_at(std::uint64_t offset)
+{
+	if (GzipFileReader::is_gzip_path(path_))
+	{
+		return std::make_unique<GzipCsvFileStream>(path_, delimiter_, offset);
+	}
+	return std::make_unique<CsvFileStream>(path_, delimiter_, thread_count_, static_cast<std::size_t>(offset));
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -10,7 +14,13 @@
  * @brief Import source that reads job applications from a CSV file.
  *
  * The CSV file is expected to have a header row. Column names are matched
- * in a case-insensitive way. Unknown columns are ignored.
+ * in a case-insensitive way. Unknown columns are ignored. Fields may be
+ * quoted as described in RFC 4180 (see CsvTokenizer), so values can contain
+ * delimiters, line breaks and escaped quotes.
+ *
+ * Files ending in ".gz" are gzip-compressed CSV. They are decompressed while
+ * they are parsed, without a temporary file; decompression is sequential, so
+ * such files are decoded on one thread regardless of `thread_count`.
  *
  * Supported column names:
  *   - company
@@ -28,10 +38,13 @@ class CsvImportSource : public IImportSource
 	/**
 	 * @brief Construct a CsvImportSource for the given file path.
 	 *
-	 * @param path      Path to the CSV file.
-	 * @param delimiter Delimiter character used to separate columns (default: ',').
+	 * @param path         Path to the CSV file.
+	 * @param delimiter    Delimiter character used to separate columns (default: ',').
+	 * @param thread_count Number of threads decoding rows (default: 1). With more
+	 *                     than one thread, record-aligned chunks of the file are
+	 *                     decoded in parallel; row order is preserved.
 	 */
-	explicit CsvImportSource(const std::string &path, char delimiter = ',');
+	explicit CsvImportSource(const std::string &path, char delimiter = ',', std::size_t thread_count = 1);
 
 	/**
 	 * @brief Read the CSV file and convert each row into an Application.
@@ -40,10 +53,48 @@ class CsvImportSource : public IImportSource
 	 */
 	std::vector<Application> fetch_applications() override;
 
+	/**
+	 * @brief Open a stream that decodes the CSV file batch by batch.
+	 *
+	 * The file is memory-mapped and consumed pages are released as the stream
+	 * advances, so memory use does not grow with the file size. Gzip files are
+	 * decompressed chunk by chunk into the parser.
+	 *
+	 * @return A stream over the rows of the CSV file.
+	 *
+	 * @throws std::runtime_error if the file cannot be opened.
+	 */
+	std::unique_ptr<IApplicationStream> open_stream() override;
+
+	/**
+	 * @brief Identify the file by canonical path, size and modification time.
+	 *
+	 * @return Checkpoint identity; std::nullopt if the file cannot be inspected.
+	 */
+	std::optional<ImportCheckpoint> checkpoint_identity() override;
+
+	/**
+	 * @brief Open a stream that starts at a record boundary inside the file.
+	 *
+	 * The header row is still read to map the columns, then decoding jumps
+	 * straight to the offset, so only the remaining bytes are read. For gzip
+	 * files the offset counts decompressed bytes; the part before it is
+	 * decompressed again but not decoded.
+	 *
+	 * @param offset Record boundary returned by IApplicationStream::resume_offset().
+	 * @return A stream over the remaining rows.
+	 *
+	 * @throws std::runtime_error if the file cannot be opened.
+	 */
+	std::unique_ptr<IApplicationStream> open_stream_at(std::uint64_t offset) override;
+
 private:
 	/// Path to the CSV file.
 	std::string path_;
 
 	/// Delimiter character used to separate columns.
 	char delimiter_;
+
+	/// Number of threads decoding rows.
+	std::size_t thread_count_;
 };
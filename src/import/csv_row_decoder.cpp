@@ -0,0 +1,218 @@
+/// \file
+/// \brief Header-driven mapping of CSV records onto Application objects.
+
+#include "import/csv_row_decoder.h"
+
+#include <cctype>
+#include <string>
+
+#include "util/string_utils.h"
+
+namespace
+{
+	/**
+	 * @brief An Application field that CSV columns can be projected onto.
+	 */
+	struct ProjectedField
+	{
+		/// Canonical column name.
+		std::string_view name;
+
+		/// Member receiving the column value.
+		std::string Application::*member;
+	};
+
+	/// Projected fields; indexes into this table are field indexes.
+	constexpr std::array<ProjectedField, CsvRowDecoder::projected_field_count> projected_fields = {{
+		{"company", &Application::company},
+		{"position", &Application::position},
+		{"location", &Application::location},
+		{"source", &Application::source},
+		{"status", &Application::status},
+		{"applied_date", &Application::applied_date},
+		{"last_update", &Application::last_update},
+		{"notes", &Application::notes},
+	}};
+
+	/**
+	 * @brief Alternative column name of a projected field.
+	 */
+	struct ColumnAlias
+	{
+		/// Normalized alias.
+		std::string_view name;
+
+		/// Index into projected_fields.
+		std::size_t field;
+	};
+
+	/// Aliases seen in exports of job boards and spreadsheets.
+	constexpr std::array<ColumnAlias, 16> column_aliases = {{
+		{"company_name", 0},
+		{"employer", 0},
+		{"organization", 0},
+		{"title", 1},
+		{"job_title", 1},
+		{"role", 1},
+		{"city", 2},
+		{"channel", 3},
+		{"stage", 4},
+		{"date_applied", 5},
+		{"applied_on", 5},
+		{"last_updated", 6},
+		{"updated", 6},
+		{"updated_at", 6},
+		{"note", 7},
+		{"comments", 7},
+	}};
+
+	/// Match quality of a column name; lower is better.
+	constexpr int canonical_match = 0;
+	constexpr int alias_match = 1;
+	constexpr int no_match = 2;
+
+	/**
+	 * @brief Trim, lower-case and turn spaces and dashes into underscores.
+	 */
+	std::string normalize_column_name(std::string_view name)
+	{
+		std::string normalized(string_utils::trim_view(name));
+		for (auto &c : normalized)
+		{
+			if (c == ' ' || c == '-')
+			{
+				c = '_';
+			}
+			else
+			{
+				c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+			}
+		}
+		return normalized;
+	}
+
+	/**
+	 * @brief Look up the field a normalized column name projects onto.
+	 *
+	 * @param name  Normalized column name.
+	 * @param match Receives canonical_match, alias_match or no_match.
+	 * @return Index into projected_fields; only meaningful if a match was found.
+	 */
+	std::size_t find_field(std::string_view name, int &match)
+	{
+		for (std::size_t field = 0; field < projected_fields.size(); ++field)
+		{
+			if (projected_fields[field].name == name)
+			{
+				match = canonical_match;
+				return field;
+			}
+		}
+
+		for (const auto &alias : column_aliases)
+		{
+			if (alias.name == name)
+			{
+				match = alias_match;
+				return alias.field;
+			}
+		}
+
+		match = no_match;
+		return 0;
+	}
+}
+
+CsvRowDecoder::CsvRowDecoder(const std::vector<std::string_view> &header, RequiredFields required)
+	: required_(required)
+{
+	columns_.fill(no_column);
+
+	std::array<int, projected_field_count> best_match;
+	best_match.fill(no_match);
+
+	for (std::size_t column = 0; column < header.size(); ++column)
+	{
+		int match = no_match;
+		const std::size_t field = find_field(normalize_column_name(header[column]), match);
+
+		// The best match wins; among equals the last column does.
+		if (match != no_match && match <= best_match[field])
+		{
+			columns_[field] = column;
+			best_match[field] = match;
+		}
+	}
+}
+
+bool CsvRowDecoder::decode(const std::vector<std::string_view> &fields, Application &app) const
+{
+	// Blank line.
+	if (fields.empty() || (fields.size() == 1 && fields[0].empty()))
+	{
+		return false;
+	}
+
+	for (std::size_t field = 0; field < projected_field_count; ++field)
+	{
+		std::string &value = app.*projected_fields[field].member;
+		const std::size_t column = columns_[field];
+
+		if (column < fields.size())
+		{
+			value.assign(string_utils::trim_view(fields[column]));
+		}
+		else
+		{
+			value.clear();
+		}
+	}
+
+	// Minimal sanity check on company + position.
+	if (required_ == RequiredFields::CompanyAndPosition)
+	{
+		return !app.company.empty() && !app.position.empty();
+	}
+
+	return !app.company.empty() || !app.position.empty();
+}
+
+bool CsvRowDecoder::accepts(const std::vector<std::string_view> &fields) const
+{
+	if (fields.empty() || (fields.size() == 1 && fields[0].empty()))
+	{
+		return false;
+	}
+
+	const bool has_company = !field_value(fields, 0).empty();
+	const bool has_position = !field_value(fields, 1).empty();
+
+	if (required_ == RequiredFields::CompanyAndPosition)
+	{
+		return has_company && has_position;
+	}
+	return has_company || has_position;
+}
+
+std::string_view CsvRowDecoder::field_value(const std::vector<std::string_view> &fields, std::size_t field) const
+{
+	const std::size_t column = columns_[field];
+	return column < fields.size() ? string_utils::trim_view(fields[column]) : std::string_view();
+}
+
+std::string_view CsvRowDecoder::field_name(std::size_t field)
+{
+	return projected_fields[field].name;
+}
+
+std::size_t CsvRowDecoder::column_of(std::string_view column) const
+{
+	for (std::size_t field = 0; field < projected_fields.size(); ++field)
+	{
+		if (projected_fields[field].name == column)
+		{
+			return columns_[field];
+		}
+	}
+	return no_column;
+}
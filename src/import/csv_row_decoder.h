@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "core/application.h"
+
+/**
+ * @brief Maps tokenized CSV records onto Application objects.
+ *
+ * The header record is compiled once into a projection table: for every
+ * Application field, the index of the column holding it. Decoding a row then
+ * only indexes into the record and assigns the trimmed field straight into
+ * the application's strings, without looking up column names or creating
+ * temporary strings. Shared by all CSV-based import sources so they agree on
+ * column names and trimming.
+ *
+ * Column names are trimmed and matched case-insensitively, with spaces and
+ * dashes treated like underscores ("Applied Date" matches applied_date).
+ * Common aliases are accepted as well (e.g. "employer" for company, "job
+ * title" for position); a column with the canonical name takes precedence
+ * over an alias. Unknown columns are ignored.
+ */
+class CsvRowDecoder
+{
+public:
+	/**
+	 * @brief Which fields a row must provide to be accepted.
+	 */
+	enum class RequiredFields
+	{
+		/// Accept rows that have a company or a position.
+		CompanyOrPosition,
+
+		/// Accept only rows that have both a company and a position.
+		CompanyAndPosition
+	};
+
+	/// Number of Application fields a column can be projected onto.
+	static constexpr std::size_t projected_field_count = 8;
+
+	/// Column index of a field missing from the header.
+	static constexpr std::size_t no_column = static_cast<std::size_t>(-1);
+
+	/**
+	 * @brief Build a decoder from the header record.
+	 *
+	 * @param header   Fields of the header record.
+	 * @param required Validation rule applied to decoded rows.
+	 */
+	CsvRowDecoder(const std::vector<std::string_view> &header, RequiredFields required);
+
+	/**
+	 * @brief Decode a data record.
+	 *
+	 * Blank lines and rows failing the RequiredFields rule are rejected.
+	 * Field values are assigned into the existing strings of `app`, so an
+	 * application reused across rows keeps its capacity.
+	 *
+	 * @param fields Fields of the data record.
+	 * @param app    Output application; only meaningful when true is returned.
+	 * @return true if the record produced an application.
+	 */
+	bool decode(const std::vector<std::string_view> &fields, Application &app) const;
+
+	/**
+	 * @brief Whether decode() would accept a record, without decoding it.
+	 *
+	 * @param fields Fields of the data record.
+	 * @return true if the record is not blank and passes the RequiredFields rule.
+	 */
+	bool accepts(const std::vector<std::string_view> &fields) const;
+
+	/**
+	 * @brief Trimmed value of one field of a data record, as decode() assigns it.
+	 *
+	 * @param fields Fields of the data record.
+	 * @param field  Index of the field, in the order of field_name().
+	 * @return View into the record; empty if the header or the record lacks the column.
+	 */
+	std::string_view field_value(const std::vector<std::string_view> &fields, std::size_t field) const;
+
+	/**
+	 * @brief Canonical column name of a field.
+	 *
+	 * Fields are numbered company, position, location, source, status,
+	 * applied_date, last_update, notes.
+	 *
+	 * @param field Index of the field; less than projected_field_count.
+	 */
+	static std::string_view field_name(std::size_t field);
+
+	/**
+	 * @brief Column index projected onto a field of Application.
+	 *
+	 * @param column Normalized canonical column name (e.g. "applied_date").
+	 * @return The column index, or no_column if the header lacks the field
+	 *         or the name is not a known column.
+	 */
+	std::size_t column_of(std::string_view column) const;
+
+private:
+	/// Column index of every projected field, in the order of the field table.
+	std::array<std::size_t, projected_field_count> columns_;
+
+	/// Validation rule applied to decoded rows.
+	RequiredFields required_;
+};
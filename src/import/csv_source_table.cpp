@@ -0,0 +1,494 @@
+/// \file
+/// \brief SQLite table-valued function streaming the records of a CSV file.
+
+#include "import/csv_source_table.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "core/application.h"
+#include "import/csv_row_decoder.h"
+#include "import/csv_stream_tokenizer.h"
+#include "import/csv_tokenizer.h"
+#include "import/gzip_file_reader.h"
+#include "util/date_time.h"
+#include "util/mapped_file.h"
+
+namespace
+{
+	/// Column of the hidden path argument; the Application fields come first.
+	constexpr int path_column = static_cast<int>(CsvRowDecoder::projected_field_count);
+
+	/// Column of the hidden delimiter argument.
+	constexpr int delimiter_column = path_column + 1;
+
+	/// Bit of idxNum telling xFilter that a delimiter argument was passed.
+	constexpr int delimiter_argument_flag = 1;
+
+	/**
+	 * @brief Source of the CSV records of a file, plain or gzip-compressed.
+	 */
+	class CsvRecordReader
+	{
+	public:
+		virtual ~CsvRecordReader() = default;
+
+		/**
+		 * @brief Read the next record (see CsvTokenizer::next_record()).
+		 */
+		virtual bool next_record(std::vector<std::string_view> &fields, std::size_t max_fields) = 0;
+	};
+
+	/**
+	 * @brief Records of a memory-mapped plain CSV file.
+	 */
+	class MappedCsvRecordReader : public CsvRecordReader
+	{
+	public:
+		MappedCsvRecordReader(const std::string &path, char delimiter)
+			: file_(path)
+			, tokenizer_(file_.view(), delimiter)
+		{
+		}
+
+		bool next_record(std::vector<std::string_view> &fields, std::size_t max_fields) override
+		{
+			if (!tokenizer_.next_record(fields, max_fields))
+			{
+				return false;
+			}
+
+			// Consumed pages are not needed any more; keep the resident set bounded.
+			file_.discard_before(tokenizer_.offset());
+			return true;
+		}
+
+	private:
+		/// Mapped CSV file.
+		MappedFile file_;
+
+		/// Tokenizer over the mapped file.
+		CsvTokenizer tokenizer_;
+	};
+
+	/**
+	 * @brief Records of a gzip-compressed CSV file, decompressed chunk by chunk.
+	 */
+	class GzipCsvRecordReader : public CsvRecordReader
+	{
+	public:
+		GzipCsvRecordReader(const std::string &path, char delimiter)
+			: reader_(path)
+			, tokenizer_(delimiter)
+		{
+		}
+
+		bool next_record(std::vector<std::string_view> &fields, std::size_t max_fields) override
+		{
+			while (!tokenizer_.next_record(fields, max_fields))
+			{
+				if (tokenizer_.exhausted())
+				{
+					return false;
+				}
+
+				if (reader_.read(chunk_))
+				{
+					tokenizer_.append(chunk_);
+				}
+				else
+				{
+					tokenizer_.finish();
+				}
+			}
+			return true;
+		}
+
+	private:
+		/// Decompresses the file chunk by chunk.
+		GzipFileReader reader_;
+
+		/// Tokenizer reassembling records across decompressed chunks.
+		CsvStreamTokenizer tokenizer_;
+
+		/// Reused decompression buffer.
+		std::string chunk_;
+	};
+
+	/**
+	 * @brief Cursor over the accepted records of one csv_source() call.
+	 */
+	struct CsvSourceCursor : sqlite3_vtab_cursor
+	{
+		/// Path argument.
+		std::string path;
+
+		/// Delimiter argument.
+		char delimiter = ',';
+
+		/// Records of the file.
+		std::unique_ptr<CsvRecordReader> reader;
+
+		/// Decoder built from the header; empty for empty files.
+		std::optional<CsvRowDecoder> decoder;
+
+		/// Fields of the current record, up to the last column needed.
+		std::vector<std::string_view> fields;
+
+		/// Number of leading fields the query needs from every record.
+		std::size_t field_limit = 0;
+
+		/// Number of the current accepted record, from 1.
+		sqlite3_int64 row = 0;
+
+		/// Whether the records are exhausted.
+		bool eof = true;
+
+		/**
+		 * @brief Move to the next record that CsvImportSource would import.
+		 */
+		void advance()
+		{
+			while (reader->next_record(fields, field_limit))
+			{
+				if (decoder->accepts(fields))
+				{
+					++row;
+					return;
+				}
+			}
+			eof = true;
+		}
+	};
+
+	/**
+	 * @brief Report an error of a cursor call through the virtual table.
+	 */
+	int fail(sqlite3_vtab_cursor *cursor, const char *message)
+	{
+		sqlite3_free(cursor->pVtab->zErrMsg);
+		cursor->pVtab->zErrMsg = sqlite3_mprintf("csv_source: %s", message);
+		return SQLITE_ERROR;
+	}
+
+	int csv_source_connect(sqlite3 *db, void *, int, const char *const *, sqlite3_vtab **table, char **)
+	{
+		std::string schema = "CREATE TABLE x(";
+		for (std::size_t field = 0; field < CsvRowDecoder::projected_field_count; ++field)
+		{
+			schema += std::string(CsvRowDecoder::field_name(field)) + " TEXT, ";
+		}
+		schema += "path HIDDEN, delimiter HIDDEN)";
+
+		const int rc = sqlite3_declare_vtab(db, schema.c_str());
+		if (rc != SQLITE_OK)
+		{
+			return rc;
+		}
+
+		*table = static_cast<sqlite3_vtab *>(sqlite3_malloc(sizeof(sqlite3_vtab)));
+		if (*table == nullptr)
+		{
+			return SQLITE_NOMEM;
+		}
+		**table = sqlite3_vtab{};
+		return SQLITE_OK;
+	}
+
+	int csv_source_disconnect(sqlite3_vtab *table)
+	{
+		sqlite3_free(table);
+		return SQLITE_OK;
+	}
+
+	int csv_source_best_index(sqlite3_vtab *table, sqlite3_index_info *info)
+	{
+		int path_constraint = -1;
+		int delimiter_constraint = -1;
+
+		for (int i = 0; i < info->nConstraint; ++i)
+		{
+			const auto &constraint = info->aConstraint[i];
+			if (constraint.op != SQLITE_INDEX_CONSTRAINT_EQ ||
+				(constraint.iColumn != path_column && constraint.iColumn != delimiter_column))
+			{
+				continue;
+			}
+
+			// Arguments only known later in a join: ask for another plan.
+			if (!constraint.usable)
+			{
+				return SQLITE_CONSTRAINT;
+			}
+			(constraint.iColumn == path_column ? path_constraint : delimiter_constraint) = i;
+		}
+
+		if (path_constraint < 0)
+		{
+			sqlite3_free(table->zErrMsg);
+			table->zErrMsg = sqlite3_mprintf("csv_source: the file path argument is required");
+			return SQLITE_ERROR;
+		}
+
+		info->aConstraintUsage[path_constraint].argvIndex = 1;
+		info->aConstraintUsage[path_constraint].omit = 1;
+		info->idxNum = 0;
+		if (delimiter_constraint >= 0)
+		{
+			info->aConstraintUsage[delimiter_constraint].argvIndex = 2;
+			info->aConstraintUsage[delimiter_constraint].omit = 1;
+			info->idxNum |= delimiter_argument_flag;
+		}
+
+		// Hand the used Application columns to xFilter for pushdown.
+		const auto field_mask = static_cast<int>(info->colUsed & ((1U << CsvRowDecoder::projected_field_count) - 1U));
+		info->idxNum |= field_mask << 1;
+
+		info->estimatedCost = 1000000.0;
+		info->estimatedRows = 1000000;
+		return SQLITE_OK;
+	}
+
+	int csv_source_open(sqlite3_vtab *, sqlite3_vtab_cursor **cursor)
+	{
+		auto *created = new (std::nothrow) CsvSourceCursor();
+		if (created == nullptr)
+		{
+			return SQLITE_NOMEM;
+		}
+		*cursor = created;
+		return SQLITE_OK;
+	}
+
+	int csv_source_close(sqlite3_vtab_cursor *cursor)
+	{
+		delete static_cast<CsvSourceCursor *>(cursor);
+		return SQLITE_OK;
+	}
+
+	int csv_source_filter(sqlite3_vtab_cursor *base, int idx_num, const char *, int argc, sqlite3_value **argv)
+	{
+		auto *cursor = static_cast<CsvSourceCursor *>(base);
+
+		try
+		{
+			const auto *path = argc > 0 ? reinterpret_cast<const char *>(sqlite3_value_text(argv[0])) : nullptr;
+			if (path == nullptr)
+			{
+				return fail(base, "the file path argument is required");
+			}
+			cursor->path = path;
+
+			cursor->delimiter = ',';
+			if ((idx_num & delimiter_argument_flag) != 0 && argc > 1)
+			{
+				const auto *delimiter = reinterpret_cast<const char *>(sqlite3_value_text(argv[1]));
+				if (delimiter == nullptr || std::char_traits<char>::length(delimiter) != 1)
+				{
+					return fail(base, "the delimiter must be a single character");
+				}
+				cursor->delimiter = delimiter[0];
+			}
+
+			if (GzipFileReader::is_gzip_path(cursor->path))
+			{
+				cursor->reader = std::make_unique<GzipCsvRecordReader>(cursor->path, cursor->delimiter);
+			}
+			else
+			{
+				cursor->reader = std::make_unique<MappedCsvRecordReader>(cursor->path, cursor->delimiter);
+			}
+
+			cursor->decoder.reset();
+			cursor->row = 0;
+			cursor->eof = true;
+			if (!cursor->reader->next_record(cursor->fields, CsvTokenizer::all_fields))
+			{
+				return SQLITE_OK;
+			}
+			cursor->decoder.emplace(cursor->fields, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+
+			// Records are tokenized up to the last column that is used or checked by accepts().
+			const int used_fields = idx_num >> 1;
+			cursor->field_limit = 0;
+			for (std::size_t field = 0; field < CsvRowDecoder::projected_field_count; ++field)
+			{
+				const bool needed = field < 2 || (used_fields & (1 << field)) != 0;
+				const std::size_t column = cursor->decoder->column_of(CsvRowDecoder::field_name(field));
+				if (needed && column != CsvRowDecoder::no_column)
+				{
+					cursor->field_limit = std::max(cursor->field_limit, column + 1);
+				}
+			}
+
+			cursor->eof = false;
+			cursor->advance();
+			return SQLITE_OK;
+		}
+		catch (const std::exception &ex)
+		{
+			cursor->eof = true;
+			return fail(base, ex.what());
+		}
+	}
+
+	int csv_source_next(sqlite3_vtab_cursor *base)
+	{
+		auto *cursor = static_cast<CsvSourceCursor *>(base);
+
+		try
+		{
+			cursor->advance();
+			return SQLITE_OK;
+		}
+		catch (const std::exception &ex)
+		{
+			cursor->eof = true;
+			return fail(base, ex.what());
+		}
+	}
+
+	int csv_source_eof(sqlite3_vtab_cursor *base)
+	{
+		return static_cast<CsvSourceCursor *>(base)->eof ? 1 : 0;
+	}
+
+	int csv_source_column(sqlite3_vtab_cursor *base, sqlite3_context *context, int column)
+	{
+		const auto *cursor = static_cast<CsvSourceCursor *>(base);
+
+		if (column == path_column)
+		{
+			sqlite3_result_text(context, cursor->path.data(), static_cast<int>(cursor->path.size()), SQLITE_TRANSIENT);
+		}
+		else if (column == delimiter_column)
+		{
+			sqlite3_result_text(context, &cursor->delimiter, 1, SQLITE_TRANSIENT);
+		}
+		else
+		{
+			// The views die with the next record, so SQLite copies the value.
+			const std::string_view value = cursor->decoder->field_value(cursor->fields, static_cast<std::size_t>(column));
+			if (value.empty())
+			{
+				// A missing column reads as '' like in CsvImportSource, not as NULL.
+				sqlite3_result_text(context, "", 0, SQLITE_STATIC);
+			}
+			else
+			{
+				sqlite3_result_text(context, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+			}
+		}
+		return SQLITE_OK;
+	}
+
+	int csv_source_rowid(sqlite3_vtab_cursor *base, sqlite3_int64 *rowid)
+	{
+		*rowid = static_cast<CsvSourceCursor *>(base)->row;
+		return SQLITE_OK;
+	}
+
+	/**
+	 * @brief Module of csv_source(), eponymous-only: without xCreate, `CREATE VIRTUAL TABLE` is rejected.
+	 *
+	 * Filled in field by field; the trailing members differ between SQLite versions.
+	 */
+	sqlite3_module make_csv_source_module()
+	{
+		sqlite3_module module{};
+		module.xConnect = csv_source_connect;
+		module.xBestIndex = csv_source_best_index;
+		module.xDisconnect = csv_source_disconnect;
+		module.xOpen = csv_source_open;
+		module.xClose = csv_source_close;
+		module.xFilter = csv_source_filter;
+		module.xNext = csv_source_next;
+		module.xEof = csv_source_eof;
+		module.xColumn = csv_source_column;
+		module.xRowid = csv_source_rowid;
+		return module;
+	}
+
+	/// Shared by every connection; SQLite keeps a pointer to it.
+	const sqlite3_module csv_source_module = make_csv_source_module();
+}
+
+void register_csv_source(sqlite3 *db)
+{
+	if (sqlite3_create_module(db, "csv_source", &csv_source_module, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error(std::string("Failed to register csv_source: ") + sqlite3_errmsg(db));
+	}
+}
+
+std::size_t import_csv_where(SqliteDatabase &database, const std::string &path, const std::string &condition, char delimiter)
+{
+	// Same defaults as JobTracker::apply_defaults(); ?2 is today's date, ?4 the default status.
+	std::string sql =
+		"INSERT INTO applications ("
+		"  company, position, location, source, status, applied_date, last_update, notes"
+		") SELECT company, position, location, source,"
+		"  CASE WHEN status = '' THEN ?4 ELSE status END,"
+		"  CASE WHEN applied_date = '' THEN ?2 ELSE applied_date END,"
+		"  CASE WHEN last_update = '' THEN ?2 ELSE last_update END,"
+		"  notes "
+		"FROM csv_source(?1, ?3)";
+	if (!condition.empty())
+	{
+		sql += " WHERE (" + condition + ")";
+	}
+
+	sqlite3 *db = database.handle();
+	sqlite3_stmt *stmt = nullptr;
+	const char *tail = nullptr;
+	if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, &tail) != SQLITE_OK)
+	{
+		throw std::runtime_error(std::string("Invalid import condition: ") + sqlite3_errmsg(db));
+	}
+
+	// The condition is spliced into the statement; it must not smuggle in another one.
+	if (tail != nullptr && std::string_view(tail).find_first_not_of(" \t\r\n;") != std::string_view::npos)
+	{
+		sqlite3_finalize(stmt);
+		throw std::runtime_error("Invalid import condition: it must be a single SQL expression");
+	}
+
+	const std::string today = datetime::today_iso();
+	const char delimiter_text[] = {delimiter, '\0'};
+	sqlite3_bind_text(stmt, 1, path.data(), static_cast<int>(path.size()), SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 2, today.data(), static_cast<int>(today.size()), SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 3, delimiter_text, 1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 4, Application::default_status, -1, SQLITE_STATIC);
+
+	try
+	{
+		database.execute_non_query("BEGIN IMMEDIATE;");
+	}
+	catch (...)
+	{
+		sqlite3_finalize(stmt);
+		throw;
+	}
+
+	const int rc_step = sqlite3_step(stmt);
+	const std::string error = rc_step == SQLITE_DONE ? std::string() : sqlite3_errmsg(db);
+	const auto inserted = static_cast<std::size_t>(sqlite3_changes(db));
+	sqlite3_finalize(stmt);
+
+	if (rc_step != SQLITE_DONE)
+	{
+		database.execute_non_query("ROLLBACK;");
+		throw std::runtime_error("Failed to import CSV file '" + path + "': " + error);
+	}
+
+	database.execute_non_query("COMMIT;");
+	return inserted;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "storage/sqlite_database.h"
+
+struct sqlite3;
+
+/**
+ * @brief Register the `csv_source` table-valued function on a connection.
+ *
+ * `csv_source(path [, delimiter])` is an eponymous virtual table over a CSV
+ * file (plain or .csv.gz) with one row per record that CsvImportSource would
+ * import, so a file can be queried, filtered and inserted with plain SQL:
+ *
+ *     INSERT INTO applications (company, position, status)
+ *         SELECT company, position, status FROM csv_source('jobs.csv') WHERE status <> 'rejected';
+ *
+ * Its columns are the Application fields (company, position, location,
+ * source, status, applied_date, last_update, notes), matched against the
+ * header by the same CsvRowDecoder as CsvImportSource, trimmed, and empty
+ * when the file lacks them. Only the columns a query uses are handed to
+ * SQLite, and the tokenizer stops decoding a record after the last column
+ * needed. Records without a company or a position are skipped.
+ *
+ * The file is streamed; nothing is loaded into Application objects.
+ *
+ * @param db Connection to register the module on.
+ *
+ * @throws std::runtime_error if the module cannot be registered.
+ */
+void register_csv_source(sqlite3 *db);
+
+/**
+ * @brief Import the records of a CSV file that match an SQL condition.
+ *
+ * Runs one INSERT ... SELECT from csv_source() inside a transaction, with
+ * the defaults of JobTracker::apply_defaults() expressed in SQL, so the rows
+ * never leave SQLite. register_csv_source() must have been called on the
+ * connection.
+ *
+ * @param database  Connection holding the applications table.
+ * @param path      Path to the CSV file.
+ * @param condition SQL expression over the csv_source columns; empty imports every record.
+ * @param delimiter Delimiter character used to separate fields.
+ * @return Number of applications inserted.
+ *
+ * @throws std::runtime_error if the file cannot be read or the condition is invalid;
+ *         nothing is inserted then.
+ */
+std::size_t import_csv_where(SqliteDatabase &database, const std::string &path, const std::string &condition, char delimiter = ',');
@@ -0,0 +1,83 @@
+/// \file
+/// \brief Chunk-fed CSV tokenizer built on CsvTokenizer.
+
+#include "import/csv_stream_tokenizer.h"
+
+CsvStreamTokenizer::CsvStreamTokenizer(char delimiter)
+	: tokenizer_(std::string_view(), delimiter)
+{
+}
+
+void CsvStreamTokenizer::append(std::string_view chunk)
+{
+	// Drop what was already read; only a partial record is left to move.
+	const std::size_t consumed = tokenizer_.offset();
+	if (consumed > 0)
+	{
+		buffer_.erase(0, consumed);
+		base_offset_ += consumed;
+		scanned_ -= consumed;
+		complete_ -= consumed;
+	}
+
+	buffer_.append(chunk);
+	scan_boundaries();
+	tokenizer_.reset(std::string_view(buffer_.data(), complete_));
+}
+
+void CsvStreamTokenizer::finish()
+{
+	const std::size_t consumed = tokenizer_.offset();
+	finished_ = true;
+	complete_ = buffer_.size();
+	tokenizer_.reset(std::string_view(buffer_.data(), complete_));
+	tokenizer_.seek(consumed);
+}
+
+bool CsvStreamTokenizer::next_record(std::vector<std::string_view> &fields, std::size_t max_fields)
+{
+	return tokenizer_.next_record(fields, max_fields);
+}
+
+bool CsvStreamTokenizer::exhausted() const
+{
+	return finished_ && tokenizer_.offset() >= buffer_.size();
+}
+
+std::uint64_t CsvStreamTokenizer::offset() const
+{
+	return base_offset_ + tokenizer_.offset();
+}
+
+void CsvStreamTokenizer::scan_boundaries()
+{
+	const std::size_t size = buffer_.size();
+	std::size_t i = scanned_;
+
+	for (; i < size; ++i)
+	{
+		const char ch = buffer_[i];
+		if (ch == '"')
+		{
+			in_quotes_ = !in_quotes_;
+		}
+		else if (!in_quotes_ && ch == '\n')
+		{
+			complete_ = i + 1;
+		}
+		else if (!in_quotes_ && ch == '\r')
+		{
+			// A CR at the end of the input may still be followed by LF.
+			if (i + 1 == size)
+			{
+				break;
+			}
+			if (buffer_[i + 1] != '\n')
+			{
+				complete_ = i + 1;
+			}
+		}
+	}
+
+	scanned_ = i;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "import/csv_tokenizer.h"
+
+/**
+ * @brief CSV tokenizer for input that arrives in arbitrary chunks.
+ *
+ * Chunks are appended as they arrive (e.g. from an HTTP download) and only
+ * complete records are handed out, so a record split across chunk boundaries
+ * is returned once its terminator has arrived. A record is complete at a line
+ * break outside quotes, tracked by quote parity like csv_chunker; the actual
+ * parsing is delegated to CsvTokenizer.
+ *
+ * Only the unread tail of the input is kept: consumed bytes are dropped on the
+ * next append(), so memory use is bounded by the chunk size plus the longest
+ * record rather than by the size of the input.
+ */
+class CsvStreamTokenizer
+{
+public:
+	/**
+	 * @brief Construct an empty tokenizer.
+	 *
+	 * @param delimiter Delimiter character used to separate fields (default: ',').
+	 */
+	explicit CsvStreamTokenizer(char delimiter = ',');
+
+	/**
+	 * @brief Append the next chunk of input.
+	 *
+	 * Invalidates the field views returned by next_record().
+	 *
+	 * @param chunk Input bytes; copied.
+	 */
+	void append(std::string_view chunk);
+
+	/**
+	 * @brief Mark the end of the input; any remaining bytes form the last record.
+	 */
+	void finish();
+
+	/**
+	 * @brief Read the next complete record.
+	 *
+	 * @param fields     Output vector; cleared and filled with one view per field.
+	 *                   The views stay valid until the next call or append().
+	 * @param max_fields Number of leading fields to return (see CsvTokenizer::next_record()).
+	 * @return true if a record was read; false if more input is needed or the
+	 *         input is exhausted (see exhausted()).
+	 */
+	bool next_record(std::vector<std::string_view> &fields, std::size_t max_fields = CsvTokenizer::all_fields);
+
+	/**
+	 * @brief Whether finish() was called and every record has been read.
+	 */
+	bool exhausted() const;
+
+	/**
+	 * @brief Position in the whole input just past the last record read.
+	 */
+	std::uint64_t offset() const;
+
+private:
+	/// Unread input; starts at input position base_offset_.
+	std::string buffer_;
+
+	/// Input position of buffer_[0].
+	std::uint64_t base_offset_ = 0;
+
+	/// Bytes of buffer_ already scanned for record boundaries.
+	std::size_t scanned_ = 0;
+
+	/// Whether scanned_ lies inside a quoted field.
+	bool in_quotes_ = false;
+
+	/// End of the last complete record in buffer_.
+	std::size_t complete_ = 0;
+
+	/// Whether finish() was called.
+	bool finished_ = false;
+
+	/// Tokenizer over the complete records buffer_[0, complete_).
+	CsvTokenizer tokenizer_;
+
+	/**
+	 * @brief Advance complete_ over the newly appended bytes.
+	 */
+	void scan_boundaries();
+};
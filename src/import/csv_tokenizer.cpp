@@ -0,0 +1,341 @@
+/// \file
+/// \brief SIMD-assisted RFC 4180 CSV tokenizer.
+
+#include "import/csv_tokenizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JOBTRACKER_CSV_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/**
+	 * @brief Find the first delimiter, quote, CR or LF at or after `from`.
+	 *
+	 * @return Offset of the first special byte, or `size` if there is none.
+	 */
+	std::size_t find_special(const char *data, std::size_t from, std::size_t size, char delimiter)
+	{
+		std::size_t i = from;
+
+		#if defined(__AVX2__)
+		const __m256i delimiter_32 = _mm256_set1_epi8(delimiter);
+		const __m256i quote_32 = _mm256_set1_epi8('"');
+		const __m256i lf_32 = _mm256_set1_epi8('\n');
+		const __m256i cr_32 = _mm256_set1_epi8('\r');
+
+		for (; i + 32 <= size; i += 32)
+		{
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+			const __m256i hits = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, delimiter_32), _mm256_cmpeq_epi8(chunk, quote_32)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf_32), _mm256_cmpeq_epi8(chunk, cr_32)));
+
+			const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(hits));
+			if (mask != 0)
+			{
+				return i + static_cast<std::size_t>(std::countr_zero(mask));
+			}
+		}
+		#endif
+
+		#if defined(JOBTRACKER_CSV_SSE2)
+		const __m128i delimiter_16 = _mm_set1_epi8(delimiter);
+		const __m128i quote_16 = _mm_set1_epi8('"');
+		const __m128i lf_16 = _mm_set1_epi8('\n');
+		const __m128i cr_16 = _mm_set1_epi8('\r');
+
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			const __m128i hits = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, delimiter_16), _mm_cmpeq_epi8(chunk, quote_16)),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, lf_16), _mm_cmpeq_epi8(chunk, cr_16)));
+
+			const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+			if (mask != 0)
+			{
+				return i + static_cast<std::size_t>(std::countr_zero(mask));
+			}
+		}
+		#endif
+
+		for (; i < size; ++i)
+		{
+			const char ch = data[i];
+			if (ch == delimiter || ch == '"' || ch == '\n' || ch == '\r')
+			{
+				return i;
+			}
+		}
+
+		return size;
+	}
+
+	/**
+	 * @brief Find the next quote at or after `from`, or `size` if there is none.
+	 *
+	 * memchr is already vectorized by every mainstream C library.
+	 */
+	std::size_t find_quote(const char *data, std::size_t from, std::size_t size)
+	{
+		const void *hit = std::memchr(data + from, '"', size - from);
+		if (hit == nullptr)
+		{
+			return size;
+		}
+		return static_cast<std::size_t>(static_cast<const char *>(hit) - data);
+	}
+}
+
+CsvTokenizer::CsvTokenizer(std::string_view buffer, char delimiter)
+	: buffer_(buffer)
+	, delimiter_(delimiter)
+{
+}
+
+bool CsvTokenizer::next_record(std::vector<std::string_view> &fields, std::size_t max_fields)
+{
+	fields.clear();
+
+	if (pos_ >= buffer_.size())
+	{
+		return false;
+	}
+
+	spans_.clear();
+	scratch_.clear();
+
+	const std::size_t size = buffer_.size();
+
+	while (true)
+	{
+		// Allow blanks before an opening quote; they would be trimmed anyway.
+		std::size_t probe = pos_;
+		while (probe < size && (buffer_[probe] == ' ' || buffer_[probe] == '\t') && buffer_[probe] != delimiter_)
+		{
+			++probe;
+		}
+
+		if (spans_.size() >= max_fields)
+		{
+			skip_field();
+		}
+		else if (probe < size && buffer_[probe] == '"')
+		{
+			pos_ = probe + 1;
+			spans_.push_back(read_quoted_field());
+		}
+		else
+		{
+			spans_.push_back(read_unquoted_field());
+		}
+
+		if (pos_ >= size)
+		{
+			break;
+		}
+
+		const char terminator = buffer_[pos_];
+		++pos_;
+
+		if (terminator == delimiter_)
+		{
+			continue;
+		}
+
+		if (terminator == '\r' && pos_ < size && buffer_[pos_] == '\n')
+		{
+			++pos_;
+		}
+		break;
+	}
+
+	fields.reserve(spans_.size());
+	for (const auto &span : spans_)
+	{
+		if (span.in_scratch)
+		{
+			fields.emplace_back(scratch_.data() + span.begin, span.length);
+		}
+		else
+		{
+			fields.push_back(buffer_.substr(span.begin, span.length));
+		}
+	}
+
+	return true;
+}
+
+std::size_t CsvTokenizer::offset() const
+{
+	return pos_;
+}
+
+void CsvTokenizer::seek(std::size_t offset)
+{
+	pos_ = std::min(offset, buffer_.size());
+}
+
+void CsvTokenizer::reset(std::string_view buffer)
+{
+	buffer_ = buffer;
+	pos_ = 0;
+}
+
+CsvTokenizer::FieldSpan CsvTokenizer::read_quoted_field()
+{
+	const char *data = buffer_.data();
+	const std::size_t size = buffer_.size();
+
+	FieldSpan span{};
+	span.begin = pos_;
+
+	std::size_t segment_begin = pos_;
+	bool copied = false;
+
+	while (true)
+	{
+		const std::size_t quote = find_quote(data, pos_, size);
+
+		// Unterminated quoted field: take everything up to the end of the buffer.
+		const bool closed = quote < size;
+		const bool escaped = closed && quote + 1 < size && data[quote + 1] == '"';
+
+		if (escaped && !copied)
+		{
+			copied = true;
+			span.begin = scratch_.size();
+			span.in_scratch = true;
+		}
+
+		if (copied)
+		{
+			// Keep one quote of an escaped pair, none of the closing quote.
+			const std::size_t segment_end = escaped ? quote + 1 : quote;
+			scratch_.append(data + segment_begin, segment_end - segment_begin);
+		}
+
+		if (escaped)
+		{
+			pos_ = quote + 2;
+			segment_begin = pos_;
+			continue;
+		}
+
+		if (!copied)
+		{
+			span.length = quote - span.begin;
+		}
+
+		pos_ = closed ? quote + 1 : size;
+		break;
+	}
+
+	// Text between the closing quote and the next delimiter is not valid RFC 4180,
+	// but spreadsheet tools keep it, so append it to the field.
+	if (pos_ < size && data[pos_] != delimiter_ && data[pos_] != '\n' && data[pos_] != '\r')
+	{
+		if (!copied)
+		{
+			const std::size_t length = span.length;
+			const std::size_t begin = span.begin;
+			span.begin = scratch_.size();
+			span.in_scratch = true;
+			scratch_.append(data + begin, length);
+		}
+		append_until_field_end();
+	}
+
+	if (span.in_scratch)
+	{
+		span.length = scratch_.size() - span.begin;
+	}
+
+	return span;
+}
+
+CsvTokenizer::FieldSpan CsvTokenizer::read_unquoted_field()
+{
+	const char *data = buffer_.data();
+	const std::size_t size = buffer_.size();
+
+	FieldSpan span{};
+	span.begin = pos_;
+
+	std::size_t end = find_special(data, pos_, size, delimiter_);
+
+	// Quotes in the middle of an unquoted field are ordinary characters.
+	while (end < size && data[end] == '"')
+	{
+		end = find_special(data, end + 1, size, delimiter_);
+	}
+
+	span.length = end - span.begin;
+	pos_ = end;
+	return span;
+}
+
+void CsvTokenizer::skip_field()
+{
+	const char *data = buffer_.data();
+	const std::size_t size = buffer_.size();
+
+	std::size_t probe = pos_;
+	while (probe < size && (data[probe] == ' ' || data[probe] == '\t') && data[probe] != delimiter_)
+	{
+		++probe;
+	}
+
+	if (probe < size && data[probe] == '"')
+	{
+		pos_ = probe + 1;
+		while (true)
+		{
+			const std::size_t quote = find_quote(data, pos_, size);
+			if (quote >= size)
+			{
+				pos_ = size;
+				return;
+			}
+			if (quote + 1 < size && data[quote + 1] == '"')
+			{
+				pos_ = quote + 2;
+				continue;
+			}
+			pos_ = quote + 1;
+			break;
+		}
+	}
+
+	// The unquoted field, or text after the closing quote, runs to the next delimiter or line break.
+	std::size_t end = find_special(data, pos_, size, delimiter_);
+	while (end < size && data[end] == '"')
+	{
+		end = find_special(data, end + 1, size, delimiter_);
+	}
+	pos_ = end;
+}
+
+void CsvTokenizer::append_until_field_end()
+{
+	const char *data = buffer_.data();
+	const std::size_t size = buffer_.size();
+
+	std::size_t end = find_special(data, pos_, size, delimiter_);
+	while (end < size && data[end] == '"')
+	{
+		end = find_special(data, end + 1, size, delimiter_);
+	}
+
+	scratch_.append(data + pos_, end - pos_);
+	pos_ = end;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief RFC 4180 CSV tokenizer over a contiguous, caller-owned buffer.
+ *
+ * The tokenizer never copies the input: fields are returned as string views
+ * into the buffer. The only exception is quoted fields containing escaped
+ * quotes (""), which are unescaped into an internal scratch buffer that is
+ * reused for every record.
+ *
+ * Supported syntax:
+ *   - fields separated by a configurable delimiter;
+ *   - records terminated by LF, CRLF or a lone CR (the last record may be
+ *     unterminated);
+ *   - quoted fields containing delimiters, line breaks and escaped quotes.
+ *
+ * Malformed input is handled leniently: a quote inside an unquoted field is
+ * kept literally, text after a closing quote is appended to the field, and an
+ * unterminated quoted field runs to the end of the buffer.
+ *
+ * Special characters are located with SSE2 (or AVX2, when the build enables
+ * it) and a portable scalar fallback.
+ */
+class CsvTokenizer
+{
+public:
+	/**
+	 * @brief Construct a tokenizer over the given buffer.
+	 *
+	 * @param buffer    CSV text. Must outlive the tokenizer and the returned views.
+	 * @param delimiter Delimiter character used to separate fields (default: ',').
+	 */
+	explicit CsvTokenizer(std::string_view buffer, char delimiter = ',');
+
+	/// Field limit of next_record() that returns every field.
+	static constexpr std::size_t all_fields = static_cast<std::size_t>(-1);
+
+	/**
+	 * @brief Read the next record.
+	 *
+	 * A blank line yields a record with a single empty field.
+	 *
+	 * @param fields     Output vector; cleared and filled with one view per field.
+	 *                   The views stay valid until the next call.
+	 * @param max_fields Number of leading fields to return. Later fields are
+	 *                   only scanned for the end of the record, never unescaped.
+	 * @return true if a record was read; false at the end of the buffer.
+	 */
+	bool next_record(std::vector<std::string_view> &fields, std::size_t max_fields = all_fields);
+
+	/**
+	 * @brief Byte offset of the next unread record in the buffer.
+	 */
+	std::size_t offset() const;
+
+	/**
+	 * @brief Continue tokenizing at the given byte offset.
+	 *
+	 * The offset must be a record boundary, such as a value previously
+	 * returned by offset(). Bytes before it are never touched again.
+	 *
+	 * @param offset Offset of the next record to read; clamped to the buffer size.
+	 */
+	void seek(std::size_t offset);
+
+	/**
+	 * @brief Start over on a different buffer, keeping the internal scratch capacity.
+	 *
+	 * @param buffer New CSV text, read from its first byte.
+	 */
+	void reset(std::string_view buffer);
+
+private:
+	/**
+	 * @brief Location of a decoded field, either in the buffer or in scratch_.
+	 */
+	struct FieldSpan
+	{
+		/// Start offset in the buffer or in scratch_.
+		std::size_t begin = 0;
+
+		/// Length of the field in bytes.
+		std::size_t length = 0;
+
+		/// True if the field was unescaped into scratch_.
+		bool in_scratch = false;
+	};
+
+	/// CSV text being tokenized.
+	std::string_view buffer_;
+
+	/// Delimiter character used to separate fields.
+	char delimiter_;
+
+	/// Offset of the next unread byte.
+	std::size_t pos_ = 0;
+
+	/// Unescaped contents of quoted fields of the current record.
+	std::string scratch_;
+
+	/// Field locations of the current record.
+	std::vector<FieldSpan> spans_;
+
+	/**
+	 * @brief Decode a quoted field starting right after its opening quote.
+	 */
+	FieldSpan read_quoted_field();
+
+	/**
+	 * @brief Decode an unquoted field starting at the current position.
+	 */
+	FieldSpan read_unquoted_field();
+
+	/**
+	 * @brief Move past the field starting at the current position without decoding it.
+	 */
+	void skip_field();
+
+	/**
+	 * @brief Append buffer bytes up to the next delimiter or line break to scratch_.
+	 */
+	void append_until_field_end();
+};
@@ -19,10 +19,25 @@ class IEmailClient
 	virtual void connect() = 0;
 	virtual void disconnect() = 0;
 
+	/**
+	 * @brief Whether connect() succeeded and the connection is still open.
+	 */
+	virtual bool is_connected() const = 0;
+
 	/**
 	 * @brief Fetch messages matching the given search expression.
 	 *
 	 * The expression is client-specific (e.g. IMAP search syntax).
 	 */
 	virtual std::vector<EmailMessage> fetch_messages(const std::string &search_expression) = 0;
+
+	/**
+	 * @brief Notification that the messages of the last fetch were imported.
+	 *
+	 * Clients that sync incrementally persist their sync position here, so a
+	 * failed import fetches the same messages again. The default does nothing.
+	 */
+	virtual void on_messages_imported()
+	{
+	}
 };
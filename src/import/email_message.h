@@ -19,9 +19,19 @@ struct EmailMessage
 	/// Primary recipient address.
 	std::string to;
 
-	/// Plain-text body (HTML already stripped, if possible).
+	/// Body as fetched; MimeDecoder::decode_body turns it into plain UTF-8 text.
 	std::string body_text;
 
+	/// Content-Type body_text was fetched as, possibly with parameters
+	/// (e.g. "text/html" or `multipart/alternative; boundary="b"`); empty if unknown.
+	std::string body_content_type;
+
+	/// Content-Transfer-Encoding body_text was fetched with (e.g. "base64"); empty if unknown.
+	std::string body_transfer_encoding;
+
+	/// Charset of body_text as fetched; empty if unknown.
+	std::string body_charset;
+
 	/// Date string as provided by the mail provider.
 	std::string date;
 };
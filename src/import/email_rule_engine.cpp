@@ -0,0 +1,388 @@
+/// \file
+/// \brief Compiled rules extracting application fields from email.
+
+#include "import/email_rule_engine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "util/string_utils.h"
+
+namespace
+{
+	/**
+	 * @brief A subject template split into literal text and placeholders.
+	 */
+	struct TemplatePieces
+	{
+		/// Literal text and placeholder names ("company", "position"), in order.
+		std::vector<std::string> pieces;
+
+		/// Whether pieces[i] is a placeholder.
+		std::vector<bool> is_placeholder;
+	};
+
+	/**
+	 * @brief Split a template such as "Your application to {company} for {position}".
+	 *
+	 * @throws std::runtime_error on an unknown or unterminated placeholder.
+	 */
+	TemplatePieces split_template(const std::string &text)
+	{
+		TemplatePieces split;
+		std::size_t start = 0;
+		while (start < text.size())
+		{
+			const std::size_t open = text.find('{', start);
+			if (open != start)
+			{
+				split.pieces.push_back(text.substr(start, open - start));
+				split.is_placeholder.push_back(false);
+				if (open == std::string::npos)
+				{
+					break;
+				}
+			}
+
+			const std::size_t close = text.find('}', open);
+			if (close == std::string::npos)
+			{
+				throw std::runtime_error("Unterminated placeholder in subject template: " + text);
+			}
+			const std::string name = text.substr(open + 1, close - open - 1);
+			if (name != "company" && name != "position")
+			{
+				throw std::runtime_error("Unknown placeholder {" + name + "} in subject template: " + text);
+			}
+			split.pieces.push_back(name);
+			split.is_placeholder.push_back(true);
+			start = close + 1;
+		}
+		return split;
+	}
+
+	/**
+	 * @brief Longest word of the template's literal text; it must occur in every matching subject.
+	 *
+	 * @throws std::runtime_error if the template has no literal word.
+	 */
+	std::string template_anchor(const std::string &text)
+	{
+		const TemplatePieces split = split_template(text);
+
+		std::string_view anchor;
+		std::vector<std::string_view> words;
+		for (std::size_t i = 0; i < split.pieces.size(); ++i)
+		{
+			if (split.is_placeholder[i])
+			{
+				continue;
+			}
+			string_utils::split_view(split.pieces[i], ' ', words);
+			for (const auto word : words)
+			{
+				if (word.size() > anchor.size())
+				{
+					anchor = word;
+				}
+			}
+		}
+
+		if (anchor.empty())
+		{
+			throw std::runtime_error("Subject template needs literal text: " + text);
+		}
+		return std::string(anchor);
+	}
+
+	/**
+	 * @brief Literal text as an ECMAScript pattern; runs of spaces match any whitespace.
+	 */
+	std::string literal_pattern(const std::string &text)
+	{
+		std::string pattern;
+		bool in_space = false;
+		for (const char c : text)
+		{
+			if (std::isspace(static_cast<unsigned char>(c)))
+			{
+				if (!in_space)
+				{
+					pattern += "\\s+";
+				}
+				in_space = true;
+				continue;
+			}
+			in_space = false;
+
+			if (std::string_view("\\^$.|?*+()[]{}/").find(c) != std::string_view::npos)
+			{
+				pattern += '\\';
+			}
+			pattern += c;
+		}
+		return pattern;
+	}
+
+	/**
+	 * @brief Trim whitespace and surrounding quotes from a captured field.
+	 */
+	std::string clean_field(std::string_view field)
+	{
+		field = string_utils::trim_view(field);
+		while (field.size() >= 2 && (field.front() == '"' || field.front() == '\'') && field.back() == field.front())
+		{
+			field = string_utils::trim_view(field.substr(1, field.size() - 2));
+		}
+		return std::string(field);
+	}
+
+	/**
+	 * @brief Precedence of a status when phrases of several statuses occur.
+	 */
+	int status_rank(const std::string &status)
+	{
+		if (status == "rejected")
+		{
+			return 4;
+		}
+		if (status == "offer")
+		{
+			return 3;
+		}
+		if (status == "interview")
+		{
+			return 2;
+		}
+		return 1;
+	}
+
+	/**
+	 * @brief Patterns of the automaton: template anchors, then status phrases.
+	 */
+	std::vector<std::string> automaton_patterns(const EmailRuleSet &rules)
+	{
+		std::vector<std::string> patterns;
+		for (const auto &subject_template : rules.subject_templates)
+		{
+			patterns.push_back(template_anchor(subject_template));
+		}
+		for (const auto &phrase : rules.status_phrases)
+		{
+			patterns.push_back(phrase.first);
+		}
+		return patterns;
+	}
+
+	/**
+	 * @brief Lower-case domain of the last address in a From header ("Jobs <a@b.example>" -> "b.example").
+	 */
+	std::string sender_domain(std::string_view from)
+	{
+		const std::size_t at = from.rfind('@');
+		if (at == std::string_view::npos)
+		{
+			return std::string();
+		}
+		std::string_view domain = from.substr(at + 1);
+		domain = domain.substr(0, domain.find_first_of("> ,;\"'"));
+		std::string lower;
+		string_utils::to_lower_into(domain, lower);
+		return lower;
+	}
+}
+
+EmailRuleSet EmailRuleSet::defaults()
+{
+	EmailRuleSet rules;
+
+	rules.ats_domains = {
+		{"greenhouse.io", "greenhouse"},
+		{"greenhouse-mail.io", "greenhouse"},
+		{"lever.co", "lever"},
+		{"myworkday.com", "workday"},
+		{"myworkdayjobs.com", "workday"},
+		{"smartrecruiters.com", "smartrecruiters"},
+		{"ashbyhq.com", "ashby"},
+		{"icims.com", "icims"},
+		{"jobvite.com", "jobvite"},
+		{"workablemail.com", "workable"},
+		{"bamboohr.com", "bamboohr"},
+		{"recruitee.com", "recruitee"},
+		{"teamtailor.com", "teamtailor"},
+		{"linkedin.com", "linkedin"},
+		{"indeed.com", "indeed"},
+	};
+
+	rules.subject_templates = {
+		"Your application to {company} for {position}",
+		"Your application for {position} at {company}",
+		"Your application was sent to {company}",
+		"Application received: {position} at {company}",
+		"{company}: Application received for {position}",
+		"Application for {position} at {company}",
+		"Interview invitation: {position} at {company}",
+		"Interview with {company} for {position}",
+		"Thank you for applying to {company}",
+		"Thank you for your application to {company}",
+		"Thank you for your interest in {company}",
+	};
+
+	rules.status_phrases = {
+		{"unfortunately", "rejected"},
+		{"not moving forward", "rejected"},
+		{"not to move forward", "rejected"},
+		{"not be moving forward", "rejected"},
+		{"move forward with other candidates", "rejected"},
+		{"decided to pursue other candidates", "rejected"},
+		{"position has been filled", "rejected"},
+		{"pleased to offer", "offer"},
+		{"happy to offer", "offer"},
+		{"offer letter", "offer"},
+		{"extend an offer", "offer"},
+		{"interview", "interview"},
+		{"phone screen", "interview"},
+		{"schedule a call", "interview"},
+		{"your availability", "interview"},
+		{"application received", "applied"},
+		{"received your application", "applied"},
+		{"thank you for applying", "applied"},
+		{"thanks for applying", "applied"},
+	};
+
+	return rules;
+}
+
+EmailRuleEngine::EmailRuleEngine(const EmailRuleSet &rules)
+	: automaton_(automaton_patterns(rules))
+{
+	if (rules.subject_templates.size() > max_subject_templates)
+	{
+		throw std::runtime_error("Too many subject templates (at most " + std::to_string(max_subject_templates) + ")");
+	}
+
+	for (const auto &text : rules.subject_templates)
+	{
+		const TemplatePieces split = split_template(text);
+
+		// Reply and forward prefixes, the template, then optional closing punctuation.
+		SubjectTemplate compiled;
+		std::string pattern = "^\\s*(?:(?:re|fwd?)\\s*:\\s*)*";
+		std::size_t group = 0;
+		for (std::size_t i = 0; i < split.pieces.size(); ++i)
+		{
+			if (!split.is_placeholder[i])
+			{
+				pattern += literal_pattern(split.pieces[i]);
+				continue;
+			}
+
+			pattern += "(.+?)";
+			++group;
+			(split.pieces[i] == "company" ? compiled.company_group : compiled.position_group) = group;
+		}
+		pattern += "\\s*[.!]?\\s*$";
+
+		compiled.pattern = std::regex(pattern, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+		templates_.push_back(std::move(compiled));
+	}
+
+	for (const auto &[phrase, status] : rules.status_phrases)
+	{
+		phrase_statuses_.push_back(status);
+		phrase_ranks_.push_back(status_rank(status));
+	}
+
+	for (const auto &[domain, source] : rules.ats_domains)
+	{
+		ats_sources_.emplace(string_utils::to_lower(domain), source);
+	}
+}
+
+EmailExtraction EmailRuleEngine::extract(const EmailMessage &message) const
+{
+	EmailExtraction extraction;
+
+	// One pass over subject and body finds template words and status phrases.
+	std::uint64_t candidates = 0;
+	std::size_t best_phrase = phrase_statuses_.size();
+	const auto on_phrase = [&](std::size_t pattern)
+	{
+		const std::size_t phrase = pattern - templates_.size();
+		if (best_phrase == phrase_statuses_.size() || phrase_ranks_[phrase] > phrase_ranks_[best_phrase])
+		{
+			best_phrase = phrase;
+		}
+	};
+
+	automaton_.scan(message.subject, [&](std::size_t pattern, std::size_t)
+	{
+		if (pattern < templates_.size())
+		{
+			candidates |= std::uint64_t{1} << pattern;
+		}
+		else
+		{
+			on_phrase(pattern);
+		}
+	});
+	automaton_.scan(message.body_text, [&](std::size_t pattern, std::size_t)
+	{
+		if (pattern >= templates_.size())
+		{
+			on_phrase(pattern);
+		}
+	});
+
+	if (best_phrase < phrase_statuses_.size())
+	{
+		extraction.status = phrase_statuses_[best_phrase];
+	}
+
+	// Only templates whose anchor word occurs can match; the first that does wins.
+	std::smatch match;
+	for (std::size_t index = 0; candidates != 0; ++index, candidates >>= 1)
+	{
+		if ((candidates & 1U) == 0)
+		{
+			continue;
+		}
+
+		const SubjectTemplate &subject_template = templates_[index];
+		if (!std::regex_match(message.subject, match, subject_template.pattern))
+		{
+			continue;
+		}
+
+		if (subject_template.company_group != 0)
+		{
+			extraction.company = clean_field(match[static_cast<int>(subject_template.company_group)].str());
+		}
+		if (subject_template.position_group != 0)
+		{
+			extraction.position = clean_field(match[static_cast<int>(subject_template.position_group)].str());
+		}
+		break;
+	}
+
+	// The sender's domain or one of its parents ("mail.greenhouse.io" -> "greenhouse.io").
+	const std::string sender = sender_domain(message.from);
+	std::string_view domain = sender;
+	while (!domain.empty())
+	{
+		const auto ats = ats_sources_.find(std::string(domain));
+		if (ats != ats_sources_.end())
+		{
+			extraction.source = ats->second;
+			break;
+		}
+		const std::size_t dot = domain.find('.');
+		domain = dot == std::string_view::npos ? std::string_view() : domain.substr(dot + 1);
+	}
+
+	return extraction;
+}
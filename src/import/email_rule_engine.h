@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "import/email_message.h"
+#include "util/aho_corasick.h"
+
+/**
+ * @brief Patterns that turn job-related email into application fields.
+ */
+struct EmailRuleSet
+{
+	/// Sender domains of applicant tracking systems and job boards, with the
+	/// source they stand for (e.g. {"greenhouse.io", "greenhouse"}).
+	std::vector<std::pair<std::string, std::string>> ats_domains;
+
+	/// Subject templates with `{company}` and `{position}` placeholders
+	/// (e.g. "Your application to {company} for {position}"); the first one
+	/// that matches wins.
+	std::vector<std::string> subject_templates;
+
+	/// Phrases in the subject or body that imply a status
+	/// (e.g. {"unfortunately", "rejected"}).
+	std::vector<std::pair<std::string, std::string>> status_phrases;
+
+	/**
+	 * @brief Rules for common applicant tracking systems and English phrasing.
+	 */
+	static EmailRuleSet defaults();
+};
+
+/**
+ * @brief Application fields extracted from one message.
+ */
+struct EmailExtraction
+{
+	/// Company name; empty if no subject template matched.
+	std::string company;
+
+	/// Position title; empty if no subject template matched.
+	std::string position;
+
+	/// Status implied by the message (e.g. "rejected", "interview"); empty if none.
+	std::string status;
+
+	/// Source of an applicant tracking system sender (e.g. "greenhouse"); empty otherwise.
+	std::string source;
+};
+
+/**
+ * @brief Extracts company, position and status from email with compiled rules.
+ *
+ * The literal words of the subject templates and all status phrases are
+ * compiled into one Aho-Corasick automaton, which scans the subject and the
+ * body once per message. Subject template regexes are compiled once too,
+ * and only run when their most selective word occurs in the subject. Sender
+ * domains are looked up with their parent domains in a hash map.
+ *
+ * When phrases of several statuses occur, the furthest one wins: "rejected",
+ * then "offer", then "interview", then any other status.
+ */
+class EmailRuleEngine
+{
+public:
+	/// Maximum number of subject templates.
+	static constexpr std::size_t max_subject_templates = 64;
+
+	/**
+	 * @brief Compile the rules.
+	 *
+	 * @throws std::runtime_error if a subject template has no literal text,
+	 *         an unknown placeholder, or there are too many templates.
+	 */
+	explicit EmailRuleEngine(const EmailRuleSet &rules);
+
+	/**
+	 * @brief Extract the application fields of one message.
+	 */
+	EmailExtraction extract(const EmailMessage &message) const;
+
+private:
+	/**
+	 * @brief A compiled subject template.
+	 */
+	struct SubjectTemplate
+	{
+		/// Whole-subject pattern; case-insensitive.
+		std::regex pattern;
+
+		/// Capture group of the company; 0 if the template has none.
+		std::size_t company_group = 0;
+
+		/// Capture group of the position; 0 if the template has none.
+		std::size_t position_group = 0;
+	};
+
+	/// Subject templates, in rule order.
+	std::vector<SubjectTemplate> templates_;
+
+	/// Statuses of the status phrases, in rule order.
+	std::vector<std::string> phrase_statuses_;
+
+	/// Precedence of each status phrase's status; higher wins.
+	std::vector<int> phrase_ranks_;
+
+	/// Patterns 0..templates_.size()-1 are template words; the rest are status phrases.
+	AhoCorasick automaton_;
+
+	/// Lower-case sender domain -> source.
+	std::unordered_map<std::string, std::string> ats_sources_;
+};
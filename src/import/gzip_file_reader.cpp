@@ -0,0 +1,117 @@
+/// \file
+/// \brief zlib-based streaming decompression of gzip files.
+
+#include "import/gzip_file_reader.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+	/// Maximum number of compressed bytes handed to zlib per call (avail_in is 32-bit).
+	constexpr std::size_t max_input_slice = 1024U * 1024U;
+
+	/// windowBits for inflateInit2(): maximum window, gzip header expected.
+	constexpr int gzip_window_bits = 15 + 16;
+}
+
+struct GzipFileReader::Inflater
+{
+	z_stream stream{};
+
+	/// Offset of the next compressed byte not yet handed to zlib.
+	std::size_t input_offset = 0;
+};
+
+GzipFileReader::GzipFileReader(const std::string &path, std::size_t chunk_bytes)
+	: file_(path)
+	, chunk_bytes_(std::max<std::size_t>(chunk_bytes, 1))
+	, inflater_(std::make_unique<Inflater>())
+{
+	if (inflateInit2(&inflater_->stream, gzip_window_bits) != Z_OK)
+	{
+		throw std::runtime_error("Failed to initialize gzip decompression for " + path);
+	}
+
+	// An empty file is treated as an empty document.
+	finished_ = file_.size() == 0;
+}
+
+GzipFileReader::~GzipFileReader()
+{
+	inflateEnd(&inflater_->stream);
+}
+
+bool GzipFileReader::read(std::string &chunk)
+{
+	chunk.resize(chunk_bytes_);
+	std::size_t produced = 0;
+
+	z_stream &stream = inflater_->stream;
+	const std::string_view input = file_.view();
+
+	while (!finished_ && produced < chunk_bytes_)
+	{
+		if (stream.avail_in == 0)
+		{
+			if (inflater_->input_offset == input.size())
+			{
+				throw std::runtime_error("Truncated gzip file");
+			}
+
+			const std::size_t slice = std::min(max_input_slice, input.size() - inflater_->input_offset);
+			stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data() + inflater_->input_offset));
+			stream.avail_in = static_cast<uInt>(slice);
+			inflater_->input_offset += slice;
+
+			// Inflated input pages are not needed any more.
+			file_.discard_before(inflater_->input_offset - slice);
+		}
+
+		stream.next_out = reinterpret_cast<Bytef *>(chunk.data() + produced);
+		stream.avail_out = static_cast<uInt>(chunk_bytes_ - produced);
+
+		const int rc = inflate(&stream, Z_NO_FLUSH);
+		produced = chunk_bytes_ - stream.avail_out;
+
+		if (rc == Z_STREAM_END)
+		{
+			// Another member may follow (concatenated gzip files).
+			if (compressed_offset() == input.size())
+			{
+				finished_ = true;
+			}
+			else if (inflateReset(&stream) != Z_OK)
+			{
+				throw std::runtime_error("Failed to reset gzip decompression");
+			}
+		}
+		else if (rc != Z_OK && rc != Z_BUF_ERROR)
+		{
+			throw std::runtime_error(std::string("Invalid gzip data: ") + (stream.msg != nullptr ? stream.msg : "unknown error"));
+		}
+	}
+
+	chunk.resize(produced);
+	decompressed_ += produced;
+	return produced > 0;
+}
+
+std::uint64_t GzipFileReader::compressed_offset() const
+{
+	return inflater_->input_offset - inflater_->stream.avail_in;
+}
+
+std::uint64_t GzipFileReader::decompressed_offset() const
+{
+	return decompressed_;
+}
+
+bool GzipFileReader::is_gzip_path(const std::string &path)
+{
+	const std::string_view suffix = ".gz";
+	return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
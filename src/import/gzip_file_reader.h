@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "util/mapped_file.h"
+
+/**
+ * @brief Streaming reader that decompresses a gzip file chunk by chunk.
+ *
+ * The compressed file is memory-mapped and inflated with zlib straight from
+ * the mapping into a caller-provided buffer. Consumed pages are released as
+ * the reader advances, so neither the compressed nor the decompressed data
+ * is ever held in memory as a whole. Files made of several concatenated gzip
+ * members (e.g. from `cat a.gz b.gz`) are decompressed as one stream.
+ */
+class GzipFileReader
+{
+public:
+	/// Default number of decompressed bytes produced per read() call.
+	static constexpr std::size_t default_chunk_bytes = 256U * 1024U;
+
+	/**
+	 * @brief Open the gzip file at the given path.
+	 *
+	 * @param path        Path to the compressed file.
+	 * @param chunk_bytes Maximum number of decompressed bytes per read() call.
+	 *
+	 * @throws std::runtime_error if the file cannot be opened or zlib fails to initialize.
+	 */
+	explicit GzipFileReader(const std::string &path, std::size_t chunk_bytes = default_chunk_bytes);
+
+	/**
+	 * @brief Release the zlib state and the mapping.
+	 */
+	~GzipFileReader();
+
+	GzipFileReader(const GzipFileReader &) = delete;
+	GzipFileReader &operator=(const GzipFileReader &) = delete;
+
+	/**
+	 * @brief Decompress the next chunk.
+	 *
+	 * @param chunk Output buffer; replaced by the next decompressed bytes.
+	 * @return false once the whole file was decompressed.
+	 *
+	 * @throws std::runtime_error if the file is not valid gzip data or is truncated.
+	 */
+	bool read(std::string &chunk);
+
+	/**
+	 * @brief Number of compressed bytes consumed so far.
+	 */
+	std::uint64_t compressed_offset() const;
+
+	/**
+	 * @brief Number of decompressed bytes produced so far.
+	 */
+	std::uint64_t decompressed_offset() const;
+
+	/**
+	 * @brief Whether the path names a gzip file (by its ".gz" extension).
+	 */
+	static bool is_gzip_path(const std::string &path);
+
+private:
+	/**
+	 * @brief zlib stream state; keeps zlib.h out of this header.
+	 */
+	struct Inflater;
+
+	/// Mapped compressed file.
+	MappedFile file_;
+
+	/// Maximum number of decompressed bytes per read() call.
+	std::size_t chunk_bytes_;
+
+	/// zlib inflate state.
+	std::unique_ptr<Inflater> inflater_;
+
+	/// Decompressed bytes produced so far.
+	std::uint64_t decompressed_ = 0;
+
+	/// Whether the end of the last gzip member was reached.
+	bool finished_ = false;
+};
@@ -2,12 +2,123 @@
 
 #include <curl/curl.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "util/string_utils.h"
 
 namespace
 {
-	std::size_t write_to_string_callback(char *ptr, std::size_t size, std::size_t nmemb, void *userdata)
+	/**
+	 * @brief Collect response header lines into an HttpHeaders map.
+	 *
+	 * libcurl reports the headers of every response it sees (redirects,
+	 * 100 Continue), so a new status line starts the map over.
+	 */
+	std::size_t header_callback(char *ptr, std::size_t size, std::size_t nitems, void *userdata)
+	{
+		const std::size_t total = size * nitems;
+		if (userdata == nullptr || ptr == nullptr)
+		{
+			return 0;
+		}
+
+		auto *headers = static_cast<HttpHeaders *>(userdata);
+		const std::string_view line(ptr, total);
+
+		if (line.substr(0, 5) == "HTTP/")
+		{
+			headers->clear();
+			return total;
+		}
+
+		const auto colon = line.find(':');
+		if (colon == std::string_view::npos)
+		{
+			return total;
+		}
+
+		std::string name(string_utils::trim_view(line.substr(0, colon)));
+		string_utils::to_lower_in_place(name);
+		(*headers)[std::move(name)] = string_utils::trim_view(line.substr(colon + 1));
+		return total;
+	}
+
+	/**
+	 * @brief State shared with the write callback of a streaming request.
+	 */
+	struct StreamingContext
+	{
+		/// Receives the response.
+		IHttpResponseHandler *handler = nullptr;
+
+		/// Easy handle performing the request.
+		CURL *curl = nullptr;
+
+		/// Headers of the current response, filled by header_callback.
+		HttpHeaders headers;
+
+		/// Whether on_head() was called.
+		bool head_delivered = false;
+
+		/// Whether the handler asked to stop the transfer.
+		bool aborted = false;
+
+		/// Whether the client resumes paused transfers; otherwise chunks are delivered regardless.
+		bool pausable = false;
+
+		/// Whether the transfer is paused until the handler is ready again.
+		bool paused = false;
+
+		/// Set by the handler's resume function; consumed by the thread driving the transfer.
+		std::atomic<bool> resume_requested{false};
+
+		/// Exception thrown by the handler; rethrown once libcurl returns.
+		std::exception_ptr error;
+	};
+
+	/**
+	 * @brief Call on_head() once the status and headers are complete.
+	 *
+	 * @return false if the transfer should stop.
+	 */
+	bool deliver_head(StreamingContext &context)
+	{
+		if (!context.head_delivered)
+		{
+			context.head_delivered = true;
+
+			long status_code = 0;
+			curl_easy_getinfo(context.curl, CURLINFO_RESPONSE_CODE, &status_code);
+
+			try
+			{
+				context.aborted = !context.handler->on_head(static_cast<int>(status_code), context.headers);
+			}
+			catch (...)
+			{
+				context.error = std::current_exception();
+				context.aborted = true;
+			}
+		}
+		return !context.aborted;
+	}
+
+	/**
+	 * @brief Pass a body chunk to the handler. Exceptions must not cross libcurl's C frames.
+	 */
+	std::size_t write_to_handler_callback(char *ptr, std::size_t size, std::size_t nmemb, void *userdata)
 	{
 		const std::size_t total = size * nmemb;
 		if (userdata == nullptr || ptr == nullptr)
@@ -15,44 +126,530 @@ namespace
 			return 0;
 		}
 
-		auto *buffer = static_cast<std::string *>(userdata);
-		buffer->append(ptr, total);
+		auto *context = static_cast<StreamingContext *>(userdata);
+		if (!deliver_head(*context))
+		{
+			return 0;
+		}
+
+		try
+		{
+			if (context->pausable && !context->handler->ready_for_body())
+			{
+				// libcurl keeps the chunk and delivers it again once the transfer is resumed.
+				context->paused = true;
+				return CURL_WRITEFUNC_PAUSE;
+			}
+
+			if (!context->handler->on_body(std::string_view(ptr, total)))
+			{
+				context->aborted = true;
+				return 0;
+			}
+		}
+		catch (...)
+		{
+			context->error = std::current_exception();
+			context->aborted = true;
+			return 0;
+		}
+
 		return total;
 	}
+
+	/**
+	 * @brief Handler that collects a whole response in memory (used by get()).
+	 */
+	class ResponseCollector : public IHttpResponseHandler
+	{
+	public:
+		bool on_head(int status_code, const HttpHeaders &headers) override
+		{
+			response_.status_code = status_code;
+			response_.headers = headers;
+			return true;
+		}
+
+		bool on_body(std::string_view chunk) override
+		{
+			response_.body.append(chunk);
+			return true;
+		}
+
+		HttpResponse take()
+		{
+			return std::move(response_);
+		}
+
+	private:
+		HttpResponse response_;
+	};
+
+	/**
+	 * @brief Build a libcurl header list; the caller frees it with curl_slist_free_all().
+	 */
+	curl_slist *make_header_list(const HttpHeaders &headers)
+	{
+		curl_slist *list = nullptr;
+		for (const auto &[name, value] : headers)
+		{
+			const std::string line = name + ": " + value;
+			curl_slist *next = curl_slist_append(list, line.c_str());
+			if (next == nullptr)
+			{
+				curl_slist_free_all(list);
+				throw std::runtime_error("Failed to build HTTP request headers");
+			}
+			list = next;
+		}
+		return list;
+	}
+
+	/**
+	 * @brief Initialize libcurl once per process; curl_global_init() is not thread-safe.
+	 */
+	void ensure_curl_initialized()
+	{
+		static std::once_flag once;
+		static CURLcode result = CURLE_OK;
+
+		std::call_once(once, []()
+		{
+			result = curl_global_init(CURL_GLOBAL_DEFAULT);
+		});
+
+		if (result != CURLE_OK)
+		{
+			throw std::runtime_error("Failed to initialize libcurl");
+		}
+	}
+
+	/**
+	 * @brief Easy handles kept for reuse; an idle handle keeps its connection open.
+	 */
+	class EasyHandlePool
+	{
+	public:
+		EasyHandlePool() = default;
+
+		~EasyHandlePool()
+		{
+			for (CURL *curl : idle_)
+			{
+				curl_easy_cleanup(curl);
+			}
+		}
+
+		EasyHandlePool(const EasyHandlePool &) = delete;
+		EasyHandlePool &operator=(const EasyHandlePool &) = delete;
+
+		/**
+		 * @brief Take an idle handle, or create a new one.
+		 */
+		CURL *acquire()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (!idle_.empty())
+				{
+					CURL *curl = idle_.back();
+					idle_.pop_back();
+					// Drops the options of the previous request but keeps its connection.
+					curl_easy_reset(curl);
+					return curl;
+				}
+			}
+
+			CURL *curl = curl_easy_init();
+			if (!curl)
+			{
+				throw std::runtime_error("Failed to initialize libcurl");
+			}
+			return curl;
+		}
+
+		/**
+		 * @brief Return a handle to the pool.
+		 */
+		void release(CURL *curl)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			idle_.push_back(curl);
+		}
+
+	private:
+		std::vector<CURL *> idle_;
+		std::mutex mutex_;
+	};
+
+	/**
+	 * @brief Whether the request headers ask for a byte range.
+	 */
+	bool is_ranged(const HttpHeaders &headers)
+	{
+		for (const auto &[name, value] : headers)
+		{
+			if (string_utils::to_lower(name) == "range")
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Set the options of a streaming GET request on a fresh or reset handle.
+	 */
+	void configure_request(
+		CURL *curl,
+		const std::string &url,
+		const HttpHeaders &headers,
+		curl_slist *request_headers,
+		StreamingContext &context,
+		const HttpClientOptions &options)
+	{
+		context.curl = curl;
+
+		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+		curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_handler_callback);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &context);
+		curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+		curl_easy_setopt(curl, CURLOPT_HEADERDATA, &context.headers);
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request_headers);
+		curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+		curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, options.connect_timeout_ms);
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, options.total_timeout_ms);
+		curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, options.tcp_keep_alive ? 1L : 0L);
+		// Worker threads must not be interrupted by SIGALRM-based DNS timeouts.
+		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+		if (options.http2)
+		{
+			// Ignored (left at HTTP/1.1) when libcurl lacks HTTP/2 support.
+			curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+		}
+		if (options.accept_compressed && !is_ranged(headers))
+		{
+			// "" offers every encoding libcurl was built with; the body arrives decoded.
+			curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+		}
+	}
+
+	/**
+	 * @brief Deliver the head of a body-less response and turn failures into exceptions.
+	 *
+	 * @throws std::runtime_error if the transfer failed; exceptions thrown by the
+	 *         handler are rethrown as well.
+	 */
+	void finish_request(CURLcode res, StreamingContext &context)
+	{
+		if (res == CURLE_OK)
+		{
+			// Responses without a body never reach the write callback.
+			deliver_head(context);
+		}
+
+		if (context.error)
+		{
+			std::rethrow_exception(context.error);
+		}
+
+		if (res != CURLE_OK && !context.aborted)
+		{
+			std::string message = "libcurl request failed: ";
+			message += curl_easy_strerror(res);
+			throw std::runtime_error(message);
+		}
+	}
 }
 
-HttpResponse LibcurlHttpClient::get(const std::string &url)
+struct LibcurlHttpClient::ConnectionPool
 {
-	CURL *curl = curl_easy_init();
-	if (!curl)
+	/// Share handle for DNS, TLS sessions and connections.
+	CURLSH *share = nullptr;
+
+	/// Locks guarding the shared data, indexed by curl_lock_data.
+	std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks;
+
+	/// Idle easy handles attached to the share handle.
+	std::optional<EasyHandlePool> handles;
+
+	static void lock(CURL * /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void *userptr)
 	{
-		throw std::runtime_error("Failed to initialize libcurl");
+		static_cast<ConnectionPool *>(userptr)->share_locks[static_cast<std::size_t>(data)].lock();
 	}
 
-	std::string body;
-	long status_code = 0;
+	static void unlock(CURL * /*handle*/, curl_lock_data data, void *userptr)
+	{
+		static_cast<ConnectionPool *>(userptr)->share_locks[static_cast<std::size_t>(data)].unlock();
+	}
+};
+
+LibcurlHttpClient::LibcurlHttpClient(HttpClientOptions options)
+	: options_(options)
+	, pool_(std::make_unique<ConnectionPool>())
+{
+	ensure_curl_initialized();
+
+	pool_->share = curl_share_init();
+	if (pool_->share == nullptr)
+	{
+		throw std::runtime_error("Failed to initialize libcurl share handle");
+	}
 
-	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_to_string_callback);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
-	curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+	curl_share_setopt(pool_->share, CURLSHOPT_LOCKFUNC, &ConnectionPool::lock);
+	curl_share_setopt(pool_->share, CURLSHOPT_UNLOCKFUNC, &ConnectionPool::unlock);
+	curl_share_setopt(pool_->share, CURLSHOPT_USERDATA, pool_.get());
+	curl_share_setopt(pool_->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(pool_->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	curl_share_setopt(pool_->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+	pool_->handles.emplace();
+}
+
+LibcurlHttpClient::~LibcurlHttpClient()
+{
+	// Easy handles must be gone before the share handle can be cleaned up.
+	pool_->handles.reset();
+	curl_share_cleanup(pool_->share);
+}
+
+HttpResponse LibcurlHttpClient::get(const std::string &url, const HttpHeaders &headers)
+{
+	ResponseCollector collector;
+	get_streaming(url, headers, collector);
+	return collector.take();
+}
+
+void LibcurlHttpClient::get_streaming(const std::string &url, const HttpHeaders &headers, IHttpResponseHandler &handler)
+{
+	curl_slist *request_headers = make_header_list(headers);
+
+	CURL *curl = nullptr;
+	try
+	{
+		curl = pool_->handles->acquire();
+	}
+	catch (...)
+	{
+		curl_slist_free_all(request_headers);
+		throw;
+	}
+
+	StreamingContext context;
+	context.handler = &handler;
+
+	configure_request(curl, url, headers, request_headers, context, options_);
+	curl_easy_setopt(curl, CURLOPT_SHARE, pool_->share);
 
 	const CURLcode res = curl_easy_perform(curl);
-	if (res != CURLE_OK)
+
+	pool_->handles->release(curl);
+	curl_slist_free_all(request_headers);
+
+	finish_request(res, context);
+}
+
+struct LibcurlMultiHttpClient::EventLoop
+{
+	/**
+	 * @brief A request handed to the loop thread by get_streaming().
+	 */
+	struct Transfer
+	{
+		/// Easy handle, configured by the requesting thread.
+		CURL *curl = nullptr;
+
+		/// State shared with the write callback.
+		StreamingContext *context = nullptr;
+
+		/// Result of the transfer, set by the loop thread once it is done.
+		std::promise<CURLcode> done;
+	};
+
+	/// Multi handle; only touched by the loop thread (except curl_multi_wakeup).
+	CURLM *multi = nullptr;
+
+	/// Idle easy handles; the multi handle keeps their connections in its cache.
+	EasyHandlePool handles;
+
+	/// Guards pending and stopping.
+	std::mutex mutex;
+
+	/// Requests waiting to be added to the multi handle.
+	std::vector<Transfer *> pending;
+
+	/// Set by the destructor; the loop exits once no transfer is left.
+	bool stopping = false;
+
+	std::thread thread;
+
+	/**
+	 * @brief Drive all transfers until the client is destroyed.
+	 */
+	void run()
+	{
+		int running = 0;
+		std::vector<Transfer *> added;
+
+		// Transfers added to the multi handle and not finished yet.
+		std::vector<Transfer *> active;
+
+		while (true)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (stopping && pending.empty() && running == 0)
+				{
+					break;
+				}
+				added.swap(pending);
+			}
+
+			for (Transfer *transfer : added)
+			{
+				curl_easy_setopt(transfer->curl, CURLOPT_PRIVATE, transfer);
+				const CURLMcode code = curl_multi_add_handle(multi, transfer->curl);
+				if (code != CURLM_OK)
+				{
+					transfer->done.set_value(CURLE_FAILED_INIT);
+				}
+				else
+				{
+					active.push_back(transfer);
+				}
+			}
+			added.clear();
+
+			resume_ready_transfers(active);
+
+			curl_multi_perform(multi, &running);
+
+			int queued = 0;
+			while (CURLMsg *message = curl_multi_info_read(multi, &queued))
+			{
+				if (message->msg != CURLMSG_DONE)
+				{
+					continue;
+				}
+
+				CURL *curl = message->easy_handle;
+				const CURLcode result = message->data.result;
+				Transfer *transfer = nullptr;
+				curl_easy_getinfo(curl, CURLINFO_PRIVATE, &transfer);
+				curl_multi_remove_handle(multi, curl);
+				active.erase(std::find(active.begin(), active.end(), transfer));
+				transfer->done.set_value(result);
+			}
+
+			// Returns early on socket activity or curl_multi_wakeup().
+			curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+		}
+	}
+
+	/**
+	 * @brief Resume the paused transfers whose handler asked for it.
+	 *
+	 * curl_easy_pause() must be called on the thread driving the transfer;
+	 * it may deliver the held back chunk right away.
+	 */
+	static void resume_ready_transfers(const std::vector<Transfer *> &active)
+	{
+		for (Transfer *transfer : active)
+		{
+			StreamingContext &context = *transfer->context;
+			if (context.paused && context.resume_requested.exchange(false, std::memory_order_acq_rel))
+			{
+				context.paused = false;
+				curl_easy_pause(transfer->curl, CURLPAUSE_CONT);
+			}
+		}
+	}
+};
+
+LibcurlMultiHttpClient::LibcurlMultiHttpClient(HttpClientOptions options, long max_connections_per_host)
+	: options_(options)
+	, loop_(std::make_unique<EventLoop>())
+{
+	ensure_curl_initialized();
+
+	loop_->multi = curl_multi_init();
+	if (loop_->multi == nullptr)
+	{
+		throw std::runtime_error("Failed to initialize libcurl multi handle");
+	}
+
+	// Transfers beyond the limit wait inside libcurl until a connection is free.
+	curl_multi_setopt(loop_->multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_connections_per_host);
+	curl_multi_setopt(loop_->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+	loop_->thread = std::thread([loop = loop_.get()]()
+	{
+		loop->run();
+	});
+}
+
+LibcurlMultiHttpClient::~LibcurlMultiHttpClient()
+{
+	{
+		std::lock_guard<std::mutex> lock(loop_->mutex);
+		loop_->stopping = true;
+	}
+	curl_multi_wakeup(loop_->multi);
+	loop_->thread.join();
+
+	curl_multi_cleanup(loop_->multi);
+}
+
+HttpResponse LibcurlMultiHttpClient::get(const std::string &url, const HttpHeaders &headers)
+{
+	ResponseCollector collector;
+	get_streaming(url, headers, collector);
+	return collector.take();
+}
+
+void LibcurlMultiHttpClient::get_streaming(const std::string &url, const HttpHeaders &headers, IHttpResponseHandler &handler)
+{
+	curl_slist *request_headers = make_header_list(headers);
+
+	CURL *curl = nullptr;
+	try
+	{
+		curl = loop_->handles.acquire();
+	}
+	catch (...)
+	{
+		curl_slist_free_all(request_headers);
+		throw;
+	}
+
+	StreamingContext context;
+	context.handler = &handler;
+	context.pausable = true;
+	configure_request(curl, url, headers, request_headers, context, options_);
+
+	EventLoop::Transfer transfer;
+	transfer.curl = curl;
+	transfer.context = &context;
+	std::future<CURLcode> done = transfer.done.get_future();
+
+	handler.set_resume([&context, multi = loop_->multi]()
+	{
+		context.resume_requested.store(true, std::memory_order_release);
+		curl_multi_wakeup(multi);
+	});
+
 	{
-		std::string message = "libcurl request failed: ";
-		message += curl_easy_strerror(res);
-		curl_easy_cleanup(curl);
-		throw std::runtime_error(message);
+		std::lock_guard<std::mutex> lock(loop_->mutex);
+		loop_->pending.push_back(&transfer);
 	}
+	curl_multi_wakeup(loop_->multi);
 
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+	const CURLcode res = done.get();
+	handler.set_resume({});
 
-	curl_easy_cleanup(curl);
+	loop_->handles.release(curl);
+	curl_slist_free_all(request_headers);
 
-	HttpResponse response{};
-	response.status_code = static_cast<int>(status_code);
-	response.body = std::move(body);
-	return response;
+	finish_request(res, context);
 }
@@ -1,6 +1,18 @@
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+
+/**
+ * @brief HTTP header fields by name.
+ *
+ * Response header names are stored in lower case, since HTTP header names are
+ * case-insensitive. Request headers are sent as given.
+ */
+using HttpHeaders = std::map<std::string, std::string>;
 
 /**
  * @brief Simple HTTP response representation.
@@ -12,6 +24,76 @@ struct HttpResponse
 
 	/// Raw response body as a string.
 	std::string body;
+
+	/// Response headers with lower-case names (of the final response after redirects).
+	HttpHeaders headers;
+
+	/**
+	 * @brief Look up a response header.
+	 *
+	 * @param name Lower-case header name (e.g. "etag").
+	 * @return The header value, or an empty string if the header is missing.
+	 */
+	std::string header(const std::string &name) const
+	{
+		const auto it = headers.find(name);
+		return it != headers.end() ? it->second : std::string();
+	}
+};
+
+/**
+ * @brief Receives an HTTP response piece by piece while it is downloaded.
+ *
+ * Both callbacks run on the thread performing the request; for
+ * LibcurlMultiHttpClient that is the event loop shared by all transfers, so
+ * a handler that blocks stalls every transfer of the client.
+ */
+class IHttpResponseHandler
+{
+public:
+	virtual ~IHttpResponseHandler() = default;
+
+	/**
+	 * @brief Called once with the status and headers, before any body bytes.
+	 *
+	 * @param status_code Numeric HTTP status code.
+	 * @param headers     Response headers with lower-case names.
+	 * @return false to abort the transfer without reading the body.
+	 */
+	virtual bool on_head(int status_code, const HttpHeaders &headers) = 0;
+
+	/**
+	 * @brief Called for every chunk of the body, in order.
+	 *
+	 * @param chunk Next body bytes; only valid during the call.
+	 * @return false to abort the transfer.
+	 */
+	virtual bool on_body(std::string_view chunk) = 0;
+
+	/**
+	 * @brief Whether on_body() can take the next chunk without blocking.
+	 *
+	 * LibcurlMultiHttpClient asks before every chunk and pauses the transfer
+	 * while this returns false, so a slow consumer does not stall the event
+	 * loop; the handler calls the function passed to set_resume() once it can
+	 * take chunks again. Other clients deliver chunks regardless, on a thread
+	 * where on_body() may block.
+	 */
+	virtual bool ready_for_body()
+	{
+		return true;
+	}
+
+	/**
+	 * @brief Receive the function that resumes a transfer paused by ready_for_body().
+	 *
+	 * Called before the transfer starts by clients that pause, and again with
+	 * an empty function once it finished. The function may be called from any
+	 * thread, also while the transfer is not paused.
+	 */
+	virtual void set_resume(std::function<void()> /*resume*/)
+	{
+	}
 };
 
 /**
@@ -23,12 +105,75 @@ class IHttpClient
 	virtual ~IHttpClient() = default;
 
 	/**
-	 * @brief Perform a blocking HTTP GET request.
+	 * @brief Perform a blocking HTTP GET request with extra request headers.
+	 *
+	 * Used for conditional (If-None-Match, If-Modified-Since) and ranged
+	 * (Range) requests.
+	 *
+	 * @param url     Target URL.
+	 * @param headers Request headers to send in addition to the defaults.
+	 * @return HttpResponse with status code, headers and body.
+	 */
+	virtual HttpResponse get(const std::string &url, const HttpHeaders &headers) = 0;
+
+	/**
+	 * @brief Perform a blocking HTTP GET request without extra headers.
 	 *
 	 * @param url Target URL.
-	 * @return HttpResponse with status code and body.
+	 * @return HttpResponse with status code, headers and body.
 	 */
-	virtual HttpResponse get(const std::string &url) = 0;
+	HttpResponse get(const std::string &url)
+	{
+		return get(url, HttpHeaders{});
+	}
+
+	/**
+	 * @brief Perform a blocking HTTP GET request, handing the body over as it arrives.
+	 *
+	 * Lets callers parse a response while it is still downloading, without
+	 * holding the whole body in memory. A transfer aborted by the handler
+	 * is not an error.
+	 *
+	 * The default implementation performs get() and delivers the body as a
+	 * single chunk.
+	 *
+	 * @param url     Target URL.
+	 * @param headers Request headers to send in addition to the defaults.
+	 * @param handler Receives the status, headers and body chunks.
+	 *
+	 * @throws std::runtime_error if the request fails; exceptions thrown by the
+	 *         handler are propagated as well.
+	 */
+	virtual void get_streaming(const std::string &url, const HttpHeaders &headers, IHttpResponseHandler &handler)
+	{
+		const HttpResponse response = get(url, headers);
+		if (handler.on_head(response.status_code, response.headers) && !response.body.empty())
+		{
+			handler.on_body(response.body);
+		}
+	}
+};
+
+/**
+ * @brief Connection settings of LibcurlHttpClient.
+ */
+struct HttpClientOptions
+{
+	/// Maximum time to establish a connection, in milliseconds (0 = libcurl default).
+	long connect_timeout_ms = 10000;
+
+	/// Maximum time for a whole request including the body, in milliseconds (0 = no limit).
+	long total_timeout_ms = 0;
+
+	/// Negotiate HTTP/2 over TLS when libcurl supports it.
+	bool http2 = true;
+
+	/// Send TCP keep-alive probes on idle connections.
+	bool tcp_keep_alive = true;
+
+	/// Ask for compressed responses (gzip, deflate, ...) and decode them transparently.
+	/// Ranged requests never ask for compression, since ranges would then count compressed bytes.
+	bool accept_compressed = true;
 };
 
 /**
@@ -36,17 +181,139 @@ class IHttpClient
  *
  * This implementation uses libcurl's easy interface to perform
  * blocking HTTP GET requests.
+ *
+ * Easy handles are pooled and reused, so repeated requests to the same host
+ * keep their TCP/TLS connection alive. A share handle additionally shares the
+ * DNS cache, TLS session tickets and the connection cache between all pooled
+ * handles. The client may be used from several threads at once.
  */
 class LibcurlHttpClient : public IHttpClient
 {
 public:
+	using IHttpClient::get;
+
+	/**
+	 * @brief Create a client with the given connection settings.
+	 *
+	 * @param options Timeouts and protocol settings.
+	 *
+	 * @throws std::runtime_error if libcurl cannot be initialized.
+	 */
+	explicit LibcurlHttpClient(HttpClientOptions options = {});
+
+	/**
+	 * @brief Close all pooled handles and connections.
+	 */
+	~LibcurlHttpClient() override;
+
+	LibcurlHttpClient(const LibcurlHttpClient &) = delete;
+	LibcurlHttpClient &operator=(const LibcurlHttpClient &) = delete;
+
 	/**
 	 * @brief Perform a GET request using libcurl.
 	 *
-	 * @param url Target URL.
-	 * @return HttpResponse with status code and body.
+	 * @param url     Target URL.
+	 * @param headers Request headers to send in addition to the defaults.
+	 * @return HttpResponse with status code, headers and body.
 	 *
 	 * @throws std::runtime_error if libcurl fails to initialize or execute the request.
 	 */
-	HttpResponse get(const std::string &url) override;
+	HttpResponse get(const std::string &url, const HttpHeaders &headers) override;
+
+	/**
+	 * @brief Perform a GET request, passing body chunks from libcurl's write callback to the handler.
+	 *
+	 * @param url     Target URL.
+	 * @param headers Request headers to send in addition to the defaults.
+	 * @param handler Receives the status, headers and body chunks.
+	 *
+	 * @throws std::runtime_error if libcurl fails to initialize or execute the request.
+	 */
+	void get_streaming(const std::string &url, const HttpHeaders &headers, IHttpResponseHandler &handler) override;
+
+private:
+	/**
+	 * @brief Pooled handles and the share handle; defined next to the libcurl code.
+	 */
+	struct ConnectionPool;
+
+	/// Connection settings applied to every request.
+	HttpClientOptions options_;
+
+	/// Pooled easy handles and shared caches.
+	std::unique_ptr<ConnectionPool> pool_;
+};
+
+/**
+ * @brief HTTP client that multiplexes concurrent requests on one libcurl event loop.
+ *
+ * Every request is added to a single curl_multi handle driven by a dedicated
+ * thread, so many downloads proceed concurrently without a thread doing
+ * network I/O per transfer. get() and get_streaming() still block their
+ * caller until the transfer finished; concurrency comes from calling them on
+ * several threads at once.
+ *
+ * At most `max_connections_per_host` connections are opened to one host;
+ * further transfers to that host wait inside libcurl until a connection is
+ * free (or share one through HTTP/2 multiplexing).
+ */
+class LibcurlMultiHttpClient : public IHttpClient
+{
+public:
+	using IHttpClient::get;
+
+	/**
+	 * @brief Create a client and start its event loop thread.
+	 *
+	 * @param options                  Timeouts and protocol settings.
+	 * @param max_connections_per_host Connection limit per host (0 = unlimited).
+	 *
+	 * @throws std::runtime_error if libcurl cannot be initialized.
+	 */
+	explicit LibcurlMultiHttpClient(HttpClientOptions options = {}, long max_connections_per_host = 4);
+
+	/**
+	 * @brief Stop the event loop. No request may be in flight.
+	 */
+	~LibcurlMultiHttpClient() override;
+
+	LibcurlMultiHttpClient(const LibcurlMultiHttpClient &) = delete;
+	LibcurlMultiHttpClient &operator=(const LibcurlMultiHttpClient &) = delete;
+
+	/**
+	 * @brief Perform a GET request on the event loop and wait for the whole response.
+	 *
+	 * @param url     Target URL.
+	 * @param headers Request headers to send in addition to the defaults.
+	 * @return HttpResponse with status code, headers and body.
+	 *
+	 * @throws std::runtime_error if the request fails.
+	 */
+	HttpResponse get(const std::string &url, const HttpHeaders &headers) override;
+
+	/**
+	 * @brief Perform a GET request on the event loop, passing body chunks to the handler.
+	 *
+	 * The handler is called on the event loop thread; this call returns once
+	 * the transfer finished.
+	 *
+	 * @param url     Target URL.
+	 * @param headers Request headers to send in addition to the defaults.
+	 * @param handler Receives the status, headers and body chunks.
+	 *
+	 * @throws std::runtime_error if the request fails.
+	 */
+	void get_streaming(const std::string &url, const HttpHeaders &headers, IHttpResponseHandler &handler) override;
+
+private:
+	/**
+	 * @brief Multi handle, its thread and the queue of submitted transfers.
+	 */
+	struct EventLoop;
+
+	/// Connection settings applied to every request.
+	HttpClientOptions options_;
+
+	/// Event loop driving all transfers.
+	std::unique_ptr<EventLoop> loop_;
 };
@@ -0,0 +1,451 @@
+/// \file
+/// \brief TCP/TLS transport for the IMAP client.
+
+#include "import/imap_connection.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	/// Number of bytes requested from the socket per read.
+	constexpr std::size_t read_chunk_bytes = 64U * 1024U;
+
+	/// Largest literal accepted from the server; a bigger one is a broken or hostile peer.
+	constexpr std::size_t max_literal_bytes = 256U * 1024U * 1024U;
+
+	/**
+	 * @brief Last OpenSSL error as text.
+	 */
+	std::string openssl_error()
+	{
+		const unsigned long code = ERR_get_error();
+		if (code == 0)
+		{
+			return "unknown error";
+		}
+		char text[256];
+		ERR_error_string_n(code, text, sizeof(text));
+		return text;
+	}
+
+	/**
+	 * @brief Blocks SIGPIPE on the calling thread while OpenSSL writes to the socket.
+	 *
+	 * A peer closing the connection must surface as a write error rather
+	 * than terminate the process. A SIGPIPE raised meanwhile is consumed.
+	 */
+	class SigpipeGuard
+	{
+	public:
+		SigpipeGuard()
+		{
+			sigset_t pipe_set;
+			sigemptyset(&pipe_set);
+			sigaddset(&pipe_set, SIGPIPE);
+			pthread_sigmask(SIG_BLOCK, &pipe_set, &previous_);
+		}
+
+		~SigpipeGuard()
+		{
+			sigset_t pipe_set;
+			sigemptyset(&pipe_set);
+			sigaddset(&pipe_set, SIGPIPE);
+
+			sigset_t pending;
+			sigpending(&pending);
+			if (sigismember(&pending, SIGPIPE) == 1)
+			{
+				const timespec no_wait{};
+				sigtimedwait(&pipe_set, nullptr, &no_wait);
+			}
+			pthread_sigmask(SIG_SETMASK, &previous_, nullptr);
+		}
+
+		SigpipeGuard(const SigpipeGuard &) = delete;
+		SigpipeGuard &operator=(const SigpipeGuard &) = delete;
+
+	private:
+		sigset_t previous_{};
+	};
+
+	/**
+	 * @brief Connect a socket to one resolved address, giving up after the timeout.
+	 *
+	 * @return The connected socket, or -1.
+	 */
+	int connect_with_timeout(const addrinfo &address, int timeout_seconds)
+	{
+		const int fd = ::socket(address.ai_family, address.ai_socktype, address.ai_protocol);
+		if (fd < 0)
+		{
+			return -1;
+		}
+
+		const int flags = ::fcntl(fd, F_GETFL, 0);
+		::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+		int rc = ::connect(fd, address.ai_addr, address.ai_addrlen);
+		if (rc != 0 && errno == EINPROGRESS)
+		{
+			pollfd waiter{fd, POLLOUT, 0};
+			rc = ::poll(&waiter, 1, timeout_seconds > 0 ? timeout_seconds * 1000 : -1);
+			if (rc == 1)
+			{
+				int error = 0;
+				socklen_t length = sizeof(error);
+				::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+				rc = error == 0 ? 0 : -1;
+			}
+			else
+			{
+				rc = -1;
+			}
+		}
+
+		if (rc != 0)
+		{
+			::close(fd);
+			return -1;
+		}
+
+		::fcntl(fd, F_SETFL, flags);
+		return fd;
+	}
+}
+
+struct ImapConnection::Tls
+{
+	SSL_CTX *context = nullptr;
+	SSL *session = nullptr;
+
+	~Tls()
+	{
+		if (session != nullptr)
+		{
+			SSL_free(session);
+		}
+		if (context != nullptr)
+		{
+			SSL_CTX_free(context);
+		}
+	}
+};
+
+ImapConnection::ImapConnection() = default;
+
+ImapConnection::~ImapConnection()
+{
+	close();
+}
+
+void ImapConnection::open(const std::string &host, int port, bool use_tls, bool verify_certificate, int timeout_seconds)
+{
+	close();
+
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo *addresses = nullptr;
+	const std::string service = std::to_string(port);
+	if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0)
+	{
+		throw std::runtime_error("Cannot resolve IMAP host " + host);
+	}
+
+	for (const addrinfo *address = addresses; address != nullptr && fd_ < 0; address = address->ai_next)
+	{
+		fd_ = connect_with_timeout(*address, timeout_seconds);
+	}
+	::freeaddrinfo(addresses);
+
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("Cannot connect to IMAP server " + host + ":" + service);
+	}
+
+	// Commands are small and latency-bound; do not delay them.
+	const int enable = 1;
+	::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+	if (timeout_seconds > 0)
+	{
+		timeval timeout{};
+		timeout.tv_sec = timeout_seconds;
+		::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		::setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+	}
+
+	if (!use_tls)
+	{
+		return;
+	}
+
+	tls_ = std::make_unique<Tls>();
+	tls_->context = SSL_CTX_new(TLS_client_method());
+	if (tls_->context == nullptr)
+	{
+		close();
+		throw std::runtime_error("Failed to create TLS context: " + openssl_error());
+	}
+	SSL_CTX_set_min_proto_version(tls_->context, TLS1_2_VERSION);
+	if (verify_certificate)
+	{
+		SSL_CTX_set_default_verify_paths(tls_->context);
+		SSL_CTX_set_verify(tls_->context, SSL_VERIFY_PEER, nullptr);
+	}
+
+	tls_->session = SSL_new(tls_->context);
+	if (tls_->session == nullptr || SSL_set_fd(tls_->session, fd_) != 1)
+	{
+		close();
+		throw std::runtime_error("Failed to create TLS session: " + openssl_error());
+	}
+	SSL_set_tlsext_host_name(tls_->session, host.c_str());
+	if (verify_certificate)
+	{
+		SSL_set1_host(tls_->session, host.c_str());
+	}
+
+	SigpipeGuard guard;
+	if (SSL_connect(tls_->session) != 1)
+	{
+		const std::string error = openssl_error();
+		close();
+		throw std::runtime_error("TLS handshake with " + host + " failed: " + error);
+	}
+}
+
+void ImapConnection::close()
+{
+	if (tls_ != nullptr && tls_->session != nullptr)
+	{
+		SigpipeGuard guard;
+		SSL_shutdown(tls_->session);
+	}
+	tls_.reset();
+
+	if (fd_ >= 0)
+	{
+		::close(fd_);
+		fd_ = -1;
+	}
+
+	buffer_.clear();
+	buffer_start_ = 0;
+	bytes_sent_ = 0;
+	bytes_received_ = 0;
+}
+
+bool ImapConnection::is_open() const
+{
+	return fd_ >= 0;
+}
+
+void ImapConnection::send(std::string_view data)
+{
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("IMAP connection is not open");
+	}
+
+	while (!data.empty())
+	{
+		long written = 0;
+		if (tls_ != nullptr)
+		{
+			SigpipeGuard guard;
+			written = SSL_write(tls_->session, data.data(), static_cast<int>(std::min<std::size_t>(data.size(), read_chunk_bytes)));
+		}
+		else
+		{
+			written = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+			if (written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+		}
+
+		if (written <= 0)
+		{
+			throw std::runtime_error("Failed to write to the IMAP server");
+		}
+
+		data.remove_prefix(static_cast<std::size_t>(written));
+		bytes_sent_ += static_cast<std::uint64_t>(written);
+	}
+}
+
+void ImapConnection::read_response(std::string &raw)
+{
+	raw.clear();
+
+	std::size_t scanned = buffer_start_;
+	while (true)
+	{
+		const std::size_t newline = buffer_.find('\n', scanned);
+		if (newline == std::string::npos)
+		{
+			// fill_buffer() may move the unconsumed bytes to the front.
+			const std::size_t scanned_bytes = buffer_.size() - buffer_start_;
+			fill_buffer();
+			scanned = buffer_start_ + scanned_bytes;
+			continue;
+		}
+
+		const std::size_t line_length = newline + 1 - buffer_start_;
+		const std::string_view line(buffer_.data() + buffer_start_, line_length);
+		raw.append(line);
+		buffer_start_ += line_length;
+
+		// A line ending in {n} announces a literal of n bytes; the response continues after it.
+		std::size_t literal = 0;
+		bool has_literal = false;
+		if (line.size() >= 3 && line[line.size() - 3] == '}')
+		{
+			const std::size_t open = line.rfind('{');
+			if (open != std::string_view::npos && open + 1 < line.size() - 3)
+			{
+				has_literal = true;
+				for (std::size_t i = open + 1; i < line.size() - 3; ++i)
+				{
+					const char c = line[i];
+					if (c < '0' || c > '9')
+					{
+						has_literal = false;
+						break;
+					}
+					// Bounded after every digit, so literal * 10 cannot overflow.
+					literal = literal * 10 + static_cast<std::size_t>(c - '0');
+					if (literal > max_literal_bytes)
+					{
+						throw std::runtime_error("IMAP server announced a literal larger than " +
+							std::to_string(max_literal_bytes) + " bytes");
+					}
+				}
+			}
+		}
+
+		if (!has_literal)
+		{
+			return;
+		}
+
+		take(raw, literal);
+		scanned = buffer_start_;
+	}
+}
+
+bool ImapConnection::wait_readable(std::chrono::milliseconds timeout)
+{
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("IMAP connection is not open");
+	}
+
+	// Bytes already buffered here or decrypted inside OpenSSL do not show up on the socket.
+	if (buffer_start_ < buffer_.size() || (tls_ != nullptr && SSL_pending(tls_->session) > 0))
+	{
+		return true;
+	}
+
+	pollfd waiter{fd_, POLLIN, 0};
+	int ready = 0;
+	do
+	{
+		ready = ::poll(&waiter, 1, static_cast<int>(timeout.count()));
+	} while (ready < 0 && errno == EINTR);
+
+	return ready > 0;
+}
+
+std::uint64_t ImapConnection::bytes_sent() const
+{
+	return bytes_sent_;
+}
+
+std::uint64_t ImapConnection::bytes_received() const
+{
+	return bytes_received_;
+}
+
+void ImapConnection::fill_buffer()
+{
+	if (fd_ < 0)
+	{
+		throw std::runtime_error("IMAP connection is not open");
+	}
+
+	// Drop consumed bytes before growing the buffer.
+	if (buffer_start_ > 0)
+	{
+		buffer_.erase(0, buffer_start_);
+		buffer_start_ = 0;
+	}
+
+	const std::size_t old_size = buffer_.size();
+	buffer_.resize(old_size + read_chunk_bytes);
+
+	long received = 0;
+	while (true)
+	{
+		if (tls_ != nullptr)
+		{
+			received = SSL_read(tls_->session, buffer_.data() + old_size, static_cast<int>(read_chunk_bytes));
+		}
+		else
+		{
+			received = ::recv(fd_, buffer_.data() + old_size, read_chunk_bytes, 0);
+			if (received < 0 && errno == EINTR)
+			{
+				continue;
+			}
+		}
+		break;
+	}
+
+	if (received <= 0)
+	{
+		buffer_.resize(old_size);
+		if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			throw std::runtime_error("Timed out waiting for the IMAP server");
+		}
+		throw std::runtime_error("IMAP server closed the connection");
+	}
+
+	buffer_.resize(old_size + static_cast<std::size_t>(received));
+	bytes_received_ += static_cast<std::uint64_t>(received);
+}
+
+void ImapConnection::take(std::string &out, std::size_t count)
+{
+	while (count > 0)
+	{
+		if (buffer_start_ == buffer_.size())
+		{
+			fill_buffer();
+		}
+
+		const std::size_t available = std::min(count, buffer_.size() - buffer_start_);
+		out.append(buffer_, buffer_start_, available);
+		buffer_start_ += available;
+		count -= available;
+	}
+}
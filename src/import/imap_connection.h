@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Byte stream to an IMAP server over TCP, optionally wrapped in TLS.
+ *
+ * Reads are buffered and split into complete server responses: a response
+ * line together with every literal it announces (`{n}\r\n` followed by n
+ * bytes), so callers can parse it in one piece. TLS is provided by OpenSSL,
+ * with certificate and host name verification against the system trust
+ * store. Uses POSIX sockets.
+ */
+class ImapConnection
+{
+public:
+	ImapConnection();
+
+	/**
+	 * @brief Close the connection if it is still open.
+	 */
+	~ImapConnection();
+
+	ImapConnection(const ImapConnection &) = delete;
+	ImapConnection &operator=(const ImapConnection &) = delete;
+
+	/**
+	 * @brief Connect to the server.
+	 *
+	 * @param host               Host name or address.
+	 * @param port               TCP port.
+	 * @param use_tls            Whether to negotiate TLS right after connecting (port 993).
+	 * @param verify_certificate Whether to verify the server certificate and host name.
+	 * @param timeout_seconds    Limit on connecting and on every single read or write (0 = none).
+	 *
+	 * @throws std::runtime_error if the connection or the TLS handshake fails.
+	 */
+	void open(const std::string &host, int port, bool use_tls, bool verify_certificate, int timeout_seconds);
+
+	/**
+	 * @brief Close the connection; does nothing if it is not open.
+	 */
+	void close();
+
+	/**
+	 * @brief Whether the connection is open.
+	 */
+	bool is_open() const;
+
+	/**
+	 * @brief Write all bytes.
+	 *
+	 * @throws std::runtime_error if the connection fails or times out.
+	 */
+	void send(std::string_view data);
+
+	/**
+	 * @brief Read the next complete server response.
+	 *
+	 * @param raw Output; replaced by the response, including its CRLF and inlined literals.
+	 *
+	 * @throws std::runtime_error if the connection is closed, fails or times out,
+	 *         or the server announces an oversized literal.
+	 */
+	void read_response(std::string &raw);
+
+	/**
+	 * @brief Wait until received data is available, without reading it.
+	 *
+	 * @param timeout Longest time to wait.
+	 * @return true if data (or the end of the stream) can be read without
+	 *         waiting; false if the timeout expired.
+	 *
+	 * @throws std::runtime_error if the connection is not open.
+	 */
+	bool wait_readable(std::chrono::milliseconds timeout);
+
+	/**
+	 * @brief Number of bytes written since the connection was opened.
+	 */
+	std::uint64_t bytes_sent() const;
+
+	/**
+	 * @brief Number of bytes read since the connection was opened.
+	 */
+	std::uint64_t bytes_received() const;
+
+private:
+	/**
+	 * @brief OpenSSL session state; keeps OpenSSL headers out of this header.
+	 */
+	struct Tls;
+
+	/// Socket descriptor; -1 when closed.
+	int fd_ = -1;
+
+	/// TLS session; null for plain connections.
+	std::unique_ptr<Tls> tls_;
+
+	/// Received bytes not yet returned.
+	std::string buffer_;
+
+	/// Offset of the first unconsumed byte in buffer_.
+	std::size_t buffer_start_ = 0;
+
+	/// Bytes written since open().
+	std::uint64_t bytes_sent_ = 0;
+
+	/// Bytes read since open().
+	std::uint64_t bytes_received_ = 0;
+
+	/**
+	 * @brief Append at least one received byte to buffer_.
+	 */
+	void fill_buffer();
+
+	/**
+	 * @brief Move up to `count` buffered bytes (reading more as needed) onto `out`.
+	 */
+	void take(std::string &out, std::size_t count);
+};
@@ -0,0 +1,792 @@
+/// \file
+/// \brief IMAP4rev1 implementation of IEmailClient with UID-based incremental sync.
+
+#include "import/imap_email_client.h"
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "util/string_utils.h"
+
+namespace
+{
+	/// Longest wait on the socket in IDLE before should_stop is polled again.
+	constexpr std::chrono::milliseconds idle_poll_interval{100};
+
+	/// FETCH items requested for every new message in full mode.
+	constexpr std::string_view full_fetch_items = " (UID BODY.PEEK[HEADER.FIELDS (FROM TO SUBJECT DATE CONTENT-TYPE CONTENT-TRANSFER-ENCODING)] BODY.PEEK[TEXT])";
+
+	/// FETCH items requested for every new message in the first phase of header-first mode.
+	constexpr std::string_view envelope_fetch_items = " (UID ENVELOPE BODYSTRUCTURE)";
+
+	/**
+	 * @brief Upper-case an ASCII string.
+	 */
+	std::string to_upper(std::string_view text)
+	{
+		std::string upper(text);
+		for (auto &c : upper)
+		{
+			c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+		}
+		return upper;
+	}
+
+	/**
+	 * @brief Whether the search expression selects every message.
+	 */
+	bool selects_all(const std::string &search_expression)
+	{
+		const std::string trimmed = string_utils::trim(search_expression);
+		return trimmed.empty() || to_upper(trimmed) == "ALL";
+	}
+
+	/**
+	 * @brief Replace the capability list with the atoms following a CAPABILITY keyword.
+	 */
+	void read_capabilities(const std::vector<ImapValue> &values, std::vector<std::string> &capabilities)
+	{
+		if (values.empty() || !values[0].is_atom("CAPABILITY"))
+		{
+			return;
+		}
+
+		capabilities.clear();
+		for (std::size_t i = 1; i < values.size(); ++i)
+		{
+			capabilities.push_back(to_upper(values[i].text));
+		}
+	}
+
+	/**
+	 * @brief Fill From/To/Subject/Date and the body type of a message from a raw header block.
+	 *
+	 * Folded header lines are unfolded; other fields are ignored.
+	 */
+	void parse_header_fields(std::string_view headers, EmailMessage &message)
+	{
+		std::string *current = nullptr;
+
+		while (!headers.empty())
+		{
+			std::size_t line_end = headers.find('\n');
+			std::string_view line = headers.substr(0, line_end);
+			headers.remove_prefix(line_end == std::string_view::npos ? headers.size() : line_end + 1);
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.remove_suffix(1);
+			}
+
+			if (!line.empty() && (line[0] == ' ' || line[0] == '\t'))
+			{
+				if (current != nullptr)
+				{
+					current->push_back(' ');
+					current->append(string_utils::trim_view(line));
+				}
+				continue;
+			}
+
+			current = nullptr;
+			const std::size_t colon = line.find(':');
+			if (colon == std::string_view::npos)
+			{
+				continue;
+			}
+
+			const std::string name = to_upper(string_utils::trim_view(line.substr(0, colon)));
+			if (name == "FROM")
+			{
+				current = &message.from;
+			}
+			else if (name == "TO")
+			{
+				current = &message.to;
+			}
+			else if (name == "SUBJECT")
+			{
+				current = &message.subject;
+			}
+			else if (name == "DATE")
+			{
+				current = &message.date;
+			}
+			else if (name == "CONTENT-TYPE")
+			{
+				current = &message.body_content_type;
+			}
+			else if (name == "CONTENT-TRANSFER-ENCODING")
+			{
+				current = &message.body_transfer_encoding;
+			}
+
+			if (current != nullptr)
+			{
+				current->assign(string_utils::trim_view(line.substr(colon + 1)));
+			}
+		}
+	}
+
+	/**
+	 * @brief Build a message from an ENVELOPE/BODYSTRUCTURE FETCH response.
+	 *
+	 * @param items     Item list of the FETCH response.
+	 * @param message   Receives date, subject, sender and recipients.
+	 * @param text_part Receives the location of the text part.
+	 * @return The UID of the message; 0 if the response carried none.
+	 */
+	std::uint32_t message_from_envelope(const ImapValue &items, EmailMessage &message, ImapTextPart &text_part)
+	{
+		std::uint32_t uid = 0;
+
+		for (std::size_t i = 0; i + 1 < items.items.size(); i += 2)
+		{
+			const ImapValue &name = items.items[i];
+			const ImapValue &value = items.items[i + 1];
+
+			if (name.is_atom("UID"))
+			{
+				uid = static_cast<std::uint32_t>(value.number());
+				message.id = value.text;
+			}
+			else if (name.is_atom("ENVELOPE") && value.items.size() >= 6)
+			{
+				// (date subject from sender reply-to to cc bcc in-reply-to message-id)
+				message.date = value.items[0].text;
+				message.subject = value.items[1].text;
+				message.from = imap_format_addresses(value.items[2]);
+				message.to = imap_format_addresses(value.items[5]);
+			}
+			else if (name.is_atom("BODYSTRUCTURE"))
+			{
+				text_part = imap_find_text_part(value);
+			}
+		}
+
+		return uid;
+	}
+
+	/**
+	 * @brief Build a message from the item list of a FETCH response.
+	 *
+	 * @return The UID of the message; 0 if the response carried none.
+	 */
+	std::uint32_t message_from_fetch(const ImapValue &items, EmailMessage &message)
+	{
+		std::uint32_t uid = 0;
+
+		for (std::size_t i = 0; i + 1 < items.items.size(); i += 2)
+		{
+			const ImapValue &name = items.items[i];
+			const ImapValue &value = items.items[i + 1];
+
+			if (name.is_atom("UID"))
+			{
+				uid = static_cast<std::uint32_t>(value.number());
+				message.id = value.text;
+				continue;
+			}
+
+			const std::string upper = to_upper(name.text);
+			if (upper.rfind("BODY[HEADER", 0) == 0)
+			{
+				parse_header_fields(value.text, message);
+			}
+			else if (upper.rfind("BODY[TEXT]", 0) == 0)
+			{
+				message.body_text = value.text;
+			}
+		}
+
+		return uid;
+	}
+}
+
+ImapEmailClient::ImapEmailClient(ConnectionSettings settings, IImapSyncStateStore *sync_state, ImapFetchOptions fetch)
+	: settings_(std::move(settings))
+	, fetch_(std::move(fetch))
+	, sync_state_(sync_state)
+{
+}
+
+ImapEmailClient::~ImapEmailClient()
+{
+	disconnect();
+}
+
+void ImapEmailClient::connect()
+{
+	connection_.open(settings_.host, settings_.port, settings_.use_tls, settings_.verify_certificate, settings_.timeout_seconds);
+
+	capabilities_.clear();
+	selected_ = false;
+	pending_output_.clear();
+	queued_commands_ = 0;
+	in_flight_commands_ = 0;
+
+	try
+	{
+		connection_.read_response(raw_response_);
+		const ImapResponse greeting = parse_imap_response(raw_response_);
+		if (greeting.tag != "*" || (greeting.status != "OK" && greeting.status != "PREAUTH"))
+		{
+			throw std::runtime_error("IMAP server refused the connection: " + greeting.text);
+		}
+		read_capabilities(greeting.code, capabilities_);
+
+		const UntaggedHandler ignore = [](const ImapResponse &) {};
+
+		if (greeting.status == "OK")
+		{
+			// Capabilities may change once authenticated; ask again in the same round trip.
+			const std::string login = send_command("LOGIN " + imap_quote(settings_.username) + " " + imap_quote(settings_.password));
+			const std::string capability = send_command("CAPABILITY");
+
+			try
+			{
+				wait_for(login, ignore);
+			}
+			catch (const std::runtime_error &ex)
+			{
+				throw std::runtime_error(std::string("IMAP login failed: ") + ex.what());
+			}
+			wait_for(capability, ignore);
+		}
+		else if (capabilities_.empty())
+		{
+			wait_for(send_command("CAPABILITY"), ignore);
+		}
+	}
+	catch (...)
+	{
+		connection_.close();
+		throw;
+	}
+}
+
+void ImapEmailClient::disconnect()
+{
+	if (!connection_.is_open())
+	{
+		return;
+	}
+
+	try
+	{
+		wait_for(send_command("LOGOUT"), [](const ImapResponse &) {});
+	}
+	catch (const std::exception &)
+	{
+		// The connection is closed either way.
+	}
+	connection_.close();
+}
+
+std::vector<EmailMessage> ImapEmailClient::fetch_messages(const std::string &search_expression)
+{
+	if (!connection_.is_open())
+	{
+		throw std::runtime_error("IMAP client is not connected");
+	}
+
+	stats_ = ImapSyncStats{};
+	pending_state_.reset();
+	const std::uint64_t sent_before = connection_.bytes_sent();
+	const std::uint64_t received_before = connection_.bytes_received();
+
+	const auto finish = [&](ImapMailboxState state)
+	{
+		stats_.bytes_sent = connection_.bytes_sent() - sent_before;
+		stats_.bytes_received = connection_.bytes_received() - received_before;
+		pending_state_ = std::move(state);
+	};
+
+	ImapMailboxState current;
+	current.mailbox_key = mailbox_key();
+	std::uint64_t exists = 0;
+
+	std::string select = "SELECT " + imap_quote(settings_.mailbox);
+	if (has_capability("CONDSTORE"))
+	{
+		select += " (CONDSTORE)";
+	}
+
+	wait_for(send_command(select), [&](const ImapResponse &response)
+	{
+		if (response.status == "OK" && response.code.size() >= 2)
+		{
+			const ImapValue &name = response.code[0];
+			if (name.is_atom("UIDVALIDITY"))
+			{
+				current.uid_validity = static_cast<std::uint32_t>(response.code[1].number());
+			}
+			else if (name.is_atom("UIDNEXT"))
+			{
+				current.uid_next = static_cast<std::uint32_t>(response.code[1].number());
+			}
+			else if (name.is_atom("HIGHESTMODSEQ"))
+			{
+				current.highest_modseq = response.code[1].number();
+			}
+		}
+		else if (response.values.size() >= 2 && response.values[1].is_atom("EXISTS"))
+		{
+			exists = response.values[0].number();
+		}
+	});
+	selected_ = true;
+
+	// Messages below first_uid were imported by an earlier sync.
+	std::uint32_t first_uid = 1;
+	const std::optional<ImapMailboxState> stored = sync_state_ != nullptr ? sync_state_->find(current.mailbox_key) : std::nullopt;
+	if (stored && stored->uid_validity == current.uid_validity)
+	{
+		const bool same_uid_next = current.uid_next != 0 && stored->uid_next == current.uid_next;
+		const bool same_modseq = current.highest_modseq != 0 && stored->highest_modseq == current.highest_modseq;
+		if (same_uid_next || same_modseq)
+		{
+			stats_.unchanged = true;
+			current.uid_next = std::max(current.uid_next, stored->uid_next);
+			finish(current);
+			return {};
+		}
+		first_uid = std::max<std::uint32_t>(stored->uid_next, 1);
+	}
+
+	std::vector<EmailMessage> messages;
+	std::uint32_t highest_uid = 0;
+
+	if (exists > 0 && (current.uid_next == 0 || first_uid < current.uid_next))
+	{
+		std::vector<std::string> uid_sets;
+		const std::size_t uids_per_fetch = std::max<std::size_t>(settings_.uids_per_fetch, 1);
+
+		const bool all = selects_all(search_expression);
+		const std::uint64_t uid_range = current.uid_next != 0 ? current.uid_next - first_uid : 0;
+
+		// Expunged messages leave gaps in the UIDs; walking a sparse range would
+		// send mostly empty fetches, so it is only walked when EXISTS fills it.
+		if (all && current.uid_next != 0 && (uid_range <= 2 * exists || uid_range <= uids_per_fetch))
+		{
+			// UIDNEXT bounds the UID range; no SEARCH round trip is needed.
+			for (std::uint64_t first = first_uid; first < current.uid_next; first += uids_per_fetch)
+			{
+				const std::uint64_t last = std::min<std::uint64_t>(first + uids_per_fetch - 1, current.uid_next - 1);
+				uid_sets.push_back(std::to_string(first) + ":" + std::to_string(last));
+			}
+		}
+		else if (all && current.uid_next == 0)
+		{
+			uid_sets.push_back(std::to_string(first_uid) + ":*");
+		}
+		else
+		{
+			std::vector<std::uint32_t> uids;
+			std::string search = "UID SEARCH UID " + std::to_string(first_uid) + ":*";
+			if (!all)
+			{
+				search += " " + string_utils::trim(search_expression);
+			}
+			wait_for(send_command(search), [&](const ImapResponse &response)
+			{
+				if (!response.values.empty() && response.values[0].is_atom("SEARCH"))
+				{
+					for (std::size_t i = 1; i < response.values.size(); ++i)
+					{
+						const auto uid = static_cast<std::uint32_t>(response.values[i].number());
+						// "N:*" always matches the highest UID, even below N.
+						if (uid >= first_uid)
+						{
+							uids.push_back(uid);
+						}
+					}
+				}
+			});
+
+			std::sort(uids.begin(), uids.end());
+			uids.erase(std::unique(uids.begin(), uids.end()), uids.end());
+			uid_sets = imap_uid_sets(uids, uids_per_fetch);
+		}
+
+		highest_uid = fetch_.mode == ImapFetchMode::Full
+			? fetch_full(uid_sets, first_uid, messages)
+			: fetch_headers_first(uid_sets, first_uid, messages);
+	}
+
+	if (current.uid_next == 0)
+	{
+		current.uid_next = std::max(first_uid, highest_uid + 1);
+	}
+
+	stats_.messages_fetched = messages.size();
+	finish(current);
+	return messages;
+}
+
+void ImapEmailClient::on_messages_imported()
+{
+	if (sync_state_ != nullptr && pending_state_)
+	{
+		sync_state_->save(*pending_state_);
+	}
+	pending_state_.reset();
+}
+
+bool ImapEmailClient::is_connected() const
+{
+	return connection_.is_open();
+}
+
+bool ImapEmailClient::idle(std::chrono::milliseconds max_wait, const std::function<bool()> &should_stop)
+{
+	if (!connection_.is_open() || !selected_)
+	{
+		throw std::runtime_error("IMAP client has no mailbox selected");
+	}
+	if (!has_capability("IDLE"))
+	{
+		throw std::runtime_error("IMAP server does not support IDLE");
+	}
+
+	// Any EXISTS means the message count changed; a false alarm only costs a SELECT.
+	bool changed = false;
+	const UntaggedHandler on_untagged = [&](const ImapResponse &response)
+	{
+		if (response.values.size() >= 2 && response.values[1].is_atom("EXISTS"))
+		{
+			changed = true;
+		}
+	};
+
+	const std::string tag = send_command("IDLE");
+	flush();
+
+	while (true)
+	{
+		connection_.read_response(raw_response_);
+		const ImapResponse response = parse_imap_response(raw_response_);
+		if (response.tag == "+")
+		{
+			break;
+		}
+		if (response.tag != "*")
+		{
+			--in_flight_commands_;
+			throw std::runtime_error("IMAP command failed: " + response.status + " " + response.text);
+		}
+		dispatch_untagged(response, on_untagged);
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + max_wait;
+	while (!changed && !(should_stop && should_stop()))
+	{
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+		if (remaining.count() <= 0)
+		{
+			break;
+		}
+		if (!connection_.wait_readable(std::min(remaining, idle_poll_interval)))
+		{
+			continue;
+		}
+
+		connection_.read_response(raw_response_);
+		const ImapResponse response = parse_imap_response(raw_response_);
+		if (response.tag != "*")
+		{
+			throw std::runtime_error("Unexpected IMAP response during IDLE");
+		}
+		dispatch_untagged(response, on_untagged);
+	}
+
+	connection_.send("DONE\r\n");
+	wait_for(tag, on_untagged);
+	return changed;
+}
+
+const ImapSyncStats &ImapEmailClient::last_sync_stats() const
+{
+	return stats_;
+}
+
+std::string ImapEmailClient::mailbox_key() const
+{
+	return settings_.username + "@" + settings_.host + "/" + settings_.mailbox;
+}
+
+bool ImapEmailClient::has_capability(std::string_view capability) const
+{
+	const std::string upper = to_upper(capability);
+	return std::find(capabilities_.begin(), capabilities_.end(), upper) != capabilities_.end();
+}
+
+std::string ImapEmailClient::send_command(std::string_view command)
+{
+	std::string tag = "A";
+	tag += std::to_string(next_tag_++);
+
+	pending_output_ += tag;
+	pending_output_ += ' ';
+	pending_output_ += command;
+	pending_output_ += "\r\n";
+
+	++queued_commands_;
+	++stats_.commands;
+	return tag;
+}
+
+void ImapEmailClient::flush()
+{
+	if (queued_commands_ == 0)
+	{
+		return;
+	}
+
+	// Commands written while others are outstanding ride on the same round trip.
+	if (in_flight_commands_ == 0)
+	{
+		++stats_.round_trips;
+	}
+
+	connection_.send(pending_output_);
+	pending_output_.clear();
+	in_flight_commands_ += queued_commands_;
+	queued_commands_ = 0;
+}
+
+void ImapEmailClient::dispatch_untagged(const ImapResponse &response, const UntaggedHandler &on_untagged)
+{
+	read_capabilities(response.values, capabilities_);
+	read_capabilities(response.code, capabilities_);
+	if (response.status == "BYE")
+	{
+		connection_.close();
+		throw std::runtime_error("IMAP server closed the session: " + response.text);
+	}
+	on_untagged(response);
+}
+
+ImapResponse ImapEmailClient::wait_for(const std::string &tag, const UntaggedHandler &on_untagged)
+{
+	flush();
+
+	while (true)
+	{
+		connection_.read_response(raw_response_);
+		ImapResponse response = parse_imap_response(raw_response_);
+
+		if (response.tag == "*")
+		{
+			dispatch_untagged(response, on_untagged);
+			continue;
+		}
+
+		if (response.tag == "+")
+		{
+			throw std::runtime_error("Unexpected IMAP continuation request");
+		}
+
+		if (response.tag != tag)
+		{
+			throw std::runtime_error("Unexpected IMAP response for command " + response.tag);
+		}
+
+		--in_flight_commands_;
+		read_capabilities(response.code, capabilities_);
+		if (response.status != "OK")
+		{
+			throw std::runtime_error("IMAP command failed: " + response.status + " " + response.text);
+		}
+		return response;
+	}
+}
+
+void ImapEmailClient::run_pipelined(const std::vector<std::string> &commands, const UntaggedHandler &on_untagged)
+{
+	const std::size_t depth = std::max<std::size_t>(settings_.pipeline_depth, 1);
+
+	std::deque<std::string> tags;
+	std::size_t next_command = 0;
+	while (next_command < commands.size() || !tags.empty())
+	{
+		// Keep up to `depth` commands in flight; the server answers them back to back.
+		while (next_command < commands.size() && tags.size() < depth)
+		{
+			tags.push_back(send_command(commands[next_command++]));
+		}
+
+		wait_for(tags.front(), on_untagged);
+		tags.pop_front();
+	}
+}
+
+std::uint32_t ImapEmailClient::fetch_full(const std::vector<std::string> &uid_sets, std::uint32_t first_uid, std::vector<EmailMessage> &messages)
+{
+	std::uint32_t highest_uid = 0;
+
+	std::vector<std::string> commands;
+	for (const auto &uid_set : uid_sets)
+	{
+		commands.push_back("UID FETCH " + uid_set + std::string(full_fetch_items));
+	}
+
+	run_pipelined(commands, [&](const ImapResponse &response)
+	{
+		if (response.values.size() < 3 || !response.values[1].is_atom("FETCH") || response.values[2].kind != ImapValue::Kind::List)
+		{
+			return;
+		}
+
+		EmailMessage message;
+		const std::uint32_t uid = message_from_fetch(response.values[2], message);
+		if (uid >= first_uid)
+		{
+			highest_uid = std::max(highest_uid, uid);
+			messages.push_back(std::move(message));
+		}
+	});
+
+	return highest_uid;
+}
+
+std::uint32_t ImapEmailClient::fetch_headers_first(const std::vector<std::string> &uid_sets, std::uint32_t first_uid, std::vector<EmailMessage> &messages)
+{
+	std::uint32_t highest_uid = 0;
+
+	// Phase 1: envelopes and body structures of every new message.
+	std::vector<std::string> commands;
+	for (const auto &uid_set : uid_sets)
+	{
+		commands.push_back("UID FETCH " + uid_set + std::string(envelope_fetch_items));
+	}
+
+	// Text part section of each kept message -> UIDs, for the second phase.
+	std::map<std::string, std::vector<std::uint32_t>> uids_by_section;
+	std::unordered_map<std::uint32_t, std::size_t> index_by_uid;
+
+	run_pipelined(commands, [&](const ImapResponse &response)
+	{
+		if (response.values.size() < 3 || !response.values[1].is_atom("FETCH") || response.values[2].kind != ImapValue::Kind::List)
+		{
+			return;
+		}
+
+		EmailMessage message;
+		ImapTextPart text_part;
+		const std::uint32_t uid = message_from_envelope(response.values[2], message, text_part);
+		if (uid < first_uid)
+		{
+			return;
+		}
+		highest_uid = std::max(highest_uid, uid);
+
+		if (!fetch_.filter.matches(message.from, message.subject))
+		{
+			++stats_.messages_filtered_out;
+			return;
+		}
+
+		if (!text_part.section.empty())
+		{
+			message.body_content_type = "text/" + text_part.subtype;
+			message.body_transfer_encoding = text_part.encoding;
+			message.body_charset = text_part.charset;
+			uids_by_section[text_part.section].push_back(uid);
+		}
+		index_by_uid[uid] = messages.size();
+		messages.push_back(std::move(message));
+	});
+
+	// Phase 2: the leading bytes of the text part of the kept messages.
+	const std::string partial = fetch_.max_body_bytes > 0 ? "<0." + std::to_string(fetch_.max_body_bytes) + ">" : std::string();
+	const std::size_t uids_per_fetch = std::max<std::size_t>(settings_.uids_per_fetch, 1);
+
+	commands.clear();
+	for (const auto &[section, uids] : uids_by_section)
+	{
+		for (const auto &uid_set : imap_uid_sets(uids, uids_per_fetch))
+		{
+			commands.push_back("UID FETCH " + uid_set + " (UID BODY.PEEK[" + section + "]" + partial + ")");
+		}
+	}
+
+	run_pipelined(commands, [&](const ImapResponse &response)
+	{
+		if (response.values.size() < 3 || !response.values[1].is_atom("FETCH") || response.values[2].kind != ImapValue::Kind::List)
+		{
+			return;
+		}
+
+		const auto &items = response.values[2].items;
+		std::uint32_t uid = 0;
+		const ImapValue *body = nullptr;
+		for (std::size_t i = 0; i + 1 < items.size(); i += 2)
+		{
+			if (items[i].is_atom("UID"))
+			{
+				uid = static_cast<std::uint32_t>(items[i + 1].number());
+			}
+			else if (to_upper(items[i].text).rfind("BODY[", 0) == 0)
+			{
+				body = &items[i + 1];
+			}
+		}
+
+		const auto message = index_by_uid.find(uid);
+		if (body != nullptr && message != index_by_uid.end())
+		{
+			messages[message->second].body_text = body->text;
+		}
+	});
+
+	return highest_uid;
+}
+
+bool ImapMessageFilter::matches(std::string_view from, std::string_view subject) const
+{
+	if (sender_domains.empty() && subject_keywords.empty())
+	{
+		return true;
+	}
+
+	// Domain of the (last) address: "Jobs <jobs@mail.acme.example>" -> "mail.acme.example".
+	std::string domain;
+	const std::size_t at = from.rfind('@');
+	if (at != std::string_view::npos)
+	{
+		std::string_view rest = from.substr(at + 1);
+		rest = rest.substr(0, rest.find_first_of("> ,"));
+		string_utils::to_lower_into(rest, domain);
+	}
+
+	std::string wanted;
+	for (const auto &sender_domain : sender_domains)
+	{
+		string_utils::to_lower_into(sender_domain, wanted);
+		if (domain == wanted ||
+			(domain.size() > wanted.size() && domain.compare(domain.size() - wanted.size(), wanted.size(), wanted) == 0 &&
+				domain[domain.size() - wanted.size() - 1] == '.'))
+		{
+			return true;
+		}
+	}
+
+	std::string lower_subject;
+	string_utils::to_lower_into(subject, lower_subject);
+	std::string lower_keyword;
+	for (const auto &keyword : subject_keywords)
+	{
+		string_utils::to_lower_into(keyword, lower_keyword);
+		if (!keyword.empty() && lower_subject.find(lower_keyword) != std::string::npos)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
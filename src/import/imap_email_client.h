@@ -1,15 +1,116 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "import/email_client.h"
+#include "import/imap_connection.h"
+#include "import/imap_protocol.h"
+#include "storage/imap_sync_state_store.h"
 
 /**
- * @brief IMAP-based email client.
+ * @brief Wire-level figures of the last ImapEmailClient::fetch_messages() call.
+ */
+struct ImapSyncStats
+{
+	/// No message arrived since the last committed sync; nothing was fetched.
+	bool unchanged = false;
+
+	/// Number of messages fetched.
+	std::size_t messages_fetched = 0;
+
+	/// Number of new messages dropped by the message filter before their text was fetched.
+	std::size_t messages_filtered_out = 0;
+
+	/// Number of commands sent (SELECT, SEARCH, FETCH, ...).
+	std::size_t commands = 0;
+
+	/// Number of times the client sent commands with none outstanding and waited for replies.
+	std::size_t round_trips = 0;
+
+	/// Bytes written to the server.
+	std::uint64_t bytes_sent = 0;
+
+	/// Bytes read from the server.
+	std::uint64_t bytes_received = 0;
+};
+
+/**
+ * @brief Decides from sender and subject whether a message is worth fetching.
+ *
+ * A message passes if no rule is configured, if its sender's domain is one
+ * of the sender domains (or a subdomain of one), or if its subject contains
+ * one of the subject keywords (case-insensitively).
+ */
+struct ImapMessageFilter
+{
+	/// Sender domains of job-related mail (e.g. "greenhouse.io").
+	std::vector<std::string> sender_domains;
+
+	/// Subject keywords of job-related mail (e.g. "application", "interview").
+	std::vector<std::string> subject_keywords;
+
+	/**
+	 * @brief Whether a message with the given sender and subject passes.
+	 *
+	 * @param from    From address, optionally with a display name ("Jobs <jobs@acme.example>").
+	 * @param subject Subject line.
+	 */
+	bool matches(std::string_view from, std::string_view subject) const;
+};
+
+/**
+ * @brief How ImapEmailClient fetches new messages.
+ */
+enum class ImapFetchMode
+{
+	/// ENVELOPE and BODYSTRUCTURE first; then the text part of matching messages only.
+	HeadersFirst,
+
+	/// Headers and the whole text of every new message in one pass.
+	Full
+};
+
+/**
+ * @brief Fetch settings of ImapEmailClient.
+ */
+struct ImapFetchOptions
+{
+	/// How new messages are fetched.
+	ImapFetchMode mode = ImapFetchMode::HeadersFirst;
+
+	/// Messages to fetch the text of (HeadersFirst only).
+	ImapMessageFilter filter;
+
+	/// Maximum number of text part bytes fetched per message (HeadersFirst only; 0 = all).
+	std::size_t max_body_bytes = 64U * 1024U;
+};
+
+/**
+ * @brief IMAP4rev1 email client with incremental, UID-based sync.
+ *
+ * Speaks IMAP directly over a TCP connection, normally wrapped in TLS
+ * (port 993). With a sync state store, the client remembers UIDVALIDITY,
+ * UIDNEXT and (with CONDSTORE) HIGHESTMODSEQ per mailbox and only fetches
+ * messages that arrived since the last committed sync; a mailbox without new
+ * messages costs a single SELECT. New messages are fetched with pipelined
+ * `UID FETCH` commands over UID ranges, several of them in flight at once,
+ * instead of one round trip per message.
+ *
+ * By default new messages are fetched in two phases: first only their
+ * ENVELOPE and BODYSTRUCTURE, which are classified with an ImapMessageFilter;
+ * then, for messages that pass, just the leading bytes of their text part
+ * (`BODY.PEEK[1]<0.N>`), skipping other parts and attachments. Full mode
+ * fetches the headers and the whole text of every new message instead.
  *
- * This is a placeholder for a real IMAP implementation. It can be backed by
- * any IMAP library (e.g. libcurl, mailio, etc.). For now, it can be left as
- * an unimplemented stub or a minimal prototype.
+ * The new sync position is only saved from on_messages_imported(), so a
+ * failed import fetches the same messages again.
  */
 class ImapEmailClient : public IEmailClient
 {
@@ -20,18 +121,205 @@ class ImapEmailClient : public IEmailClient
 		int port = 993;
 		bool use_tls = true;
 
+		/// Verify the server certificate and host name (TLS only).
+		bool verify_certificate = true;
+
+		/// Limit in seconds on connecting and on every single read or write (0 = none).
+		int timeout_seconds = 30;
+
 		std::string username;
 		std::string password; // In practice, use app passwords or environment variables.
 		std::string mailbox = "INBOX"; // Or a Gmail label, e.g. "[Gmail]/All Mail".
+
+		/// Maximum number of UIDs requested by one UID FETCH command.
+		std::size_t uids_per_fetch = 500;
+
+		/// Maximum number of UID FETCH commands in flight at once.
+		std::size_t pipeline_depth = 8;
 	};
 
-	explicit ImapEmailClient(ConnectionSettings settings);
+	/**
+	 * @brief Construct a client; nothing is sent before connect().
+	 *
+	 * @param settings   Server, account and mailbox to sync.
+	 * @param sync_state Optional store of sync positions; without it every
+	 *                   fetch starts from the first message.
+	 * @param fetch      How new messages are fetched and filtered.
+	 */
+	explicit ImapEmailClient(ConnectionSettings settings, IImapSyncStateStore *sync_state = nullptr, ImapFetchOptions fetch = ImapFetchOptions());
+
+	/**
+	 * @brief Log out if still connected.
+	 */
+	~ImapEmailClient() override;
 
+	ImapEmailClient(const ImapEmailClient &) = delete;
+	ImapEmailClient &operator=(const ImapEmailClient &) = delete;
+
+	/**
+	 * @brief Connect, read the greeting and log in.
+	 *
+	 * @throws std::runtime_error if the server cannot be reached or rejects the login.
+	 */
 	void connect() override;
+
+	/**
+	 * @brief Log out and close the connection; does nothing if not connected.
+	 */
 	void disconnect() override;
+
+	/**
+	 * @brief Whether the connection to the server is open.
+	 */
+	bool is_connected() const override;
+
+	/**
+	 * @brief Select the mailbox and fetch the messages that are new since the last committed sync.
+	 *
+	 * @param search_expression IMAP search criteria (e.g. "UNSEEN", `FROM "jobs@example.com"`);
+	 *                          empty or "ALL" fetches every new message without a SEARCH.
+	 * @return New matching messages in UID order (without those dropped by the
+	 *         message filter); EmailMessage::id holds the UID.
+	 *
+	 * @throws std::runtime_error if not connected or a command fails.
+	 */
 	std::vector<EmailMessage> fetch_messages(const std::string &search_expression) override;
 
+	/**
+	 * @brief Save the sync position reached by the last fetch_messages() call.
+	 */
+	void on_messages_imported() override;
+
+	/**
+	 * @brief Wait in IDLE until the server announces a change in the selected mailbox.
+	 *
+	 * IDLE (RFC 2177) lets the server push `* n EXISTS` as soon as a message
+	 * arrives. IDLE is ended when the server reports a new message count,
+	 * when `max_wait` expires or when `should_stop` returns true; servers drop
+	 * sessions idle for 30 minutes, so callers restart IDLE before that.
+	 *
+	 * @param max_wait    Longest time to stay in IDLE.
+	 * @param should_stop Polled a few times per second while waiting; may be empty.
+	 * @return true if the server announced a new message count; false on
+	 *         timeout or stop.
+	 *
+	 * @throws std::runtime_error if no mailbox is selected, the server does
+	 *         not support IDLE, or the connection fails.
+	 */
+	bool idle(std::chrono::milliseconds max_wait, const std::function<bool()> &should_stop);
+
+	/**
+	 * @brief Figures of the last fetch_messages() call.
+	 */
+	const ImapSyncStats &last_sync_stats() const;
+
+	/**
+	 * @brief Key of the synced mailbox in the sync state store ("user@host/mailbox").
+	 */
+	std::string mailbox_key() const;
+
+	/**
+	 * @brief Whether the server announced the capability (e.g. "CONDSTORE").
+	 */
+	bool has_capability(std::string_view capability) const;
+
 private:
+	/// Handles untagged responses received while waiting for a command.
+	using UntaggedHandler = std::function<void(const ImapResponse &)>;
+
 	ConnectionSettings settings_;
-	// Internal IMAP client state / handles will go here.
+
+	/// How new messages are fetched.
+	ImapFetchOptions fetch_;
+
+	/// Optional store of sync positions.
+	IImapSyncStateStore *sync_state_;
+
+	/// Connection to the server.
+	ImapConnection connection_;
+
+	/// Upper-case capabilities announced by the server.
+	std::vector<std::string> capabilities_;
+
+	/// Whether the mailbox was selected on the current connection.
+	bool selected_ = false;
+
+	/// Number of the next command tag.
+	std::uint64_t next_tag_ = 1;
+
+	/// Commands queued by send_command() and not yet written.
+	std::string pending_output_;
+
+	/// Number of commands in pending_output_.
+	std::size_t queued_commands_ = 0;
+
+	/// Number of written commands whose tagged response was not read yet.
+	std::size_t in_flight_commands_ = 0;
+
+	/// Figures of the current or last fetch.
+	ImapSyncStats stats_;
+
+	/// Sync position to save once the fetched messages are imported.
+	std::optional<ImapMailboxState> pending_state_;
+
+	/// Raw response buffer, reused across reads.
+	std::string raw_response_;
+
+	/**
+	 * @brief Queue a command; it is written by the next wait_for().
+	 *
+	 * @return The tag of the command.
+	 */
+	std::string send_command(std::string_view command);
+
+	/**
+	 * @brief Write the queued commands.
+	 */
+	void flush();
+
+	/**
+	 * @brief Note capabilities and session ends in an untagged response, then pass it on.
+	 *
+	 * @throws std::runtime_error if the server ended the session (BYE).
+	 */
+	void dispatch_untagged(const ImapResponse &response, const UntaggedHandler &on_untagged);
+
+	/**
+	 * @brief Read responses until the tagged response of the given command.
+	 *
+	 * @param tag          Tag returned by send_command().
+	 * @param on_untagged  Receives untagged responses read meanwhile.
+	 * @return The tagged response.
+	 *
+	 * @throws std::runtime_error if the command did not complete with OK.
+	 */
+	ImapResponse wait_for(const std::string &tag, const UntaggedHandler &on_untagged);
+
+	/**
+	 * @brief Send commands keeping up to pipeline_depth of them in flight, and wait for all.
+	 *
+	 * @param commands    Commands to send, in order.
+	 * @param on_untagged Receives the untagged responses of all commands.
+	 */
+	void run_pipelined(const std::vector<std::string> &commands, const UntaggedHandler &on_untagged);
+
+	/**
+	 * @brief Fetch the headers and whole text of the messages in the given UID sets.
+	 *
+	 * @param uid_sets  Sequence sets to fetch, one command each.
+	 * @param first_uid Messages with lower UIDs are ignored.
+	 * @param messages  Receives the fetched messages.
+	 * @return The highest UID seen; 0 if none.
+	 */
+	std::uint32_t fetch_full(const std::vector<std::string> &uid_sets, std::uint32_t first_uid, std::vector<EmailMessage> &messages);
+
+	/**
+	 * @brief Fetch envelopes, filter them, then fetch the text part of the matching messages.
+	 *
+	 * @param uid_sets  Sequence sets to fetch, one command each.
+	 * @param first_uid Messages with lower UIDs are ignored.
+	 * @param messages  Receives the messages that pass the filter.
+	 * @return The highest UID seen, filtered or not; 0 if none.
+	 */
+	std::uint32_t fetch_headers_first(const std::vector<std::string> &uid_sets, std::uint32_t first_uid, std::vector<EmailMessage> &messages);
 };
@@ -1,47 +1,356 @@
 #include "import/imap_import_source.h"
 
-#include "util/string_utils.h" // If you want to reuse trimming, etc.
-#include "util/date_time.h"    // For default dates, if needed
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+#include "import/mime_decoder.h"
+#include "util/string_utils.h"
+#include "util/date_time.h"
+
+namespace
+{
+	/// Messages a worker maps before offering the rest of its range to idle workers.
+	constexpr std::size_t mapping_grain = 16;
+
+	/**
+	 * @brief Decoder of the calling thread; its buffers are reused from one message to the next.
+	 */
+	MimeDecoder &thread_mime_decoder()
+	{
+		thread_local MimeDecoder decoder;
+		return decoder;
+	}
+}
+
+/**
+ * @brief Stream that maps fetched messages to applications one batch at a time.
+ */
+class ImapImportSource::MessageStream : public IApplicationStream
+{
+public:
+	MessageStream(const ImapImportSource &source, std::vector<EmailMessage> messages)
+		: source_(source)
+		, messages_(std::move(messages))
+		, today_(datetime::today_iso())
+	{
+	}
+
+	bool next_batch(std::vector<Application> &batch, std::size_t max_count) override
+	{
+		const std::size_t count = std::min(std::max<std::size_t>(max_count, 1), messages_.size() - next_);
+		batch.clear();
+		batch.resize(count);
+
+		// Every index writes only its own slot, so the batch keeps UID order however the work is split.
+		const auto map_one = [&](std::size_t i)
+		{
+			EmailMessage &message = messages_[next_ + i];
+			thread_mime_decoder().decode_body(message);
+			batch[i] = source_.map_email_to_application(message, today_);
+
+			// Mapped messages are not needed any more; release their bodies.
+			messages_[next_ + i] = EmailMessage{};
+		};
+
+		if (source_.pool_ != nullptr && count > mapping_grain)
+		{
+			source_.pool_->parallel_for(count, mapping_grain, map_one);
+		}
+		else
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				map_one(i);
+			}
+		}
+
+		next_ += count;
+		return !batch.empty();
+	}
+
+private:
+	/// Source providing the mapping rules and workers.
+	const ImapImportSource &source_;
+
+	/// Fetched messages, released as they are mapped.
+	std::vector<EmailMessage> messages_;
+
+	/// Index of the next message to map.
+	std::size_t next_ = 0;
+
+	/// Date given to every application of this import.
+	std::string today_;
+};
 
 ImapImportSource::ImapImportSource(std::unique_ptr<IEmailClient> client, Config config)
 	: client_(std::move(client))
 	, config_(std::move(config))
+	, rules_(config_.rules)
 {
+	if (config_.worker_count > 1)
+	{
+		pool_ = std::make_unique<WorkStealingPool>(config_.worker_count);
+	}
 }
 
 std::vector<Application> ImapImportSource::fetch_applications()
 {
-	std::vector<Application> result;
-
-	client_->connect();
-	const auto messages = client_->fetch_messages(config_.search_expression);
-	client_->disconnect();
+	const auto stream = open_stream();
+	return drain_stream(*stream);
+}
 
-	result.reserve(messages.size());
-	for (const auto &message : messages)
+std::unique_ptr<IApplicationStream> ImapImportSource::open_stream()
+{
+	if (!client_->is_connected())
+	{
+		client_->connect();
+	}
+	auto messages = client_->fetch_messages(config_.search_expression);
+	if (!config_.stay_connected)
 	{
-		result.push_back(map_email_to_application(message));
+		client_->disconnect();
 	}
 
-	return result;
+	return std::make_unique<MessageStream>(*this, std::move(messages));
 }
 
-Application ImapImportSource::map_email_to_application(const EmailMessage &message) const
+void ImapImportSource::on_import_committed()
+{
+	client_->on_messages_imported();
+}
+
+Application ImapImportSource::map_email_to_application(const EmailMessage &message, const std::string &today) const
 {
 	Application app;
 
-	// Very naive mapping for now, this can be improved later.
-	app.company = "";   // TODO: derive from subject or body
-	app.position = "";  // TODO: derive from subject or body
+	const EmailExtraction extraction = rules_.extract(message);
+	app.company = extraction.company;
+	app.position = extraction.position;
 	app.location = "";
-	app.source = "email";
-	app.status = "applied";
+	app.source = extraction.source.empty() ? "email" : extraction.source;
+	app.status = extraction.status.empty() ? Application::default_status : extraction.status;
 
 	app.notes = "Imported from email: " + message.subject;
 
-	// Dates: you can convert from message.date, or reuse datetime::today_iso()
-	app.applied_date = datetime::today_iso();
-	app.last_update = datetime::today_iso();
+	app.applied_date = today;
+	app.last_update = today;
 
 	return app;
 }
+
+namespace
+{
+	/**
+	 * @brief Parse a true/false setting.
+	 */
+	bool parse_flag(const std::string &key, const std::string &value)
+	{
+		const std::string lower = string_utils::to_lower(value);
+		if (lower == "true" || lower == "yes" || lower == "1")
+		{
+			return true;
+		}
+		if (lower == "false" || lower == "no" || lower == "0")
+		{
+			return false;
+		}
+		throw std::runtime_error("Invalid value for IMAP setting '" + key + "': " + value);
+	}
+
+	/**
+	 * @brief Parse a non-negative integer setting.
+	 */
+	int parse_number(const std::string &key, const std::string &value)
+	{
+		try
+		{
+			std::size_t used = 0;
+			const int number = std::stoi(value, &used);
+			if (used == value.size() && number >= 0)
+			{
+				return number;
+			}
+		}
+		catch (const std::exception &)
+		{
+		}
+		throw std::runtime_error("Invalid value for IMAP setting '" + key + "': " + value);
+	}
+
+	/**
+	 * @brief Parse a comma-separated list setting, dropping empty entries.
+	 */
+	std::vector<std::string> parse_list(const std::string &value)
+	{
+		std::vector<std::string> entries;
+		for (const auto &entry : string_utils::split(value, ','))
+		{
+			const std::string trimmed = string_utils::trim(entry);
+			if (!trimmed.empty())
+			{
+				entries.push_back(trimmed);
+			}
+		}
+		return entries;
+	}
+}
+
+ImapImportConfig parse_imap_config(std::istream &in)
+{
+	ImapImportConfig config;
+	config.source.mailbox = config.connection.mailbox;
+	config.source.search_expression = "ALL";
+
+	bool port_set = false;
+	bool templates_set = false;
+	bool phrases_set = false;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		const std::string trimmed = string_utils::trim(line);
+		if (trimmed.empty() || trimmed[0] == '#')
+		{
+			continue;
+		}
+
+		const std::size_t equals = trimmed.find('=');
+		if (equals == std::string::npos)
+		{
+			throw std::runtime_error("Malformed IMAP config line: " + trimmed);
+		}
+
+		const std::string key = string_utils::to_lower(string_utils::trim(trimmed.substr(0, equals)));
+		const std::string value = string_utils::trim(trimmed.substr(equals + 1));
+
+		if (key == "host")
+		{
+			config.connection.host = value;
+		}
+		else if (key == "port")
+		{
+			config.connection.port = parse_number(key, value);
+			port_set = true;
+		}
+		else if (key == "tls")
+		{
+			config.connection.use_tls = parse_flag(key, value);
+		}
+		else if (key == "verify_certificate")
+		{
+			config.connection.verify_certificate = parse_flag(key, value);
+		}
+		else if (key == "timeout")
+		{
+			config.connection.timeout_seconds = parse_number(key, value);
+		}
+		else if (key == "username")
+		{
+			config.connection.username = value;
+		}
+		else if (key == "password")
+		{
+			config.connection.password = value;
+		}
+		else if (key == "password_env")
+		{
+			const char *password = std::getenv(value.c_str());
+			if (password == nullptr)
+			{
+				throw std::runtime_error("Environment variable '" + value + "' holding the IMAP password is not set");
+			}
+			config.connection.password = password;
+		}
+		else if (key == "mailbox")
+		{
+			config.connection.mailbox = value;
+			config.source.mailbox = value;
+		}
+		else if (key == "search")
+		{
+			config.source.search_expression = value;
+		}
+		else if (key == "fetch")
+		{
+			if (value == "headers-first")
+			{
+				config.fetch.mode = ImapFetchMode::HeadersFirst;
+			}
+			else if (value == "full")
+			{
+				config.fetch.mode = ImapFetchMode::Full;
+			}
+			else
+			{
+				throw std::runtime_error("Invalid value for IMAP setting 'fetch': " + value);
+			}
+		}
+		else if (key == "sender_domains")
+		{
+			config.fetch.filter.sender_domains = parse_list(value);
+		}
+		else if (key == "subject_keywords")
+		{
+			config.fetch.filter.subject_keywords = parse_list(value);
+		}
+		else if (key == "max_body_bytes")
+		{
+			config.fetch.max_body_bytes = static_cast<std::size_t>(parse_number(key, value));
+		}
+		else if (key == "workers")
+		{
+			config.source.worker_count = static_cast<std::size_t>(std::max(parse_number(key, value), 1));
+		}
+		else if (key == "ats_domains")
+		{
+			// The source is named after the first label: "greenhouse.io" -> "greenhouse".
+			config.source.rules.ats_domains.clear();
+			for (const auto &domain : parse_list(value))
+			{
+				config.source.rules.ats_domains.emplace_back(string_utils::to_lower(domain), string_utils::to_lower(domain.substr(0, domain.find('.'))));
+			}
+		}
+		else if (key == "subject_template")
+		{
+			// The first template given replaces the built-in ones.
+			if (!templates_set)
+			{
+				config.source.rules.subject_templates.clear();
+				templates_set = true;
+			}
+			config.source.rules.subject_templates.push_back(value);
+		}
+		else if (key == "status_phrase")
+		{
+			const std::size_t colon = value.find(':');
+			const std::string status = colon == std::string::npos ? std::string() : string_utils::trim(value.substr(0, colon));
+			const std::string phrase = colon == std::string::npos ? std::string() : string_utils::trim(value.substr(colon + 1));
+			if (status.empty() || phrase.empty())
+			{
+				throw std::runtime_error("Invalid value for IMAP setting 'status_phrase' (expected 'status: phrase'): " + value);
+			}
+			if (!phrases_set)
+			{
+				config.source.rules.status_phrases.clear();
+				phrases_set = true;
+			}
+			config.source.rules.status_phrases.emplace_back(phrase, string_utils::to_lower(status));
+		}
+		else
+		{
+			throw std::runtime_error("Unknown IMAP setting '" + key + "'");
+		}
+	}
+
+	if (config.connection.host.empty())
+	{
+		throw std::runtime_error("IMAP config does not name a host");
+	}
+	if (!port_set && !config.connection.use_tls)
+	{
+		config.connection.port = 143;
+	}
+
+	return config;
+}
@@ -1,18 +1,24 @@
 #pragma once
 
+#include <istream>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "import/import_source.h"
 #include "import/email_client.h"
+#include "import/email_rule_engine.h"
+#include "import/imap_email_client.h"
 #include "core/application.h"
+#include "util/work_stealing_pool.h"
 
 /**
  * @brief Import source that pulls applications from an IMAP mailbox.
  *
  * This class does not know anything about SQLite or JobTracker.
- * It only depends on IEmailClient and translates email messages into Application objects.
+ * It only depends on IEmailClient and translates email messages into Application objects:
+ * bodies are decoded to plain text with a MimeDecoder, then company, position, status
+ * and source are filled in with an EmailRuleEngine.
  */
 class ImapImportSource : public IImportSource
 {
@@ -25,7 +31,14 @@ class ImapImportSource : public IImportSource
 		/// IMAP search query (e.g. "UNSEEN", "FROM ...", etc.).
 		std::string search_expression;
 
-		// Future: mapping rules (e.g. regex to extract company/position from subject)
+		/// Keep the client connected after fetching, so the next import reuses the session.
+		bool stay_connected = false;
+
+		/// Rules extracting company, position, status and source from each message.
+		EmailRuleSet rules = EmailRuleSet::defaults();
+
+		/// Threads mapping fetched messages to applications; 1 maps them on the calling thread.
+		std::size_t worker_count = 1;
 	};
 
 
@@ -33,9 +46,81 @@ class ImapImportSource : public IImportSource
 
 	std::vector<Application> fetch_applications() override;
 
+	/**
+	 * @brief Fetch matching messages and open a stream that maps them lazily.
+	 *
+	 * The client is connected first unless it already is, and disconnected
+	 * afterwards unless Config::stay_connected is set. Messages are mapped to
+	 * applications one batch at a time, after their bodies were decoded, and
+	 * released as soon as they are mapped. With Config::worker_count above 1, the messages of a batch are
+	 * mapped on a work-stealing pool; the batch keeps their UID order.
+	 *
+	 * Every matching message is fetched before the stream is returned, so
+	 * memory grows with the number of new messages until they are mapped.
+	 */
+	std::unique_ptr<IApplicationStream> open_stream() override;
+
+	/**
+	 * @brief Let the email client save its sync position.
+	 */
+	void on_import_committed() override;
+
 private:
+	class MessageStream;
+
 	std::unique_ptr<IEmailClient> client_;
 	Config config_;
 
-	Application map_email_to_application(const EmailMessage &message) const;
+	/// Rules compiled from config_.rules.
+	EmailRuleEngine rules_;
+
+	/// Workers mapping messages; null when mapping on the calling thread.
+	std::unique_ptr<WorkStealingPool> pool_;
+
+	/**
+	 * @brief Turn one message into an application.
+	 *
+	 * Reentrant: only reads the compiled rules, so workers may map different
+	 * messages concurrently.
+	 *
+	 * @param message Message to map.
+	 * @param today   Applied and last-update date (YYYY-MM-DD).
+	 */
+	Application map_email_to_application(const EmailMessage &message, const std::string &today) const;
+};
+
+/**
+ * @brief Everything needed to import from one IMAP mailbox.
+ */
+struct ImapImportConfig
+{
+	/// Server, account and mailbox.
+	ImapEmailClient::ConnectionSettings connection;
+
+	/// Fetch mode and message filter.
+	ImapFetchOptions fetch;
+
+	/// Mailbox and search expression of the import source.
+	ImapImportSource::Config source;
 };
+
+/**
+ * @brief Read an IMAP configuration file.
+ *
+ * Every line holds one `key = value` setting; blank lines and lines starting
+ * with '#' are ignored. Keys: `host`, `port`, `tls` (true/false),
+ * `verify_certificate` (true/false), `timeout` (seconds), `username`,
+ * `password`, `password_env` (name of an environment variable holding the
+ * password), `mailbox`, `search`, `fetch` (`headers-first` or `full`),
+ * `sender_domains` and `subject_keywords` (comma-separated lists),
+ * `max_body_bytes`, `ats_domains` (comma-separated list), and the repeatable
+ * `subject_template` and `status_phrase` (`status: phrase`). Domains,
+ * templates and phrases given replace the built-in ones. `workers` sets the
+ * number of threads mapping messages.
+ *
+ * @param in Stream holding the configuration.
+ * @return The parsed configuration.
+ *
+ * @throws std::runtime_error on an unknown key, a malformed line or a missing host.
+ */
+ImapImportConfig parse_imap_config(std::istream &in);
@@ -0,0 +1,139 @@
+/// \file
+/// \brief Long-running IMAP import driven by IDLE notifications.
+
+#include "import/imap_mailbox_watcher.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace
+{
+	/**
+	 * @brief Source settings that keep the session open between import runs.
+	 */
+	ImapImportSource::Config watch_source_config(ImapImportSource::Config config)
+	{
+		config.stay_connected = true;
+		return config;
+	}
+}
+
+ImapMailboxWatcher::ImapMailboxWatcher(ImapImportConfig config, IImapSyncStateStore &sync_state, IApplicationRepository &repository, ImapWatchOptions options)
+	: client_(new ImapEmailClient(config.connection, &sync_state, config.fetch))
+	, source_(std::unique_ptr<IEmailClient>(client_), watch_source_config(std::move(config.source)))
+	, repository_(repository)
+	, options_(options)
+{
+}
+
+void ImapMailboxWatcher::run(const SyncCallback &on_sync, const ErrorCallback &on_error)
+{
+	std::chrono::milliseconds delay = options_.reconnect_delay;
+	bool connected_before = false;
+
+	while (!stopping_.load())
+	{
+		try
+		{
+			if (!client_->is_connected())
+			{
+				client_->connect();
+				if (connected_before)
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					++stats_.reconnects;
+				}
+				connected_before = true;
+			}
+
+			ImportService service(source_, repository_, options_.import);
+			const ImportResult result = service.run_once();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				++stats_.syncs;
+				stats_.imported += result.imported;
+			}
+			if (on_sync)
+			{
+				on_sync(result, client_->last_sync_stats());
+			}
+
+			delay = options_.reconnect_delay;
+			wait_for_mail();
+		}
+		catch (const std::exception &ex)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				++stats_.failures;
+				stats_.last_error = ex.what();
+			}
+			if (on_error)
+			{
+				on_error(ex.what());
+			}
+
+			client_->disconnect();
+			pause(delay);
+			delay = std::min(delay * 2, options_.max_reconnect_delay);
+		}
+	}
+
+	client_->disconnect();
+}
+
+void ImapMailboxWatcher::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_.store(true);
+	}
+	stopped_.notify_all();
+}
+
+ImapWatchStats ImapMailboxWatcher::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+void ImapMailboxWatcher::pause(std::chrono::milliseconds duration)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	stopped_.wait_for(lock, duration, [this]()
+	{
+		return stopping_.load();
+	});
+}
+
+void ImapMailboxWatcher::wait_for_mail()
+{
+	if (!client_->has_capability("IDLE"))
+	{
+		pause(options_.poll_interval);
+		return;
+	}
+
+	const auto should_stop = [this]()
+	{
+		return stopping_.load();
+	};
+
+	while (!stopping_.load())
+	{
+		const bool changed = client_->idle(options_.idle_refresh, should_stop);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (changed)
+		{
+			++stats_.idle_wakeups;
+			return;
+		}
+		if (!stopping_.load())
+		{
+			++stats_.idle_refreshes;
+		}
+	}
+}
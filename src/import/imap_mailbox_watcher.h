@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "import/imap_email_client.h"
+#include "import/imap_import_source.h"
+#include "import/import_service.h"
+#include "storage/application_repository.h"
+#include "storage/imap_sync_state_store.h"
+
+/**
+ * @brief Tuning options for ImapMailboxWatcher.
+ */
+struct ImapWatchOptions
+{
+	/// Longest single IDLE before it is ended and restarted (servers drop sessions idle for 30 minutes).
+	std::chrono::milliseconds idle_refresh{std::chrono::minutes(25)};
+
+	/// Time between syncs when the server does not support IDLE.
+	std::chrono::milliseconds poll_interval{std::chrono::minutes(1)};
+
+	/// Delay before the first reconnect attempt; doubled after every failed attempt.
+	std::chrono::milliseconds reconnect_delay{std::chrono::seconds(1)};
+
+	/// Upper bound of the reconnect delay.
+	std::chrono::milliseconds max_reconnect_delay{std::chrono::minutes(5)};
+
+	/// Options of every import run; small batches commit a burst of new mail early.
+	ImportOptions import{100};
+};
+
+/**
+ * @brief Counters of an ImapMailboxWatcher run.
+ */
+struct ImapWatchStats
+{
+	/// Number of import runs, including those that found the mailbox unchanged.
+	std::size_t syncs = 0;
+
+	/// Number of applications imported by all runs.
+	std::size_t imported = 0;
+
+	/// Number of IDLE commands ended by the server announcing new messages.
+	std::size_t idle_wakeups = 0;
+
+	/// Number of IDLE commands ended by the refresh timeout.
+	std::size_t idle_refreshes = 0;
+
+	/// Number of successful connects after the first.
+	std::size_t reconnects = 0;
+
+	/// Number of failed connects, syncs or IDLEs.
+	std::size_t failures = 0;
+
+	/// Message of the last failure; empty if none.
+	std::string last_error;
+};
+
+/**
+ * @brief Imports new mail of an IMAP mailbox as it arrives.
+ *
+ * Holds one authenticated session open. After an initial sync the session
+ * waits in IDLE; when the server announces new messages, an ImportService run
+ * through ImapImportSource fetches only the new UIDs (see ImapEmailClient) and
+ * writes them in transactions of ImportOptions::batch_size applications. IDLE
+ * is restarted every ImapWatchOptions::idle_refresh. Servers without IDLE are
+ * polled every ImapWatchOptions::poll_interval instead.
+ *
+ * A failed connect, sync or IDLE closes the session and reconnects after a
+ * delay that doubles on every further failure; the next sync starts from
+ * the last saved sync position, so no message is missed.
+ */
+class ImapMailboxWatcher
+{
+public:
+	/// Called after every import run with its result and wire figures.
+	using SyncCallback = std::function<void(const ImportResult &, const ImapSyncStats &)>;
+
+	/// Called after every failure with its message.
+	using ErrorCallback = std::function<void(const std::string &)>;
+
+	/**
+	 * @brief Construct a watcher; nothing is sent before run().
+	 *
+	 * @param config     Server, account, mailbox and fetch settings.
+	 * @param sync_state Store of sync positions; must outlive the watcher.
+	 * @param repository Repository receiving the applications; must outlive the watcher.
+	 * @param options    Refresh, reconnect and import options.
+	 */
+	ImapMailboxWatcher(ImapImportConfig config, IImapSyncStateStore &sync_state, IApplicationRepository &repository, ImapWatchOptions options = {});
+
+	ImapMailboxWatcher(const ImapMailboxWatcher &) = delete;
+	ImapMailboxWatcher &operator=(const ImapMailboxWatcher &) = delete;
+
+	/**
+	 * @brief Sync and wait for new mail until stop() is called; then log out.
+	 *
+	 * Failures are reported to `on_error` and retried; run() itself does not throw
+	 * on connection or server errors.
+	 *
+	 * @param on_sync  Receives the result of every import run; may be empty.
+	 * @param on_error Receives every failure; may be empty.
+	 */
+	void run(const SyncCallback &on_sync = {}, const ErrorCallback &on_error = {});
+
+	/**
+	 * @brief Make run() return soon; safe to call from any thread.
+	 */
+	void stop();
+
+	/**
+	 * @brief Counters so far; safe to call from any thread.
+	 */
+	ImapWatchStats stats() const;
+
+private:
+	/// Client owned by source_.
+	ImapEmailClient *client_;
+
+	/// Source fetching new messages over the session kept open by client_.
+	ImapImportSource source_;
+
+	/// Repository receiving the applications.
+	IApplicationRepository &repository_;
+
+	/// Refresh, reconnect and import options.
+	ImapWatchOptions options_;
+
+	/// Set by stop().
+	std::atomic<bool> stopping_{false};
+
+	/// Guards stats_ and wakes delays on stop().
+	mutable std::mutex mutex_;
+
+	/// Signalled by stop().
+	std::condition_variable stopped_;
+
+	/// Counters so far.
+	ImapWatchStats stats_;
+
+	/**
+	 * @brief Sleep for the given time or until stop() is called.
+	 */
+	void pause(std::chrono::milliseconds duration);
+
+	/**
+	 * @brief Wait until the mailbox may hold new messages, or until stop() is called.
+	 */
+	void wait_for_mail();
+};
@@ -0,0 +1,475 @@
+/// \file
+/// \brief Parsing and formatting helpers for the IMAP4rev1 wire protocol.
+
+#include "import/imap_protocol.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace
+{
+	/**
+	 * @brief Compare ASCII strings case-insensitively.
+	 */
+	bool equals_ignore_case(std::string_view a, std::string_view b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (std::toupper(static_cast<unsigned char>(a[i])) != std::toupper(static_cast<unsigned char>(b[i])))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Lower-case text of an atom or string; empty for NIL and lists.
+	 */
+	std::string lower_text(const ImapValue &value)
+	{
+		std::string lower = value.text;
+		for (auto &c : lower)
+		{
+			c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		}
+		return lower;
+	}
+
+	/**
+	 * @brief Value of a parameter in a BODYSTRUCTURE parameter list ("CHARSET" "utf-8" ...).
+	 */
+	std::string parameter(const ImapValue &parameters, std::string_view name)
+	{
+		for (std::size_t i = 0; i + 1 < parameters.items.size(); i += 2)
+		{
+			if (equals_ignore_case(parameters.items[i].text, name))
+			{
+				return lower_text(parameters.items[i + 1]);
+			}
+		}
+		return {};
+	}
+
+	/**
+	 * @brief Depth-first search for text parts.
+	 *
+	 * @param part    BODYSTRUCTURE of the part.
+	 * @param section Section of the part ("" for the whole message).
+	 * @param plain   Receives the first text/plain part.
+	 * @param html    Receives the first text/html part.
+	 */
+	void find_text_parts(const ImapValue &part, const std::string &section, ImapTextPart &plain, ImapTextPart &html)
+	{
+		if (part.kind != ImapValue::Kind::List || part.items.empty())
+		{
+			return;
+		}
+
+		// Multipart: child parts first, then the subtype.
+		if (part.items[0].kind == ImapValue::Kind::List)
+		{
+			std::size_t child = 0;
+			for (const auto &item : part.items)
+			{
+				if (item.kind != ImapValue::Kind::List)
+				{
+					break;
+				}
+				++child;
+				const std::string child_section = section.empty() ? std::to_string(child) : section + "." + std::to_string(child);
+				find_text_parts(item, child_section, plain, html);
+			}
+			return;
+		}
+
+		// Single part: type, subtype, parameters, id, description, encoding, size, ...
+		if (part.items.size() < 7 || !equals_ignore_case(part.items[0].text, "TEXT"))
+		{
+			return;
+		}
+
+		// Extension data of a text part: md5, disposition, language, location.
+		if (part.items.size() > 9 && part.items[9].kind == ImapValue::Kind::List && !part.items[9].items.empty() &&
+			equals_ignore_case(part.items[9].items[0].text, "ATTACHMENT"))
+		{
+			return;
+		}
+
+		ImapTextPart text;
+		// A non-multipart message has its body in part 1.
+		text.section = section.empty() ? "1" : section;
+		text.subtype = lower_text(part.items[1]);
+		text.charset = parameter(part.items[2], "CHARSET");
+		text.encoding = lower_text(part.items[5]);
+		text.size = part.items[6].kind == ImapValue::Kind::Atom ? part.items[6].number() : 0;
+
+		if (text.subtype == "plain" && plain.section.empty())
+		{
+			plain = std::move(text);
+		}
+		else if (text.subtype == "html" && html.section.empty())
+		{
+			html = std::move(text);
+		}
+	}
+
+	/**
+	 * @brief Recursive-descent parser over one raw response.
+	 */
+	class ResponseParser
+	{
+	public:
+		explicit ResponseParser(std::string_view input)
+			: input_(input)
+		{
+		}
+
+		ImapResponse parse()
+		{
+			ImapResponse response;
+			response.tag = read_word();
+			skip_spaces();
+
+			if (response.tag == "+")
+			{
+				response.text = std::string(rest_of_line());
+				return response;
+			}
+
+			const std::size_t word_start = pos_;
+			std::string word = read_word();
+			for (auto &c : word)
+			{
+				c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+			}
+
+			if (word == "OK" || word == "NO" || word == "BAD" || word == "BYE" || word == "PREAUTH")
+			{
+				response.status = word;
+				skip_spaces();
+				if (peek() == '[')
+				{
+					++pos_;
+					parse_values(response.code, ']');
+					expect(']');
+					skip_spaces();
+				}
+				response.text = std::string(rest_of_line());
+				return response;
+			}
+
+			pos_ = word_start;
+			parse_values(response.values, '\0');
+			return response;
+		}
+
+	private:
+		std::string_view input_;
+		std::size_t pos_ = 0;
+
+		char peek() const
+		{
+			return pos_ < input_.size() ? input_[pos_] : '\0';
+		}
+
+		bool at_line_end() const
+		{
+			return pos_ >= input_.size() || input_[pos_] == '\r' || input_[pos_] == '\n';
+		}
+
+		void skip_spaces()
+		{
+			while (peek() == ' ')
+			{
+				++pos_;
+			}
+		}
+
+		void expect(char c)
+		{
+			if (peek() != c)
+			{
+				throw std::runtime_error(std::string("Malformed IMAP response: expected '") + c + "'");
+			}
+			++pos_;
+		}
+
+		std::string read_word()
+		{
+			const std::size_t start = pos_;
+			while (!at_line_end() && input_[pos_] != ' ')
+			{
+				++pos_;
+			}
+			return std::string(input_.substr(start, pos_ - start));
+		}
+
+		std::string_view rest_of_line()
+		{
+			const std::size_t start = pos_;
+			while (!at_line_end())
+			{
+				++pos_;
+			}
+			return input_.substr(start, pos_ - start);
+		}
+
+		/**
+		 * @brief Parse values until the closing character (or the end of the response for '\0').
+		 */
+		void parse_values(std::vector<ImapValue> &values, char closing)
+		{
+			while (true)
+			{
+				skip_spaces();
+				if (at_line_end() || (closing != '\0' && peek() == closing))
+				{
+					return;
+				}
+				values.push_back(parse_value(closing));
+			}
+		}
+
+		ImapValue parse_value(char closing)
+		{
+			ImapValue value;
+			const char c = peek();
+
+			if (c == '(')
+			{
+				++pos_;
+				value.kind = ImapValue::Kind::List;
+				parse_values(value.items, ')');
+				expect(')');
+			}
+			else if (c == '"')
+			{
+				value.kind = ImapValue::Kind::String;
+				parse_quoted(value.text);
+			}
+			else if (c == '{' || (c == '~' && pos_ + 1 < input_.size() && input_[pos_ + 1] == '{'))
+			{
+				value.kind = ImapValue::Kind::String;
+				parse_literal(value.text);
+			}
+			else
+			{
+				value.text = parse_atom(closing);
+				if (equals_ignore_case(value.text, "NIL"))
+				{
+					value.kind = ImapValue::Kind::Nil;
+					value.text.clear();
+				}
+			}
+
+			return value;
+		}
+
+		void parse_quoted(std::string &out)
+		{
+			++pos_;
+			while (true)
+			{
+				if (at_line_end())
+				{
+					throw std::runtime_error("Malformed IMAP response: unterminated quoted string");
+				}
+				char c = input_[pos_++];
+				if (c == '"')
+				{
+					return;
+				}
+				if (c == '\\' && pos_ < input_.size())
+				{
+					c = input_[pos_++];
+				}
+				out.push_back(c);
+			}
+		}
+
+		void parse_literal(std::string &out)
+		{
+			if (peek() == '~')
+			{
+				++pos_;
+			}
+			++pos_;
+
+			const std::size_t digits_start = pos_;
+			while (std::isdigit(static_cast<unsigned char>(peek())))
+			{
+				++pos_;
+			}
+
+			std::size_t length = 0;
+			const auto [end, error] = std::from_chars(input_.data() + digits_start, input_.data() + pos_, length);
+			if (error != std::errc() || end == input_.data() + digits_start)
+			{
+				throw std::runtime_error("Malformed IMAP response: bad literal length");
+			}
+
+			expect('}');
+			expect('\r');
+			expect('\n');
+
+			if (input_.size() - pos_ < length)
+			{
+				throw std::runtime_error("Malformed IMAP response: truncated literal");
+			}
+			out.assign(input_.substr(pos_, length));
+			pos_ += length;
+		}
+
+		std::string parse_atom(char closing)
+		{
+			const std::size_t start = pos_;
+			int depth = 0;
+
+			while (!at_line_end())
+			{
+				const char c = input_[pos_];
+				if (depth == 0 && (c == ' ' || c == '(' || c == ')' || (c == ']' && closing == ']')))
+				{
+					break;
+				}
+
+				// Section specifiers may contain spaces and lists: BODY[HEADER.FIELDS (FROM)].
+				if (c == '[')
+				{
+					++depth;
+				}
+				else if (c == ']' && depth > 0)
+				{
+					--depth;
+				}
+				++pos_;
+			}
+
+			if (pos_ == start)
+			{
+				throw std::runtime_error("Malformed IMAP response: unexpected character");
+			}
+			return std::string(input_.substr(start, pos_ - start));
+		}
+	};
+}
+
+bool ImapValue::is_atom(std::string_view name) const
+{
+	return kind == Kind::Atom && equals_ignore_case(text, name);
+}
+
+std::uint64_t ImapValue::number() const
+{
+	std::uint64_t value = 0;
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (kind != Kind::Atom || text.empty() || error != std::errc() || end != text.data() + text.size())
+	{
+		throw std::runtime_error("Malformed IMAP response: expected a number, got '" + text + "'");
+	}
+	return value;
+}
+
+ImapResponse parse_imap_response(std::string_view raw)
+{
+	return ResponseParser(raw).parse();
+}
+
+std::string imap_quote(std::string_view value)
+{
+	std::string quoted;
+	quoted.reserve(value.size() + 2);
+	quoted.push_back('"');
+	for (const char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			quoted.push_back('\\');
+		}
+		quoted.push_back(c);
+	}
+	quoted.push_back('"');
+	return quoted;
+}
+
+std::vector<std::string> imap_uid_sets(const std::vector<std::uint32_t> &uids, std::size_t max_per_set)
+{
+	std::vector<std::string> sets;
+	const std::size_t limit = max_per_set > 0 ? max_per_set : 1;
+
+	std::size_t i = 0;
+	while (i < uids.size())
+	{
+		std::string set;
+		const std::size_t set_end = std::min(uids.size(), i + limit);
+
+		while (i < set_end)
+		{
+			// Extend the run of consecutive UIDs starting at i.
+			std::size_t run_end = i;
+			while (run_end + 1 < set_end && uids[run_end + 1] == uids[run_end] + 1)
+			{
+				++run_end;
+			}
+
+			if (!set.empty())
+			{
+				set.push_back(',');
+			}
+			set += std::to_string(uids[i]);
+			if (run_end > i)
+			{
+				set += ':' + std::to_string(uids[run_end]);
+			}
+			i = run_end + 1;
+		}
+
+		sets.push_back(std::move(set));
+	}
+
+	return sets;
+}
+
+std::string imap_format_addresses(const ImapValue &addresses)
+{
+	std::string formatted;
+	for (const auto &address : addresses.items)
+	{
+		// (name adl mailbox host); group markers have a NIL host.
+		if (address.items.size() < 4 || address.items[3].kind == ImapValue::Kind::Nil)
+		{
+			continue;
+		}
+
+		if (!formatted.empty())
+		{
+			formatted += ", ";
+		}
+
+		const std::string email = address.items[2].text + "@" + address.items[3].text;
+		if (!address.items[0].text.empty())
+		{
+			formatted += address.items[0].text + " <" + email + ">";
+		}
+		else
+		{
+			formatted += email;
+		}
+	}
+	return formatted;
+}
+
+ImapTextPart imap_find_text_part(const ImapValue &body_structure)
+{
+	ImapTextPart plain;
+	ImapTextPart html;
+	find_text_parts(body_structure, "", plain, html);
+	return !plain.section.empty() ? plain : html;
+}
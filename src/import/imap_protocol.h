@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief One value of an IMAP response: an atom, a string, NIL or a list.
+ *
+ * Atoms keep bracketed section specifiers intact, so a FETCH item name such
+ * as `BODY[HEADER.FIELDS (SUBJECT)]` is a single atom.
+ */
+struct ImapValue
+{
+	/**
+	 * @brief Kind of value.
+	 */
+	enum class Kind
+	{
+		/// Atom or number (e.g. `FETCH`, `\Seen`, `42`).
+		Atom,
+
+		/// Quoted string or literal.
+		String,
+
+		/// The NIL atom.
+		Nil,
+
+		/// Parenthesized list.
+		List
+	};
+
+	/// Kind of value.
+	Kind kind = Kind::Atom;
+
+	/// Text of an atom or (unescaped) string; empty for NIL and lists.
+	std::string text;
+
+	/// Elements of a list.
+	std::vector<ImapValue> items;
+
+	/**
+	 * @brief Whether this is the given atom, compared case-insensitively.
+	 */
+	bool is_atom(std::string_view name) const;
+
+	/**
+	 * @brief Numeric value of an atom.
+	 *
+	 * @throws std::runtime_error if the value is not a number.
+	 */
+	std::uint64_t number() const;
+};
+
+/**
+ * @brief A parsed server response.
+ *
+ * Status responses (`OK`, `NO`, `BAD`, `BYE`, `PREAUTH`) carry an optional
+ * response code and free text; other responses (e.g. `* 12 FETCH (...)`,
+ * `* CAPABILITY ...`) are parsed into values.
+ */
+struct ImapResponse
+{
+	/// `*` for untagged responses, `+` for continuations, otherwise the command tag.
+	std::string tag;
+
+	/// Upper-case status of a status response; empty for other responses.
+	std::string status;
+
+	/// Response code of a status response (e.g. {`UIDNEXT`, `4392`}); empty if none.
+	std::vector<ImapValue> code;
+
+	/// Human-readable text of a status response or continuation.
+	std::string text;
+
+	/// Values of a non-status response.
+	std::vector<ImapValue> values;
+};
+
+/**
+ * @brief Parse one complete server response.
+ *
+ * @param raw Response line including CRLF, with any literals inlined as sent
+ *            by the server (`{n}\r\n` followed by n bytes).
+ * @return The parsed response.
+ *
+ * @throws std::runtime_error on malformed input.
+ */
+ImapResponse parse_imap_response(std::string_view raw);
+
+/**
+ * @brief Quote a string for use as an IMAP command argument.
+ */
+std::string imap_quote(std::string_view value);
+
+/**
+ * @brief Compress sorted UIDs into IMAP sequence sets (e.g. `1:4,7,9:12`).
+ *
+ * @param uids         UIDs in ascending order.
+ * @param max_per_set  Maximum number of UIDs covered by one set.
+ * @return One or more sequence sets covering all UIDs, in order.
+ */
+std::vector<std::string> imap_uid_sets(const std::vector<std::uint32_t> &uids, std::size_t max_per_set);
+
+/**
+ * @brief Format an ENVELOPE address list as "Name <mailbox@host>, ...".
+ *
+ * @param addresses Address list of an ENVELOPE (or NIL).
+ * @return The formatted addresses; empty for NIL.
+ */
+std::string imap_format_addresses(const ImapValue &addresses);
+
+/**
+ * @brief Where the readable text of a message is, according to its BODYSTRUCTURE.
+ */
+struct ImapTextPart
+{
+	/// Part specifier for BODY[...] (e.g. "1", "1.2").
+	std::string section;
+
+	/// Lower-case MIME subtype ("plain" or "html").
+	std::string subtype;
+
+	/// Lower-case charset parameter; empty if absent.
+	std::string charset;
+
+	/// Lower-case Content-Transfer-Encoding (e.g. "7bit", "base64").
+	std::string encoding;
+
+	/// Size of the encoded part in bytes.
+	std::uint64_t size = 0;
+};
+
+/**
+ * @brief Find the text part to read in a BODYSTRUCTURE.
+ *
+ * The first text/plain part wins; otherwise the first text/html part.
+ * Attachments (parts with a Content-Disposition of "attachment") and
+ * embedded messages are skipped.
+ *
+ * @param body_structure BODYSTRUCTURE value of a FETCH response.
+ * @return The text part; an empty section if the message has none.
+ */
+ImapTextPart imap_find_text_part(const ImapValue &body_structure);
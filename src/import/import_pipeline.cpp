@@ -0,0 +1,365 @@
+/// \file
+/// \brief Multi-threaded reader/normalizer/writer import pipeline.
+
+#include "import/import_pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "core/job_tracker.h"
+#include "util/date_time.h"
+#include "util/spsc_queue.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	/**
+	 * @brief Applications travelling between stages, with the stream position after them.
+	 */
+	struct Batch
+	{
+		/// Applications of the batch, in source order.
+		std::vector<Application> applications;
+
+		/// IApplicationStream::resume_offset() right after the batch was read.
+		std::uint64_t resume_offset = 0;
+
+		/// Fingerprints of the templates, in batch order; empty without a KnownRecordFilter.
+		std::vector<std::uint64_t> fingerprints;
+	};
+
+	/**
+	 * @brief Seconds elapsed since `start`.
+	 */
+	double seconds_since(Clock::time_point start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	/**
+	 * @brief Occupancy samples taken by the producer of a queue.
+	 */
+	struct OccupancySampler
+	{
+		std::size_t samples = 0;
+		std::size_t total = 0;
+		std::size_t max = 0;
+
+		void sample(std::size_t occupancy)
+		{
+			++samples;
+			total += occupancy;
+			max = std::max(max, occupancy);
+		}
+
+		ImportQueueStats to_stats(std::size_t capacity) const
+		{
+			ImportQueueStats stats{};
+			stats.capacity = capacity;
+			stats.max_occupancy = max;
+			stats.average_occupancy = samples > 0 ? static_cast<double>(total) / static_cast<double>(samples) : 0.0;
+			return stats;
+		}
+	};
+
+	/**
+	 * @brief Push a batch, waiting while the queue is full.
+	 *
+	 * @return false if the pipeline failed while waiting.
+	 */
+	bool push_batch(
+		BoundedSpscQueue<Batch> &queue,
+		Batch &&batch,
+		const std::atomic<bool> &failed,
+		ImportStageStats &stats,
+		OccupancySampler &sampler)
+	{
+		const auto wait_start = Clock::now();
+		unsigned int attempt = 0;
+
+		while (!queue.try_push(std::move(batch)))
+		{
+			if (failed.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			spsc_back_off(attempt);
+		}
+
+		stats.wait_seconds += seconds_since(wait_start);
+		sampler.sample(queue.size());
+		return true;
+	}
+
+	/**
+	 * @brief Pop a batch, waiting while the queue is empty and the producer is still running.
+	 *
+	 * @return false once the producer finished and the queue is drained, or the pipeline failed.
+	 */
+	bool pop_batch(
+		BoundedSpscQueue<Batch> &queue,
+		Batch &batch,
+		const std::atomic<bool> &producer_done,
+		const std::atomic<bool> &failed,
+		ImportStageStats &stats)
+	{
+		const auto wait_start = Clock::now();
+		unsigned int attempt = 0;
+
+		while (!queue.try_pop(batch))
+		{
+			if (failed.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			if (producer_done.load(std::memory_order_acquire))
+			{
+				// The producer may have pushed its last batch right before finishing.
+				const bool popped = queue.try_pop(batch);
+				stats.wait_seconds += seconds_since(wait_start);
+				return popped;
+			}
+			spsc_back_off(attempt);
+		}
+
+		stats.wait_seconds += seconds_since(wait_start);
+		return true;
+	}
+}
+
+ImportPipeline::ImportPipeline(
+	IApplicationStream &stream,
+	IApplicationRepository &repository,
+	const ImportOptions &options,
+	ImportCheckpoint *checkpoint,
+	KnownRecordFilter *known)
+	: stream_(stream)
+	, repository_(repository)
+	, options_(options)
+	, checkpoint_(checkpoint)
+	, known_(known)
+{
+}
+
+ImportResult ImportPipeline::run()
+{
+	ImportResult result{};
+
+	BoundedSpscQueue<Batch> decoded(options_.queue_capacity);
+	BoundedSpscQueue<Batch> normalized(options_.queue_capacity);
+
+	// Written batches go back to the reader for reuse. Room for every batch in
+	// flight, so the writer never has to wait for it.
+	BoundedSpscQueue<Batch> recycled(2 * options_.queue_capacity + 4);
+
+	std::atomic<bool> reader_done{false};
+	std::atomic<bool> normalizer_done{false};
+	std::atomic<bool> failed{false};
+
+	// Each error slot is written by one thread only and read after join().
+	std::exception_ptr reader_error;
+	std::exception_ptr normalizer_error;
+	std::exception_ptr writer_error;
+
+	OccupancySampler decoded_sampler;
+	OccupancySampler normalized_sampler;
+
+	std::thread reader([&]()
+	{
+		try
+		{
+			while (!failed.load(std::memory_order_acquire))
+			{
+				const auto work_start = Clock::now();
+				Batch batch;
+				recycled.try_pop(batch);
+				const bool has_batch = stream_.next_batch(batch.applications, options_.batch_size);
+				batch.resume_offset = stream_.resume_offset();
+				result.pipeline.reader.busy_seconds += seconds_since(work_start);
+
+				if (!has_batch)
+				{
+					break;
+				}
+
+				result.pipeline.reader.items += batch.applications.size();
+				++result.pipeline.reader.batches;
+
+				if (!push_batch(decoded, std::move(batch), failed, result.pipeline.reader, decoded_sampler))
+				{
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			reader_error = std::current_exception();
+			failed.store(true, std::memory_order_release);
+		}
+		reader_done.store(true, std::memory_order_release);
+	});
+
+	std::thread normalizer([&]()
+	{
+		try
+		{
+			const std::string today = datetime::today_iso();
+			Batch batch;
+
+			while (pop_batch(decoded, batch, reader_done, failed, result.pipeline.normalizer))
+			{
+				const auto work_start = Clock::now();
+				if (known_ != nullptr)
+				{
+					record_fingerprints(batch.applications, batch.fingerprints);
+				}
+				for (auto &app : batch.applications)
+				{
+					JobTracker::apply_defaults(app, today);
+				}
+				result.pipeline.normalizer.busy_seconds += seconds_since(work_start);
+
+				result.pipeline.normalizer.items += batch.applications.size();
+				++result.pipeline.normalizer.batches;
+
+				if (!push_batch(normalized, std::move(batch), failed, result.pipeline.normalizer, normalized_sampler))
+				{
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			normalizer_error = std::current_exception();
+			failed.store(true, std::memory_order_release);
+		}
+		normalizer_done.store(true, std::memory_order_release);
+	});
+
+	// The writer runs on the calling thread: the repository is not shared.
+	try
+	{
+		Batch batch;
+		while (pop_batch(normalized, batch, normalizer_done, failed, result.pipeline.writer))
+		{
+			const auto work_start = Clock::now();
+			result.total += batch.applications.size();
+			if (checkpoint_ != nullptr)
+			{
+				checkpoint_->offset = batch.resume_offset;
+			}
+			if (known_ != nullptr)
+			{
+				result.skipped += known_->drop_known(batch.applications, batch.fingerprints);
+			}
+			write_batch(repository_, batch.applications, result, checkpoint_, known_ != nullptr ? &batch.fingerprints : nullptr);
+			result.pipeline.writer.busy_seconds += seconds_since(work_start);
+
+			result.pipeline.writer.items += batch.applications.size();
+			++result.pipeline.writer.batches;
+
+			// Dropped if the reader has enough spare batches already.
+			recycled.try_push(std::move(batch));
+		}
+	}
+	catch (...)
+	{
+		writer_error = std::current_exception();
+		failed.store(true, std::memory_order_release);
+	}
+
+	reader.join();
+	normalizer.join();
+
+	result.pipeline.decoded_queue = decoded_sampler.to_stats(decoded.capacity());
+	result.pipeline.normalized_queue = normalized_sampler.to_stats(normalized.capacity());
+
+	for (const auto &error : {reader_error, normalizer_error, writer_error})
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	return result;
+}
+
+void ImportPipeline::write_batch(
+	IApplicationRepository &repository,
+	std::vector<Application> &batch,
+	ImportResult &result,
+	ImportCheckpoint *checkpoint,
+	const std::vector<std::uint64_t> *fingerprints)
+{
+	// A batch emptied by a KnownRecordFilter has nothing to commit.
+	if (batch.empty() && checkpoint == nullptr)
+	{
+		return;
+	}
+
+	repository.begin_transaction();
+
+	std::size_t inserted = 0;
+	std::vector<std::uint64_t> inserted_fingerprints;
+	std::vector<int> inserted_ids;
+	for (std::size_t i = 0; i < batch.size(); ++i)
+	{
+		try
+		{
+			// Hand the strings to storage and take them back: their capacity is
+			// reused by the stream for the next batch (see ApplicationBatchFiller).
+			batch[i] = repository.insert(std::move(batch[i]));
+			++inserted;
+			if (fingerprints != nullptr)
+			{
+				inserted_fingerprints.push_back((*fingerprints)[i]);
+				inserted_ids.push_back(batch[i].id);
+			}
+		}
+		catch (...)
+		{
+			++result.failed;
+		}
+	}
+
+	try
+	{
+		if (fingerprints != nullptr)
+		{
+			repository.save_fingerprints(inserted_fingerprints, inserted_ids);
+		}
+
+		if (checkpoint != nullptr)
+		{
+			ImportCheckpoint next = *checkpoint;
+			next.rows_committed += inserted;
+			repository.save_checkpoint(next);
+			repository.commit_transaction();
+			*checkpoint = next;
+		}
+		else
+		{
+			repository.commit_transaction();
+		}
+		result.imported += inserted;
+	}
+	catch (...)
+	{
+		// Best effort: the connection may already have rolled back on its own.
+		try
+		{
+			repository.rollback_transaction();
+		}
+		catch (...)
+		{
+		}
+		throw;
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/application.h"
+#include "import/import_service.h"
+#include "import/import_source.h"
+#include "import/known_record_filter.h"
+#include "storage/application_repository.h"
+
+/**
+ * @brief Three-stage import pipeline with overlapping reader, normalizer and writer.
+ *
+ * - Reader thread: pulls decoded batches from the source stream.
+ * - Normalizer thread: applies JobTracker defaults to every application.
+ * - Writer (calling thread): inserts each batch in one repository transaction.
+ *
+ * Stages are connected by bounded lock-free single-producer/single-consumer
+ * queues. A stage that finds its output queue full waits, which throttles
+ * upstream stages to the pace of the slowest one (backpressure). The first
+ * exception thrown by any stage stops the others and is rethrown from run().
+ *
+ * Every batch carries the stream's resume offset from the moment it was read,
+ * so the writer can commit a matching checkpoint with it. With a
+ * KnownRecordFilter, the normalizer also fingerprints every template and the
+ * writer drops known records before inserting.
+ *
+ * Written batches travel back to the reader through a fourth queue, so the
+ * stream decodes into their strings again (see ApplicationBatchFiller) and
+ * steady-state batches allocate nothing per row.
+ */
+class ImportPipeline
+{
+public:
+	/**
+	 * @brief Construct a pipeline over an already opened stream.
+	 *
+	 * @param stream     Stream providing decoded application templates.
+	 * @param repository Repository receiving the applications. Only used from
+	 *                   the thread calling run().
+	 * @param options    Batch size and queue capacity.
+	 * @param checkpoint Checkpoint advanced and saved with every batch; may be
+	 *                   null for sources that cannot resume.
+	 * @param known      Filter dropping known records, used by the writer; may be null.
+	 */
+	ImportPipeline(
+		IApplicationStream &stream,
+		IApplicationRepository &repository,
+		const ImportOptions &options,
+		ImportCheckpoint *checkpoint = nullptr,
+		KnownRecordFilter *known = nullptr);
+
+	/**
+	 * @brief Run all stages until the stream is exhausted.
+	 *
+	 * @return Aggregated counts plus per-stage statistics.
+	 *
+	 * @throws Any exception raised by a stage (the first one wins).
+	 */
+	ImportResult run();
+
+	/**
+	 * @brief Insert a normalized batch inside a single transaction.
+	 *
+	 * Rows that fail to insert are counted as failed; the rest of the batch is
+	 * still committed. If the commit itself fails the transaction is rolled
+	 * back and the error is rethrown.
+	 *
+	 * @param repository Repository receiving the applications.
+	 * @param batch      Normalized applications. Their strings are moved into the
+	 *                   repository and taken back from the returned entities, so
+	 *                   the batch can be refilled without allocating.
+	 * @param result     Counters updated with imported/failed rows.
+	 * @param checkpoint Optional checkpoint whose offset already points past the
+	 *                   batch. Its row count is advanced and it is saved in the
+	 *                   same transaction as the rows.
+	 * @param fingerprints Optional fingerprints of the batch, in batch order. Those
+	 *                   of the inserted rows are saved in the same transaction.
+	 *
+	 * An empty batch without a checkpoint opens no transaction.
+	 */
+	static void write_batch(
+		IApplicationRepository &repository,
+		std::vector<Application> &batch,
+		ImportResult &result,
+		ImportCheckpoint *checkpoint = nullptr,
+		const std::vector<std::uint64_t> *fingerprints = nullptr);
+
+private:
+	/// Stream providing decoded application templates.
+	IApplicationStream &stream_;
+
+	/// Repository receiving the applications.
+	IApplicationRepository &repository_;
+
+	/// Batch size and queue capacity.
+	ImportOptions options_;
+
+	/// Checkpoint saved with every batch; null if the source cannot resume.
+	ImportCheckpoint *checkpoint_;
+
+	/// Filter dropping known records; null to write every record.
+	KnownRecordFilter *known_;
+};
@@ -1,33 +1,101 @@
 #include "import/import_service.h"
 
-ImportService::ImportService(IImportSource &source, IApplicationRepository &repository)
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "import/import_pipeline.h"
+#include "util/date_time.h"
+
+ImportService::ImportService(IImportSource &source, IApplicationRepository &repository, ImportOptions options)
 	: source_(source)
 	, repository_(repository)
+	, options_(options)
 {
 }
 
 ImportResult ImportService::run_once()
 {
+	std::optional<ImportCheckpoint> checkpoint = source_.checkpoint_identity();
+
+	if (checkpoint && options_.resume)
+	{
+		const auto saved = repository_.find_checkpoint(checkpoint->source);
+		if (saved)
+		{
+			if (!saved->same_source(*checkpoint))
+			{
+				throw std::runtime_error("Import source changed since its checkpoint: " + checkpoint->source);
+			}
+			checkpoint = saved;
+		}
+	}
+
+	ImportCheckpoint *const progress = checkpoint ? &*checkpoint : nullptr;
+	const std::uint64_t start_offset = progress != nullptr ? progress->offset : 0;
+	const std::uint64_t start_rows = progress != nullptr ? progress->rows_committed : 0;
+
+	std::optional<KnownRecordFilter> known;
+	if (options_.skip_known)
+	{
+		known.emplace(repository_);
+	}
+	KnownRecordFilter *const filter = known ? &*known : nullptr;
+
+	const auto stream = source_.open_stream_at(start_offset);
+
 	ImportResult result{};
 
-	const auto templates = source_.fetch_applications();
-	result.total = templates.size();
+	if (options_.pipelined)
+	{
+		ImportPipeline pipeline(*stream, repository_, options_, progress, filter);
+		result = pipeline.run();
+	}
+	else
+	{
+		run_sequential(*stream, progress, filter, result);
+	}
 
-	for (const auto &tmpl : templates)
+	if (filter != nullptr)
 	{
-		try
+		result.known_records = filter->stats();
+	}
+	result.resumed_offset = start_offset;
+	result.resumed_rows = start_rows;
+
+	source_.on_import_committed();
+	return result;
+}
+
+void ImportService::run_sequential(IApplicationStream &stream, ImportCheckpoint *checkpoint, KnownRecordFilter *known, ImportResult &result)
+{
+	const std::string today = datetime::today_iso();
+
+	std::vector<Application> batch;
+	batch.reserve(options_.batch_size);
+	std::vector<std::uint64_t> fingerprints;
+
+	while (stream.next_batch(batch, options_.batch_size))
+	{
+		result.total += batch.size();
+
+		if (known != nullptr)
 		{
-			Application app = tmpl;
-			app.id = 0;
+			record_fingerprints(batch, fingerprints);
+			result.skipped += known->drop_known(batch, fingerprints);
+		}
 
-			repository_.insert(app);
-			++result.imported;
+		for (auto &tmpl : batch)
+		{
+			JobTracker::apply_defaults(tmpl, today);
 		}
-		catch (...)
+
+		if (checkpoint != nullptr)
 		{
-			++result.failed;
+			checkpoint->offset = stream.resume_offset();
 		}
-	}
 
-	return result;
+		ImportPipeline::write_batch(repository_, batch, result, checkpoint, known != nullptr ? &fingerprints : nullptr);
+	}
 }
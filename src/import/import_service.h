@@ -1,12 +1,77 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include "core/application.h"
+#include "core/job_tracker.h"
 #include "core/statistics.h"
 #include "import/import_source.h"
+#include "import/known_record_filter.h"
 #include "storage/application_repository.h"
 
+/**
+ * @brief Throughput counters of one import pipeline stage.
+ */
+struct ImportStageStats
+{
+	/// Number of applications processed by the stage.
+	std::size_t items = 0;
+
+	/// Number of batches processed by the stage.
+	std::size_t batches = 0;
+
+	/// Time spent doing work, excluding waits on neighbouring stages.
+	double busy_seconds = 0.0;
+
+	/// Time spent waiting for input or for room in the output queue.
+	double wait_seconds = 0.0;
+
+	/**
+	 * @brief Applications processed per second of busy time.
+	 */
+	double items_per_second() const
+	{
+		return busy_seconds > 0.0 ? static_cast<double>(items) / busy_seconds : 0.0;
+	}
+};
+
+/**
+ * @brief Occupancy of a queue between two pipeline stages.
+ */
+struct ImportQueueStats
+{
+	/// Maximum number of batches the queue can hold.
+	std::size_t capacity = 0;
+
+	/// Highest number of queued batches observed.
+	std::size_t max_occupancy = 0;
+
+	/// Average number of queued batches, sampled after every push.
+	double average_occupancy = 0.0;
+};
+
+/**
+ * @brief Per-stage statistics of a pipelined import run.
+ */
+struct ImportPipelineStats
+{
+	/// Reads and decodes batches from the source stream.
+	ImportStageStats reader;
+
+	/// Applies JobTracker defaults to every application.
+	ImportStageStats normalizer;
+
+	/// Writes batches to the repository, one transaction per batch.
+	ImportStageStats writer;
+
+	/// Queue between reader and normalizer.
+	ImportQueueStats decoded_queue;
+
+	/// Queue between normalizer and writer.
+	ImportQueueStats normalized_queue;
+};
+
 /**
  * @brief Result of a single import run.
  */
@@ -20,11 +85,63 @@ struct ImportResult
 
 	/// Number of applications that could not be imported.
 	std::size_t failed = 0;
+
+	/// Number of applications dropped as imported before (see ImportOptions::skip_known).
+	std::size_t skipped = 0;
+
+	/// Counters of the known-record filter; only filled in with ImportOptions::skip_known.
+	KnownRecordStats known_records;
+
+	/// Stage statistics; only filled in for pipelined runs.
+	ImportPipelineStats pipeline;
+
+	/// Byte offset the run resumed from (0 when it started at the beginning).
+	std::uint64_t resumed_offset = 0;
+
+	/// Rows committed by earlier, interrupted runs of a resumed import.
+	std::uint64_t resumed_rows = 0;
+};
+
+/**
+ * @brief Tuning options for ImportService.
+ */
+struct ImportOptions
+{
+	/// Maximum number of applications pulled from the source per batch.
+	std::size_t batch_size = 1000;
+
+	/// Run reading, normalizing and writing on separate, overlapping threads.
+	bool pipelined = false;
+
+	/// Maximum number of batches buffered between two pipeline stages.
+	std::size_t queue_capacity = 4;
+
+	/// Continue from the last committed checkpoint of the source, if any.
+	bool resume = false;
+
+	/// Drop records whose fingerprint an earlier run with this option stored, and
+	/// store the fingerprints of the records written (see KnownRecordFilter).
+	bool skip_known = false;
 };
 
 /**
  * @brief High-level service that imports applications from a source
  *        into the application repository.
+ *
+ * Imported templates get the same defaults (status, dates) as applications
+ * added from the CLI (see JobTracker::apply_defaults). The source is consumed
+ * as a stream, one batch at a time, so memory use is bounded by the batch size
+ * rather than by the size of the input. Each batch is written in a single
+ * repository transaction.
+ *
+ * Sources that provide a checkpoint identity (see
+ * IImportSource::checkpoint_identity) get a checkpoint saved in the
+ * transaction of every batch. With ImportOptions::resume set, the import
+ * continues from the last committed checkpoint instead of starting over.
+ *
+ * With ImportOptions::skip_known set, every template is fingerprinted before
+ * the defaults are applied, and records an earlier import already wrote are
+ * dropped before they reach the repository.
  */
 class ImportService
 {
@@ -34,17 +151,37 @@ class ImportService
 	 *
 	 * @param source      Import source providing application templates.
 	 * @param repository  Repository used to persist imported applications.
+	 * @param options     Tuning options such as the batch size.
 	 */
-	ImportService(IImportSource &source, IApplicationRepository &repository);
+	ImportService(IImportSource &source, IApplicationRepository &repository, ImportOptions options = {});
 
 	/**
 	 * @brief Fetch applications from the source and persist them once.
 	 *
+	 * With ImportOptions::pipelined set, the work is split across an
+	 * ImportPipeline; otherwise batches are read and written in turn.
+	 *
 	 * @return ImportResult structure with aggregated counts.
+	 *
+	 * @throws std::runtime_error if the source or a transaction fails, or if
+	 *         a resumed source changed since its checkpoint was written.
 	 */
 	ImportResult run_once();
 
 private:
+	/**
+	 * @brief Read, normalize and write batches in turn on the calling thread.
+	 *
+	 * @param stream     Stream positioned at the first row to import.
+	 * @param checkpoint Checkpoint advanced and saved with every batch; may be null.
+	 * @param known      Filter dropping known records; may be null.
+	 * @param result     Counters updated with every batch.
+	 */
+	void run_sequential(IApplicationStream &stream, ImportCheckpoint *checkpoint, KnownRecordFilter *known, ImportResult &result);
+
 	IImportSource &source_;
 	IApplicationRepository &repository_;
+
+	/// Tuning options such as the batch size.
+	ImportOptions options_;
 };
@@ -0,0 +1,132 @@
+/// \file
+/// \brief Default streaming helpers for IImportSource implementations.
+
+#include "import/import_source.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	/// Batch size used when draining a stream into a single vector.
+	constexpr std::size_t drain_batch_size = 4096;
+}
+
+VectorApplicationStream::VectorApplicationStream(std::vector<Application> applications)
+	: applications_(std::move(applications))
+{
+}
+
+bool VectorApplicationStream::next_batch(std::vector<Application> &batch, std::size_t max_count)
+{
+	batch.clear();
+
+	const std::size_t remaining = applications_.size() - next_;
+	const std::size_t count = std::min(remaining, std::max<std::size_t>(max_count, 1));
+
+	const auto first = applications_.begin() + static_cast<std::ptrdiff_t>(next_);
+	batch.insert(
+		batch.end(),
+		std::make_move_iterator(first),
+		std::make_move_iterator(first + static_cast<std::ptrdiff_t>(count)));
+	next_ += count;
+
+	return !batch.empty();
+}
+
+ApplicationBatchFiller::ApplicationBatchFiller(std::vector<Application> &batch)
+	: batch_(batch)
+{
+}
+
+ApplicationBatchFiller::~ApplicationBatchFiller()
+{
+	// Spare slots only exist when this batch is shorter than the last one.
+	batch_.erase(batch_.begin() + static_cast<std::ptrdiff_t>(count_), batch_.end());
+}
+
+Application &ApplicationBatchFiller::slot()
+{
+	if (count_ == batch_.size())
+	{
+		batch_.emplace_back();
+	}
+
+	Application &app = batch_[count_];
+	app.id = 0;
+	return app;
+}
+
+void ApplicationBatchFiller::commit()
+{
+	++count_;
+}
+
+std::size_t ApplicationBatchFiller::size() const
+{
+	return count_;
+}
+
+std::unique_ptr<IApplicationStream> IImportSource::open_stream()
+{
+	return std::make_unique<VectorApplicationStream>(fetch_applications());
+}
+
+std::optional<ImportCheckpoint> IImportSource::checkpoint_identity()
+{
+	return std::nullopt;
+}
+
+std::unique_ptr<IApplicationStream> IImportSource::open_stream_at(std::uint64_t offset)
+{
+	if (offset != 0)
+	{
+		throw std::runtime_error("Import source cannot resume from an offset");
+	}
+	return open_stream();
+}
+
+std::vector<Application> drain_stream(IApplicationStream &stream)
+{
+	std::vector<Application> result;
+	std::vector<Application> batch;
+
+	while (stream.next_batch(batch, drain_batch_size))
+	{
+		result.insert(result.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+	}
+
+	return result;
+}
+
+std::optional<ImportCheckpoint> file_checkpoint_identity(const std::string &path)
+{
+	std::error_code error;
+
+	const auto canonical = std::filesystem::weakly_canonical(path, error);
+	if (error)
+	{
+		return std::nullopt;
+	}
+
+	const auto size = std::filesystem::file_size(canonical, error);
+	if (error)
+	{
+		return std::nullopt;
+	}
+
+	const auto mtime = std::filesystem::last_write_time(canonical, error);
+	if (error)
+	{
+		return std::nullopt;
+	}
+
+	ImportCheckpoint identity;
+	identity.source = canonical.string();
+	identity.source_size = size;
+	identity.source_mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+	return identity;
+}
@@ -1,8 +1,126 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "core/application.h"
+#include "core/import_checkpoint.h"
+
+/**
+ * @brief Pull-based stream of applications produced by an import source.
+ *
+ * Streams let the caller process a source batch by batch, so that memory use
+ * is bounded by the batch size rather than by the size of the input.
+ */
+class IApplicationStream
+{
+public:
+	virtual ~IApplicationStream() = default;
+
+	/**
+	 * @brief Read the next batch of applications.
+	 *
+	 * @param batch     Output vector; replaced by up to max_count applications.
+	 *                  Streams may decode into the applications it already holds
+	 *                  (see ApplicationBatchFiller), so callers pass the previous
+	 *                  batch back in rather than a fresh vector.
+	 * @param max_count Maximum number of applications to read (at least 1 is used).
+	 * @return true if at least one application was read; false once the stream is exhausted.
+	 */
+	virtual bool next_batch(std::vector<Application> &batch, std::size_t max_count) = 0;
+
+	/**
+	 * @brief Position to resume from once the batches read so far are committed.
+	 *
+	 * For byte-oriented sources this is the offset just past the last record
+	 * consumed by next_batch(). Streams that cannot resume return 0.
+	 */
+	virtual std::uint64_t resume_offset() const
+	{
+		return 0;
+	}
+};
+
+/**
+ * @brief Stream over applications that are already held in memory.
+ *
+ * Used as the default stream for sources that can only produce all of their
+ * applications at once.
+ */
+class VectorApplicationStream : public IApplicationStream
+{
+public:
+	/**
+	 * @brief Construct a stream that hands out the given applications in order.
+	 *
+	 * @param applications Applications to stream.
+	 */
+	explicit VectorApplicationStream(std::vector<Application> applications);
+
+	bool next_batch(std::vector<Application> &batch, std::size_t max_count) override;
+
+private:
+	/// Applications to hand out.
+	std::vector<Application> applications_;
+
+	/// Index of the next application to hand out.
+	std::size_t next_ = 0;
+};
+
+/**
+ * @brief Fills a batch by decoding into the applications it already holds.
+ *
+ * A batch handed back to IApplicationStream::next_batch() still owns the
+ * strings of the previous batch (ImportPipeline::write_batch() returns them
+ * from the repository). Decoding into those strings reuses their capacity,
+ * so once the first batches have grown them, import rows stop allocating.
+ * The batch is the arena and it is recycled once per batch.
+ *
+ * Usage: decode into slot(), call commit() if the record was accepted. On
+ * destruction the batch is trimmed to the committed applications.
+ */
+class ApplicationBatchFiller
+{
+public:
+	/**
+	 * @brief Start filling `batch`; its current applications become scratch storage.
+	 */
+	explicit ApplicationBatchFiller(std::vector<Application> &batch);
+
+	~ApplicationBatchFiller();
+
+	ApplicationBatchFiller(const ApplicationBatchFiller &) = delete;
+	ApplicationBatchFiller &operator=(const ApplicationBatchFiller &) = delete;
+
+	/**
+	 * @brief Application to decode the next record into.
+	 *
+	 * Its id is reset; its strings hold stale values with spare capacity and
+	 * must all be assigned by the decoder.
+	 */
+	Application &slot();
+
+	/**
+	 * @brief Keep the application decoded into slot() as part of the batch.
+	 */
+	void commit();
+
+	/**
+	 * @brief Number of committed applications.
+	 */
+	std::size_t size() const;
+
+private:
+	/// Batch being filled.
+	std::vector<Application> &batch_;
+
+	/// Number of committed applications at the front of batch_.
+	std::size_t count_ = 0;
+};
 
 /**
  * @brief Abstract interface for sources that can provide job applications.
@@ -21,4 +139,68 @@ class IImportSource
 	 * @return A vector of Application objects read from the source.
 	 */
 	virtual std::vector<Application> fetch_applications() = 0;
+
+	/**
+	 * @brief Open a stream that reads applications from the source in batches.
+	 *
+	 * The default implementation fetches everything up front and wraps it in a
+	 * VectorApplicationStream. Sources that can decode incrementally override
+	 * this to keep memory bounded.
+	 *
+	 * @return A stream positioned at the first application.
+	 */
+	virtual std::unique_ptr<IApplicationStream> open_stream();
+
+	/**
+	 * @brief Describe the source for import checkpoints.
+	 *
+	 * Sources that can resume an interrupted import return a checkpoint with
+	 * the identity fields (source, size, modification time) filled in and a
+	 * zero offset. The default returns std::nullopt: the source cannot resume.
+	 *
+	 * @return Identity of the source, or std::nullopt if resuming is unsupported.
+	 */
+	virtual std::optional<ImportCheckpoint> checkpoint_identity();
+
+	/**
+	 * @brief Open a stream that starts at a position returned by IApplicationStream::resume_offset().
+	 *
+	 * Resuming only reads the remainder of the source. The default
+	 * implementation supports offset 0 only.
+	 *
+	 * @param offset Position to start reading from.
+	 * @return A stream positioned at the given offset.
+	 *
+	 * @throws std::runtime_error if the source cannot resume at the offset.
+	 */
+	virtual std::unique_ptr<IApplicationStream> open_stream_at(std::uint64_t offset);
+
+	/**
+	 * @brief Notification that every batch of the last opened stream was committed.
+	 *
+	 * Sources that remember what they already delivered (e.g. HTTP validators)
+	 * persist that state here, so an import that fails halfway is fetched
+	 * again in full next time. The default does nothing.
+	 */
+	virtual void on_import_committed()
+	{
+	}
 };
+
+/**
+ * @brief Read a stream to the end and collect all applications.
+ *
+ * @param stream Stream to drain.
+ * @return All remaining applications of the stream, in order.
+ */
+std::vector<Application> drain_stream(IApplicationStream &stream);
+
+/**
+ * @brief Checkpoint identity of a local file: canonical path, size and modification time.
+ *
+ * Shared by the file-based sources to implement IImportSource::checkpoint_identity().
+ *
+ * @param path Path to the file.
+ * @return Identity with a zero offset; std::nullopt if the file cannot be inspected.
+ */
+std::optional<ImportCheckpoint> file_checkpoint_identity(const std::string &path);
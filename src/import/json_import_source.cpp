@@ -0,0 +1,353 @@
+/// \file
+/// \brief NDJSON/JSON-based implementation of IImportSource.
+
+#include "import/json_import_source.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "import/json_sax_parser.h"
+#include "util/mapped_file.h"
+#include "util/string_utils.h"
+
+namespace
+{
+	/**
+	 * @brief An Application field and the JsonFieldMapping path locating it.
+	 */
+	struct MappedField
+	{
+		/// Field name accepted by JsonFieldMapping::parse().
+		std::string_view name;
+
+		/// Path of the field within a record.
+		std::string JsonFieldMapping::*path;
+
+		/// Member receiving the value.
+		std::string Application::*member;
+	};
+
+	/// Every mappable field.
+	const std::array<MappedField, 8> mapped_fields = {{
+		{"company", &JsonFieldMapping::company, &Application::company},
+		{"position", &JsonFieldMapping::position, &Application::position},
+		{"location", &JsonFieldMapping::location, &Application::location},
+		{"source", &JsonFieldMapping::source, &Application::source},
+		{"status", &JsonFieldMapping::status, &Application::status},
+		{"applied_date", &JsonFieldMapping::applied_date, &Application::applied_date},
+		{"last_update", &JsonFieldMapping::last_update, &Application::last_update},
+		{"notes", &JsonFieldMapping::notes, &Application::notes},
+	}};
+
+	/// Node index of values outside the mapping.
+	constexpr std::size_t no_node = static_cast<std::size_t>(-1);
+
+	/**
+	 * @brief Maps the events of one JSON record onto an Application.
+	 *
+	 * The mapping paths are compiled into a tree of keys once. While a record
+	 * is parsed, the decoder tracks the tree node of every open object, so a
+	 * key is only compared against the few children of one node, and values
+	 * outside the mapping are passed over without any lookup.
+	 */
+	class JsonRecordDecoder : public JsonSaxHandler
+	{
+	public:
+		explicit JsonRecordDecoder(const JsonFieldMapping &mapping)
+			: nodes_(1)
+		{
+			for (const auto &field : mapped_fields)
+			{
+				const std::string &path = mapping.*field.path;
+				if (path.empty())
+				{
+					continue;
+				}
+
+				std::size_t node = 0;
+				std::string_view rest = path;
+				while (true)
+				{
+					const std::size_t dot = rest.find('.');
+					node = add_child(node, rest.substr(0, dot));
+					if (dot == std::string_view::npos)
+					{
+						break;
+					}
+					rest.remove_prefix(dot + 1);
+				}
+				nodes_[node].member = field.member;
+			}
+
+			open_.reserve(JsonSaxParser::max_depth + 1);
+		}
+
+		/**
+		 * @brief Decode the next record into `app`, clearing its fields first.
+		 */
+		void begin(Application &app)
+		{
+			app_ = &app;
+			app.id = 0;
+			for (const auto &field : mapped_fields)
+			{
+				(app.*field.member).clear();
+			}
+			open_.clear();
+			pending_ = no_node;
+			object_record_ = false;
+		}
+
+		/**
+		 * @brief Whether the record decoded since begin() is an application.
+		 */
+		bool accepted() const
+		{
+			return object_record_ && (!app_->company.empty() || !app_->position.empty());
+		}
+
+		void start_object() override
+		{
+			if (open_.empty())
+			{
+				object_record_ = true;
+				open_.push_back(0);
+			}
+			else
+			{
+				open_.push_back(pending_);
+			}
+			pending_ = no_node;
+		}
+
+		void key(std::string_view name) override
+		{
+			const std::size_t parent = open_.back();
+			pending_ = parent == no_node ? no_node : find_child(parent, name);
+		}
+
+		void end_object() override
+		{
+			open_.pop_back();
+			pending_ = no_node;
+		}
+
+		void start_array() override
+		{
+			// Array elements have no keys, so nothing inside an array is mapped.
+			open_.push_back(no_node);
+			pending_ = no_node;
+		}
+
+		void end_array() override
+		{
+			open_.pop_back();
+			pending_ = no_node;
+		}
+
+		void scalar(JsonScalarType type, std::string_view text) override
+		{
+			if (pending_ != no_node && nodes_[pending_].member != nullptr)
+			{
+				std::string &target = app_->*nodes_[pending_].member;
+				if (type == JsonScalarType::Null)
+				{
+					target.clear();
+				}
+				else
+				{
+					target.assign(string_utils::trim_view(text));
+				}
+			}
+			pending_ = no_node;
+		}
+
+	private:
+		/**
+		 * @brief One key of the mapping tree; node 0 is the record itself.
+		 */
+		struct Node
+		{
+			/// Key leading to this node from its parent.
+			std::string key;
+
+			/// Indexes of the child nodes.
+			std::vector<std::size_t> children;
+
+			/// Member receiving a scalar found at this node; null if none.
+			std::string Application::*member = nullptr;
+		};
+
+		/// Mapping tree.
+		std::vector<Node> nodes_;
+
+		/// Node of every open object or array of the record; no_node outside the mapping.
+		std::vector<std::size_t> open_;
+
+		/// Node of the value following the last key; no_node if it is not mapped.
+		std::size_t pending_ = no_node;
+
+		/// Application receiving the record.
+		Application *app_ = nullptr;
+
+		/// Whether the record is an object.
+		bool object_record_ = false;
+
+		/**
+		 * @brief Child of `parent` with the given key, or no_node.
+		 */
+		std::size_t find_child(std::size_t parent, std::string_view key) const
+		{
+			for (const std::size_t child : nodes_[parent].children)
+			{
+				if (nodes_[child].key == key)
+				{
+					return child;
+				}
+			}
+			return no_node;
+		}
+
+		/**
+		 * @brief Child of `parent` with the given key, added if missing.
+		 */
+		std::size_t add_child(std::size_t parent, std::string_view key)
+		{
+			const std::size_t existing = find_child(parent, key);
+			if (existing != no_node)
+			{
+				return existing;
+			}
+
+			Node node;
+			node.key = std::string(key);
+			nodes_.push_back(std::move(node));
+			nodes_[parent].children.push_back(nodes_.size() - 1);
+			return nodes_.size() - 1;
+		}
+	};
+
+	/**
+	 * @brief Stream that decodes a memory-mapped NDJSON or JSON file record by record.
+	 */
+	class JsonFileStream : public IApplicationStream
+	{
+	public:
+		JsonFileStream(const std::string &path, const JsonFieldMapping &mapping, std::size_t start_offset)
+			: file_(path)
+			, parser_(file_.view())
+			, decoder_(mapping)
+		{
+			parser_.seek(start_offset);
+		}
+
+		bool next_batch(std::vector<Application> &batch, std::size_t max_count) override
+		{
+			const std::size_t limit = std::max<std::size_t>(max_count, 1);
+			ApplicationBatchFiller filler(batch);
+
+			while (filler.size() < limit)
+			{
+				decoder_.begin(filler.slot());
+				if (!parser_.next_record(decoder_))
+				{
+					break;
+				}
+				if (decoder_.accepted())
+				{
+					filler.commit();
+				}
+			}
+
+			// Consumed pages are not needed any more; keep the resident set bounded.
+			file_.discard_before(parser_.offset());
+
+			return filler.size() > 0;
+		}
+
+		std::uint64_t resume_offset() const override
+		{
+			return parser_.offset();
+		}
+
+	private:
+		/// Mapped JSON file.
+		MappedFile file_;
+
+		/// Parser over the mapped file.
+		JsonSaxParser parser_;
+
+		/// Maps parsed records onto applications.
+		JsonRecordDecoder decoder_;
+	};
+}
+
+JsonFieldMapping JsonFieldMapping::parse(std::string_view spec)
+{
+	JsonFieldMapping mapping;
+
+	while (!spec.empty())
+	{
+		const std::size_t comma = spec.find(',');
+		const std::string_view entry = string_utils::trim_view(spec.substr(0, comma));
+		spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+
+		if (entry.empty())
+		{
+			continue;
+		}
+
+		const std::size_t equals = entry.find('=');
+		if (equals == std::string_view::npos)
+		{
+			throw std::runtime_error("Invalid JSON field mapping entry '" + std::string(entry) + "': expected field=path");
+		}
+
+		const std::string_view name = string_utils::trim_view(entry.substr(0, equals));
+		const auto field = std::find_if(
+			mapped_fields.begin(),
+			mapped_fields.end(),
+			[name](const MappedField &candidate)
+			{
+				return candidate.name == name;
+			});
+		if (field == mapped_fields.end())
+		{
+			throw std::runtime_error("Unknown field '" + std::string(name) + "' in JSON field mapping");
+		}
+
+		mapping.*field->path = std::string(string_utils::trim_view(entry.substr(equals + 1)));
+	}
+
+	return mapping;
+}
+
+JsonImportSource::JsonImportSource(const std::string &path, JsonFieldMapping mapping)
+	: path_(path)
+	, mapping_(std::move(mapping))
+{
+}
+
+std::vector<Application> JsonImportSource::fetch_applications()
+{
+	const auto stream = open_stream();
+	return drain_stream(*stream);
+}
+
+std::unique_ptr<IApplicationStream> JsonImportSource::open_stream()
+{
+	return open_stream_at(0);
+}
+
+std::optional<ImportCheckpoint> JsonImportSource::checkpoint_identity()
+{
+	return file_checkpoint_identity(path_);
+}
+
+std::unique_ptr<IApplicationStream> JsonImportSource::open_stream_at(std::uint64_t offset)
+{
+	return std::make_unique<JsonFileStream>(path_, mapping_, static_cast<std::size_t>(offset));
+}
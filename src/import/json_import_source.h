@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/application.h"
+#include "import/import_source.h"
+
+/**
+ * @brief Where the fields of an Application are found in a JSON record.
+ *
+ * Every field holds a dot-separated path of object keys, so nested values
+ * can be mapped ("employer.name"). Keys are matched exactly. An empty path
+ * leaves the field unmapped. By default every field is read from the
+ * top-level key of the same name.
+ */
+struct JsonFieldMapping
+{
+	/// Path of Application::company.
+	std::string company = "company";
+
+	/// Path of Application::position.
+	std::string position = "position";
+
+	/// Path of Application::location.
+	std::string location = "location";
+
+	/// Path of Application::source.
+	std::string source = "source";
+
+	/// Path of Application::status.
+	std::string status = "status";
+
+	/// Path of Application::applied_date.
+	std::string applied_date = "applied_date";
+
+	/// Path of Application::last_update.
+	std::string last_update = "last_update";
+
+	/// Path of Application::notes.
+	std::string notes = "notes";
+
+	/**
+	 * @brief Override fields of the default mapping from a specification string.
+	 *
+	 * The specification is a comma-separated list of `field=path` entries,
+	 * e.g. "company=employer.name,position=title,notes=". Fields not listed
+	 * keep their default path.
+	 *
+	 * @param spec Mapping specification.
+	 * @return The default mapping with the listed fields replaced.
+	 *
+	 * @throws std::runtime_error if an entry lacks '=' or names an unknown field.
+	 */
+	static JsonFieldMapping parse(std::string_view spec);
+};
+
+/**
+ * @brief Import source that reads job applications from an NDJSON or JSON file.
+ *
+ * The file holds either one JSON object per line (NDJSON) or a single
+ * top-level array of objects. It is memory-mapped and parsed record by
+ * record with a JsonSaxParser, without building a document tree; consumed
+ * pages are released as the stream advances, so memory use does not grow
+ * with the file size. Fields are picked out of every record according to a
+ * JsonFieldMapping while it is parsed.
+ *
+ * Strings are trimmed; numbers and booleans are taken as written, null as
+ * empty. Values of a mapped path that are objects or arrays are ignored.
+ * Like CSV rows, records without a company or a position are skipped, as
+ * are records that are not objects. Malformed JSON stops the import with
+ * an error.
+ */
+class JsonImportSource : public IImportSource
+{
+public:
+	/**
+	 * @brief Construct a JsonImportSource for the given file path.
+	 *
+	 * @param path    Path to the NDJSON or JSON file.
+	 * @param mapping Paths of the Application fields within a record.
+	 */
+	explicit JsonImportSource(const std::string &path, JsonFieldMapping mapping = {});
+
+	/**
+	 * @brief Read the whole file and convert each record into an Application.
+	 *
+	 * @return A vector of Application objects parsed from the file.
+	 */
+	std::vector<Application> fetch_applications() override;
+
+	/**
+	 * @brief Open a stream that decodes the file batch by batch.
+	 *
+	 * @return A stream over the records of the file.
+	 *
+	 * @throws std::runtime_error if the file cannot be opened.
+	 */
+	std::unique_ptr<IApplicationStream> open_stream() override;
+
+	/**
+	 * @brief Identify the file by canonical path, size and modification time.
+	 *
+	 * @return Checkpoint identity; std::nullopt if the file cannot be inspected.
+	 */
+	std::optional<ImportCheckpoint> checkpoint_identity() override;
+
+	/**
+	 * @brief Open a stream that continues after the record ending at the offset.
+	 *
+	 * @param offset Record boundary returned by IApplicationStream::resume_offset().
+	 * @return A stream over the remaining records.
+	 *
+	 * @throws std::runtime_error if the file cannot be opened.
+	 */
+	std::unique_ptr<IApplicationStream> open_stream_at(std::uint64_t offset) override;
+
+private:
+	/// Path to the NDJSON or JSON file.
+	std::string path_;
+
+	/// Paths of the Application fields within a record.
+	JsonFieldMapping mapping_;
+};
@@ -0,0 +1,543 @@
+/// \file
+/// \brief Streaming SAX-style parser for NDJSON and top-level JSON arrays.
+
+#include "import/json_sax_parser.h"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JOBTRACKER_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/// UTF-8 byte order mark some exporters put in front of the text.
+	constexpr std::string_view utf8_bom = "\xEF\xBB\xBF";
+
+	/// Code point substituted for unpaired UTF-16 surrogates.
+	constexpr unsigned int replacement_character = 0xFFFD;
+
+	/**
+	 * @brief Find the first quote or backslash at or after `from`.
+	 *
+	 * @return Offset of the first special byte, or `size` if there is none.
+	 */
+	std::size_t find_string_special(const char *data, std::size_t from, std::size_t size)
+	{
+		std::size_t i = from;
+
+		#if defined(JOBTRACKER_JSON_SSE2)
+		const __m128i quote_16 = _mm_set1_epi8('"');
+		const __m128i backslash_16 = _mm_set1_epi8('\\');
+
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote_16), _mm_cmpeq_epi8(chunk, backslash_16));
+
+			const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+			if (mask != 0)
+			{
+				return i + static_cast<std::size_t>(std::countr_zero(mask));
+			}
+		}
+		#endif
+
+		for (; i < size; ++i)
+		{
+			if (data[i] == '"' || data[i] == '\\')
+			{
+				return i;
+			}
+		}
+
+		return size;
+	}
+
+	/**
+	 * @brief Value of four hex digits at `at`, or -1 if they are not four hex digits.
+	 */
+	long read_hex4(std::string_view input, std::size_t at)
+	{
+		if (at + 4 > input.size())
+		{
+			return -1;
+		}
+
+		long value = 0;
+		for (std::size_t i = at; i < at + 4; ++i)
+		{
+			const char c = input[i];
+			int digit = 0;
+			if (c >= '0' && c <= '9')
+			{
+				digit = c - '0';
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				digit = c - 'a' + 10;
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				digit = c - 'A' + 10;
+			}
+			else
+			{
+				return -1;
+			}
+			value = value * 16 + digit;
+		}
+		return value;
+	}
+
+	/**
+	 * @brief Append a code point to `out` as UTF-8.
+	 */
+	void append_utf8(std::string &out, unsigned int code_point)
+	{
+		if (code_point < 0x80)
+		{
+			out.push_back(static_cast<char>(code_point));
+		}
+		else if (code_point < 0x800)
+		{
+			out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+			out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+		else if (code_point < 0x10000)
+		{
+			out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+			out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+		else
+		{
+			out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+			out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+	}
+
+	/**
+	 * @brief Whether `c` is an ASCII digit.
+	 */
+	bool is_digit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+}
+
+JsonSaxParser::JsonSaxParser(std::string_view input)
+	: input_(input)
+{
+	if (input_.substr(0, utf8_bom.size()) == utf8_bom)
+	{
+		pos_ = utf8_bom.size();
+	}
+
+	skip_whitespace();
+	if (pos_ < input_.size() && input_[pos_] == '[')
+	{
+		array_ = true;
+		++pos_;
+	}
+	record_end_ = pos_;
+}
+
+bool JsonSaxParser::next_record(JsonSaxHandler &handler)
+{
+	if (finished_)
+	{
+		return false;
+	}
+
+	skip_whitespace();
+
+	if (!array_)
+	{
+		if (pos_ >= input_.size())
+		{
+			finished_ = true;
+			return false;
+		}
+	}
+	else
+	{
+		if (pos_ >= input_.size())
+		{
+			fail(after_element_ ? "',' or ']'" : "value or ']'");
+		}
+
+		if (input_[pos_] == ']')
+		{
+			++pos_;
+			skip_whitespace();
+			if (pos_ < input_.size())
+			{
+				fail("end of input after the top-level array");
+			}
+			finished_ = true;
+			return false;
+		}
+
+		if (after_element_)
+		{
+			if (input_[pos_] != ',')
+			{
+				fail("',' or ']'");
+			}
+			++pos_;
+			skip_whitespace();
+		}
+	}
+
+	parse_value(handler, 0);
+	record_end_ = pos_;
+	after_element_ = array_;
+	return true;
+}
+
+std::size_t JsonSaxParser::offset() const
+{
+	return record_end_;
+}
+
+void JsonSaxParser::seek(std::size_t offset)
+{
+	if (offset > record_end_ && offset <= input_.size())
+	{
+		pos_ = offset;
+		record_end_ = offset;
+		after_element_ = array_;
+	}
+}
+
+bool JsonSaxParser::top_level_array() const
+{
+	return array_;
+}
+
+void JsonSaxParser::skip_whitespace()
+{
+	while (pos_ < input_.size())
+	{
+		const char c = input_[pos_];
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+		{
+			return;
+		}
+		++pos_;
+	}
+}
+
+void JsonSaxParser::parse_value(JsonSaxHandler &handler, std::size_t depth)
+{
+	if (pos_ >= input_.size())
+	{
+		fail("value");
+	}
+
+	switch (input_[pos_])
+	{
+		case '{':
+			parse_object(handler, depth);
+			return;
+
+		case '[':
+			parse_array(handler, depth);
+			return;
+
+		case '"':
+			handler.scalar(JsonScalarType::String, parse_string());
+			return;
+
+		case 't':
+			expect_literal("true");
+			handler.scalar(JsonScalarType::True, "true");
+			return;
+
+		case 'f':
+			expect_literal("false");
+			handler.scalar(JsonScalarType::False, "false");
+			return;
+
+		case 'n':
+			expect_literal("null");
+			handler.scalar(JsonScalarType::Null, "null");
+			return;
+
+		default:
+			handler.scalar(JsonScalarType::Number, parse_number());
+			return;
+	}
+}
+
+void JsonSaxParser::parse_object(JsonSaxHandler &handler, std::size_t depth)
+{
+	if (depth >= max_depth)
+	{
+		fail("at most 128 levels of nesting");
+	}
+
+	++pos_;
+	handler.start_object();
+	skip_whitespace();
+
+	if (pos_ < input_.size() && input_[pos_] == '}')
+	{
+		++pos_;
+		handler.end_object();
+		return;
+	}
+
+	while (true)
+	{
+		if (pos_ >= input_.size() || input_[pos_] != '"')
+		{
+			fail("string key");
+		}
+		handler.key(parse_string());
+
+		skip_whitespace();
+		if (pos_ >= input_.size() || input_[pos_] != ':')
+		{
+			fail("':'");
+		}
+		++pos_;
+		skip_whitespace();
+
+		parse_value(handler, depth + 1);
+
+		skip_whitespace();
+		if (pos_ < input_.size() && input_[pos_] == ',')
+		{
+			++pos_;
+			skip_whitespace();
+			continue;
+		}
+		if (pos_ < input_.size() && input_[pos_] == '}')
+		{
+			++pos_;
+			handler.end_object();
+			return;
+		}
+		fail("',' or '}'");
+	}
+}
+
+void JsonSaxParser::parse_array(JsonSaxHandler &handler, std::size_t depth)
+{
+	if (depth >= max_depth)
+	{
+		fail("at most 128 levels of nesting");
+	}
+
+	++pos_;
+	handler.start_array();
+	skip_whitespace();
+
+	if (pos_ < input_.size() && input_[pos_] == ']')
+	{
+		++pos_;
+		handler.end_array();
+		return;
+	}
+
+	while (true)
+	{
+		parse_value(handler, depth + 1);
+
+		skip_whitespace();
+		if (pos_ < input_.size() && input_[pos_] == ',')
+		{
+			++pos_;
+			skip_whitespace();
+			continue;
+		}
+		if (pos_ < input_.size() && input_[pos_] == ']')
+		{
+			++pos_;
+			handler.end_array();
+			return;
+		}
+		fail("',' or ']'");
+	}
+}
+
+std::string_view JsonSaxParser::parse_string()
+{
+	const std::size_t start = pos_ + 1;
+	std::size_t special = find_string_special(input_.data(), start, input_.size());
+
+	// Most strings have no escapes: hand out a view into the input.
+	if (special < input_.size() && input_[special] == '"')
+	{
+		pos_ = special + 1;
+		return input_.substr(start, special - start);
+	}
+
+	scratch_.assign(input_.data() + start, special - start);
+	pos_ = special;
+
+	while (pos_ < input_.size())
+	{
+		if (input_[pos_] == '"')
+		{
+			++pos_;
+			return scratch_;
+		}
+
+		parse_escape();
+
+		special = find_string_special(input_.data(), pos_, input_.size());
+		scratch_.append(input_.data() + pos_, special - pos_);
+		pos_ = special;
+	}
+
+	fail("closing '\"'");
+}
+
+void JsonSaxParser::parse_escape()
+{
+	if (pos_ + 1 >= input_.size())
+	{
+		fail("escape sequence");
+	}
+
+	const char c = input_[pos_ + 1];
+	switch (c)
+	{
+		case '"':
+		case '\\':
+		case '/':
+			scratch_.push_back(c);
+			break;
+		case 'b':
+			scratch_.push_back('\b');
+			break;
+		case 'f':
+			scratch_.push_back('\f');
+			break;
+		case 'n':
+			scratch_.push_back('\n');
+			break;
+		case 'r':
+			scratch_.push_back('\r');
+			break;
+		case 't':
+			scratch_.push_back('\t');
+			break;
+		case 'u':
+		{
+			const long unit = read_hex4(input_, pos_ + 2);
+			if (unit < 0)
+			{
+				fail("four hex digits after '\\u'");
+			}
+			pos_ += 6;
+
+			auto code_point = static_cast<unsigned int>(unit);
+			if (code_point >= 0xD800 && code_point <= 0xDBFF)
+			{
+				// A high surrogate needs the low surrogate of its pair right after it.
+				const long low = input_.compare(pos_, 2, "\\u") == 0 ? read_hex4(input_, pos_ + 2) : -1;
+				if (low >= 0xDC00 && low <= 0xDFFF)
+				{
+					code_point = 0x10000 + ((code_point - 0xD800) << 10) + (static_cast<unsigned int>(low) - 0xDC00);
+					pos_ += 6;
+				}
+				else
+				{
+					code_point = replacement_character;
+				}
+			}
+			else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+			{
+				code_point = replacement_character;
+			}
+
+			append_utf8(scratch_, code_point);
+			return;
+		}
+		default:
+			fail("escape sequence");
+	}
+
+	pos_ += 2;
+}
+
+std::string_view JsonSaxParser::parse_number()
+{
+	const std::size_t start = pos_;
+
+	if (input_[pos_] == '-')
+	{
+		++pos_;
+	}
+
+	if (pos_ < input_.size() && input_[pos_] == '0')
+	{
+		++pos_;
+	}
+	else if (pos_ < input_.size() && is_digit(input_[pos_]))
+	{
+		while (pos_ < input_.size() && is_digit(input_[pos_]))
+		{
+			++pos_;
+		}
+	}
+	else
+	{
+		fail(pos_ == start ? "value" : "digit");
+	}
+
+	if (pos_ < input_.size() && input_[pos_] == '.')
+	{
+		++pos_;
+		if (pos_ >= input_.size() || !is_digit(input_[pos_]))
+		{
+			fail("digit");
+		}
+		while (pos_ < input_.size() && is_digit(input_[pos_]))
+		{
+			++pos_;
+		}
+	}
+
+	if (pos_ < input_.size() && (input_[pos_] == 'e' || input_[pos_] == 'E'))
+	{
+		++pos_;
+		if (pos_ < input_.size() && (input_[pos_] == '+' || input_[pos_] == '-'))
+		{
+			++pos_;
+		}
+		if (pos_ >= input_.size() || !is_digit(input_[pos_]))
+		{
+			fail("digit");
+		}
+		while (pos_ < input_.size() && is_digit(input_[pos_]))
+		{
+			++pos_;
+		}
+	}
+
+	return input_.substr(start, pos_ - start);
+}
+
+void JsonSaxParser::expect_literal(std::string_view literal)
+{
+	if (input_.compare(pos_, literal.size(), literal) != 0)
+	{
+		fail(literal.data());
+	}
+	pos_ += literal.size();
+}
+
+void JsonSaxParser::fail(const char *expected) const
+{
+	throw std::runtime_error("Invalid JSON at byte " + std::to_string(pos_) + ": expected " + expected);
+}
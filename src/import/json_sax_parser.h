@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Kind of a JSON scalar reported to a JsonSaxHandler.
+ */
+enum class JsonScalarType
+{
+	String,
+	Number,
+	True,
+	False,
+	Null
+};
+
+/**
+ * @brief Receives the events of a JsonSaxParser.
+ *
+ * Views passed to the handler are only valid during the call: they point into
+ * the input when the text needs no unescaping, and into a scratch buffer of
+ * the parser otherwise.
+ */
+class JsonSaxHandler
+{
+public:
+	virtual ~JsonSaxHandler() = default;
+
+	/**
+	 * @brief An object starts; its keys and values follow.
+	 */
+	virtual void start_object() = 0;
+
+	/**
+	 * @brief The key of the next member of the innermost object.
+	 */
+	virtual void key(std::string_view name) = 0;
+
+	/**
+	 * @brief The innermost object ends.
+	 */
+	virtual void end_object() = 0;
+
+	/**
+	 * @brief An array starts; its elements follow.
+	 */
+	virtual void start_array() = 0;
+
+	/**
+	 * @brief The innermost array ends.
+	 */
+	virtual void end_array() = 0;
+
+	/**
+	 * @brief A string, number or literal.
+	 *
+	 * @param type Kind of the scalar.
+	 * @param text Unescaped string, number as written, or the literal ("true", "false", "null").
+	 */
+	virtual void scalar(JsonScalarType type, std::string_view text) = 0;
+};
+
+/**
+ * @brief Streaming, SAX-style parser for NDJSON and top-level JSON arrays.
+ *
+ * The input is a sequence of records: either whitespace-separated JSON values
+ * (NDJSON, one per line) or the elements of one top-level array; the format
+ * is told apart by the first character. Records are parsed one at a time and
+ * reported to a JsonSaxHandler as events, so no document tree is built and
+ * memory use does not depend on the size of the input. Strings without
+ * escapes are reported as views into the input; only escaped strings are
+ * unescaped, into one reused buffer.
+ *
+ * The parser is strict about structure (commas, colons, brackets, number and
+ * literal syntax) but passes raw control characters and invalid UTF-8 inside
+ * strings through unchanged.
+ */
+class JsonSaxParser
+{
+public:
+	/// Maximum nesting depth of arrays and objects within a record.
+	static constexpr std::size_t max_depth = 128;
+
+	/**
+	 * @brief Prepare parsing the input.
+	 *
+	 * A leading UTF-8 byte order mark is skipped. The input must outlive the parser.
+	 *
+	 * @param input Whole NDJSON or JSON text.
+	 */
+	explicit JsonSaxParser(std::string_view input);
+
+	/**
+	 * @brief Parse the next record and report its events to the handler.
+	 *
+	 * @param handler Receives the events of the record.
+	 * @return false once every record was parsed.
+	 *
+	 * @throws std::runtime_error on malformed JSON, with the byte offset of the error.
+	 */
+	bool next_record(JsonSaxHandler &handler);
+
+	/**
+	 * @brief Byte offset just past the last record parsed.
+	 *
+	 * The value can be passed to seek() on a parser over the same input to
+	 * continue with the following record.
+	 */
+	std::size_t offset() const;
+
+	/**
+	 * @brief Continue after a record that ended at the given offset.
+	 *
+	 * @param offset A value returned by offset(); offsets before the first record are ignored.
+	 */
+	void seek(std::size_t offset);
+
+	/**
+	 * @brief Whether the records are the elements of a top-level array.
+	 */
+	bool top_level_array() const;
+
+private:
+	/// Whole input.
+	std::string_view input_;
+
+	/// Position of the next byte to parse.
+	std::size_t pos_ = 0;
+
+	/// Position just past the last record parsed.
+	std::size_t record_end_ = 0;
+
+	/// Whether the records are the elements of a top-level array.
+	bool array_ = false;
+
+	/// Whether a comma has to precede the next array element.
+	bool after_element_ = false;
+
+	/// Whether the end of the input was reached.
+	bool finished_ = false;
+
+	/// Buffer receiving unescaped strings.
+	std::string scratch_;
+
+	/**
+	 * @brief Advance pos_ past spaces, tabs and line breaks.
+	 */
+	void skip_whitespace();
+
+	/**
+	 * @brief Parse the value starting at pos_, nested `depth` levels deep.
+	 */
+	void parse_value(JsonSaxHandler &handler, std::size_t depth);
+
+	/**
+	 * @brief Parse an object whose opening brace is at pos_.
+	 */
+	void parse_object(JsonSaxHandler &handler, std::size_t depth);
+
+	/**
+	 * @brief Parse an array whose opening bracket is at pos_.
+	 */
+	void parse_array(JsonSaxHandler &handler, std::size_t depth);
+
+	/**
+	 * @brief Parse a string whose opening quote is at pos_.
+	 *
+	 * @return The string, viewing the input or scratch_.
+	 */
+	std::string_view parse_string();
+
+	/**
+	 * @brief Append the escape sequence whose backslash is at pos_ to scratch_.
+	 */
+	void parse_escape();
+
+	/**
+	 * @brief Parse a number starting at pos_.
+	 *
+	 * @return The number as written.
+	 */
+	std::string_view parse_number();
+
+	/**
+	 * @brief Consume `literal` at pos_.
+	 */
+	void expect_literal(std::string_view literal);
+
+	/**
+	 * @brief Throw a std::runtime_error saying what was expected at pos_.
+	 */
+	[[noreturn]] void fail(const char *expected) const;
+};
@@ -0,0 +1,165 @@
+/// \file
+/// \brief Record fingerprints and the Bloom filter dropping known records.
+
+#include "import/known_record_filter.h"
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+	/// Smallest number of keys the filter is sized for.
+	constexpr std::size_t min_filter_capacity = 1 << 16;
+
+	/// FNV-1a 64-bit offset basis and prime.
+	constexpr std::uint64_t fnv_offset = 0xCBF29CE484222325ULL;
+	constexpr std::uint64_t fnv_prime = 0x100000001B3ULL;
+
+	/**
+	 * @brief Hash one field into `hash`: trimmed, whitespace runs as one space, ASCII case folded.
+	 */
+	void hash_field(const std::string &field, std::uint64_t &hash)
+	{
+		bool pending_space = false;
+		bool started = false;
+		for (const char c : field)
+		{
+			if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v')
+			{
+				pending_space = started;
+				continue;
+			}
+			if (pending_space)
+			{
+				hash = (hash ^ static_cast<unsigned char>(' ')) * fnv_prime;
+				pending_space = false;
+			}
+			const char folded = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+			hash = (hash ^ static_cast<unsigned char>(folded)) * fnv_prime;
+			started = true;
+		}
+
+		// A separator that cannot occur in a field keeps ("ab", "c") apart from ("a", "bc").
+		hash = (hash ^ 0x1F) * fnv_prime;
+	}
+
+	/**
+	 * @brief Final mix (MurmurHash3 fmix64), so every output bit depends on every input bit.
+	 */
+	std::uint64_t mix(std::uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+}
+
+std::uint64_t record_fingerprint(const Application &application)
+{
+	std::uint64_t hash = fnv_offset;
+	hash_field(application.company, hash);
+	hash_field(application.position, hash);
+	hash_field(application.location, hash);
+	hash_field(application.status, hash);
+	hash_field(application.applied_date, hash);
+	hash_field(application.last_update, hash);
+	hash_field(application.source, hash);
+	hash_field(application.notes, hash);
+	return mix(hash);
+}
+
+void record_fingerprints(const std::vector<Application> &batch, std::vector<std::uint64_t> &fingerprints)
+{
+	fingerprints.clear();
+	fingerprints.reserve(batch.size());
+	for (const auto &application : batch)
+	{
+		fingerprints.push_back(record_fingerprint(application));
+	}
+}
+
+KnownRecordFilter::KnownRecordFilter(IApplicationRepository &repository, double false_positive_rate)
+	: repository_(repository)
+	, false_positive_rate_(false_positive_rate)
+	, filter_(0, false_positive_rate)
+{
+	reload(0);
+}
+
+std::size_t KnownRecordFilter::drop_known(std::vector<Application> &batch, std::vector<std::uint64_t> &fingerprints)
+{
+	if (keys_ + batch.size() > capacity_)
+	{
+		reload(batch.size());
+	}
+
+	// Test the whole batch first, so the exact lookups go to the repository together.
+	candidates_.clear();
+	filter_hit_.assign(batch.size(), false);
+	for (std::size_t i = 0; i < batch.size(); ++i)
+	{
+		if (filter_.may_contain(fingerprints[i]))
+		{
+			candidates_.push_back(fingerprints[i]);
+			filter_hit_[i] = true;
+		}
+	}
+	stats_.filter_hits += candidates_.size();
+	std::sort(candidates_.begin(), candidates_.end());
+	const std::vector<std::uint64_t> known = repository_.find_fingerprints(candidates_);
+	known_.clear();
+	known_.insert(known.begin(), known.end());
+
+	batch_fingerprints_.clear();
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < batch.size(); ++i)
+	{
+		const std::uint64_t fingerprint = fingerprints[i];
+		++stats_.checked;
+
+		if (known_.count(fingerprint) > 0 || batch_fingerprints_.count(fingerprint) > 0)
+		{
+			++stats_.dropped;
+			continue;
+		}
+
+		stats_.false_positives += filter_hit_[i] ? 1 : 0;
+		filter_.insert(fingerprint);
+		++keys_;
+		batch_fingerprints_.insert(fingerprint);
+
+		if (kept != i)
+		{
+			batch[kept] = std::move(batch[i]);
+			fingerprints[kept] = fingerprint;
+		}
+		++kept;
+	}
+
+	const std::size_t dropped = batch.size() - kept;
+	batch.resize(kept);
+	fingerprints.resize(kept);
+	return dropped;
+}
+
+const KnownRecordStats &KnownRecordFilter::stats() const
+{
+	return stats_;
+}
+
+void KnownRecordFilter::reload(std::size_t incoming)
+{
+	// Committed batches are in the repository; kept records of failed batches are rightly forgotten.
+	const std::vector<std::uint64_t> stored = repository_.load_fingerprints();
+	capacity_ = std::max(min_filter_capacity, (std::max(stored.size(), keys_) + incoming) * 2);
+	filter_ = BloomFilter(capacity_, false_positive_rate_);
+	for (const std::uint64_t fingerprint : stored)
+	{
+		filter_.insert(fingerprint);
+	}
+	keys_ = stored.size();
+	stats_.loaded += stored.size();
+}
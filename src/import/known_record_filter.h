@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "core/application.h"
+#include "storage/application_repository.h"
+#include "util/bloom_filter.h"
+
+/**
+ * @brief Stable 64-bit fingerprint of an application template.
+ *
+ * Covers every field but the id, after trimming, collapsing runs of
+ * whitespace and folding ASCII case, so the same record re-emitted by a source
+ * gets the same fingerprint in every run and on every platform. Templates are
+ * fingerprinted before JobTracker defaults fill in dates, so a record without
+ * dates is still recognised on a later day.
+ */
+std::uint64_t record_fingerprint(const Application &application);
+
+/**
+ * @brief Replace `fingerprints` with the fingerprints of a batch, in batch order.
+ */
+void record_fingerprints(const std::vector<Application> &batch, std::vector<std::uint64_t> &fingerprints);
+
+/**
+ * @brief Counters of a KnownRecordFilter.
+ */
+struct KnownRecordStats
+{
+	/// Fingerprints loaded from the repository, including reloads after the filter filled up.
+	std::size_t loaded = 0;
+
+	/// Records checked.
+	std::size_t checked = 0;
+
+	/// Records the Bloom filter passed on to an exact lookup.
+	std::size_t filter_hits = 0;
+
+	/// Records the Bloom filter passed on to an exact lookup that turned out to be new.
+	std::size_t false_positives = 0;
+
+	/// Records dropped: imported before, or repeated within their batch.
+	std::size_t dropped = 0;
+
+	/**
+	 * @brief Share of new records the Bloom filter wrongly reported as possibly known.
+	 */
+	double false_positive_rate() const
+	{
+		const std::size_t new_records = checked - dropped;
+		return new_records > 0 ? static_cast<double>(false_positives) / static_cast<double>(new_records) : 0.0;
+	}
+};
+
+/**
+ * @brief Drops records an earlier import already wrote, before they reach the repository.
+ *
+ * The fingerprints stored in the repository are loaded into a Bloom filter
+ * once. Most new records are told apart by the filter alone; the records of a
+ * batch the filter reports as possibly known are looked up in the repository's
+ * fingerprint index with one call, so no new record is ever dropped by a false
+ * positive.
+ * The filter is rebuilt, twice as large, once more records were added than it
+ * was sized for.
+ *
+ * Uses the repository from the calling thread only: call it from the thread
+ * that writes the batches.
+ */
+class KnownRecordFilter
+{
+public:
+	/**
+	 * @brief Load the stored fingerprints.
+	 *
+	 * @param repository          Repository holding the fingerprint index; must outlive the filter.
+	 * @param false_positive_rate Target rate of the Bloom filter.
+	 */
+	explicit KnownRecordFilter(IApplicationRepository &repository, double false_positive_rate = 0.01);
+
+	/**
+	 * @brief Remove known records from a batch.
+	 *
+	 * Records repeated within the batch are removed too, except the first.
+	 * The fingerprints of the remaining records stay aligned with the batch
+	 * and are added to the filter right away; store them with the batch (see
+	 * IApplicationRepository::save_fingerprints).
+	 *
+	 * @param batch        Records to check, in source order.
+	 * @param fingerprints Fingerprints of `batch` (see record_fingerprints).
+	 * @return Number of records removed.
+	 */
+	std::size_t drop_known(std::vector<Application> &batch, std::vector<std::uint64_t> &fingerprints);
+
+	/**
+	 * @brief Counters so far.
+	 */
+	const KnownRecordStats &stats() const;
+
+private:
+	/// Repository holding the fingerprint index.
+	IApplicationRepository &repository_;
+
+	/// Target rate of the Bloom filter.
+	double false_positive_rate_;
+
+	/// Number of keys filter_ was sized for.
+	std::size_t capacity_ = 0;
+
+	/// Number of keys added to filter_.
+	std::size_t keys_ = 0;
+
+	/// Fingerprints of stored records and of records kept so far.
+	BloomFilter filter_;
+
+	/// Fingerprints of the current batch the filter passed on to the repository.
+	std::vector<std::uint64_t> candidates_;
+
+	/// Whether the filter passed the record at each index of the current batch on.
+	std::vector<bool> filter_hit_;
+
+	/// Fingerprints of the current batch known to the repository.
+	std::unordered_set<std::uint64_t> known_;
+
+	/// Fingerprints kept from the current batch.
+	std::unordered_set<std::uint64_t> batch_fingerprints_;
+
+	/// Counters so far.
+	KnownRecordStats stats_;
+
+	/**
+	 * @brief Rebuild filter_ from the repository.
+	 *
+	 * @param incoming Records about to be checked; the filter is sized for
+	 *                 twice the stored fingerprints plus these.
+	 */
+	void reload(std::size_t incoming);
+};
@@ -0,0 +1,1049 @@
+/// \file
+/// \brief Streaming MIME decoding of email bodies to plain UTF-8 text.
+
+#include "import/mime_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <functional>
+
+#include <iconv.h>
+
+#include "util/string_utils.h"
+
+namespace
+{
+	/// Deepest nesting of multipart bodies that is followed.
+	constexpr int max_multipart_depth = 8;
+
+	/// U+FFFD, written for bytes that cannot be converted.
+	constexpr std::string_view replacement_character = "\xEF\xBF\xBD";
+
+	/**
+	 * @brief Whether a character is HTML/MIME whitespace.
+	 */
+	bool is_space(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f';
+	}
+
+	bool is_alpha(char c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+
+	bool is_alnum(char c)
+	{
+		return is_alpha(c) || (c >= '0' && c <= '9');
+	}
+
+	char lower(char c)
+	{
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	/**
+	 * @brief Compare ASCII strings ignoring case.
+	 */
+	bool iequals(std::string_view a, std::string_view b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (lower(a[i]) != lower(b[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool istarts_with(std::string_view text, std::string_view prefix)
+	{
+		return text.size() >= prefix.size() && iequals(text.substr(0, prefix.size()), prefix);
+	}
+
+	/**
+	 * @brief Value of a hexadecimal digit; -1 for other characters.
+	 */
+	int hex_value(char c)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			return c - '0';
+		}
+		if (c >= 'a' && c <= 'f')
+		{
+			return c - 'a' + 10;
+		}
+		if (c >= 'A' && c <= 'F')
+		{
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+
+	/**
+	 * @brief Append a code point as UTF-8; invalid code points become U+FFFD.
+	 */
+	void append_utf8(std::uint32_t code_point, std::string &out)
+	{
+		if (code_point == 0 || (code_point >= 0xD800 && code_point <= 0xDFFF) || code_point > 0x10FFFF)
+		{
+			out.append(replacement_character);
+		}
+		else if (code_point < 0x80)
+		{
+			out.push_back(static_cast<char>(code_point));
+		}
+		else if (code_point < 0x800)
+		{
+			out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+			out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+		else if (code_point < 0x10000)
+		{
+			out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+			out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+		else
+		{
+			out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+			out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+	}
+
+	/// Code points of windows-1252 bytes 0x80-0x9F; 0 where the byte is unassigned (kept as a C1 control).
+	constexpr std::array<std::uint16_t, 32> windows1252_high = {
+		0x20AC, 0, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+		0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0, 0x017D, 0,
+		0, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+		0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0, 0x017E, 0x0178,
+	};
+
+	/**
+	 * @brief Code point of a windows-1252 byte.
+	 */
+	std::uint32_t windows1252_code_point(unsigned char byte)
+	{
+		if (byte >= 0x80 && byte <= 0x9F && windows1252_high[byte - 0x80] != 0)
+		{
+			return windows1252_high[byte - 0x80];
+		}
+		return byte;
+	}
+
+	/**
+	 * @brief Charsets converted without iconv.
+	 */
+	enum class KnownCharset
+	{
+		Utf8,
+		Windows1252,
+		Other
+	};
+
+	KnownCharset classify_charset(std::string_view charset)
+	{
+		charset = string_utils::trim_view(charset);
+		if (charset.empty() || iequals(charset, "utf-8") || iequals(charset, "utf8") || iequals(charset, "us-ascii") ||
+			iequals(charset, "ascii"))
+		{
+			return KnownCharset::Utf8;
+		}
+
+		// Mail labelled ISO-8859-1 is decoded as windows-1252, its superset, as browsers do.
+		if (iequals(charset, "iso-8859-1") || iequals(charset, "iso8859-1") || iequals(charset, "latin1") ||
+			iequals(charset, "latin-1") || iequals(charset, "windows-1252") || iequals(charset, "cp1252"))
+		{
+			return KnownCharset::Windows1252;
+		}
+		return KnownCharset::Other;
+	}
+
+	bool is_ascii(std::string_view text)
+	{
+		return std::all_of(text.begin(), text.end(), [](char c)
+		{
+			return static_cast<unsigned char>(c) < 0x80;
+		});
+	}
+
+	/**
+	 * @brief Owns an iconv conversion descriptor.
+	 */
+	class IconvHandle
+	{
+	public:
+		explicit IconvHandle(const std::string &from_charset)
+			: handle_(iconv_open("UTF-8", from_charset.c_str()))
+		{
+		}
+
+		~IconvHandle()
+		{
+			if (valid())
+			{
+				iconv_close(handle_);
+			}
+		}
+
+		IconvHandle(const IconvHandle &) = delete;
+		IconvHandle &operator=(const IconvHandle &) = delete;
+
+		bool valid() const
+		{
+			return handle_ != reinterpret_cast<iconv_t>(-1);
+		}
+
+		iconv_t get() const
+		{
+			return handle_;
+		}
+
+	private:
+		iconv_t handle_;
+	};
+
+	/**
+	 * @brief Convert with iconv; invalid sequences become U+FFFD, a sequence cut off at the end is dropped.
+	 *
+	 * @return false if iconv does not know the charset.
+	 */
+	bool convert_with_iconv(std::string_view text, std::string_view charset, std::string &out)
+	{
+		const IconvHandle converter{std::string(string_utils::trim_view(charset))};
+		if (!converter.valid())
+		{
+			return false;
+		}
+
+		// iconv does not write through its input pointer.
+		char *in = const_cast<char *>(text.data());
+		std::size_t in_left = text.size();
+		std::array<char, 4096> buffer;
+
+		while (in_left > 0)
+		{
+			char *converted = buffer.data();
+			std::size_t out_left = buffer.size();
+			const std::size_t result = iconv(converter.get(), &in, &in_left, &converted, &out_left);
+			out.append(buffer.data(), static_cast<std::size_t>(converted - buffer.data()));
+
+			if (result == static_cast<std::size_t>(-1))
+			{
+				if (errno == E2BIG)
+				{
+					continue;
+				}
+				if (errno == EILSEQ)
+				{
+					out.append(replacement_character);
+					++in;
+					--in_left;
+					continue;
+				}
+				break;
+			}
+		}
+
+		// Return stateful encodings to their initial shift state.
+		char *converted = buffer.data();
+		std::size_t out_left = buffer.size();
+		iconv(converter.get(), nullptr, nullptr, &converted, &out_left);
+		out.append(buffer.data(), static_cast<std::size_t>(converted - buffer.data()));
+		return true;
+	}
+
+	/**
+	 * @brief Whether text in the given charset has to be converted to be valid UTF-8.
+	 */
+	bool needs_conversion(std::string_view text, std::string_view charset)
+	{
+		switch (classify_charset(charset))
+		{
+		case KnownCharset::Utf8:
+			return false;
+		case KnownCharset::Windows1252:
+			return !is_ascii(text);
+		case KnownCharset::Other:
+			break;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Media type of a Content-Type value: "Text/HTML; charset=x" -> "Text/HTML".
+	 */
+	std::string_view media_type(std::string_view content_type)
+	{
+		return string_utils::trim_view(content_type.substr(0, content_type.find(';')));
+	}
+
+	/**
+	 * @brief Value of a parameter of a header value, without quotes; empty if absent.
+	 */
+	std::string_view header_parameter(std::string_view value, std::string_view name)
+	{
+		std::size_t separator = value.find(';');
+		while (separator != std::string_view::npos)
+		{
+			std::string_view rest = value.substr(separator + 1);
+			const std::size_t equals = rest.find('=');
+			if (equals == std::string_view::npos)
+			{
+				return {};
+			}
+
+			const std::string_view key = string_utils::trim_view(rest.substr(0, equals));
+			rest = string_utils::trim_view(rest.substr(equals + 1));
+
+			std::string_view parameter;
+			if (!rest.empty() && rest[0] == '"')
+			{
+				const std::size_t close = rest.find('"', 1);
+				parameter = rest.substr(1, close == std::string_view::npos ? std::string_view::npos : close - 1);
+				value = close == std::string_view::npos ? std::string_view() : rest.substr(close + 1);
+			}
+			else
+			{
+				const std::size_t end = rest.find(';');
+				parameter = string_utils::trim_view(rest.substr(0, end));
+				value = end == std::string_view::npos ? std::string_view() : rest.substr(end);
+			}
+
+			if (iequals(key, name))
+			{
+				return parameter;
+			}
+			separator = value.find(';');
+		}
+		return {};
+	}
+
+	/**
+	 * @brief Offset of the next "--boundary" delimiter starting a line at or after `from`; npos if none.
+	 */
+	std::size_t find_delimiter(std::string_view body, std::string_view boundary, std::size_t from)
+	{
+		while (true)
+		{
+			const std::size_t found = body.find(boundary, from);
+			if (found == std::string_view::npos)
+			{
+				return std::string_view::npos;
+			}
+			if (found >= 2 && body[found - 1] == '-' && body[found - 2] == '-' && (found == 2 || body[found - 3] == '\n'))
+			{
+				return found - 2;
+			}
+			from = found + 1;
+		}
+	}
+
+	/**
+	 * @brief Split a body part into its headers of interest and its content.
+	 *
+	 * @param entity     The part, headers first.
+	 * @param part       Receives Content-Type, Content-Transfer-Encoding and content.
+	 * @param attachment Set if Content-Disposition marks the part as an attachment.
+	 */
+	void parse_body_part(std::string_view entity, MimePart &part, bool &attachment)
+	{
+		part = MimePart{};
+		attachment = false;
+
+		while (!entity.empty())
+		{
+			std::size_t field_end = entity.find('\n');
+			std::string_view line = entity.substr(0, field_end);
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.remove_suffix(1);
+			}
+			if (line.empty())
+			{
+				part.body = field_end == std::string_view::npos ? std::string_view() : entity.substr(field_end + 1);
+				return;
+			}
+
+			// A field continues on lines starting with whitespace.
+			while (field_end != std::string_view::npos && field_end + 1 < entity.size() &&
+				(entity[field_end + 1] == ' ' || entity[field_end + 1] == '\t'))
+			{
+				field_end = entity.find('\n', field_end + 1);
+			}
+
+			const std::string_view field = entity.substr(0, field_end);
+			entity.remove_prefix(field_end == std::string_view::npos ? entity.size() : field_end + 1);
+
+			const std::size_t colon = field.find(':');
+			if (colon == std::string_view::npos)
+			{
+				continue;
+			}
+			const std::string_view name = string_utils::trim_view(field.substr(0, colon));
+			const std::string_view value = string_utils::trim_view(field.substr(colon + 1));
+			if (iequals(name, "Content-Type"))
+			{
+				part.content_type = value;
+			}
+			else if (iequals(name, "Content-Transfer-Encoding"))
+			{
+				part.transfer_encoding = value;
+			}
+			else if (iequals(name, "Content-Disposition"))
+			{
+				attachment = istarts_with(value, "attachment");
+			}
+		}
+	}
+
+	/**
+	 * @brief The first text/plain and text/html parts found so far.
+	 */
+	struct TextParts
+	{
+		MimePart plain;
+		MimePart html;
+		bool has_plain = false;
+		bool has_html = false;
+	};
+
+	/**
+	 * @brief Walk an entity depth-first, recording its text parts, until a text/plain part is found.
+	 */
+	void collect_text_parts(const MimePart &entity, int depth, TextParts &found)
+	{
+		const std::string_view type = media_type(entity.content_type);
+
+		if (istarts_with(type, "multipart/"))
+		{
+			const std::string_view boundary = header_parameter(entity.content_type, "boundary");
+			if (boundary.empty() || depth >= max_multipart_depth)
+			{
+				return;
+			}
+
+			const std::string_view body = entity.body;
+			std::size_t delimiter = find_delimiter(body, boundary, 0);
+			while (delimiter != std::string_view::npos && !found.has_plain)
+			{
+				// "--boundary--" closes the multipart; anything after it is epilogue.
+				std::size_t start = delimiter + 2 + boundary.size();
+				if (body.substr(start, 2) == "--")
+				{
+					return;
+				}
+				const std::size_t line_end = body.find('\n', start);
+				if (line_end == std::string_view::npos)
+				{
+					return;
+				}
+				start = line_end + 1;
+
+				// The line break before the next delimiter belongs to the delimiter.
+				const std::size_t next = find_delimiter(body, boundary, start);
+				std::size_t end = next == std::string_view::npos ? body.size() : next;
+				if (next != std::string_view::npos && end > start && body[end - 1] == '\n')
+				{
+					--end;
+					if (end > start && body[end - 1] == '\r')
+					{
+						--end;
+					}
+				}
+
+				MimePart part;
+				bool attachment = false;
+				parse_body_part(body.substr(start, end - start), part, attachment);
+				if (!attachment)
+				{
+					collect_text_parts(part, depth + 1, found);
+				}
+				delimiter = next;
+			}
+			return;
+		}
+
+		if (type.empty() || iequals(type, "text/plain"))
+		{
+			if (!found.has_plain)
+			{
+				found.plain = entity;
+				found.has_plain = true;
+			}
+		}
+		else if (iequals(type, "text/html"))
+		{
+			if (!found.has_html)
+			{
+				found.html = entity;
+				found.has_html = true;
+			}
+		}
+	}
+
+	/**
+	 * @brief Writes HTML text content, collapsing whitespace and line breaks.
+	 *
+	 * Whitespace and line breaks are only written once more text follows, so
+	 * the output never starts or ends with them.
+	 */
+	class HtmlTextWriter
+	{
+	public:
+		explicit HtmlTextWriter(std::string &out)
+			: out_(out)
+			, start_(out.size())
+		{
+		}
+
+		/**
+		 * @brief Write characters that are not whitespace.
+		 */
+		void text(std::string_view characters)
+		{
+			if (pending_breaks_ > 0)
+			{
+				out_.append(static_cast<std::size_t>(pending_breaks_), '\n');
+			}
+			else if (pending_space_ && out_.size() > start_)
+			{
+				out_.push_back(' ');
+			}
+			pending_breaks_ = 0;
+			pending_space_ = false;
+			out_.append(characters);
+		}
+
+		void space()
+		{
+			pending_space_ = true;
+		}
+
+		/**
+		 * @brief End the line; two breaks leave an empty line.
+		 */
+		void line_break(int count)
+		{
+			if (out_.size() > start_)
+			{
+				pending_breaks_ = std::max(pending_breaks_, count);
+			}
+		}
+
+	private:
+		std::string &out_;
+		std::size_t start_;
+		bool pending_space_ = false;
+		int pending_breaks_ = 0;
+	};
+
+	/**
+	 * @brief Line breaks written for a block-level element.
+	 */
+	struct BlockElement
+	{
+		std::string_view name;
+		int breaks;
+	};
+
+	constexpr BlockElement block_elements[] = {
+		{"br", 1}, {"div", 1}, {"li", 1}, {"tr", 1}, {"dt", 1}, {"dd", 1},
+		{"section", 1}, {"article", 1}, {"header", 1}, {"footer", 1},
+		{"p", 2}, {"h1", 2}, {"h2", 2}, {"h3", 2}, {"h4", 2}, {"h5", 2}, {"h6", 2},
+		{"ul", 2}, {"ol", 2}, {"table", 2}, {"blockquote", 2}, {"pre", 2}, {"hr", 2},
+	};
+
+	/// Elements whose content is not shown.
+	constexpr std::string_view hidden_elements[] = {"head", "script", "style", "template"};
+
+	/// Named character references decoded; other names are kept as written.
+	constexpr std::pair<std::string_view, std::string_view> named_references[] = {
+		{"amp", "&"}, {"lt", "<"}, {"gt", ">"}, {"quot", "\""}, {"apos", "'"},
+		{"copy", "\xC2\xA9"}, {"reg", "\xC2\xAE"}, {"trade", "\xE2\x84\xA2"}, {"euro", "\xE2\x82\xAC"},
+		{"pound", "\xC2\xA3"}, {"middot", "\xC2\xB7"}, {"bull", "\xE2\x80\xA2"}, {"hellip", "\xE2\x80\xA6"},
+		{"ndash", "\xE2\x80\x93"}, {"mdash", "\xE2\x80\x94"}, {"lsquo", "\xE2\x80\x98"}, {"rsquo", "\xE2\x80\x99"},
+		{"ldquo", "\xE2\x80\x9C"}, {"rdquo", "\xE2\x80\x9D"},
+	};
+
+	/// Longest character reference name looked up.
+	constexpr std::size_t max_reference_name = 8;
+
+	/**
+	 * @brief Read a character reference starting at '&'.
+	 *
+	 * @return Offset after the reference; after the '&' if it is none.
+	 */
+	std::size_t read_reference(std::string_view html, std::size_t at, HtmlTextWriter &writer)
+	{
+		std::size_t i = at + 1;
+
+		if (i < html.size() && html[i] == '#')
+		{
+			++i;
+			const bool hex = i < html.size() && (html[i] == 'x' || html[i] == 'X');
+			if (hex)
+			{
+				++i;
+			}
+
+			const std::size_t digits = i;
+			std::uint32_t code_point = 0;
+			while (i < html.size() && i - digits < 7)
+			{
+				const int digit = hex ? hex_value(html[i]) : (html[i] >= '0' && html[i] <= '9' ? html[i] - '0' : -1);
+				if (digit < 0)
+				{
+					break;
+				}
+				code_point = code_point * (hex ? 16 : 10) + static_cast<std::uint32_t>(digit);
+				++i;
+			}
+			if (i == digits)
+			{
+				writer.text("&");
+				return at + 1;
+			}
+			if (i < html.size() && html[i] == ';')
+			{
+				++i;
+			}
+
+			// Like browsers, read references to C1 controls as windows-1252.
+			if (code_point >= 0x80 && code_point <= 0x9F)
+			{
+				code_point = windows1252_code_point(static_cast<unsigned char>(code_point));
+			}
+			if (code_point == 0xA0 || (code_point < 0x80 && is_space(static_cast<char>(code_point))))
+			{
+				writer.space();
+			}
+			else
+			{
+				std::string utf8;
+				append_utf8(code_point, utf8);
+				writer.text(utf8);
+			}
+			return i;
+		}
+
+		while (i < html.size() && i - at <= max_reference_name && is_alnum(html[i]))
+		{
+			++i;
+		}
+		if (i < html.size() && html[i] == ';')
+		{
+			const std::string_view name = html.substr(at + 1, i - at - 1);
+			if (name == "nbsp")
+			{
+				writer.space();
+				return i + 1;
+			}
+			for (const auto &[reference, replacement] : named_references)
+			{
+				if (name == reference)
+				{
+					writer.text(replacement);
+					return i + 1;
+				}
+			}
+		}
+
+		writer.text("&");
+		return at + 1;
+	}
+
+	/**
+	 * @brief Offset of the end tag of a hidden element; the end of the document if it is not closed.
+	 */
+	std::size_t find_end_tag(std::string_view html, std::size_t from, std::string_view name)
+	{
+		while (true)
+		{
+			const std::size_t open = html.find("</", from);
+			if (open == std::string_view::npos)
+			{
+				return html.size();
+			}
+			const std::size_t after = open + 2 + name.size();
+			if (iequals(html.substr(open + 2, name.size()), name) && (after >= html.size() || !is_alnum(html[after])))
+			{
+				return open;
+			}
+			from = open + 2;
+		}
+	}
+
+	/**
+	 * @brief Read markup starting at '<': a tag, comment or declaration.
+	 *
+	 * @return Offset after the markup, and after the content of hidden elements.
+	 */
+	std::size_t read_markup(std::string_view html, std::size_t at, HtmlTextWriter &writer)
+	{
+		std::size_t i = at + 1;
+		if (i >= html.size())
+		{
+			return html.size();
+		}
+
+		if (html.compare(i, 3, "!--") == 0)
+		{
+			const std::size_t end = html.find("-->", i + 3);
+			return end == std::string_view::npos ? html.size() : end + 3;
+		}
+		if (html[i] == '!' || html[i] == '?')
+		{
+			const std::size_t end = html.find('>', i);
+			return end == std::string_view::npos ? html.size() : end + 1;
+		}
+
+		const bool end_tag = html[i] == '/';
+		if (end_tag)
+		{
+			++i;
+		}
+		if (i >= html.size() || !is_alpha(html[i]))
+		{
+			// Not a tag, just a '<' in the text.
+			writer.text("<");
+			return at + 1;
+		}
+
+		const std::size_t name_start = i;
+		while (i < html.size() && is_alnum(html[i]))
+		{
+			++i;
+		}
+		const std::string_view name = html.substr(name_start, i - name_start);
+
+		// The tag ends at the first '>' outside a quoted attribute value.
+		char quote = 0;
+		for (; i < html.size(); ++i)
+		{
+			const char c = html[i];
+			if (quote != 0)
+			{
+				if (c == quote)
+				{
+					quote = 0;
+				}
+			}
+			else if ((c == '"' || c == '\'') && html[i - 1] == '=')
+			{
+				quote = c;
+			}
+			else if (c == '>')
+			{
+				break;
+			}
+		}
+		if (i >= html.size())
+		{
+			return html.size();
+		}
+
+		for (const auto &element : block_elements)
+		{
+			if (iequals(name, element.name))
+			{
+				writer.line_break(element.breaks);
+				break;
+			}
+		}
+		if (iequals(name, "td") || iequals(name, "th"))
+		{
+			writer.space();
+		}
+
+		if (!end_tag && html[i - 1] != '/')
+		{
+			for (const auto hidden : hidden_elements)
+			{
+				if (iequals(name, hidden))
+				{
+					return find_end_tag(html, i + 1, hidden);
+				}
+			}
+		}
+		return i + 1;
+	}
+}
+
+void mime_decode_quoted_printable(std::string_view encoded, std::string &out)
+{
+	out.reserve(out.size() + encoded.size());
+
+	std::size_t i = 0;
+	while (i < encoded.size())
+	{
+		const std::size_t escape = encoded.find('=', i);
+		if (escape == std::string_view::npos)
+		{
+			out.append(encoded.substr(i));
+			return;
+		}
+		out.append(encoded.substr(i, escape - i));
+		i = escape + 1;
+
+		// Soft line break: '=', optional trailing whitespace, line end.
+		std::size_t j = i;
+		while (j < encoded.size() && (encoded[j] == ' ' || encoded[j] == '\t'))
+		{
+			++j;
+		}
+		if (j >= encoded.size())
+		{
+			return;
+		}
+		if (encoded[j] == '\r' || encoded[j] == '\n')
+		{
+			if (encoded[j] == '\r' && j + 1 < encoded.size() && encoded[j + 1] == '\n')
+			{
+				++j;
+			}
+			i = j + 1;
+			continue;
+		}
+
+		if (i + 1 >= encoded.size())
+		{
+			return;
+		}
+		const int high = hex_value(encoded[i]);
+		const int low = hex_value(encoded[i + 1]);
+		if (high < 0 || low < 0)
+		{
+			out.push_back('=');
+			continue;
+		}
+		out.push_back(static_cast<char>((high << 4) | low));
+		i += 2;
+	}
+}
+
+void mime_decode_base64(std::string_view encoded, std::string &out)
+{
+	static constexpr auto values = []()
+	{
+		std::array<std::int8_t, 256> table{};
+		table.fill(-1);
+		constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		for (std::size_t i = 0; i < alphabet.size(); ++i)
+		{
+			table[static_cast<unsigned char>(alphabet[i])] = static_cast<std::int8_t>(i);
+		}
+		return table;
+	}();
+
+	out.reserve(out.size() + encoded.size() / 4 * 3);
+
+	std::uint32_t bits = 0;
+	int bit_count = 0;
+	std::size_t i = 0;
+	while (i < encoded.size())
+	{
+		// Whole groups between line breaks in one step.
+		if (bit_count == 0 && i + 4 <= encoded.size())
+		{
+			const int a = values[static_cast<unsigned char>(encoded[i])];
+			const int b = values[static_cast<unsigned char>(encoded[i + 1])];
+			const int c = values[static_cast<unsigned char>(encoded[i + 2])];
+			const int d = values[static_cast<unsigned char>(encoded[i + 3])];
+			if ((a | b | c | d) >= 0)
+			{
+				const std::uint32_t group = (static_cast<std::uint32_t>(a) << 18) | (static_cast<std::uint32_t>(b) << 12) |
+					(static_cast<std::uint32_t>(c) << 6) | static_cast<std::uint32_t>(d);
+				const char bytes[3] = {static_cast<char>(group >> 16), static_cast<char>(group >> 8), static_cast<char>(group)};
+				out.append(bytes, 3);
+				i += 4;
+				continue;
+			}
+		}
+
+		const char c = encoded[i++];
+		if (c == '=')
+		{
+			return;
+		}
+		const int value = values[static_cast<unsigned char>(c)];
+		if (value < 0)
+		{
+			continue;
+		}
+		bits = (bits << 6) | static_cast<std::uint32_t>(value);
+		bit_count += 6;
+		if (bit_count >= 8)
+		{
+			bit_count -= 8;
+			out.push_back(static_cast<char>(bits >> bit_count));
+		}
+	}
+}
+
+bool mime_convert_to_utf8(std::string_view text, std::string_view charset, std::string &out)
+{
+	switch (classify_charset(charset))
+	{
+	case KnownCharset::Utf8:
+		out.append(text);
+		return true;
+
+	case KnownCharset::Windows1252:
+		out.reserve(out.size() + text.size() + text.size() / 8);
+		for (const char c : text)
+		{
+			const auto byte = static_cast<unsigned char>(c);
+			if (byte < 0x80)
+			{
+				out.push_back(c);
+			}
+			else
+			{
+				append_utf8(windows1252_code_point(byte), out);
+			}
+		}
+		return true;
+
+	case KnownCharset::Other:
+		break;
+	}
+
+	const std::size_t before = out.size();
+	if (convert_with_iconv(text, charset, out))
+	{
+		return true;
+	}
+	out.resize(before);
+	out.append(text);
+	return false;
+}
+
+void mime_html_to_text(std::string_view html, std::string &out)
+{
+	out.reserve(out.size() + html.size() / 2);
+	HtmlTextWriter writer(out);
+
+	std::size_t i = 0;
+	while (i < html.size())
+	{
+		const char c = html[i];
+		if (c == '<')
+		{
+			i = read_markup(html, i, writer);
+		}
+		else if (c == '&')
+		{
+			i = read_reference(html, i, writer);
+		}
+		else if (is_space(c))
+		{
+			writer.space();
+			++i;
+		}
+		else
+		{
+			const std::size_t start = i;
+			while (i < html.size() && html[i] != '<' && html[i] != '&' && !is_space(html[i]))
+			{
+				++i;
+			}
+			writer.text(html.substr(start, i - start));
+		}
+	}
+}
+
+bool mime_find_text_part(std::string_view content_type, std::string_view transfer_encoding, std::string_view body, MimePart &part)
+{
+	TextParts found;
+	collect_text_parts(MimePart{content_type, transfer_encoding, body}, 0, found);
+
+	if (found.has_plain)
+	{
+		part = found.plain;
+		return true;
+	}
+	if (found.has_html)
+	{
+		part = found.html;
+		return true;
+	}
+	return false;
+}
+
+std::string_view MimeDecoder::decode_text(std::string_view content_type, std::string_view transfer_encoding, std::string_view charset, std::string_view body)
+{
+	MimePart part;
+	if (!mime_find_text_part(content_type, transfer_encoding, body, part))
+	{
+		return {};
+	}
+	std::string_view text = part.body;
+
+	const std::string_view encoding = string_utils::trim_view(part.transfer_encoding);
+	if (iequals(encoding, "base64"))
+	{
+		transfer_buffer_.clear();
+		mime_decode_base64(text, transfer_buffer_);
+		text = transfer_buffer_;
+	}
+	else if (iequals(encoding, "quoted-printable"))
+	{
+		transfer_buffer_.clear();
+		mime_decode_quoted_printable(text, transfer_buffer_);
+		text = transfer_buffer_;
+	}
+
+	std::string_view part_charset = header_parameter(part.content_type, "charset");
+	if (part_charset.empty())
+	{
+		part_charset = charset;
+	}
+	if (needs_conversion(text, part_charset))
+	{
+		utf8_buffer_.clear();
+		mime_convert_to_utf8(text, part_charset, utf8_buffer_);
+		text = utf8_buffer_;
+	}
+
+	if (iequals(media_type(part.content_type), "text/html"))
+	{
+		text_buffer_.clear();
+		mime_html_to_text(text, text_buffer_);
+		text = text_buffer_;
+	}
+	return text;
+}
+
+void MimeDecoder::decode_body(EmailMessage &message)
+{
+	const std::string_view text = decode_text(message.body_content_type, message.body_transfer_encoding, message.body_charset, message.body_text);
+
+	// A text part taken as is is a view into the body itself: cut the body down to it.
+	const char *body_begin = message.body_text.data();
+	const char *body_end = body_begin + message.body_text.size();
+	if (!text.empty() && std::less_equal<const char *>()(body_begin, text.data()) && std::less_equal<const char *>()(text.data() + text.size(), body_end))
+	{
+		const std::size_t offset = static_cast<std::size_t>(text.data() - body_begin);
+		message.body_text.erase(offset + text.size());
+		message.body_text.erase(0, offset);
+	}
+	else
+	{
+		message.body_text.assign(text);
+	}
+
+	message.body_content_type = "text/plain";
+	message.body_transfer_encoding.clear();
+	message.body_charset = "utf-8";
+}
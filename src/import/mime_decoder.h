@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "import/email_message.h"
+
+/**
+ * @brief Location of one leaf part inside a MIME body; all views point into that body.
+ */
+struct MimePart
+{
+	/// Content-Type of the part, with parameters; empty means text/plain.
+	std::string_view content_type;
+
+	/// Content-Transfer-Encoding of the part; empty means 7bit.
+	std::string_view transfer_encoding;
+
+	/// Encoded content of the part.
+	std::string_view body;
+};
+
+/**
+ * @brief Append the bytes of a quoted-printable text (RFC 2045, section 6.7).
+ *
+ * Soft line breaks are removed; malformed escapes are copied unchanged and an
+ * escape cut off at the end of the text is dropped.
+ */
+void mime_decode_quoted_printable(std::string_view encoded, std::string &out);
+
+/**
+ * @brief Append the bytes of a base64 text (RFC 2045, section 6.8).
+ *
+ * Line breaks and other characters outside the alphabet are skipped; of a
+ * group cut off at the end of the text, only the complete bytes are kept.
+ */
+void mime_decode_base64(std::string_view encoded, std::string &out);
+
+/**
+ * @brief Append a text in the given charset converted to UTF-8.
+ *
+ * UTF-8, US-ASCII, ISO-8859-1 and windows-1252 are converted directly; other
+ * charsets go through iconv, with invalid sequences replaced by U+FFFD.
+ *
+ * @return false if the charset is unknown; the text is then appended unchanged.
+ */
+bool mime_convert_to_utf8(std::string_view text, std::string_view charset, std::string &out);
+
+/**
+ * @brief Append the readable text of an HTML document.
+ *
+ * Works in a single pass: tags and comments are dropped, script, style and
+ * head contents are skipped, character references are decoded, block-level
+ * tags become line breaks and other runs of whitespace collapse to one space.
+ * A document cut off in the middle of a tag loses only that tag.
+ */
+void mime_html_to_text(std::string_view html, std::string &out);
+
+/**
+ * @brief Find the part of a MIME body to read as text.
+ *
+ * Walks multipart bodies over the given buffer without copying: text/plain is
+ * preferred over text/html, parts sent as attachments are skipped.
+ *
+ * @param content_type      Content-Type of the body, with parameters.
+ * @param transfer_encoding Content-Transfer-Encoding of the body.
+ * @param body              The body; must outlive the returned views.
+ * @param part              Receives the part found.
+ * @return false if the body holds no text part.
+ */
+bool mime_find_text_part(std::string_view content_type, std::string_view transfer_encoding, std::string_view body, MimePart &part);
+
+/**
+ * @brief Turns MIME bodies into plain UTF-8 text.
+ *
+ * Combines mime_find_text_part, the transfer decoders, mime_convert_to_utf8
+ * and mime_html_to_text. Intermediate results go to buffers owned by the
+ * decoder, which keep their capacity from one message to the next; a body that
+ * needs no decoding is returned without being copied. Not thread-safe: use one
+ * decoder per thread.
+ */
+class MimeDecoder
+{
+public:
+	/**
+	 * @brief Decode a body to plain UTF-8 text.
+	 *
+	 * @param content_type      Content-Type of the body (e.g. "text/html" or
+	 *                          `multipart/alternative; boundary="b"`); empty means text/plain.
+	 * @param transfer_encoding Content-Transfer-Encoding of the body; empty means 7bit.
+	 * @param charset           Charset used when the Content-Type names none.
+	 * @param body              The body as received.
+	 * @return The text; points into `body` or into the decoder, and stays valid
+	 *         until the next call. Empty if the body holds no text part.
+	 */
+	std::string_view decode_text(std::string_view content_type, std::string_view transfer_encoding, std::string_view charset, std::string_view body);
+
+	/**
+	 * @brief Replace the body of a message with its plain UTF-8 text.
+	 *
+	 * Afterwards body_content_type is "text/plain", body_charset "utf-8" and
+	 * body_transfer_encoding empty, so decoding a message twice is harmless.
+	 */
+	void decode_body(EmailMessage &message);
+
+private:
+	/// Output of the transfer decoding.
+	std::string transfer_buffer_;
+
+	/// Output of the charset conversion.
+	std::string utf8_buffer_;
+
+	/// Output of the HTML stripping.
+	std::string text_buffer_;
+};
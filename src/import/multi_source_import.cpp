@@ -0,0 +1,251 @@
+/// \file
+/// \brief Concurrent import of several sources through a single writer.
+
+#include "import/multi_source_import.h"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "core/job_tracker.h"
+#include "import/import_pipeline.h"
+#include "util/date_time.h"
+#include "util/spsc_queue.h"
+
+namespace
+{
+	/**
+	 * @brief One normalized batch of a source.
+	 */
+	struct SourceBatch
+	{
+		std::vector<Application> applications;
+
+		/// Fingerprints of the templates, in batch order; empty without skip_known.
+		std::vector<std::uint64_t> fingerprints;
+	};
+
+	/**
+	 * @brief Batches of one source on their way to the writer.
+	 */
+	struct SourceLane
+	{
+		explicit SourceLane(std::size_t capacity)
+			: queue(capacity)
+		{
+		}
+
+		/// Normalized batches, pushed by the reader and popped by the writer.
+		BoundedSpscQueue<SourceBatch> queue;
+
+		/// Set by the reader once it pushed its last batch.
+		std::atomic<bool> done{false};
+
+		/// Error that stopped the reader; published by done.
+		std::exception_ptr error;
+
+		/// Whether the writer drained the lane. Writer only.
+		bool finished = false;
+	};
+
+	/**
+	 * @brief Read and normalize a whole source, pushing its batches into the lane.
+	 *
+	 * Stops early, without an error, once `failed` is set. With `fingerprint`
+	 * set, every template is fingerprinted before its defaults are applied.
+	 */
+	void read_source(IImportSource &source, SourceLane &lane, std::size_t batch_size, bool fingerprint, const std::atomic<bool> &failed)
+	{
+		try
+		{
+			const auto stream = source.open_stream();
+			const std::string today = datetime::today_iso();
+			SourceBatch batch;
+			bool stopped = false;
+
+			while (!stopped && !failed.load(std::memory_order_acquire) && stream->next_batch(batch.applications, batch_size))
+			{
+				if (fingerprint)
+				{
+					record_fingerprints(batch.applications, batch.fingerprints);
+				}
+				for (auto &app : batch.applications)
+				{
+					JobTracker::apply_defaults(app, today);
+				}
+
+				unsigned int attempt = 0;
+				while (!lane.queue.try_push(std::move(batch)))
+				{
+					if (failed.load(std::memory_order_acquire))
+					{
+						stopped = true;
+						break;
+					}
+					spsc_back_off(attempt);
+				}
+				batch = SourceBatch();
+			}
+		}
+		catch (...)
+		{
+			lane.error = std::current_exception();
+		}
+		lane.done.store(true, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Message of an exception thrown by a source.
+	 */
+	std::string describe(const std::exception_ptr &error)
+	{
+		try
+		{
+			std::rethrow_exception(error);
+		}
+		catch (const std::exception &ex)
+		{
+			return ex.what();
+		}
+		catch (...)
+		{
+			return "unknown error";
+		}
+	}
+}
+
+MultiSourceImportService::MultiSourceImportService(
+	std::vector<IImportSource *> sources,
+	IApplicationRepository &repository,
+	ImportOptions options)
+	: sources_(std::move(sources))
+	, repository_(repository)
+	, options_(options)
+{
+}
+
+MultiSourceImportResult MultiSourceImportService::run_once()
+{
+	MultiSourceImportResult result{};
+	result.sources.resize(sources_.size());
+
+	std::vector<std::unique_ptr<SourceLane>> lanes;
+	lanes.reserve(sources_.size());
+	for (std::size_t i = 0; i < sources_.size(); ++i)
+	{
+		lanes.push_back(std::make_unique<SourceLane>(options_.queue_capacity));
+	}
+
+	std::atomic<bool> failed{false};
+	std::vector<std::thread> readers;
+	readers.reserve(sources_.size());
+
+	for (std::size_t i = 0; i < sources_.size(); ++i)
+	{
+		readers.emplace_back([this, &lanes, &failed, i]()
+		{
+			read_source(*sources_[i], *lanes[i], options_.batch_size, options_.skip_known, failed);
+		});
+	}
+
+	// The writer runs on the calling thread: the repository is not shared.
+	std::exception_ptr writer_error;
+	try
+	{
+		std::optional<KnownRecordFilter> known;
+		if (options_.skip_known)
+		{
+			known.emplace(repository_);
+		}
+
+		std::size_t remaining = lanes.size();
+		SourceBatch batch;
+		unsigned int attempt = 0;
+
+		while (remaining > 0)
+		{
+			bool progressed = false;
+
+			// One batch per source and round keeps fast sources from starving slow ones.
+			for (std::size_t i = 0; i < lanes.size(); ++i)
+			{
+				SourceLane &lane = *lanes[i];
+				if (lane.finished)
+				{
+					continue;
+				}
+
+				// The reader may have pushed its last batch right before finishing.
+				const bool done = lane.done.load(std::memory_order_acquire);
+				if (lane.queue.try_pop(batch))
+				{
+					ImportResult &counts = result.sources[i].result;
+					counts.total += batch.applications.size();
+					if (known)
+					{
+						counts.skipped += known->drop_known(batch.applications, batch.fingerprints);
+					}
+					ImportPipeline::write_batch(repository_, batch.applications, counts, nullptr, known ? &batch.fingerprints : nullptr);
+					progressed = true;
+				}
+				else if (done)
+				{
+					lane.finished = true;
+					--remaining;
+					progressed = true;
+
+					if (lane.error)
+					{
+						result.sources[i].error = describe(lane.error);
+					}
+					else
+					{
+						sources_[i]->on_import_committed();
+					}
+				}
+			}
+
+			if (progressed)
+			{
+				attempt = 0;
+			}
+			else
+			{
+				spsc_back_off(attempt);
+			}
+		}
+
+		if (known)
+		{
+			result.total.known_records = known->stats();
+		}
+	}
+	catch (...)
+	{
+		writer_error = std::current_exception();
+		failed.store(true, std::memory_order_release);
+	}
+
+	for (auto &reader : readers)
+	{
+		reader.join();
+	}
+
+	if (writer_error)
+	{
+		std::rethrow_exception(writer_error);
+	}
+
+	for (const auto &source : result.sources)
+	{
+		result.total.total += source.result.total;
+		result.total.imported += source.result.imported;
+		result.total.failed += source.result.failed;
+		result.total.skipped += source.result.skipped;
+	}
+
+	return result;
+}
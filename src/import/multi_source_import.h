@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "import/import_service.h"
+#include "import/import_source.h"
+#include "storage/application_repository.h"
+
+/**
+ * @brief Outcome of one source of a MultiSourceImportService run.
+ */
+struct SourceImportResult
+{
+	/// Rows read from this source and how many of them were persisted.
+	ImportResult result;
+
+	/// Error that stopped reading the source; empty if it was read completely.
+	std::string error;
+
+	/**
+	 * @brief Whether the source was read to the end.
+	 */
+	bool succeeded() const
+	{
+		return error.empty();
+	}
+};
+
+/**
+ * @brief Result of a MultiSourceImportService run.
+ */
+struct MultiSourceImportResult
+{
+	/// Counts summed over all sources.
+	ImportResult total;
+
+	/// Outcome of every source, in the order the sources were given.
+	std::vector<SourceImportResult> sources;
+
+	/**
+	 * @brief Number of sources that could not be read to the end.
+	 */
+	std::size_t failed_sources() const
+	{
+		std::size_t failed = 0;
+		for (const auto &source : sources)
+		{
+			failed += source.succeeded() ? 0 : 1;
+		}
+		return failed;
+	}
+};
+
+/**
+ * @brief Imports several sources concurrently into one repository.
+ *
+ * Every source is read and normalized on its own thread, so slow sources
+ * (e.g. remote feeds waiting on the network) overlap instead of adding up.
+ * All batches are funneled into a single writer on the calling thread, which
+ * takes one batch from each source in turn and commits it in its own
+ * transaction; the repository is never shared between threads. Every source
+ * has a bounded lock-free queue to the writer, so a writer that falls behind
+ * throttles the readers.
+ *
+ * A source that fails is reported in its SourceImportResult while the other
+ * sources carry on; its rows committed so far are kept. A failing commit
+ * stops all sources and is rethrown. IImportSource::on_import_committed() is
+ * called, on the calling thread, for every source that was read completely.
+ * Checkpoints are not written: sources are always read from the start.
+ * With ImportOptions::skip_known, the readers fingerprint their records and
+ * the writer drops the known ones, so a record emitted by two sources is
+ * written once.
+ */
+class MultiSourceImportService
+{
+public:
+	/**
+	 * @brief Construct a MultiSourceImportService.
+	 *
+	 * @param sources    Sources to import; none may be null.
+	 * @param repository Repository used to persist imported applications.
+	 * @param options    Batch size, per-source queue capacity and skip_known.
+	 */
+	MultiSourceImportService(std::vector<IImportSource *> sources, IApplicationRepository &repository, ImportOptions options = {});
+
+	/**
+	 * @brief Read all sources concurrently and persist their applications once.
+	 *
+	 * @return Per-source outcomes and their sum.
+	 *
+	 * @throws std::runtime_error if a transaction fails.
+	 */
+	MultiSourceImportResult run_once();
+
+private:
+	std::vector<IImportSource *> sources_;
+	IApplicationRepository &repository_;
+
+	/// Batch size, per-source queue capacity and skip_known.
+	ImportOptions options_;
+};
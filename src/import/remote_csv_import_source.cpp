@@ -1,106 +1,575 @@
 #include "import/remote_csv_import_source.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <sstream>
-#include <unordered_map>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
 
+#include "import/csv_row_decoder.h"
+#include "import/csv_stream_tokenizer.h"
+#include "util/spsc_queue.h"
 #include "util/string_utils.h"
 
-RemoteCsvImportSource::RemoteCsvImportSource(IHttpClient &http_client, const RemoteCsvConfig &config)
+namespace
+{
+	/// Maximum number of body chunks buffered between the download thread and the parser.
+	constexpr std::size_t download_queue_chunks = 64;
+
+	/**
+	 * @brief HTTP download running on its own thread, handing body chunks to a consumer.
+	 *
+	 * The network transfer overlaps with parsing on the consumer thread. The
+	 * chunk queue is bounded: when the parser falls behind, the transfer is
+	 * paused (or, with clients that do not pause, the download thread waits)
+	 * instead of buffering the body. The consumer resumes it once the queue
+	 * drained to half its capacity.
+	 */
+	class StreamingDownload : public IHttpResponseHandler
+	{
+	public:
+		StreamingDownload(IHttpClient &client, const std::string &url, const HttpHeaders &headers)
+			: chunks_(download_queue_chunks)
+			, head_future_(head_promise_.get_future())
+		{
+			thread_ = std::thread([this, &client, url, headers]()
+			{
+				run(client, url, headers);
+			});
+		}
+
+		~StreamingDownload() override
+		{
+			cancelled_.store(true);
+			// A paused transfer must run on to notice the cancellation.
+			if (paused_.exchange(false))
+			{
+				resume();
+			}
+			thread_.join();
+		}
+
+		StreamingDownload(const StreamingDownload &) = delete;
+		StreamingDownload &operator=(const StreamingDownload &) = delete;
+
+		/**
+		 * @brief Block until the status and headers are known. Call once.
+		 *
+		 * @return The response without its body.
+		 *
+		 * @throws std::runtime_error if the request failed before a response arrived.
+		 */
+		HttpResponse wait_head()
+		{
+			return head_future_.get();
+		}
+
+		/**
+		 * @brief Block until the next body chunk arrives.
+		 *
+		 * @return false once the whole body was delivered.
+		 *
+		 * @throws std::runtime_error if the transfer failed midway.
+		 */
+		bool next_chunk(std::string &chunk)
+		{
+			unsigned int attempt = 0;
+
+			while (!chunks_.try_pop(chunk))
+			{
+				if (done_.load(std::memory_order_acquire))
+				{
+					// The download may have pushed its last chunk right before finishing.
+					if (chunks_.try_pop(chunk))
+					{
+						return true;
+					}
+					if (error_)
+					{
+						std::rethrow_exception(error_);
+					}
+					return false;
+				}
+				resume_if_drained();
+				spsc_back_off(attempt);
+			}
+
+			resume_if_drained();
+			return true;
+		}
+
+		bool on_head(int status_code, const HttpHeaders &headers) override
+		{
+			HttpResponse head{};
+			head.status_code = status_code;
+			head.headers = headers;
+			head_promise_.set_value(std::move(head));
+			head_delivered_ = true;
+
+			// Only successful responses carry CSV; skip error pages.
+			return status_code == 200 || status_code == 206;
+		}
+
+		bool ready_for_body() override
+		{
+			if (cancelled_.load(std::memory_order_acquire) || chunks_.size() < chunks_.capacity())
+			{
+				return true;
+			}
+
+			// Sequentially consistent with the destructor: either it sees the pause
+			// and resumes, or this sees the cancellation and does not pause.
+			paused_.store(true);
+			if (cancelled_.load())
+			{
+				paused_.exchange(false);
+				return true;
+			}
+			return false;
+		}
+
+		void set_resume(std::function<void()> resume) override
+		{
+			std::lock_guard<std::mutex> lock(resume_mutex_);
+			resume_ = std::move(resume);
+		}
+
+		bool on_body(std::string_view chunk) override
+		{
+			std::string copy(chunk);
+			unsigned int attempt = 0;
+
+			// Only waits with clients that do not pause; they call this on the download thread.
+			while (!chunks_.try_push(std::move(copy)))
+			{
+				if (cancelled_.load(std::memory_order_acquire))
+				{
+					return false;
+				}
+				spsc_back_off(attempt);
+			}
+
+			return !cancelled_.load(std::memory_order_acquire);
+		}
+
+	private:
+		/// Body chunks in arrival order.
+		BoundedSpscQueue<std::string> chunks_;
+
+		std::promise<HttpResponse> head_promise_;
+		std::future<HttpResponse> head_future_;
+
+		/// Written by the download thread only; read by it as well.
+		bool head_delivered_ = false;
+
+		/// Set by the consumer to abort the transfer.
+		std::atomic<bool> cancelled_{false};
+
+		/// Set by the download thread once get_streaming() returned.
+		std::atomic<bool> done_{false};
+
+		/// Set when ready_for_body() paused the transfer; cleared by whoever resumes it.
+		std::atomic<bool> paused_{false};
+
+		/// Resumes the paused transfer; set by the client for the duration of the transfer.
+		std::function<void()> resume_;
+
+		/// Guards resume_.
+		std::mutex resume_mutex_;
+
+		/// Transfer error; published by done_.
+		std::exception_ptr error_;
+
+		std::thread thread_;
+
+		/**
+		 * @brief Resume the transfer once the parser drained half of the queue.
+		 */
+		void resume_if_drained()
+		{
+			if (chunks_.size() <= chunks_.capacity() / 2 && paused_.exchange(false, std::memory_order_acq_rel))
+			{
+				resume();
+			}
+		}
+
+		void resume()
+		{
+			std::lock_guard<std::mutex> lock(resume_mutex_);
+			if (resume_)
+			{
+				resume_();
+			}
+		}
+
+		void run(IHttpClient &client, const std::string &url, const HttpHeaders &headers)
+		{
+			try
+			{
+				client.get_streaming(url, headers, *this);
+				if (!head_delivered_)
+				{
+					head_promise_.set_value(HttpResponse{});
+				}
+			}
+			catch (...)
+			{
+				error_ = std::current_exception();
+				if (!head_delivered_)
+				{
+					head_promise_.set_exception(error_);
+				}
+			}
+			done_.store(true, std::memory_order_release);
+		}
+	};
+
+	/**
+	 * @brief Stream that decodes a CSV document while it is being downloaded.
+	 *
+	 * Body chunks are fed into a CsvStreamTokenizer, so records split across
+	 * chunks are reassembled and memory stays bounded by the download queue.
+	 * `prefix` is parsed before the body (the stored header row of a tail
+	 * fetch). Records ending at or before `skip_until` were imported by an
+	 * earlier run and are skipped.
+	 *
+	 * Once the body was parsed completely, the feed state is published to
+	 * `outcome`, ready to be saved by RemoteCsvImportSource::on_import_committed().
+	 */
+	class RemoteCsvStream : public IApplicationStream
+	{
+	public:
+		RemoteCsvStream(
+			std::unique_ptr<StreamingDownload> download,
+			char delimiter,
+			const std::string &prefix,
+			std::uint64_t skip_until,
+			std::uint64_t length_before,
+			HttpFeedState state,
+			std::shared_ptr<RemoteCsvFetchOutcome> outcome)
+			: download_(std::move(download))
+			, tokenizer_(delimiter)
+			, skip_until_(skip_until)
+			, length_before_(length_before)
+			, state_(std::move(state))
+			, outcome_(std::move(outcome))
+		{
+			tokenizer_.append(prefix);
+		}
+
+		bool next_batch(std::vector<Application> &batch, std::size_t max_count) override
+		{
+			const std::size_t limit = std::max<std::size_t>(max_count, 1);
+			ApplicationBatchFiller filler(batch);
+
+			while (filler.size() < limit)
+			{
+				if (tokenizer_.next_record(fields_))
+				{
+					if (!decoder_)
+					{
+						decoder_.emplace(fields_, CsvRowDecoder::RequiredFields::CompanyAndPosition);
+						remember_header_line();
+					}
+					else if (tokenizer_.offset() > skip_until_ && decoder_->decode(fields_, filler.slot()))
+					{
+						filler.commit();
+					}
+					continue;
+				}
+
+				if (tokenizer_.exhausted())
+				{
+					complete();
+					break;
+				}
+
+				if (download_->next_chunk(chunk_))
+				{
+					body_bytes_ += chunk_.size();
+					if (!chunk_.empty())
+					{
+						last_byte_ = chunk_.back();
+					}
+					if (!decoder_)
+					{
+						header_text_ += chunk_;
+					}
+					tokenizer_.append(chunk_);
+				}
+				else
+				{
+					tokenizer_.finish();
+				}
+			}
+
+			return filler.size() > 0;
+		}
+
+	private:
+		/// Download feeding the tokenizer.
+		std::unique_ptr<StreamingDownload> download_;
+
+		/// Tokenizer reassembling records across chunks.
+		CsvStreamTokenizer tokenizer_;
+
+		/// Decoder built from the header row; empty until it arrived.
+		std::optional<CsvRowDecoder> decoder_;
+
+		/// Reused field buffer.
+		std::vector<std::string_view> fields_;
+
+		/// Reused chunk buffer.
+		std::string chunk_;
+
+		/// Body bytes received until the header row was complete.
+		std::string header_text_;
+
+		/// Records ending at or before this input position are skipped.
+		std::uint64_t skip_until_;
+
+		/// Document bytes imported before the body (start of a tail fetch).
+		std::uint64_t length_before_;
+
+		/// Body bytes received so far.
+		std::uint64_t body_bytes_ = 0;
+
+		/// Last body byte received.
+		char last_byte_ = '\0';
+
+		/// Feed state to publish once the body was parsed.
+		HttpFeedState state_;
+
+		/// Shared with the source that opened the stream.
+		std::shared_ptr<RemoteCsvFetchOutcome> outcome_;
+
+		/// Whether complete() already ran.
+		bool completed_ = false;
+
+		/**
+		 * @brief Keep the raw header row of a full download for later tail fetches.
+		 */
+		void remember_header_line()
+		{
+			if (!state_.header_line.empty())
+			{
+				return;
+			}
+
+			std::string_view line(header_text_);
+			line = line.substr(0, std::min<std::size_t>(line.size(), tokenizer_.offset()));
+			while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+			{
+				line.remove_suffix(1);
+			}
+			state_.header_line = std::string(line);
+			header_text_.clear();
+			header_text_.shrink_to_fit();
+		}
+
+		/**
+		 * @brief Publish the feed state once the whole body was parsed.
+		 */
+		void complete()
+		{
+			if (completed_)
+			{
+				return;
+			}
+			completed_ = true;
+
+			// Tails can only be appended after a complete record.
+			state_.imported_length = body_bytes_ > 0 && last_byte_ == '\n' ? length_before_ + body_bytes_ : 0;
+			outcome_->unchanged = skip_until_ > 0 && body_bytes_ <= skip_until_;
+			outcome_->completed_state = std::move(state_);
+		}
+	};
+
+	/**
+	 * @brief Stream without any rows, used for errors and unchanged feeds.
+	 */
+	std::unique_ptr<IApplicationStream> empty_stream()
+	{
+		return std::make_unique<VectorApplicationStream>(std::vector<Application>{});
+	}
+
+	/**
+	 * @brief First byte position of a "Content-Range: bytes first-last/length" header.
+	 *
+	 * @return The first byte position, or std::nullopt if the header cannot be parsed.
+	 */
+	std::optional<std::uint64_t> content_range_start(const std::string &content_range)
+	{
+		const std::string_view prefix = "bytes ";
+		if (content_range.compare(0, prefix.size(), prefix) != 0)
+		{
+			return std::nullopt;
+		}
+
+		std::uint64_t first = 0;
+		const char *begin = content_range.data() + prefix.size();
+		const char *end = content_range.data() + content_range.size();
+		const auto [ptr, ec] = std::from_chars(begin, end, first);
+		if (ec != std::errc() || ptr == end || *ptr != '-')
+		{
+			return std::nullopt;
+		}
+		return first;
+	}
+}
+
+RemoteCsvImportSource::RemoteCsvImportSource(IHttpClient &http_client, const RemoteCsvConfig &config, IHttpFeedStateStore *state_store)
 	: http_client_(http_client)
 	, config_(config)
+	, state_store_(state_store)
 {
 }
 
 std::vector<Application> RemoteCsvImportSource::fetch_applications()
 {
-	std::vector<Application> result;
+	const auto stream = open_stream();
+	return drain_stream(*stream);
+}
 
-	const HttpResponse response = http_client_.get(config_.url);
+std::unique_ptr<IApplicationStream> RemoteCsvImportSource::open_stream()
+{
+	outcome_ = std::make_shared<RemoteCsvFetchOutcome>();
 
-	// Soft-fail on HTTP error: return empty list, caller can log.
-	if (response.status_code != 200)
+	std::optional<HttpFeedState> state;
+	if (state_store_ != nullptr)
 	{
-		return result;
+		state = state_store_->find(config_.url);
 	}
 
-	if (response.body.empty())
+	HttpHeaders headers;
+	std::uint64_t known_length = 0;
+
+	if (state)
 	{
-		return result;
+		if (!state->etag.empty())
+		{
+			headers["If-None-Match"] = state->etag;
+		}
+		if (!state->last_modified.empty())
+		{
+			headers["If-Modified-Since"] = state->last_modified;
+		}
+		if (config_.append_only && state->imported_length > 0 && !state->header_line.empty())
+		{
+			known_length = state->imported_length;
+			headers["Range"] = "bytes=" + std::to_string(known_length) + "-";
+		}
 	}
 
-	std::istringstream stream(response.body);
+	auto download = std::make_unique<StreamingDownload>(http_client_, config_.url, headers);
+	HttpResponse head = download->wait_head();
 
-	std::string header_line;
-	if (!std::getline(stream, header_line))
+	// Not modified, or nothing appended past the imported length.
+	if (head.status_code == 304 || (known_length > 0 && head.status_code == 416))
 	{
-		return result;
+		outcome_->unchanged = true;
+		return empty_stream();
 	}
 
-	const auto header_parts = string_utils::split(header_line, config_.delimiter);
-	if (header_parts.empty())
-	{
-		return result;
-	}
+	HttpFeedState next;
+	next.url = config_.url;
 
-	std::unordered_map<std::string, std::size_t> column_index;
+	std::string prefix;
+	std::uint64_t skip_until = 0;
+	std::uint64_t length_before = 0;
 
-	for (std::size_t i = 0; i < header_parts.size(); ++i)
+	const auto range_start = content_range_start(head.header("content-range"));
+	if (head.status_code == 206 && known_length > 0 && range_start == known_length)
 	{
-		const auto trimmed = string_utils::trim(header_parts[i]);
-		const auto lower = string_utils::to_lower(trimmed);
-		column_index[lower] = i;
+		// Tail of an append-only feed: decode it with the stored header row.
+		next.header_line = state->header_line;
+		prefix = state->header_line + "\n";
+		length_before = known_length;
 	}
-
-	auto get_column = [&](const std::vector<std::string> &parts, const char *name) -> std::string
+	else
 	{
-		const auto it = column_index.find(name);
-		if (it == column_index.end())
+		if (head.status_code == 206)
 		{
-			return {};
+			// Unexpected range; fall back to an unconditional full download.
+			download = std::make_unique<StreamingDownload>(http_client_, config_.url, HttpHeaders{});
+			head = download->wait_head();
 		}
 
-		const auto idx = it->second;
-		if (idx >= parts.size())
+		// Soft-fail on HTTP error: return an empty stream, caller can log.
+		if (head.status_code != 200)
 		{
-			return {};
+			return empty_stream();
 		}
 
-		return string_utils::trim(parts[idx]);
-	};
+		// A server that ignores Range sends the whole append-only feed; skip what we have,
+		// unless the announced length shows the feed was replaced by a shorter one.
+		// The length of a compressed body says nothing about the document length.
+		std::uint64_t content_length = 0;
+		const std::string length_header = head.header("content-length");
+		const auto [ptr, ec] = std::from_chars(length_header.data(), length_header.data() + length_header.size(), content_length);
+		const bool shorter = ec == std::errc() && head.header("content-encoding").empty() && content_length < known_length;
+		skip_until = shorter ? 0 : known_length;
+	}
 
-	std::string line;
-	while (std::getline(stream, line))
+	next.etag = head.header("etag");
+	next.last_modified = head.header("last-modified");
+
+	return std::make_unique<RemoteCsvStream>(
+		std::move(download), config_.delimiter, prefix, skip_until, length_before, std::move(next), outcome_);
+}
+
+void RemoteCsvImportSource::on_import_committed()
+{
+	if (state_store_ != nullptr && outcome_ && outcome_->completed_state)
 	{
-		if (line.empty())
-		{
-			continue;
-		}
+		state_store_->save(*outcome_->completed_state);
+		outcome_->completed_state.reset();
+	}
+}
+
+bool RemoteCsvImportSource::unchanged() const
+{
+	return outcome_ && outcome_->unchanged;
+}
+
+std::vector<RemoteCsvConfig> parse_remote_csv_feeds(std::istream &in)
+{
+	std::vector<RemoteCsvConfig> feeds;
+	std::string line;
 
-		const auto parts = string_utils::split(line, config_.delimiter);
-		if (parts.empty())
+	while (std::getline(in, line))
+	{
+		line = string_utils::trim(line);
+		if (line.empty() || line.front() == '#')
 		{
 			continue;
 		}
 
-		Application app{};
+		std::istringstream words(line);
+		RemoteCsvConfig config{};
+		words >> config.url;
 
-		app.company = get_column(parts, "company");
-		app.position = get_column(parts, "position");
-		app.location = get_column(parts, "location");
-		app.source = get_column(parts, "source");
-		app.status = get_column(parts, "status");
-		app.applied_date = get_column(parts, "applied_date");
-		app.last_update = get_column(parts, "last_update");
-		app.notes = get_column(parts, "notes");
-
-		// Minimal sanity check: require at least company + position.
-		if (app.company.empty() || app.position.empty())
+		std::string option;
+		while (words >> option)
 		{
-			continue;
+			if (option != "append-only")
+			{
+				throw std::runtime_error("Unknown option '" + option + "' for feed " + config.url);
+			}
+			config.append_only = true;
 		}
 
-		result.push_back(app);
+		feeds.push_back(std::move(config));
 	}
 
-	return result;
+	return feeds;
 }
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <istream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "core/application.h"
 #include "import/import_source.h"
 #include "import/http_client.h"
+#include "storage/http_feed_state_store.h"
 
 /**
  * @brief Configuration for RemoteCsvImportSource.
@@ -17,12 +21,54 @@ struct RemoteCsvConfig
 
 	/// Delimiter character used to split columns (default: ',').
 	char delimiter = ',';
+
+	/// The feed only ever grows at the end: fetch just the new tail with a Range request.
+	bool append_only = false;
+};
+
+/**
+ * @brief Read a list of remote CSV feeds.
+ *
+ * Every line names one feed: its URL, optionally followed by the word
+ * `append-only`. Blank lines and lines starting with '#' are ignored.
+ *
+ * @param in Stream holding the feed list.
+ * @return One configuration per feed, in file order.
+ *
+ * @throws std::runtime_error on a line with an unknown option.
+ */
+std::vector<RemoteCsvConfig> parse_remote_csv_feeds(std::istream &in);
+
+/**
+ * @brief What the last RemoteCsvImportSource::open_stream() found, shared with its stream.
+ */
+struct RemoteCsvFetchOutcome
+{
+	/// The feed answered 304, or nothing was appended since the last import.
+	bool unchanged = false;
+
+	/// Feed state to save; set once the stream parsed the whole body.
+	std::optional<HttpFeedState> completed_state;
 };
 
 /**
  * @brief Import source that fetches a CSV document over HTTP.
  *
  * The fetched body is parsed using the same conventions as CsvImportSource.
+ * It is parsed while it downloads: a download thread hands body chunks to the
+ * stream through a bounded queue, so parsing overlaps the transfer and memory
+ * use does not grow with the size of the feed.
+ *
+ * With a feed state store, the source remembers the ETag and Last-Modified
+ * validators of the last imported response and sends them as If-None-Match /
+ * If-Modified-Since. An unchanged feed then answers 304 and yields no rows.
+ * For append-only feeds the source also requests only the bytes after the
+ * imported length (Range: bytes=N-) and decodes them with the stored header
+ * row. Servers that ignore the Range header still work: the already imported
+ * prefix of their full response is skipped.
+ *
+ * The state is saved from on_import_committed(), so a failed import fetches
+ * the same data again.
  */
 class RemoteCsvImportSource : public IImportSource
 {
@@ -32,8 +78,10 @@ class RemoteCsvImportSource : public IImportSource
 	 *
 	 * @param http_client HTTP client used to perform the GET request.
 	 * @param config      Configuration describing which URL to fetch and how to parse it.
+	 * @param state_store Optional store for HTTP validators; without it every
+	 *                    run downloads the full document.
 	 */
-	RemoteCsvImportSource(IHttpClient &http_client, const RemoteCsvConfig &config);
+	RemoteCsvImportSource(IHttpClient &http_client, const RemoteCsvConfig &config, IHttpFeedStateStore *state_store = nullptr);
 
 	/**
 	 * @brief Fetch applications from the remote CSV.
@@ -43,10 +91,35 @@ class RemoteCsvImportSource : public IImportSource
 	 */
 	std::vector<Application> fetch_applications() override;
 
+	/**
+	 * @brief Start downloading the CSV document and open a stream over its rows.
+	 *
+	 * Waits for the response headers only. Rows are decoded batch by batch as
+	 * body chunks arrive. HTTP errors produce an empty stream; transfer errors
+	 * after the headers are thrown from IApplicationStream::next_batch().
+	 */
+	std::unique_ptr<IApplicationStream> open_stream() override;
+
+	/**
+	 * @brief Save the validators of the response streamed by open_stream().
+	 */
+	void on_import_committed() override;
+
+	/**
+	 * @brief Whether the last open_stream() found the feed unchanged (304 or nothing appended).
+	 */
+	bool unchanged() const;
+
 private:
 	/// HTTP client used to fetch the CSV document.
 	IHttpClient &http_client_;
 
 	/// Configuration describing URL and delimiter.
 	RemoteCsvConfig config_;
+
+	/// Store for HTTP validators; may be null.
+	IHttpFeedStateStore *state_store_;
+
+	/// Outcome of the last open_stream(); its state is saved once the import is committed.
+	std::shared_ptr<RemoteCsvFetchOutcome> outcome_;
 };
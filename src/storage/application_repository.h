@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "core/application.h"
+#include "core/import_checkpoint.h"
 #include "core/statistics.h"
 
 /**
@@ -29,6 +31,18 @@ class IApplicationRepository
 	 */
 	virtual Application insert(const Application &application) = 0;
 
+	/**
+	 * @brief Insert a new application, taking ownership of its fields.
+	 *
+	 * Import paths hand over freshly decoded applications they no longer need,
+	 * so implementations should move the fields into the returned entity
+	 * instead of copying them.
+	 *
+	 * @param application Application to insert. Its id field may be 0.
+	 * @return Application with an assigned id and any storage-managed fields.
+	 */
+	virtual Application insert(Application &&application) = 0;
+
 	/**
 	 * @brief Update an existing application.
 	 *
@@ -74,4 +88,69 @@ class IApplicationRepository
 	 * @return Statistics structure containing aggregated counts.
 	 */
 	virtual Statistics compute_statistics() = 0;
+
+	/**
+	 * @brief Start a transaction that groups the following writes.
+	 *
+	 * Bulk imports wrap each batch in a transaction so that storage can
+	 * commit many rows at once.
+	 */
+	virtual void begin_transaction() = 0;
+
+	/**
+	 * @brief Commit the transaction started by begin_transaction().
+	 */
+	virtual void commit_transaction() = 0;
+
+	/**
+	 * @brief Discard the writes of the transaction started by begin_transaction().
+	 */
+	virtual void rollback_transaction() = 0;
+
+	/**
+	 * @brief Look up the last committed checkpoint of an import source.
+	 *
+	 * @param source Source identity (see ImportCheckpoint::source).
+	 * @return The stored checkpoint; std::nullopt if the source was never imported.
+	 */
+	virtual std::optional<ImportCheckpoint> find_checkpoint(const std::string &source) = 0;
+
+	/**
+	 * @brief Store the checkpoint of an import source, replacing any previous one.
+	 *
+	 * Import paths call this inside the transaction of the batch it describes,
+	 * so the checkpoint is committed or rolled back together with the rows.
+	 *
+	 * @param checkpoint Checkpoint to store.
+	 */
+	virtual void save_checkpoint(const ImportCheckpoint &checkpoint) = 0;
+
+	/**
+	 * @brief Retrieve the fingerprints of all records imported so far.
+	 *
+	 * Import paths that skip known records (see KnownRecordFilter) load them
+	 * once to fill their in-memory filter.
+	 */
+	virtual std::vector<std::uint64_t> load_fingerprints() = 0;
+
+	/**
+	 * @brief Look up several fingerprints at once.
+	 *
+	 * @param fingerprints Fingerprints to look up (see record_fingerprint).
+	 * @return The given fingerprints that are stored, in no particular order.
+	 */
+	virtual std::vector<std::uint64_t> find_fingerprints(const std::vector<std::uint64_t> &fingerprints) = 0;
+
+	/**
+	 * @brief Store the fingerprints of imported records; stored ones are ignored.
+	 *
+	 * Import paths call this inside the transaction of the batch the records
+	 * belong to, so fingerprints are committed or rolled back with the rows.
+	 * Every fingerprint is linked to the application inserted for it, and
+	 * remove() drops it again, so a removed application can be reimported.
+	 *
+	 * @param fingerprints    Fingerprints to store.
+	 * @param application_ids Id of the application inserted for each fingerprint, aligned with `fingerprints`.
+	 */
+	virtual void save_fingerprints(const std::vector<std::uint64_t> &fingerprints, const std::vector<int> &application_ids) = 0;
 };
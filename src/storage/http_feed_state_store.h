@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @brief What is known about the last imported version of a remote feed.
+ *
+ * The validators (ETag, Last-Modified) make the next fetch conditional, so an
+ * unchanged feed costs a single 304 response. For append-only feeds, the
+ * imported length and the header row allow fetching just the new tail with a
+ * Range request.
+ */
+struct HttpFeedState
+{
+	/// URL of the feed.
+	std::string url;
+
+	/// ETag of the last imported response; empty if the server sent none.
+	std::string etag;
+
+	/// Last-Modified of the last imported response; empty if the server sent none.
+	std::string last_modified;
+
+	/// Number of document bytes already imported; 0 if a tail fetch is not possible.
+	std::uint64_t imported_length = 0;
+
+	/// Header row of the document, needed to decode a tail without its header.
+	std::string header_line;
+};
+
+/**
+ * @brief Abstract storage for HttpFeedState, keyed by URL.
+ */
+class IHttpFeedStateStore
+{
+public:
+	virtual ~IHttpFeedStateStore() = default;
+
+	/**
+	 * @brief Look up the state of a feed.
+	 *
+	 * @param url URL of the feed.
+	 * @return The stored state; std::nullopt if the feed was never imported.
+	 */
+	virtual std::optional<HttpFeedState> find(const std::string &url) = 0;
+
+	/**
+	 * @brief Store the state of a feed, replacing any previous one.
+	 *
+	 * @param state State to store.
+	 */
+	virtual void save(const HttpFeedState &state) = 0;
+};
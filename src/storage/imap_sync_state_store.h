@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @brief How far the import of an IMAP mailbox has progressed.
+ *
+ * IMAP assigns every message a UID that only grows within a mailbox as long
+ * as UIDVALIDITY stays the same. Remembering UIDNEXT of the last sync lets
+ * the next sync fetch only messages with higher UIDs, and skip fetching
+ * altogether when UIDNEXT did not move. HIGHESTMODSEQ (CONDSTORE, RFC 7162)
+ * is kept where the server provides it.
+ */
+struct ImapMailboxState
+{
+	/// Account and mailbox the state belongs to (e.g. "me@imap.example.com/INBOX").
+	std::string mailbox_key;
+
+	/// UIDVALIDITY of the mailbox at the last sync.
+	std::uint32_t uid_validity = 0;
+
+	/// UIDNEXT of the mailbox at the last sync; messages below it were imported.
+	std::uint32_t uid_next = 0;
+
+	/// HIGHESTMODSEQ at the last sync; 0 if the server does not support CONDSTORE.
+	std::uint64_t highest_modseq = 0;
+};
+
+/**
+ * @brief Abstract storage for ImapMailboxState, keyed by mailbox key.
+ */
+class IImapSyncStateStore
+{
+public:
+	virtual ~IImapSyncStateStore() = default;
+
+	/**
+	 * @brief Look up the state of a mailbox.
+	 *
+	 * @param mailbox_key Account and mailbox key.
+	 * @return The stored state; std::nullopt if the mailbox was never synced.
+	 */
+	virtual std::optional<ImapMailboxState> find(const std::string &mailbox_key) = 0;
+
+	/**
+	 * @brief Store the state of a mailbox, replacing any previous one.
+	 *
+	 * @param state State to store.
+	 */
+	virtual void save(const ImapMailboxState &state) = 0;
+};
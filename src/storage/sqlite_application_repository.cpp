@@ -5,7 +5,35 @@
 
 #include <sqlite3.h>
 
+#include <cstdint>
+#include <filesystem>
 #include <stdexcept>
+#include <utility>
+
+namespace
+{
+	/**
+	 * @brief Run a query returning a single integer, e.g. a COUNT(*).
+	 */
+	std::int64_t query_int64(sqlite3 *db, const char *sql)
+	{
+		sqlite3_stmt *stmt = nullptr;
+		if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+		{
+			throw std::runtime_error(std::string("Failed to prepare query: ") + sqlite3_errmsg(db));
+		}
+
+		const int rc_step = sqlite3_step(stmt);
+		const std::int64_t value = rc_step == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+		sqlite3_finalize(stmt);
+
+		if (rc_step != SQLITE_ROW)
+		{
+			throw std::runtime_error(std::string("Failed to execute query: ") + sqlite3_errmsg(db));
+		}
+		return value;
+	}
+}
 
 SqliteApplicationRepository::SqliteApplicationRepository(const std::string &database_path)
 	: database_(database_path)
@@ -26,9 +54,30 @@ void SqliteApplicationRepository::ensure_schema()
 		"  applied_date TEXT,"
 		"  last_update TEXT,"
 		"  notes TEXT"
+		");"
+		"CREATE TABLE IF NOT EXISTS import_checkpoints ("
+		"  source TEXT PRIMARY KEY,"
+		"  source_size INTEGER NOT NULL,"
+		"  source_mtime INTEGER NOT NULL,"
+		"  byte_offset INTEGER NOT NULL,"
+		"  rows_committed INTEGER NOT NULL"
+		");"
+		"CREATE TABLE IF NOT EXISTS import_fingerprints ("
+		"  fingerprint INTEGER PRIMARY KEY,"
+		"  application_id INTEGER"
 		");";
 
 	database_.execute_non_query(sql);
+
+	// Fingerprint tables created before application ids were recorded.
+	if (query_int64(database_.handle(),
+		"SELECT COUNT(*) FROM pragma_table_info('import_fingerprints') WHERE name = 'application_id';") == 0)
+	{
+		database_.execute_non_query("ALTER TABLE import_fingerprints ADD COLUMN application_id INTEGER;");
+	}
+
+	database_.execute_non_query(
+		"CREATE INDEX IF NOT EXISTS import_fingerprints_application ON import_fingerprints (application_id);");
 }
 
 Application SqliteApplicationRepository::map_row_to_application(sqlite3_stmt *stmt) const
@@ -75,6 +124,21 @@ Application SqliteApplicationRepository::map_row_to_application(sqlite3_stmt *st
 }
 
 Application SqliteApplicationRepository::insert(const Application &application)
+{
+	const int id = insert_row(application);
+
+	Application stored = application;
+	stored.id = id;
+	return stored;
+}
+
+Application SqliteApplicationRepository::insert(Application &&application)
+{
+	application.id = insert_row(application);
+	return std::move(application);
+}
+
+int SqliteApplicationRepository::insert_row(const Application &application)
 {
 	const char *sql =
 		"INSERT INTO applications ("
@@ -82,69 +146,27 @@ Application SqliteApplicationRepository::insert(const Application &application)
 		") VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
 
 	sqlite3 *db = database_.handle();
-	sqlite3_stmt *stmt = nullptr;
 
-	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	if (!insert_stmt_)
 	{
-		throw std::runtime_error("Failed to prepare INSERT statement");
-	}
-
-	const int rc_bind_company = sqlite3_bind_text(
-		stmt,
-		1,
-		application.company.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_position = sqlite3_bind_text(
-		stmt,
-		2,
-		application.position.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_location = sqlite3_bind_text(
-		stmt,
-		3,
-		application.location.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_source = sqlite3_bind_text(
-		stmt,
-		4,
-		application.source.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_status = sqlite3_bind_text(
-		stmt,
-		5,
-		application.status.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_applied = sqlite3_bind_text(
-		stmt,
-		6,
-		application.applied_date.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_update = sqlite3_bind_text(
-		stmt,
-		7,
-		application.last_update.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
-	const int rc_bind_notes = sqlite3_bind_text(
-		stmt,
-		8,
-		application.notes.c_str(),
-		-1,
-		SQLITE_TRANSIENT
-	);
+		sqlite3_stmt *prepared = nullptr;
+		if (sqlite3_prepare_v2(db, sql, -1, &prepared, nullptr) != SQLITE_OK)
+		{
+			throw std::runtime_error("Failed to prepare INSERT statement");
+		}
+		insert_stmt_.reset(prepared);
+	}
+
+	sqlite3_stmt *stmt = insert_stmt_.get();
+
+	const int rc_bind_company = bind_text(stmt, 1, application.company);
+	const int rc_bind_position = bind_text(stmt, 2, application.position);
+	const int rc_bind_location = bind_text(stmt, 3, application.location);
+	const int rc_bind_source = bind_text(stmt, 4, application.source);
+	const int rc_bind_status = bind_text(stmt, 5, application.status);
+	const int rc_bind_applied = bind_text(stmt, 6, application.applied_date);
+	const int rc_bind_update = bind_text(stmt, 7, application.last_update);
+	const int rc_bind_notes = bind_text(stmt, 8, application.notes);
 
 	if (rc_bind_company != SQLITE_OK ||
 		rc_bind_position != SQLITE_OK ||
@@ -155,22 +177,22 @@ Application SqliteApplicationRepository::insert(const Application &application)
 		rc_bind_update != SQLITE_OK ||
 		rc_bind_notes != SQLITE_OK)
 	{
-		sqlite3_finalize(stmt);
+		sqlite3_clear_bindings(stmt);
 		throw std::runtime_error("Failed to bind INSERT parameters");
 	}
 
 	const int rc_step = sqlite3_step(stmt);
+
+	// Make the statement reusable and drop pointers into the caller's strings.
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
 	if (rc_step != SQLITE_DONE)
 	{
-		sqlite3_finalize(stmt);
 		throw std::runtime_error("Failed to execute INSERT statement");
 	}
 
-	sqlite3_finalize(stmt);
-
-	Application stored = application;
-	stored.id = static_cast<int>(sqlite3_last_insert_rowid(db));
-	return stored;
+	return static_cast<int>(sqlite3_last_insert_rowid(db));
 }
 
 bool SqliteApplicationRepository::update(const Application &application)
@@ -195,14 +217,14 @@ bool SqliteApplicationRepository::update(const Application &application)
 		throw std::runtime_error("Failed to prepare UPDATE statement");
 	}
 
-	sqlite3_bind_text(stmt, 1, application.company.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 2, application.position.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 3, application.location.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 4, application.source.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 5, application.status.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 6, application.applied_date.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 7, application.last_update.c_str(), -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 8, application.notes.c_str(), -1, SQLITE_TRANSIENT);
+	bind_text(stmt, 1, application.company);
+	bind_text(stmt, 2, application.position);
+	bind_text(stmt, 3, application.location);
+	bind_text(stmt, 4, application.source);
+	bind_text(stmt, 5, application.status);
+	bind_text(stmt, 6, application.applied_date);
+	bind_text(stmt, 7, application.last_update);
+	bind_text(stmt, 8, application.notes);
 	sqlite3_bind_int(stmt, 9, application.id);
 
 	const int rc_step = sqlite3_step(stmt);
@@ -220,29 +242,54 @@ bool SqliteApplicationRepository::update(const Application &application)
 
 bool SqliteApplicationRepository::remove(int id)
 {
-	const char *sql = "DELETE FROM applications WHERE id = ?;";
-
 	sqlite3 *db = database_.handle();
-	sqlite3_stmt *stmt = nullptr;
 
-	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	// Run one DELETE by id and return the number of deleted rows.
+	const auto delete_by_id = [db, id](const char *sql)
 	{
-		throw std::runtime_error("Failed to prepare DELETE statement");
-	}
+		sqlite3_stmt *stmt = nullptr;
+		if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+		{
+			throw std::runtime_error("Failed to prepare DELETE statement");
+		}
 
-	sqlite3_bind_int(stmt, 1, id);
+		sqlite3_bind_int(stmt, 1, id);
 
-	const int rc_step = sqlite3_step(stmt);
-	if (rc_step != SQLITE_DONE)
-	{
+		const int rc_step = sqlite3_step(stmt);
 		sqlite3_finalize(stmt);
-		throw std::runtime_error("Failed to execute DELETE statement");
+		if (rc_step != SQLITE_DONE)
+		{
+			throw std::runtime_error("Failed to execute DELETE statement");
+		}
+		return sqlite3_changes(db);
+	};
+
+	const bool own_transaction = sqlite3_get_autocommit(db) != 0;
+	if (own_transaction)
+	{
+		begin_transaction();
 	}
 
-	const int changes = sqlite3_changes(db);
-	sqlite3_finalize(stmt);
+	try
+	{
+		const int changes = delete_by_id("DELETE FROM applications WHERE id = ?;");
+		// A later import with skip-known may bring the application back.
+		delete_by_id("DELETE FROM import_fingerprints WHERE application_id = ?;");
 
-	return changes > 0;
+		if (own_transaction)
+		{
+			commit_transaction();
+		}
+		return changes > 0;
+	}
+	catch (...)
+	{
+		if (own_transaction)
+		{
+			rollback_transaction();
+		}
+		throw;
+	}
 }
 
 std::vector<Application> SqliteApplicationRepository::find_all()
@@ -335,7 +382,7 @@ std::vector<Application> SqliteApplicationRepository::find_by_status(const std::
 		throw std::runtime_error("Failed to prepare SELECT by status statement");
 	}
 
-	sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_TRANSIENT);
+	bind_text(stmt, 1, status);
 
 	std::vector<Application> result;
 
@@ -405,3 +452,340 @@ Statistics SqliteApplicationRepository::compute_statistics()
 	sqlite3_finalize(stmt);
 	return stats;
 }
+
+void SqliteApplicationRepository::begin_transaction()
+{
+	database_.execute_non_query("BEGIN IMMEDIATE;");
+}
+
+void SqliteApplicationRepository::commit_transaction()
+{
+	database_.execute_non_query("COMMIT;");
+}
+
+void SqliteApplicationRepository::rollback_transaction()
+{
+	database_.execute_non_query("ROLLBACK;");
+}
+
+std::optional<ImportCheckpoint> SqliteApplicationRepository::find_checkpoint(const std::string &source)
+{
+	const char *sql =
+		"SELECT source, source_size, source_mtime, byte_offset, rows_committed "
+		"FROM import_checkpoints "
+		"WHERE source = ?;";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare SELECT checkpoint statement");
+	}
+
+	bind_text(stmt, 1, source);
+
+	const int rc_step = sqlite3_step(stmt);
+	if (rc_step == SQLITE_ROW)
+	{
+		ImportCheckpoint checkpoint;
+		checkpoint.source = source;
+		checkpoint.source_size = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 1));
+		checkpoint.source_mtime = sqlite3_column_int64(stmt, 2);
+		checkpoint.offset = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 3));
+		checkpoint.rows_committed = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 4));
+		sqlite3_finalize(stmt);
+		return checkpoint;
+	}
+	if (rc_step == SQLITE_DONE)
+	{
+		sqlite3_finalize(stmt);
+		return std::nullopt;
+	}
+
+	sqlite3_finalize(stmt);
+	throw std::runtime_error("Failed to execute SELECT checkpoint statement");
+}
+
+void SqliteApplicationRepository::save_checkpoint(const ImportCheckpoint &checkpoint)
+{
+	const char *sql =
+		"INSERT OR REPLACE INTO import_checkpoints ("
+		"  source, source_size, source_mtime, byte_offset, rows_committed"
+		") VALUES (?, ?, ?, ?, ?);";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare checkpoint statement");
+	}
+
+	bind_text(stmt, 1, checkpoint.source);
+	sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(checkpoint.source_size));
+	sqlite3_bind_int64(stmt, 3, checkpoint.source_mtime);
+	sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(checkpoint.offset));
+	sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(checkpoint.rows_committed));
+
+	const int rc_step = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	if (rc_step != SQLITE_DONE)
+	{
+		throw std::runtime_error("Failed to execute checkpoint statement");
+	}
+}
+
+std::vector<std::uint64_t> SqliteApplicationRepository::load_fingerprints()
+{
+	const char *sql = "SELECT fingerprint FROM import_fingerprints;";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare SELECT fingerprints statement");
+	}
+
+	std::vector<std::uint64_t> fingerprints;
+	int rc_step = SQLITE_ROW;
+	while ((rc_step = sqlite3_step(stmt)) == SQLITE_ROW)
+	{
+		// Fingerprints are stored as the signed 64-bit integer with the same bits.
+		fingerprints.push_back(static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 0)));
+	}
+
+	sqlite3_finalize(stmt);
+
+	if (rc_step != SQLITE_DONE)
+	{
+		throw std::runtime_error("Failed to execute SELECT fingerprints statement");
+	}
+	return fingerprints;
+}
+
+std::vector<std::uint64_t> SqliteApplicationRepository::find_fingerprints(const std::vector<std::uint64_t> &fingerprints)
+{
+	const char *sql = "SELECT 1 FROM import_fingerprints WHERE fingerprint = ?;";
+
+	std::vector<std::uint64_t> found;
+	if (fingerprints.empty())
+	{
+		return found;
+	}
+
+	if (!fingerprint_select_stmt_)
+	{
+		sqlite3_stmt *prepared = nullptr;
+		if (sqlite3_prepare_v2(database_.handle(), sql, -1, &prepared, nullptr) != SQLITE_OK)
+		{
+			throw std::runtime_error("Failed to prepare SELECT fingerprint statement");
+		}
+		fingerprint_select_stmt_.reset(prepared);
+	}
+
+	// An autocommit statement takes and drops the file lock every time; one read transaction takes it once.
+	const bool own_transaction = sqlite3_get_autocommit(database_.handle()) != 0;
+	if (own_transaction)
+	{
+		database_.execute_non_query("BEGIN;");
+	}
+
+	sqlite3_stmt *stmt = fingerprint_select_stmt_.get();
+	int rc_step = SQLITE_DONE;
+	for (const std::uint64_t fingerprint : fingerprints)
+	{
+		sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(fingerprint));
+		rc_step = sqlite3_step(stmt);
+		sqlite3_reset(stmt);
+
+		if (rc_step == SQLITE_ROW)
+		{
+			found.push_back(fingerprint);
+		}
+		else if (rc_step != SQLITE_DONE)
+		{
+			break;
+		}
+	}
+
+	if (own_transaction)
+	{
+		database_.execute_non_query("COMMIT;");
+	}
+
+	if (rc_step != SQLITE_ROW && rc_step != SQLITE_DONE)
+	{
+		throw std::runtime_error("Failed to execute SELECT fingerprint statement");
+	}
+	return found;
+}
+
+void SqliteApplicationRepository::save_fingerprints(const std::vector<std::uint64_t> &fingerprints, const std::vector<int> &application_ids)
+{
+	const char *sql = "INSERT OR IGNORE INTO import_fingerprints (fingerprint, application_id) VALUES (?, ?);";
+
+	if (application_ids.size() != fingerprints.size())
+	{
+		throw std::runtime_error("save_fingerprints needs one application id per fingerprint");
+	}
+
+	if (!fingerprint_insert_stmt_)
+	{
+		sqlite3_stmt *prepared = nullptr;
+		if (sqlite3_prepare_v2(database_.handle(), sql, -1, &prepared, nullptr) != SQLITE_OK)
+		{
+			throw std::runtime_error("Failed to prepare fingerprint statement");
+		}
+		fingerprint_insert_stmt_.reset(prepared);
+	}
+
+	sqlite3_stmt *stmt = fingerprint_insert_stmt_.get();
+	for (std::size_t i = 0; i < fingerprints.size(); ++i)
+	{
+		sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(fingerprints[i]));
+		sqlite3_bind_int(stmt, 2, application_ids[i]);
+		const int rc_step = sqlite3_step(stmt);
+		sqlite3_reset(stmt);
+
+		if (rc_step != SQLITE_DONE)
+		{
+			throw std::runtime_error("Failed to execute fingerprint statement");
+		}
+	}
+}
+
+DatabaseMergeResult SqliteApplicationRepository::merge_database(const std::string &source_path)
+{
+	// ATTACH creates missing files; a typo must not merge an empty database.
+	std::error_code error;
+	if (!std::filesystem::is_regular_file(source_path, error))
+	{
+		throw std::runtime_error("Source database '" + source_path + "' does not exist");
+	}
+
+	sqlite3 *db = database_.handle();
+
+	sqlite3_stmt *attach = nullptr;
+	if (sqlite3_prepare_v2(db, "ATTACH DATABASE ? AS merge_source;", -1, &attach, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare ATTACH statement");
+	}
+	bind_text(attach, 1, source_path);
+	const int rc_attach = sqlite3_step(attach);
+	sqlite3_finalize(attach);
+	if (rc_attach != SQLITE_DONE)
+	{
+		throw std::runtime_error("Failed to attach source database '" + source_path + "': " + sqlite3_errmsg(db));
+	}
+
+	DatabaseMergeResult result;
+	bool in_transaction = false;
+
+	try
+	{
+		const auto has_table = [db](const char *sql)
+		{
+			return query_int64(db, sql) > 0;
+		};
+
+		if (!has_table("SELECT COUNT(*) FROM merge_source.sqlite_master WHERE type = 'table' AND name = 'applications';"))
+		{
+			throw std::runtime_error("'" + source_path + "' is not a jobtracker database");
+		}
+
+		database_.execute_non_query("BEGIN IMMEDIATE;");
+		in_transaction = true;
+
+		// Natural keys of the stored rows; the first row of every key wins.
+		// Applied dates may be NULL, which a WITHOUT ROWID key does not accept.
+		database_.execute_non_query(
+			"CREATE TEMP TABLE merge_keys ("
+			"  company TEXT COLLATE NOCASE NOT NULL,"
+			"  position TEXT COLLATE NOCASE NOT NULL,"
+			"  applied_date TEXT NOT NULL,"
+			"  row_id INTEGER NOT NULL,"
+			"  PRIMARY KEY (company, position, applied_date)"
+			") WITHOUT ROWID;"
+			"INSERT OR IGNORE INTO temp.merge_keys "
+			"  SELECT company, position, IFNULL(applied_date, ''), id FROM main.applications ORDER BY id;");
+
+		// Source rows with a new key are entered with their negated id, so
+		// repeats within the source collapse onto their first occurrence.
+		database_.execute_non_query(
+			"INSERT OR IGNORE INTO temp.merge_keys "
+			"  SELECT company, position, IFNULL(applied_date, ''), -id FROM merge_source.applications ORDER BY id;"
+			"CREATE TEMP TABLE merge_new (source_id INTEGER PRIMARY KEY);"
+			"INSERT INTO temp.merge_new SELECT -row_id FROM temp.merge_keys WHERE row_id < 0;");
+
+		const std::int64_t last_id_before = query_int64(db, "SELECT IFNULL(MAX(id), 0) FROM main.applications;");
+
+		// Walking merge_new in key order inserts in source id order, so new
+		// ids continue this database's sequence in the order of the source.
+		database_.execute_non_query(
+			"INSERT INTO main.applications ("
+			"  company, position, location, source, status, applied_date, last_update, notes"
+			") SELECT s.company, s.position, s.location, s.source, s.status, s.applied_date, s.last_update, s.notes "
+			"  FROM temp.merge_new n JOIN merge_source.applications s ON s.id = n.source_id "
+			"  ORDER BY n.source_id;");
+		result.imported = static_cast<std::size_t>(sqlite3_changes(db));
+
+		if (has_table("SELECT COUNT(*) FROM merge_source.sqlite_master WHERE type = 'table' AND name = 'import_fingerprints';"))
+		{
+			// Point every key at the row now holding it, so fingerprints follow their record.
+			database_.execute_non_query(
+				"DELETE FROM temp.merge_keys WHERE row_id < 0;"
+				"INSERT OR IGNORE INTO temp.merge_keys "
+				"  SELECT company, position, IFNULL(applied_date, ''), id FROM main.applications "
+				"  WHERE id > " + std::to_string(last_id_before) + " ORDER BY id;");
+
+			// Fingerprint tables of older versions have no application ids; those stay unlinked.
+			if (has_table("SELECT COUNT(*) FROM pragma_table_info('import_fingerprints', 'merge_source') WHERE name = 'application_id';"))
+			{
+				database_.execute_non_query(
+					"INSERT OR IGNORE INTO main.import_fingerprints (fingerprint, application_id) "
+					"  SELECT f.fingerprint, k.row_id FROM merge_source.import_fingerprints f "
+					"  LEFT JOIN merge_source.applications s ON s.id = f.application_id "
+					"  LEFT JOIN temp.merge_keys k "
+					"    ON k.company = s.company AND k.position = s.position AND k.applied_date = IFNULL(s.applied_date, '');");
+			}
+			else
+			{
+				database_.execute_non_query(
+					"INSERT OR IGNORE INTO main.import_fingerprints (fingerprint) SELECT fingerprint FROM merge_source.import_fingerprints;");
+			}
+		}
+
+		result.source_rows = static_cast<std::size_t>(query_int64(db, "SELECT COUNT(*) FROM merge_source.applications;"));
+		result.duplicates = result.source_rows - result.imported;
+
+		database_.execute_non_query("COMMIT;");
+		in_transaction = false;
+		database_.execute_non_query("DROP TABLE temp.merge_keys; DROP TABLE temp.merge_new; DETACH DATABASE merge_source;");
+	}
+	catch (...)
+	{
+		// Best effort: leave the connection as it was before the merge.
+		if (in_transaction)
+		{
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		}
+		sqlite3_exec(db, "DROP TABLE IF EXISTS temp.merge_keys; DROP TABLE IF EXISTS temp.merge_new;", nullptr, nullptr, nullptr);
+		sqlite3_exec(db, "DETACH DATABASE merge_source;", nullptr, nullptr, nullptr);
+		throw;
+	}
+
+	return result;
+}
+
+SqliteDatabase &SqliteApplicationRepository::database()
+{
+	return database_;
+}
+
+void SqliteApplicationRepository::StatementFinalizer::operator()(sqlite3_stmt *stmt) const
+{
+	sqlite3_finalize(stmt);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -9,6 +11,21 @@
 #include "storage/application_repository.h"
 #include "storage/sqlite_database.h"
 
+/**
+ * @brief Counts of a merge of another jobtracker database (see SqliteApplicationRepository::merge_database).
+ */
+struct DatabaseMergeResult
+{
+	/// Number of applications in the source database.
+	std::size_t source_rows = 0;
+
+	/// Number of applications inserted under new ids.
+	std::size_t imported = 0;
+
+	/// Number of source applications whose natural key was already present.
+	std::size_t duplicates = 0;
+};
+
 /**
  * @brief SQLite-based implementation of IApplicationRepository.
  *
@@ -33,6 +50,14 @@ class SqliteApplicationRepository : public IApplicationRepository
 	 */
 	Application insert(const Application &application) override;
 
+	/**
+	 * @brief Insert a new application and move it into the returned entity.
+	 *
+	 * @param application Application to insert. Its id field may be 0.
+	 * @return The moved-in Application with its assigned id.
+	 */
+	Application insert(Application &&application) override;
+
 	/**
 	 * @brief Update an existing application.
 	 *
@@ -42,7 +67,9 @@ class SqliteApplicationRepository : public IApplicationRepository
 	bool update(const Application &application) override;
 
 	/**
-	 * @brief Remove an application by id.
+	 * @brief Remove an application by id, together with its import fingerprints.
+	 *
+	 * Both deletes run in one transaction, or in the caller's if one is open.
 	 *
 	 * @param id Primary key of the application to remove.
 	 * @return true if a row was deleted; false if no matching id existed.
@@ -79,17 +106,139 @@ class SqliteApplicationRepository : public IApplicationRepository
 	 */
 	Statistics compute_statistics() override;
 
+	/**
+	 * @brief Begin an immediate SQLite transaction.
+	 *
+	 * @throws std::runtime_error if the transaction cannot be started.
+	 */
+	void begin_transaction() override;
+
+	/**
+	 * @brief Commit the current SQLite transaction.
+	 *
+	 * @throws std::runtime_error if the commit fails.
+	 */
+	void commit_transaction() override;
+
+	/**
+	 * @brief Roll back the current SQLite transaction.
+	 *
+	 * @throws std::runtime_error if the rollback fails.
+	 */
+	void rollback_transaction() override;
+
+	/**
+	 * @brief Look up the checkpoint stored for an import source.
+	 *
+	 * @param source Source identity (see ImportCheckpoint::source).
+	 * @return The stored checkpoint; std::nullopt if there is none.
+	 */
+	std::optional<ImportCheckpoint> find_checkpoint(const std::string &source) override;
+
+	/**
+	 * @brief Insert or replace the checkpoint row of an import source.
+	 *
+	 * @param checkpoint Checkpoint to store.
+	 *
+	 * @throws std::runtime_error if the row cannot be written.
+	 */
+	void save_checkpoint(const ImportCheckpoint &checkpoint) override;
+
+	/**
+	 * @brief Read every row of the fingerprint table.
+	 *
+	 * @throws std::runtime_error if the table cannot be read.
+	 */
+	std::vector<std::uint64_t> load_fingerprints() override;
+
+	/**
+	 * @brief Look fingerprints up through the primary key of the fingerprint table.
+	 *
+	 * Outside a transaction, all lookups share one read transaction, so the
+	 * database file is locked once rather than once per fingerprint.
+	 *
+	 * @throws std::runtime_error if a lookup fails.
+	 */
+	std::vector<std::uint64_t> find_fingerprints(const std::vector<std::uint64_t> &fingerprints) override;
+
+	/**
+	 * @brief Insert fingerprints with their application ids, ignoring those already stored.
+	 *
+	 * @throws std::runtime_error if a row cannot be written.
+	 */
+	void save_fingerprints(const std::vector<std::uint64_t> &fingerprints, const std::vector<int> &application_ids) override;
+
+	/**
+	 * @brief Merge the applications of another jobtracker database into this one.
+	 *
+	 * The source is ATTACHed to this connection and copied with set-based
+	 * INSERT ... SELECT statements inside one transaction, so rows never pass
+	 * through Application objects. Applications are deduplicated on their
+	 * natural key: company and position (case-insensitive) plus applied date.
+	 * A source row whose key is already stored, or repeats an earlier source
+	 * row, is skipped. Source ids are not kept: new rows continue this
+	 * database's id sequence in source id order. Stored fingerprints of the
+	 * source (see save_fingerprints) are merged as well, linked to the
+	 * application that now holds their record's natural key.
+	 *
+	 * Must not be called inside a transaction.
+	 *
+	 * @param source_path Path to the other database file.
+	 * @return Counts of merged and skipped applications.
+	 *
+	 * @throws std::runtime_error if the source does not exist, is not a
+	 *         jobtracker database, or the merge fails; nothing is merged then.
+	 */
+	DatabaseMergeResult merge_database(const std::string &source_path);
+
+	/**
+	 * @brief Underlying connection, for SQL that runs next to the repository
+	 *        (e.g. registering virtual tables).
+	 */
+	SqliteDatabase &database();
+
 private:
+	/**
+	 * @brief Deleter that finalizes cached prepared statements.
+	 */
+	struct StatementFinalizer
+	{
+		void operator()(sqlite3_stmt *stmt) const;
+	};
+
 	/// Low-level SQLite database wrapper that manages the connection handle.
 	SqliteDatabase database_;
 
+	/// Cached INSERT statement, prepared on first use and reused for every row.
+	/// Declared after database_ so it is finalized before the connection closes.
+	std::unique_ptr<sqlite3_stmt, StatementFinalizer> insert_stmt_;
+
+	/// Cached fingerprint lookup, prepared on first use.
+	std::unique_ptr<sqlite3_stmt, StatementFinalizer> fingerprint_select_stmt_;
+
+	/// Cached fingerprint insert, prepared on first use.
+	std::unique_ptr<sqlite3_stmt, StatementFinalizer> fingerprint_insert_stmt_;
+
 	/**
 	 * @brief Ensure that the required database schema exists.
 	 *
-	 * This method creates tables and indexes if they are missing.
+	 * This method creates tables and indexes if they are missing, and adds
+	 * columns that databases created by older versions lack.
 	 */
 	void ensure_schema();
 
+	/**
+	 * @brief Execute the INSERT statement for the given application.
+	 *
+	 * Text parameters are bound with SQLITE_STATIC, so the application must
+	 * stay alive until this call returns. The statement is prepared once and
+	 * reset after every row.
+	 *
+	 * @param application Application whose fields are bound to the statement.
+	 * @return Row id assigned by SQLite.
+	 */
+	int insert_row(const Application &application);
+
 	/**
 	 * @brief Map the current row of a prepared SQLite statement to an Application object.
 	 *
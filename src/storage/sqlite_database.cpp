@@ -18,6 +18,10 @@ SqliteDatabase::SqliteDatabase(const std::string &path)
 		db_ = nullptr;
 		throw std::runtime_error(message);
 	}
+
+	// Other connections to the same file (e.g. the feed state store) may be
+	// committing concurrently; wait for their locks instead of failing.
+	sqlite3_busy_timeout(db_, 5000);
 }
 
 SqliteDatabase::~SqliteDatabase()
@@ -76,3 +80,8 @@ void SqliteDatabase::execute_non_query(const std::string &sql)
 		throw std::runtime_error(message);
 	}
 }
+
+int bind_text(sqlite3_stmt *stmt, int index, const std::string &value)
+{
+	return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
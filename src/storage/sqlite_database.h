@@ -4,6 +4,7 @@
 #include <stdexcept>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 /**
  * @brief RAII wrapper around a SQLite database connection.
@@ -74,3 +75,16 @@ class SqliteDatabase
 	/// Underlying sqlite3 database handle, or nullptr if not open.
 	sqlite3 *db_ = nullptr;
 };
+
+/**
+ * @brief Bind a string parameter without letting SQLite copy it.
+ *
+ * Uses SQLITE_STATIC, so the string must stay alive until the statement is
+ * stepped and finalized; the explicit length spares SQLite a strlen() call.
+ *
+ * @param stmt  Prepared statement.
+ * @param index 1-based parameter index.
+ * @param value String to bind.
+ * @return SQLite result code of sqlite3_bind_text().
+ */
+int bind_text(sqlite3_stmt *stmt, int index, const std::string &value);
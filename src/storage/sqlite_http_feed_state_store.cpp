@@ -0,0 +1,107 @@
+/// \file
+/// \brief SQLite-based implementation of IHttpFeedStateStore.
+
+#include "storage/sqlite_http_feed_state_store.h"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+	/**
+	 * @brief Read a text column, mapping NULL to an empty string.
+	 */
+	std::string column_string(sqlite3_stmt *stmt, int index)
+	{
+		const auto *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, index));
+		return text != nullptr ? std::string(text) : std::string();
+	}
+}
+
+SqliteHttpFeedStateStore::SqliteHttpFeedStateStore(const std::string &database_path)
+	: database_(database_path)
+{
+	database_.execute_non_query(
+		"CREATE TABLE IF NOT EXISTS http_feed_state ("
+		"  url TEXT PRIMARY KEY,"
+		"  etag TEXT,"
+		"  last_modified TEXT,"
+		"  imported_length INTEGER NOT NULL,"
+		"  header_line TEXT"
+		");");
+}
+
+std::optional<HttpFeedState> SqliteHttpFeedStateStore::find(const std::string &url)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const char *sql =
+		"SELECT etag, last_modified, imported_length, header_line "
+		"FROM http_feed_state "
+		"WHERE url = ?;";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare SELECT feed state statement");
+	}
+
+	bind_text(stmt, 1, url);
+
+	const int rc_step = sqlite3_step(stmt);
+	if (rc_step == SQLITE_ROW)
+	{
+		HttpFeedState state;
+		state.url = url;
+		state.etag = column_string(stmt, 0);
+		state.last_modified = column_string(stmt, 1);
+		state.imported_length = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 2));
+		state.header_line = column_string(stmt, 3);
+		sqlite3_finalize(stmt);
+		return state;
+	}
+	if (rc_step == SQLITE_DONE)
+	{
+		sqlite3_finalize(stmt);
+		return std::nullopt;
+	}
+
+	sqlite3_finalize(stmt);
+	throw std::runtime_error("Failed to execute SELECT feed state statement");
+}
+
+void SqliteHttpFeedStateStore::save(const HttpFeedState &state)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const char *sql =
+		"INSERT OR REPLACE INTO http_feed_state ("
+		"  url, etag, last_modified, imported_length, header_line"
+		") VALUES (?, ?, ?, ?, ?);";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare feed state statement");
+	}
+
+	bind_text(stmt, 1, state.url);
+	bind_text(stmt, 2, state.etag);
+	bind_text(stmt, 3, state.last_modified);
+	sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(state.imported_length));
+	bind_text(stmt, 5, state.header_line);
+
+	const int rc_step = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	if (rc_step != SQLITE_DONE)
+	{
+		throw std::runtime_error("Failed to execute feed state statement");
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "storage/http_feed_state_store.h"
+#include "storage/sqlite_database.h"
+
+/**
+ * @brief SQLite-based implementation of IHttpFeedStateStore.
+ *
+ * Keeps one row per feed URL in the http_feed_state table. The store opens
+ * its own connection, so it can share a database file with
+ * SqliteApplicationRepository. Calls are serialized, so sources importing
+ * concurrently may share one store.
+ */
+class SqliteHttpFeedStateStore : public IHttpFeedStateStore
+{
+public:
+	/**
+	 * @brief Open (or create) a SQLite database at the given path and ensure the table exists.
+	 *
+	 * @param database_path Path to the SQLite database file. Use ":memory:" for tests.
+	 */
+	explicit SqliteHttpFeedStateStore(const std::string &database_path);
+
+	/**
+	 * @brief Look up the state of a feed.
+	 *
+	 * @param url URL of the feed.
+	 * @return The stored state; std::nullopt if there is none.
+	 */
+	std::optional<HttpFeedState> find(const std::string &url) override;
+
+	/**
+	 * @brief Insert or replace the state row of a feed.
+	 *
+	 * @param state State to store.
+	 *
+	 * @throws std::runtime_error if the row cannot be written.
+	 */
+	void save(const HttpFeedState &state) override;
+
+private:
+	/// Low-level SQLite database wrapper that manages the connection handle.
+	SqliteDatabase database_;
+
+	/// Serializes use of the connection.
+	std::mutex mutex_;
+};
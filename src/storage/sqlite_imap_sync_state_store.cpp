@@ -0,0 +1,92 @@
+/// \file
+/// \brief SQLite-based implementation of IImapSyncStateStore.
+
+#include "storage/sqlite_imap_sync_state_store.h"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+SqliteImapSyncStateStore::SqliteImapSyncStateStore(const std::string &database_path)
+	: database_(database_path)
+{
+	database_.execute_non_query(
+		"CREATE TABLE IF NOT EXISTS imap_sync_state ("
+		"  mailbox_key TEXT PRIMARY KEY,"
+		"  uid_validity INTEGER NOT NULL,"
+		"  uid_next INTEGER NOT NULL,"
+		"  highest_modseq INTEGER NOT NULL"
+		");");
+}
+
+std::optional<ImapMailboxState> SqliteImapSyncStateStore::find(const std::string &mailbox_key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const char *sql =
+		"SELECT uid_validity, uid_next, highest_modseq "
+		"FROM imap_sync_state "
+		"WHERE mailbox_key = ?;";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare SELECT IMAP sync state statement");
+	}
+
+	bind_text(stmt, 1, mailbox_key);
+
+	const int rc_step = sqlite3_step(stmt);
+	if (rc_step == SQLITE_ROW)
+	{
+		ImapMailboxState state;
+		state.mailbox_key = mailbox_key;
+		state.uid_validity = static_cast<std::uint32_t>(sqlite3_column_int64(stmt, 0));
+		state.uid_next = static_cast<std::uint32_t>(sqlite3_column_int64(stmt, 1));
+		state.highest_modseq = static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 2));
+		sqlite3_finalize(stmt);
+		return state;
+	}
+	if (rc_step == SQLITE_DONE)
+	{
+		sqlite3_finalize(stmt);
+		return std::nullopt;
+	}
+
+	sqlite3_finalize(stmt);
+	throw std::runtime_error("Failed to execute SELECT IMAP sync state statement");
+}
+
+void SqliteImapSyncStateStore::save(const ImapMailboxState &state)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const char *sql =
+		"INSERT OR REPLACE INTO imap_sync_state ("
+		"  mailbox_key, uid_validity, uid_next, highest_modseq"
+		") VALUES (?, ?, ?, ?);";
+
+	sqlite3 *db = database_.handle();
+	sqlite3_stmt *stmt = nullptr;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		throw std::runtime_error("Failed to prepare IMAP sync state statement");
+	}
+
+	bind_text(stmt, 1, state.mailbox_key);
+	sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(state.uid_validity));
+	sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(state.uid_next));
+	sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(state.highest_modseq));
+
+	const int rc_step = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	if (rc_step != SQLITE_DONE)
+	{
+		throw std::runtime_error("Failed to execute IMAP sync state statement");
+	}
+}
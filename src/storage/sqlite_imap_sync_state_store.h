@@ -0,0 +1,50 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "storage/imap_sync_state_store.h"
+#include "storage/sqlite_database.h"
+
+/**
+ * @brief SQLite-based implementation of IImapSyncStateStore.
+ *
+ * Keeps one row per mailbox in the imap_sync_state table. The store opens
+ * its own connection, so it can share a database file with
+ * SqliteApplicationRepository. Calls are serialized.
+ */
+class SqliteImapSyncStateStore : public IImapSyncStateStore
+{
+public:
+	/**
+	 * @brief Open (or create) a SQLite database at the given path and ensure the table exists.
+	 *
+	 * @param database_path Path to the SQLite database file. Use ":memory:" for tests.
+	 */
+	explicit SqliteImapSyncStateStore(const std::string &database_path);
+
+	/**
+	 * @brief Look up the state of a mailbox.
+	 *
+	 * @param mailbox_key Account and mailbox key.
+	 * @return The stored state; std::nullopt if there is none.
+	 */
+	std::optional<ImapMailboxState> find(const std::string &mailbox_key) override;
+
+	/**
+	 * @brief Insert or replace the state row of a mailbox.
+	 *
+	 * @param state State to store.
+	 *
+	 * @throws std::runtime_error if the row cannot be written.
+	 */
+	void save(const ImapMailboxState &state) override;
+
+private:
+	/// Low-level SQLite database wrapper that manages the connection handle.
+	SqliteDatabase database_;
+
+	/// Serializes use of the connection.
+	std::mutex mutex_;
+};
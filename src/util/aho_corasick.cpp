@@ -0,0 +1,129 @@
+/// \file
+/// \brief Construction of the Aho-Corasick automaton.
+
+#include "util/aho_corasick.h"
+
+#include <cctype>
+#include <cstdint>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+AhoCorasick::AhoCorasick(const std::vector<std::string> &patterns)
+	: pattern_count_(patterns.size())
+{
+	// Case-fold and assign one input class per distinct pattern byte.
+	for (const auto &pattern : patterns)
+	{
+		for (const char c : pattern)
+		{
+			const auto lower = static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+			if (byte_class_[lower] == 0)
+			{
+				byte_class_[lower] = static_cast<std::uint16_t>(class_count_++);
+			}
+		}
+	}
+	for (int c = 0; c < 256; ++c)
+	{
+		const auto lower = static_cast<unsigned char>(std::tolower(c));
+		byte_class_[static_cast<std::size_t>(c)] = byte_class_[lower];
+	}
+
+	// Trie of the patterns; missing edges are marked with `none`.
+	constexpr std::uint32_t none = UINT32_MAX;
+	std::vector<std::uint32_t> trie(class_count_, none);
+	std::vector<std::vector<std::uint32_t>> matches(1);
+
+	for (std::size_t index = 0; index < patterns.size(); ++index)
+	{
+		if (patterns[index].empty())
+		{
+			continue;
+		}
+
+		std::uint32_t state = 0;
+		for (const char c : patterns[index])
+		{
+			const std::size_t edge = state * class_count_ + byte_class_[static_cast<unsigned char>(c)];
+			if (trie[edge] == none)
+			{
+				trie[edge] = static_cast<std::uint32_t>(matches.size());
+				trie.resize(trie.size() + class_count_, none);
+				matches.emplace_back();
+			}
+			state = trie[edge];
+		}
+		matches[state].push_back(static_cast<std::uint32_t>(index));
+	}
+
+	// Breadth-first, turn the trie into a DFA: a missing edge leads where the
+	// failure link (the longest proper suffix that is also a trie path) would.
+	const std::size_t state_count = matches.size();
+	std::vector<std::uint32_t> failure(state_count, 0);
+	std::queue<std::uint32_t> pending;
+
+	for (std::size_t c = 0; c < class_count_; ++c)
+	{
+		if (trie[c] == none)
+		{
+			trie[c] = 0;
+		}
+		else
+		{
+			pending.push(trie[c]);
+		}
+	}
+
+	while (!pending.empty())
+	{
+		const std::uint32_t state = pending.front();
+		pending.pop();
+
+		// Patterns ending at the failure state also end here.
+		const auto &inherited = matches[failure[state]];
+		matches[state].insert(matches[state].end(), inherited.begin(), inherited.end());
+
+		for (std::size_t c = 0; c < class_count_; ++c)
+		{
+			const std::size_t edge = state * class_count_ + c;
+			const std::uint32_t fallback = trie[failure[state] * class_count_ + c];
+			if (trie[edge] == none)
+			{
+				trie[edge] = fallback;
+			}
+			else
+			{
+				failure[trie[edge]] = fallback;
+				pending.push(trie[edge]);
+			}
+		}
+	}
+
+	if (state_count * class_count_ >= match_flag)
+	{
+		throw std::length_error("Aho-Corasick automaton too large");
+	}
+
+	// Store row offsets instead of state numbers, and flag accepting targets,
+	// so scanning needs neither a multiplication nor an output lookup per byte.
+	transitions_ = std::move(trie);
+	for (auto &target : transitions_)
+	{
+		const bool accepting = !matches[target].empty();
+		target = static_cast<std::uint32_t>(target * class_count_) | (accepting ? match_flag : 0U);
+	}
+
+	output_begin_.reserve(state_count + 1);
+	for (const auto &state_matches : matches)
+	{
+		output_begin_.push_back(static_cast<std::uint32_t>(outputs_.size()));
+		outputs_.insert(outputs_.end(), state_matches.begin(), state_matches.end());
+	}
+	output_begin_.push_back(static_cast<std::uint32_t>(outputs_.size()));
+}
+
+std::size_t AhoCorasick::pattern_count() const
+{
+	return pattern_count_;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Finds many fixed strings in a text in one pass (Aho-Corasick).
+ *
+ * The patterns are compiled into a deterministic automaton: scanning costs
+ * one table lookup per input byte, however many patterns there are. Matching
+ * ignores ASCII case. Bytes that occur in no pattern share one input class,
+ * which keeps the transition table small.
+ */
+class AhoCorasick
+{
+public:
+	/**
+	 * @brief Compile the patterns.
+	 *
+	 * @param patterns Strings to find; empty patterns never match.
+	 *
+	 * @throws std::length_error if the automaton would not fit its 31-bit state table.
+	 */
+	explicit AhoCorasick(const std::vector<std::string> &patterns);
+
+	/**
+	 * @brief Number of patterns the automaton was compiled from.
+	 */
+	std::size_t pattern_count() const;
+
+	/**
+	 * @brief Report every occurrence of every pattern in the text.
+	 *
+	 * Overlapping occurrences are all reported, in the order they end.
+	 *
+	 * @param text     Text to scan.
+	 * @param on_match Called as on_match(pattern_index, end_offset) for every
+	 *                 occurrence; end_offset is one past its last byte.
+	 */
+	template <typename OnMatch>
+	void scan(std::string_view text, OnMatch &&on_match) const
+	{
+		std::uint32_t row = 0;
+		for (std::size_t i = 0; i < text.size(); ++i)
+		{
+			const std::uint32_t next = transitions_[row + byte_class_[static_cast<unsigned char>(text[i])]];
+			row = next & ~match_flag;
+			if ((next & match_flag) == 0)
+			{
+				continue;
+			}
+
+			const std::size_t state = row / class_count_;
+			const std::uint32_t end = output_begin_[state + 1];
+			for (std::uint32_t output = output_begin_[state]; output < end; ++output)
+			{
+				on_match(static_cast<std::size_t>(outputs_[output]), i + 1);
+			}
+		}
+	}
+
+private:
+	/// Set in a transition whose target state ends at least one pattern.
+	static constexpr std::uint32_t match_flag = 0x80000000U;
+
+	/// Number of patterns.
+	std::size_t pattern_count_ = 0;
+
+	/// Input class of every byte; 0 for bytes in no pattern.
+	std::array<std::uint16_t, 256> byte_class_{};
+
+	/// Number of input classes.
+	std::size_t class_count_ = 1;
+
+	/// Row offset (state * class_count_) of the next state for every (state,
+	/// input class), row by row; match_flag marks targets that end a pattern.
+	std::vector<std::uint32_t> transitions_;
+
+	/// Start of the outputs of every state in outputs_, plus one end marker.
+	std::vector<std::uint32_t> output_begin_;
+
+	/// Indices of the patterns ending in each state, state by state.
+	std::vector<std::uint32_t> outputs_;
+};
@@ -0,0 +1,73 @@
+/// \file
+/// \brief Sizing and probing of the Bloom filter.
+
+#include "util/bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/// Smallest filter built, so an empty repository still gets a useful filter.
+	constexpr std::uint64_t min_bit_count = 1024;
+
+	/// Upper bound of bits set per key; more only costs time.
+	constexpr unsigned int max_hash_count = 16;
+
+	/**
+	 * @brief Step between the bit positions of a key; odd, so the positions never repeat early.
+	 */
+	std::uint64_t probe_step(std::uint64_t key)
+	{
+		return ((key >> 32) | (key << 32)) | 1;
+	}
+}
+
+BloomFilter::BloomFilter(std::size_t expected_keys, double false_positive_rate)
+{
+	const double keys = static_cast<double>(std::max<std::size_t>(expected_keys, 1));
+	const double rate = std::clamp(false_positive_rate, 1e-9, 0.5);
+	const double ln2 = std::log(2.0);
+
+	// m = -n ln p / (ln 2)^2 bits and k = m/n ln 2 hashes minimise the false-positive rate.
+	const double bits = std::ceil(-keys * std::log(rate) / (ln2 * ln2));
+	bit_count_ = std::max(min_bit_count, static_cast<std::uint64_t>(bits));
+	hash_count_ = std::clamp(static_cast<unsigned int>(std::lround(static_cast<double>(bit_count_) / keys * ln2)), 1u, max_hash_count);
+	words_.assign(static_cast<std::size_t>((bit_count_ + 63) / 64), 0);
+}
+
+void BloomFilter::insert(std::uint64_t key)
+{
+	const std::uint64_t step = probe_step(key);
+	for (unsigned int i = 0; i < hash_count_; ++i)
+	{
+		const std::uint64_t bit = key % bit_count_;
+		words_[bit / 64] |= std::uint64_t{1} << (bit % 64);
+		key += step;
+	}
+}
+
+bool BloomFilter::may_contain(std::uint64_t key) const
+{
+	const std::uint64_t step = probe_step(key);
+	for (unsigned int i = 0; i < hash_count_; ++i)
+	{
+		const std::uint64_t bit = key % bit_count_;
+		if ((words_[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0)
+		{
+			return false;
+		}
+		key += step;
+	}
+	return true;
+}
+
+std::size_t BloomFilter::bit_count() const
+{
+	return static_cast<std::size_t>(bit_count_);
+}
+
+unsigned int BloomFilter::hash_count() const
+{
+	return hash_count_;
+}
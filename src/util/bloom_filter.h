@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Set of 64-bit hashes that may report false positives but never false negatives.
+ *
+ * Sized up front for an expected number of keys and a target false-positive
+ * rate. Keys must already be well mixed hashes: the bit positions are derived
+ * from the key itself by double hashing. Inserting more keys than the filter
+ * was sized for keeps it correct but raises its false-positive rate.
+ */
+class BloomFilter
+{
+public:
+	/**
+	 * @brief Size the filter.
+	 *
+	 * @param expected_keys       Number of keys the false-positive rate is computed for.
+	 * @param false_positive_rate Target rate, between 0 and 1 (exclusive).
+	 */
+	BloomFilter(std::size_t expected_keys, double false_positive_rate);
+
+	/**
+	 * @brief Add a key.
+	 */
+	void insert(std::uint64_t key);
+
+	/**
+	 * @brief Whether the key may have been inserted; false means it certainly was not.
+	 */
+	bool may_contain(std::uint64_t key) const;
+
+	/**
+	 * @brief Number of bits of the filter.
+	 */
+	std::size_t bit_count() const;
+
+	/**
+	 * @brief Number of bits set per key.
+	 */
+	unsigned int hash_count() const;
+
+private:
+	/// The bits, 64 per word.
+	std::vector<std::uint64_t> words_;
+
+	/// Number of bits in use; bit positions are taken modulo this.
+	std::uint64_t bit_count_;
+
+	/// Number of bits set per key.
+	unsigned int hash_count_;
+};
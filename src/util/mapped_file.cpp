@@ -0,0 +1,174 @@
+/// \file
+/// \brief Implementation of the MappedFile RAII helper.
+
+#include "util/mapped_file.h"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &path)
+{
+	#if defined(_WIN32)
+	HANDLE file = CreateFileA(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to open file: " + path);
+	}
+
+	LARGE_INTEGER file_size{};
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Failed to read size of file: " + path);
+	}
+
+	size_ = static_cast<std::size_t>(file_size.QuadPart);
+	if (size_ == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+	{
+		throw std::runtime_error("Failed to map file: " + path);
+	}
+
+	void *address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (address == nullptr)
+	{
+		throw std::runtime_error("Failed to map file: " + path);
+	}
+	#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to open file: " + path);
+	}
+
+	struct stat info{};
+	if (::fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("Failed to read size of file: " + path);
+	}
+
+	size_ = static_cast<std::size_t>(info.st_size);
+	if (size_ == 0)
+	{
+		::close(fd);
+		return;
+	}
+
+	// The mapping keeps its own reference to the file, so the descriptor can go.
+	void *address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED)
+	{
+		size_ = 0;
+		throw std::runtime_error("Failed to map file: " + path);
+	}
+
+	// Parsers walk the file front to back; let the kernel read ahead aggressively.
+	::madvise(address, size_, MADV_SEQUENTIAL);
+	#endif
+
+	data_ = static_cast<const char *>(address);
+}
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+	: data_(other.data_)
+	, size_(other.size_)
+	, discarded_(other.discarded_)
+{
+	other.data_ = nullptr;
+	other.size_ = 0;
+	other.discarded_ = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+		data_ = other.data_;
+		size_ = other.size_;
+		discarded_ = other.discarded_;
+		other.data_ = nullptr;
+		other.size_ = 0;
+		other.discarded_ = 0;
+	}
+	return *this;
+}
+
+std::string_view MappedFile::view() const
+{
+	return std::string_view(data_, size_);
+}
+
+std::size_t MappedFile::size() const
+{
+	return size_;
+}
+
+void MappedFile::discard_before(std::size_t offset)
+{
+	#if defined(_WIN32)
+	// Windows trims the working set of file-backed views on its own.
+	(void)offset;
+	#else
+	static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+	// Only discard in large steps; each madvise call is a syscall.
+	constexpr std::size_t discard_step = 16U * 1024U * 1024U;
+
+	const std::size_t aligned = (offset < size_ ? offset : size_) / page_size * page_size;
+	if (data_ == nullptr || aligned < discarded_ + discard_step)
+	{
+		return;
+	}
+
+	::madvise(const_cast<char *>(data_) + discarded_, aligned - discarded_, MADV_DONTNEED);
+	discarded_ = aligned;
+	#endif
+}
+
+void MappedFile::unmap() noexcept
+{
+	if (data_ != nullptr)
+	{
+		#if defined(_WIN32)
+		UnmapViewOfFile(data_);
+		#else
+		::munmap(const_cast<char *>(data_), size_);
+		#endif
+	}
+
+	data_ = nullptr;
+	size_ = 0;
+	discarded_ = 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief RAII read-only memory mapping of a whole file.
+ *
+ * The mapped bytes are exposed as a std::string_view so that parsers can
+ * work on the file contents in place, without reading them into a buffer.
+ */
+class MappedFile
+{
+public:
+	/**
+	 * @brief Map the file at the given path into memory.
+	 *
+	 * Empty files are valid and produce an empty view.
+	 *
+	 * @param path Path to the file to map.
+	 *
+	 * @throws std::runtime_error if the file cannot be opened or mapped.
+	 */
+	explicit MappedFile(const std::string &path);
+
+	/**
+	 * @brief Unmap the file if it is mapped.
+	 */
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/**
+	 * @brief Move constructor. Transfers ownership of the mapping.
+	 *
+	 * @param other MappedFile to move from.
+	 */
+	MappedFile(MappedFile &&other) noexcept;
+
+	/**
+	 * @brief Move assignment operator. Releases the current mapping first.
+	 *
+	 * @param other MappedFile to move from.
+	 * @return Reference to this instance.
+	 */
+	MappedFile &operator=(MappedFile &&other) noexcept;
+
+	/**
+	 * @brief View over the whole mapped file.
+	 */
+	std::string_view view() const;
+
+	/**
+	 * @brief Size of the mapped file in bytes.
+	 */
+	std::size_t size() const;
+
+	/**
+	 * @brief Tell the OS that bytes before the given offset will not be read again.
+	 *
+	 * Streaming readers call this as they advance so that the resident size of
+	 * a large mapping stays bounded. Pages are dropped on a best-effort basis;
+	 * the view stays valid (dropped pages are re-read from disk if touched).
+	 *
+	 * @param offset Offset up to which the file has been consumed.
+	 */
+	void discard_before(std::size_t offset);
+
+private:
+	/// Start of the mapping, or nullptr for empty or moved-from files.
+	const char *data_ = nullptr;
+
+	/// Number of mapped bytes.
+	std::size_t size_ = 0;
+
+	/// Page-aligned offset up to which pages were already discarded.
+	std::size_t discarded_ = 0;
+
+	/**
+	 * @brief Release the mapping and reset this instance to empty.
+	 */
+	void unmap() noexcept;
+};
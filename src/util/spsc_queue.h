@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+ *
+ * A classic ring buffer: the producer only writes tail_, the consumer only
+ * writes head_, and acquire/release ordering hands slot contents over. Both
+ * operations are non-blocking; callers decide how to wait when the queue is
+ * full or empty, which is how backpressure is applied.
+ */
+template <typename T>
+class BoundedSpscQueue
+{
+public:
+	/**
+	 * @brief Create a queue holding up to `capacity` elements.
+	 *
+	 * @param capacity Maximum number of queued elements; 0 is treated as 1.
+	 */
+	explicit BoundedSpscQueue(std::size_t capacity)
+		: slots_((capacity == 0 ? 1 : capacity) + 1)
+	{
+	}
+
+	BoundedSpscQueue(const BoundedSpscQueue &) = delete;
+	BoundedSpscQueue &operator=(const BoundedSpscQueue &) = delete;
+
+	/**
+	 * @brief Append an element if there is room. Producer thread only.
+	 *
+	 * @param value Element to append; moved from only on success.
+	 * @return true if the element was queued; false if the queue is full.
+	 */
+	bool try_push(T &&value)
+	{
+		const std::size_t tail = tail_.load(std::memory_order_relaxed);
+		const std::size_t next = increment(tail);
+		if (next == head_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		slots_[tail] = std::move(value);
+		tail_.store(next, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Remove the oldest element if there is one. Consumer thread only.
+	 *
+	 * @param value Receives the removed element.
+	 * @return true if an element was removed; false if the queue is empty.
+	 */
+	bool try_pop(T &value)
+	{
+		const std::size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		value = std::move(slots_[head]);
+		head_.store(increment(head), std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Approximate number of queued elements (exact when called by either side).
+	 */
+	std::size_t size() const
+	{
+		const std::size_t head = head_.load(std::memory_order_acquire);
+		const std::size_t tail = tail_.load(std::memory_order_acquire);
+		return tail >= head ? tail - head : tail + slots_.size() - head;
+	}
+
+	/**
+	 * @brief Maximum number of queued elements.
+	 */
+	std::size_t capacity() const
+	{
+		return slots_.size() - 1;
+	}
+
+private:
+	/// Assumed cache line size; keeps the two indices from false sharing.
+	static constexpr std::size_t cache_line = 64;
+
+	/// Ring storage with one spare slot to tell "full" from "empty".
+	std::vector<T> slots_;
+
+	/// Index of the oldest element; written by the consumer.
+	alignas(cache_line) std::atomic<std::size_t> head_{0};
+
+	/// Index of the next free slot; written by the producer.
+	alignas(cache_line) std::atomic<std::size_t> tail_{0};
+
+	std::size_t increment(std::size_t index) const
+	{
+		return index + 1 == slots_.size() ? 0 : index + 1;
+	}
+};
+
+/**
+ * @brief Back off while the other side of a BoundedSpscQueue catches up.
+ *
+ * Spins with yields first (cheap when the other side is about to deliver),
+ * then sleeps briefly so an idle thread does not burn a core.
+ *
+ * @param attempt Number of waits so far; start at 0 for every new wait.
+ */
+inline void spsc_back_off(unsigned int &attempt)
+{
+	/// Number of yield-only retries before the caller starts sleeping.
+	constexpr unsigned int spin_limit = 64;
+
+	if (attempt < spin_limit)
+	{
+		++attempt;
+		std::this_thread::yield();
+	}
+	else
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
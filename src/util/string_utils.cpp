@@ -3,76 +3,221 @@
 
 #include "util/string_utils.h"
 
-#include <cctype>
+#include <bit>
 #include <vector>
 
-namespace string_utils
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JOBTRACKER_STRING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
 {
-	std::vector<std::string> split(const std::string &input, char delimiter)
+	/**
+	 * @brief Whether a byte is whitespace for std::isspace in the "C" locale.
+	 */
+	bool is_space(char ch)
 	{
-		std::vector<std::string> parts;
-		std::string current;
+		return ch == ' ' || (ch >= '\t' && ch <= '\r');
+	}
 
-		for (char ch : input)
+	/**
+	 * @brief Call `on_delimiter(offset)` for every delimiter in order, until it returns false.
+	 *
+	 * Blocks without a delimiter cost one compare and one movemask; the set
+	 * bits of the mask give the offsets of the delimiters in the block.
+	 */
+	template <typename OnDelimiter>
+	void for_each_delimiter(std::string_view input, char delimiter, OnDelimiter on_delimiter)
+	{
+		const char *data = input.data();
+		const std::size_t size = input.size();
+		std::size_t i = 0;
+
+		#if defined(__AVX2__)
+		const __m256i delimiter_32 = _mm256_set1_epi8(delimiter);
+		for (; i + 32 <= size; i += 32)
 		{
-			if (ch == delimiter)
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+			auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, delimiter_32)));
+			while (mask != 0)
 			{
-				parts.push_back(current);
-				current.clear();
+				if (!on_delimiter(i + static_cast<std::size_t>(std::countr_zero(mask))))
+				{
+					return;
+				}
+				mask &= mask - 1;
 			}
-			else
+		}
+		#endif
+
+		#if defined(JOBTRACKER_STRING_SSE2)
+		const __m128i delimiter_16 = _mm_set1_epi8(delimiter);
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+			auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delimiter_16)));
+			while (mask != 0)
 			{
-				current.push_back(ch);
+				if (!on_delimiter(i + static_cast<std::size_t>(std::countr_zero(mask))))
+				{
+					return;
+				}
+				mask &= mask - 1;
 			}
 		}
+		#endif
 
-		// Push the last segment (even if it is empty).
-		parts.push_back(current);
-
-		return parts;
+		for (; i < size; ++i)
+		{
+			if (data[i] == delimiter && !on_delimiter(i))
+			{
+				return;
+			}
+		}
 	}
 
-	std::string trim(const std::string &input)
+	/**
+	 * @brief Lowercase the ASCII letters of `size` bytes from `in` into `out`; they may alias.
+	 *
+	 * Vector form: adding 0x80 - 'A' maps exactly A-Z onto the 26 smallest
+	 * signed byte values, so one signed compare selects the letters whose
+	 * 0x20 bit is then set.
+	 */
+	void lower_ascii(const char *in, char *out, std::size_t size)
 	{
-		if (input.empty())
+		std::size_t i = 0;
+
+		#if defined(__AVX2__)
+		const __m256i shift_32 = _mm256_set1_epi8(static_cast<char>(0x80 - 'A'));
+		const __m256i limit_32 = _mm256_set1_epi8(static_cast<char>(0x80 + 26));
+		const __m256i case_bit_32 = _mm256_set1_epi8(0x20);
+		for (; i + 32 <= size; i += 32)
 		{
-			return {};
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+			const __m256i upper = _mm256_cmpgt_epi8(limit_32, _mm256_add_epi8(chunk, shift_32));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+				_mm256_or_si256(chunk, _mm256_and_si256(upper, case_bit_32)));
 		}
+		#endif
 
-		std::size_t start = 0;
-		std::size_t end = input.size() - 1;
-
-		while (start < input.size() &&
-			std::isspace(static_cast<unsigned char>(input[start])))
+		#if defined(JOBTRACKER_STRING_SSE2)
+		const __m128i shift_16 = _mm_set1_epi8(static_cast<char>(0x80 - 'A'));
+		const __m128i limit_16 = _mm_set1_epi8(static_cast<char>(0x80 + 26));
+		const __m128i case_bit_16 = _mm_set1_epi8(0x20);
+		for (; i + 16 <= size; i += 16)
 		{
-			++start;
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+			const __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(chunk, shift_16), limit_16);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+				_mm_or_si128(chunk, _mm_and_si128(upper, case_bit_16)));
 		}
+		#endif
 
-		// If the string is entirely whitespace, return an empty string.
-		if (start == input.size())
+		for (; i < size; ++i)
 		{
-			return {};
+			const char ch = in[i];
+			out[i] = ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + ('a' - 'A')) : ch;
 		}
+	}
+}
 
-		while (end > start &&
-			std::isspace(static_cast<unsigned char>(input[end])))
+namespace string_utils
+{
+	std::vector<std::string> split(const std::string &input, char delimiter)
+	{
+		std::vector<std::string> parts;
+
+		std::size_t start = 0;
+		for_each_delimiter(input, delimiter, [&](std::size_t offset)
 		{
-			--end;
+			parts.emplace_back(input, start, offset - start);
+			start = offset + 1;
+			return true;
+		});
+
+		// Push the last segment (even if it is empty).
+		parts.emplace_back(input, start);
+
+		return parts;
+	}
+
+	void split_view(std::string_view input, char delimiter, std::vector<std::string_view> &parts)
+	{
+		parts.clear();
+
+		std::size_t start = 0;
+		for_each_delimiter(input, delimiter, [&](std::size_t offset)
+		{
+			parts.push_back(input.substr(start, offset - start));
+			start = offset + 1;
+			return true;
+		});
+
+		parts.push_back(input.substr(start));
+	}
+
+	std::size_t split_view(std::string_view input, char delimiter, std::span<std::string_view> parts)
+	{
+		if (parts.empty())
+		{
+			return 0;
 		}
 
-		return input.substr(start, end - start + 1);
+		std::size_t count = 0;
+		std::size_t start = 0;
+		for_each_delimiter(input, delimiter, [&](std::size_t offset)
+		{
+			// The last slot is kept for the remainder.
+			if (count + 1 == parts.size())
+			{
+				return false;
+			}
+			parts[count++] = input.substr(start, offset - start);
+			start = offset + 1;
+			return true;
+		});
+
+		parts[count++] = input.substr(start);
+		return count;
 	}
 
-	std::string to_lower(const std::string &input)
+	std::string trim(const std::string &input)
 	{
-		std::string result;
-		result.reserve(input.size());
+		return std::string(trim_view(input));
+	}
 
-		for (unsigned char ch : input)
+	std::string_view trim_view(std::string_view input)
+	{
+		while (!input.empty() && is_space(input.front()))
 		{
-			result.push_back(static_cast<char>(std::tolower(ch)));
+			input.remove_prefix(1);
 		}
+		while (!input.empty() && is_space(input.back()))
+		{
+			input.remove_suffix(1);
+		}
+		return input;
+	}
 
+	std::string to_lower(const std::string &input)
+	{
+		std::string result;
+		to_lower_into(input, result);
 		return result;
 	}
+
+	void to_lower_in_place(std::string &text)
+	{
+		lower_ascii(text.data(), text.data(), text.size());
+	}
+
+	void to_lower_into(std::string_view input, std::string &output)
+	{
+		output.resize(input.size());
+		lower_ascii(input.data(), output.data(), input.size());
+	}
 }
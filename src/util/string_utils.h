@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -20,6 +23,32 @@ namespace string_utils
 	 */
 	std::vector<std::string> split(const std::string &input, char delimiter);
 
+	/**
+	 * @brief Split into views of the input, without copying.
+	 *
+	 * Same segments as split(). Delimiters are located 16 or 32 bytes at a
+	 * time with SSE2/AVX2 where available.
+	 *
+	 * @param input     Input characters; the views point into them.
+	 * @param delimiter Delimiter character.
+	 * @param parts     Output vector; cleared and filled with one view per segment.
+	 *                  Reusing it across calls avoids allocating.
+	 */
+	void split_view(std::string_view input, char delimiter, std::vector<std::string_view> &parts);
+
+	/**
+	 * @brief Split into a caller-provided array of views, without allocating.
+	 *
+	 * If the input has more segments than `parts` can hold, the last element
+	 * receives the unsplit remainder of the input (like a split limit).
+	 *
+	 * @param input     Input characters; the views point into them.
+	 * @param delimiter Delimiter character.
+	 * @param parts     Output views.
+	 * @return Number of views written; 0 only if `parts` is empty.
+	 */
+	std::size_t split_view(std::string_view input, char delimiter, std::span<std::string_view> parts);
+
 	/**
 	 * @brief Remove leading and trailing whitespace characters from a string.
 	 *
@@ -28,11 +57,44 @@ namespace string_utils
 	 */
 	std::string trim(const std::string &input);
 
+	/**
+	 * @brief Remove leading and trailing whitespace characters without copying.
+	 *
+	 * Whitespace is the set of std::isspace in the "C" locale (space, tab,
+	 * line feed, vertical tab, form feed, carriage return), tested without a
+	 * locale lookup.
+	 *
+	 * @param input Input characters.
+	 * @return A view of the input without surrounding whitespace.
+	 */
+	std::string_view trim_view(std::string_view input);
+
 	/**
 	 * @brief Convert all characters in a string to lowercase.
 	 *
+	 * ASCII-only, see to_lower_in_place().
+	 *
 	 * @param input Input string.
 	 * @return Lowercased copy of the input.
 	 */
 	std::string to_lower(const std::string &input);
+
+	/**
+	 * @brief Convert ASCII letters to lowercase in place.
+	 *
+	 * Bytes outside A-Z (including UTF-8 sequences) are left unchanged,
+	 * exactly like std::tolower in the "C" locale. Processes 16 or 32 bytes
+	 * at a time with SSE2/AVX2 where available.
+	 *
+	 * @param text Text to convert.
+	 */
+	void to_lower_in_place(std::string &text);
+
+	/**
+	 * @brief Write the ASCII-lowercased input into a caller-provided buffer.
+	 *
+	 * @param input  Input characters.
+	 * @param output Replaced by the converted input; reusing it across calls avoids allocating.
+	 */
+	void to_lower_into(std::string_view input, std::string &output);
 }
@@ -0,0 +1,72 @@
+/// \file
+/// \brief Implementation of the ThreadPool helper.
+
+#include "util/thread_pool.h"
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+{
+	const std::size_t count = thread_count == 0 ? 1 : thread_count;
+
+	workers_.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		workers_.emplace_back([this]()
+		{
+			run_worker();
+		});
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	available_.notify_all();
+
+	for (auto &worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+std::size_t ThreadPool::size() const
+{
+	return workers_.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push(std::move(task));
+	}
+	available_.notify_one();
+}
+
+void ThreadPool::run_worker()
+{
+	while (true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			available_.wait(lock, [this]()
+			{
+				return stopping_ || !tasks_.empty();
+			});
+
+			if (tasks_.empty())
+			{
+				return;
+			}
+
+			task = std::move(tasks_.front());
+			tasks_.pop();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of worker threads executing submitted tasks.
+ *
+ * Tasks run in submission order on whichever worker becomes free. Results
+ * and exceptions are delivered through std::future.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * @brief Start the given number of worker threads.
+	 *
+	 * @param thread_count Number of workers; 0 is treated as 1.
+	 */
+	explicit ThreadPool(std::size_t thread_count);
+
+	/**
+	 * @brief Finish all queued tasks and join the workers.
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/**
+	 * @brief Number of worker threads.
+	 */
+	std::size_t size() const;
+
+	/**
+	 * @brief Queue a task for execution.
+	 *
+	 * @param task Callable without arguments.
+	 * @return Future receiving the task's result or exception.
+	 */
+	template <typename Task>
+	std::future<std::invoke_result_t<Task>> submit(Task task)
+	{
+		using Result = std::invoke_result_t<Task>;
+
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+		std::future<Result> result = packaged->get_future();
+
+		enqueue([packaged]()
+		{
+			(*packaged)();
+		});
+
+		return result;
+	}
+
+private:
+	/// Worker threads.
+	std::vector<std::thread> workers_;
+
+	/// Tasks waiting for a free worker.
+	std::queue<std::function<void()>> tasks_;
+
+	/// Protects tasks_ and stopping_.
+	std::mutex mutex_;
+
+	/// Signals workers that a task is available or the pool is stopping.
+	std::condition_variable available_;
+
+	/// Set when the pool is being destroyed.
+	bool stopping_ = false;
+
+	/**
+	 * @brief Add a type-erased task to the queue and wake a worker.
+	 */
+	void enqueue(std::function<void()> task);
+
+	/**
+	 * @brief Worker loop: run tasks until the pool stops and the queue is empty.
+	 */
+	void run_worker();
+};
@@ -0,0 +1,167 @@
+/// \file
+/// \brief Implementation of the WorkStealingPool helper.
+
+#include "util/work_stealing_pool.h"
+
+namespace
+{
+	/// Pool the calling thread works for; null outside any pool.
+	thread_local const void *current_pool = nullptr;
+
+	/// Index of the calling worker within current_pool.
+	thread_local std::size_t current_worker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t thread_count)
+{
+	const std::size_t count = thread_count == 0 ? 1 : thread_count;
+
+	queues_.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		queues_.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	workers_.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		workers_.emplace_back([this, i]()
+		{
+			run_worker(i);
+		});
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		const std::lock_guard<std::mutex> lock(sleep_mutex_);
+		stopping_ = true;
+	}
+	wake_.notify_all();
+
+	for (auto &worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+std::size_t WorkStealingPool::size() const
+{
+	return workers_.size();
+}
+
+void WorkStealingPool::push(std::function<void()> task)
+{
+	const std::size_t target = current_pool == this ? current_worker : next_queue_.fetch_add(1) % queues_.size();
+	{
+		const std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+		queues_[target]->tasks.push_back(std::move(task));
+	}
+
+	// Taking the sleep lock orders the count update before a worker's check, so no wake-up is lost.
+	{
+		const std::lock_guard<std::mutex> lock(sleep_mutex_);
+		queued_.fetch_add(1);
+	}
+	wake_.notify_one();
+}
+
+void WorkStealingPool::push_range(ParallelFor &job, std::size_t first, std::size_t last)
+{
+	push([this, &job, first, last]()
+	{
+		run_range(job, first, last);
+	});
+}
+
+void WorkStealingPool::run_range(ParallelFor &job, std::size_t first, std::size_t last)
+{
+	// Offer the upper half to thieves; keep splitting the lower half until it fits the grain.
+	while (last - first > job.grain)
+	{
+		const std::size_t middle = first + (last - first) / 2;
+		push_range(job, middle, last);
+		last = middle;
+	}
+
+	std::exception_ptr error;
+	try
+	{
+		job.body(first, last);
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	// Update and notify under the lock: the waiting caller destroys job as soon as it sees 0.
+	const std::lock_guard<std::mutex> lock(job.mutex);
+	if (error && !job.error)
+	{
+		job.error = error;
+	}
+	job.remaining -= last - first;
+	if (job.remaining == 0)
+	{
+		job.finished.notify_all();
+	}
+}
+
+bool WorkStealingPool::take_task(std::size_t worker, std::function<void()> &task)
+{
+	{
+		WorkerQueue &own = *queues_[worker];
+		const std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			queued_.fetch_sub(1);
+			return true;
+		}
+	}
+
+	for (std::size_t offset = 1; offset < queues_.size(); ++offset)
+	{
+		WorkerQueue &victim = *queues_[(worker + offset) % queues_.size()];
+		const std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			queued_.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingPool::run_worker(std::size_t worker)
+{
+	current_pool = this;
+	current_worker = worker;
+
+	std::function<void()> task;
+	while (true)
+	{
+		if (take_task(worker, task))
+		{
+			task();
+			task = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		wake_.wait(lock, [this]()
+		{
+			return stopping_ || queued_.load() > 0;
+		});
+
+		if (stopping_ && queued_.load() == 0)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Pool of worker threads that balance uneven work by stealing.
+ *
+ * Every worker owns a task deque. A worker pushes and pops its own tasks at
+ * the back (newest first, which keeps its data in cache) and, when its deque
+ * is empty, steals the oldest task from the front of another worker's
+ * deque. parallel_for() splits a range in halves on demand, so a worker
+ * stuck on expensive items sheds the rest of its range to idle workers
+ * instead of holding a fixed share.
+ *
+ * Unlike ThreadPool, tasks do not run in submission order.
+ */
+class WorkStealingPool
+{
+public:
+	/**
+	 * @brief Start the given number of worker threads.
+	 *
+	 * @param thread_count Number of workers; 0 is treated as 1.
+	 */
+	explicit WorkStealingPool(std::size_t thread_count);
+
+	/**
+	 * @brief Finish all queued tasks and join the workers.
+	 */
+	~WorkStealingPool();
+
+	WorkStealingPool(const WorkStealingPool &) = delete;
+	WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+	/**
+	 * @brief Number of worker threads.
+	 */
+	std::size_t size() const;
+
+	/**
+	 * @brief Queue a task for execution.
+	 *
+	 * Tasks submitted from a worker go to that worker's deque; others are
+	 * spread over the workers in turn.
+	 *
+	 * @param task Callable without arguments.
+	 * @return Future receiving the task's result or exception.
+	 */
+	template <typename Task>
+	std::future<std::invoke_result_t<Task>> submit(Task task)
+	{
+		using Result = std::invoke_result_t<Task>;
+
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+		std::future<Result> result = packaged->get_future();
+
+		push([packaged]()
+		{
+			(*packaged)();
+		});
+
+		return result;
+	}
+
+	/**
+	 * @brief Call body(i) for every i in [0, count) on the workers and wait.
+	 *
+	 * Calls for different indices may run concurrently, so body must only
+	 * touch state owned by its index (e.g. results[i]). Must not be called
+	 * from a worker of this pool.
+	 *
+	 * @param count Number of indices.
+	 * @param grain Largest range a worker runs without offering half of it to others; 0 is treated as 1.
+	 * @param body  Callable taking a std::size_t index.
+	 *
+	 * @throws The first exception thrown by body, after all started calls finished.
+	 */
+	template <typename Body>
+	void parallel_for(std::size_t count, std::size_t grain, const Body &body)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		ParallelFor job;
+		job.remaining = count;
+		job.grain = std::max<std::size_t>(grain, 1);
+		job.body = [&body](std::size_t first, std::size_t last)
+		{
+			for (std::size_t i = first; i < last; ++i)
+			{
+				body(i);
+			}
+		};
+
+		push_range(job, 0, count);
+
+		std::unique_lock<std::mutex> lock(job.mutex);
+		job.finished.wait(lock, [&job]()
+		{
+			return job.remaining == 0;
+		});
+
+		if (job.error)
+		{
+			std::rethrow_exception(job.error);
+		}
+	}
+
+private:
+	/**
+	 * @brief Shared state of one parallel_for() call.
+	 */
+	struct ParallelFor
+	{
+		/// Runs the body over [first, last).
+		std::function<void(std::size_t, std::size_t)> body;
+
+		/// Largest range run without splitting.
+		std::size_t grain = 1;
+
+		/// Number of indices not processed yet.
+		std::size_t remaining = 0;
+
+		/// First exception thrown by the body.
+		std::exception_ptr error;
+
+		/// Guards remaining and error.
+		std::mutex mutex;
+
+		/// Signalled when remaining reaches 0.
+		std::condition_variable finished;
+	};
+
+	/**
+	 * @brief Task deque of one worker.
+	 */
+	struct alignas(64) WorkerQueue
+	{
+		/// Guards tasks.
+		std::mutex mutex;
+
+		/// Owner works at the back; thieves take from the front.
+		std::deque<std::function<void()>> tasks;
+	};
+
+	/// Task deques, one per worker.
+	std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+	/// Worker threads.
+	std::vector<std::thread> workers_;
+
+	/// Number of queued tasks over all deques; briefly negative when a task
+	/// is taken before its push was counted.
+	std::atomic<std::ptrdiff_t> queued_{0};
+
+	/// Next deque receiving a task submitted from outside the pool.
+	std::atomic<std::size_t> next_queue_{0};
+
+	/// Guards sleeping and stopping_.
+	std::mutex sleep_mutex_;
+
+	/// Wakes sleeping workers when tasks are queued or the pool stops.
+	std::condition_variable wake_;
+
+	/// Set when the pool is being destroyed.
+	bool stopping_ = false;
+
+	/**
+	 * @brief Queue a task on the calling worker's deque, or on the next deque in turn.
+	 */
+	void push(std::function<void()> task);
+
+	/**
+	 * @brief Queue a task running [first, last) of a parallel_for() call.
+	 */
+	void push_range(ParallelFor &job, std::size_t first, std::size_t last);
+
+	/**
+	 * @brief Run [first, last), handing its upper halves to the pool while it exceeds the grain.
+	 */
+	void run_range(ParallelFor &job, std::size_t first, std::size_t last);
+
+	/**
+	 * @brief Take a task from the worker's own deque, or steal one from another.
+	 *
+	 * @return false if every deque is empty.
+	 */
+	bool take_task(std::size_t worker, std::function<void()> &task);
+
+	/**
+	 * @brief Worker loop: run tasks until the pool stops and all deques are empty.
+	 */
+	void run_worker(std::size_t worker);
+};
@@ -1,5 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <stdexcept>
+#include <vector>
+
 #include "cli/command_line.h"
 
 TEST_CASE("parse_arguments_defaults_to_help_when_no_command_is_given")
@@ -70,3 +73,333 @@ TEST_CASE("parse_arguments_parses_import_csv_command")
 	REQUIRE(options.csv_path == "apps.csv");
 	REQUIRE(options.database_path == "jobtracker.db");
 }
+
+TEST_CASE("parse_arguments_parses_import_json_command")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-json"),
+		const_cast<char *>("--json"),
+		const_cast<char *>("jobs.ndjson"),
+		const_cast<char *>("--json-map"),
+		const_cast<char *>("company=employer.name"),
+		const_cast<char *>("--db"),
+		const_cast<char *>("jobtracker.db")
+	};
+	int argc = 8;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.command == CommandType::ImportJson);
+	REQUIRE(options.json_path == "jobs.ndjson");
+	REQUIRE(options.json_mapping == "company=employer.name");
+	REQUIRE(options.database_path == "jobtracker.db");
+}
+
+TEST_CASE("parse_arguments_parses_batch_size_and_rejects_invalid_values")
+{
+	char *valid_argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--batch-size"),
+		const_cast<char *>("250")
+	};
+
+	char *invalid_argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--batch-size"),
+		const_cast<char *>("lots")
+	};
+
+	REQUIRE(parse_arguments(4, valid_argv).batch_size == 250);
+	REQUIRE_THROWS_AS(parse_arguments(4, invalid_argv), std::runtime_error);
+}
+
+TEST_CASE("parse_arguments_parses_resume_flag")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--csv"),
+		const_cast<char *>("apps.csv"),
+		const_cast<char *>("--resume")
+	};
+	int argc = 5;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.resume);
+	REQUIRE_FALSE(parse_arguments(4, argv).resume);
+}
+
+TEST_CASE("parse_arguments_parses_skip_known_flag")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--csv"),
+		const_cast<char *>("apps.csv"),
+		const_cast<char *>("--skip-known")
+	};
+	int argc = 5;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.skip_known);
+	REQUIRE_FALSE(parse_arguments(4, argv).skip_known);
+}
+
+TEST_CASE("parse_arguments_parses_follow_flag")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--csv"),
+		const_cast<char *>("apps.csv"),
+		const_cast<char *>("--follow")
+	};
+	int argc = 5;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.command == CommandType::ImportCsv);
+	REQUIRE(options.follow);
+	REQUIRE_FALSE(parse_arguments(4, argv).follow);
+}
+
+TEST_CASE("parse_arguments_parses_where_condition")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--csv"),
+		const_cast<char *>("apps.csv"),
+		const_cast<char *>("--where"),
+		const_cast<char *>("status <> 'rejected'")
+	};
+	int argc = 6;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.command == CommandType::ImportCsv);
+	REQUIRE(options.where == "status <> 'rejected'");
+	REQUIRE(parse_arguments(4, argv).where.empty());
+}
+
+TEST_CASE("parse_arguments_rejects_where_with_flags_it_cannot_honor")
+{
+	const char *flags[][2] = {
+		{"--follow", nullptr},
+		{"--skip-known", nullptr},
+		{"--resume", nullptr},
+		{"--pipeline", nullptr},
+		{"--threads", "4"},
+		{"--batch-size", "100"}
+	};
+
+	for (const auto &flag : flags)
+	{
+		std::vector<char *> argv = {
+			const_cast<char *>("jobtracker_cli"),
+			const_cast<char *>("import-csv"),
+			const_cast<char *>("--where"),
+			const_cast<char *>("status <> 'rejected'"),
+			const_cast<char *>(flag[0])
+		};
+		if (flag[1] != nullptr)
+		{
+			argv.push_back(const_cast<char *>(flag[1]));
+		}
+
+		REQUIRE_THROWS_AS(parse_arguments(static_cast<int>(argv.size()), argv.data()), std::runtime_error);
+	}
+}
+
+TEST_CASE("parse_arguments_rejects_follow_with_flags_it_cannot_honor")
+{
+	const char *flags[][2] = {
+		{"--resume", nullptr},
+		{"--pipeline", nullptr},
+		{"--threads", "4"}
+	};
+
+	for (const auto &flag : flags)
+	{
+		std::vector<char *> argv = {
+			const_cast<char *>("jobtracker_cli"),
+			const_cast<char *>("import-csv"),
+			const_cast<char *>("--csv"),
+			const_cast<char *>("applications.csv"),
+			const_cast<char *>("--follow"),
+			const_cast<char *>(flag[0])
+		};
+		if (flag[1] != nullptr)
+		{
+			argv.push_back(const_cast<char *>(flag[1]));
+		}
+
+		REQUIRE_THROWS_AS(parse_arguments(static_cast<int>(argv.size()), argv.data()), std::runtime_error);
+	}
+
+	// The flags the follower does honor are still accepted.
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-csv"),
+		const_cast<char *>("--csv"),
+		const_cast<char *>("applications.csv"),
+		const_cast<char *>("--follow"),
+		const_cast<char *>("--skip-known"),
+		const_cast<char *>("--batch-size"),
+		const_cast<char *>("50")
+	};
+	const CommandLineOptions options = parse_arguments(8, argv);
+	REQUIRE(options.follow);
+	REQUIRE(options.skip_known);
+	REQUIRE(options.batch_size == 50);
+}
+
+TEST_CASE("parse_arguments_rejects_resume_and_pipeline_with_several_feeds")
+{
+	const char *feed_flags[][4] = {
+		{"--feeds", "feeds.txt", nullptr, nullptr},
+		{"--remote-csv-url", "http://a.example/jobs.csv", "--remote-csv-url", "http://b.example/jobs.csv"}
+	};
+
+	for (const auto &feeds : feed_flags)
+	{
+		for (const char *flag : {"--resume", "--pipeline"})
+		{
+			std::vector<char *> argv = {
+				const_cast<char *>("jobtracker_cli"),
+				const_cast<char *>("import-remote-csv")
+			};
+			for (const char *arg : feeds)
+			{
+				if (arg != nullptr)
+				{
+					argv.push_back(const_cast<char *>(arg));
+				}
+			}
+			argv.push_back(const_cast<char *>(flag));
+
+			REQUIRE_THROWS_AS(parse_arguments(static_cast<int>(argv.size()), argv.data()), std::runtime_error);
+		}
+	}
+
+	// A single feed still honors both.
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-remote-csv"),
+		const_cast<char *>("--remote-csv-url"),
+		const_cast<char *>("http://a.example/jobs.csv"),
+		const_cast<char *>("--resume"),
+		const_cast<char *>("--pipeline")
+	};
+	const CommandLineOptions options = parse_arguments(6, argv);
+	REQUIRE(options.resume);
+	REQUIRE(options.pipelined);
+}
+
+TEST_CASE("parse_arguments_parses_import_db_command")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-db"),
+		const_cast<char *>("--database"),
+		const_cast<char *>("central.db"),
+		const_cast<char *>("--from"),
+		const_cast<char *>("laptop.db")
+	};
+	int argc = 6;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.command == CommandType::ImportDb);
+	REQUIRE(options.database_path == "central.db");
+	REQUIRE(options.source_database_path == "laptop.db");
+}
+
+TEST_CASE("parse_arguments_parses_watch_imap_command")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("watch-imap"),
+		const_cast<char *>("--database"),
+		const_cast<char *>("jobs.db"),
+		const_cast<char *>("--imap-config"),
+		const_cast<char *>("imap.conf")
+	};
+	int argc = 6;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.command == CommandType::WatchImap);
+	REQUIRE(options.database_path == "jobs.db");
+	REQUIRE(options.imap_config_path == "imap.conf");
+}
+
+TEST_CASE("parse_arguments_parses_http_timeouts")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-remote-csv"),
+		const_cast<char *>("--connect-timeout"),
+		const_cast<char *>("5"),
+		const_cast<char *>("--timeout"),
+		const_cast<char *>("120")
+	};
+	int argc = 6;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.connect_timeout_seconds == 5);
+	REQUIRE(options.timeout_seconds == 120);
+}
+
+TEST_CASE("parse_arguments_collects_several_remote_feeds")
+{
+	char *argv[] = {
+		const_cast<char *>("jobtracker_cli"),
+		const_cast<char *>("import-remote-csv"),
+		const_cast<char *>("--remote-csv-url"),
+		const_cast<char *>("https://a.example/jobs.csv"),
+		const_cast<char *>("--remote-csv-url"),
+		const_cast<char *>("https://b.example/jobs.csv"),
+		const_cast<char *>("--feeds"),
+		const_cast<char *>("feeds.txt"),
+		const_cast<char *>("--max-per-host"),
+		const_cast<char *>("2")
+	};
+	int argc = 10;
+
+	CommandLineOptions options = parse_arguments(argc, argv);
+
+	REQUIRE(options.remote_csv_urls.size() == 2);
+	REQUIRE(options.remote_csv_urls[1] == "https://b.example/jobs.csv");
+	REQUIRE(options.remote_csv_url == "https://b.example/jobs.csv");
+	REQUIRE(options.feeds_path == "feeds.txt");
+	REQUIRE(options.max_connections_per_host == 2);
+}
+
+TEST_CASE("parse_arguments_rejects_invalid_numeric_values")
+{
+	const char *flags[] = {"--batch-size", "--threads", "--max-per-host", "--timeout", "--connect-timeout"};
+	const char *values[] = {"abc", "-1", "12x", ""};
+
+	for (const char *flag : flags)
+	{
+		for (const char *value : values)
+		{
+			char *argv[] = {
+				const_cast<char *>("jobtracker_cli"),
+				const_cast<char *>("import-csv"),
+				const_cast<char *>(flag),
+				const_cast<char *>(value)
+			};
+			int argc = 4;
+
+			REQUIRE_THROWS_AS(parse_arguments(argc, argv), std::runtime_error);
+		}
+	}
+}
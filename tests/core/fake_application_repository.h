@@ -1,8 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <map>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "storage/application_repository.h"
@@ -39,6 +42,26 @@ class FakeApplicationRepository : public IApplicationRepository
 		return copy;
 	}
 
+	/**
+	 * @brief Insert a new application, moving it into the returned value.
+	 *
+	 * The in-memory store still keeps its own copy, just like a database row.
+	 *
+	 * @param application Application to insert.
+	 * @return Application with a valid id.
+	 */
+	Application insert(Application &&application) override
+	{
+		if (application.id == 0)
+		{
+			application.id = next_id_;
+			++next_id_;
+		}
+
+		store_.push_back(application);
+		return std::move(application);
+	}
+
 	/**
 	 * @brief Update an existing application in the in-memory store.
 	 *
@@ -80,6 +103,11 @@ class FakeApplicationRepository : public IApplicationRepository
 		}
 
 		store_.erase(it, store_.end());
+
+		std::erase_if(fingerprints_, [id](const auto &fingerprint)
+		{
+			return fingerprint.second == id;
+		});
 		return true;
 	}
 
@@ -149,10 +177,126 @@ class FakeApplicationRepository : public IApplicationRepository
 		return stats;
 	}
 
+	/**
+	 * @brief Record that a transaction was started.
+	 */
+	void begin_transaction() override
+	{
+		++transactions_begun_;
+	}
+
+	/**
+	 * @brief Record that a transaction was committed.
+	 */
+	void commit_transaction() override
+	{
+		++transactions_committed_;
+	}
+
+	/**
+	 * @brief Record that a transaction was rolled back.
+	 */
+	void rollback_transaction() override
+	{
+		++transactions_rolled_back_;
+	}
+
+	/**
+	 * @brief Look up a checkpoint saved by save_checkpoint().
+	 */
+	std::optional<ImportCheckpoint> find_checkpoint(const std::string &source) override
+	{
+		const auto it = checkpoints_.find(source);
+		if (it == checkpoints_.end())
+		{
+			return std::nullopt;
+		}
+		return it->second;
+	}
+
+	/**
+	 * @brief Store a checkpoint in memory.
+	 */
+	void save_checkpoint(const ImportCheckpoint &checkpoint) override
+	{
+		checkpoints_[checkpoint.source] = checkpoint;
+	}
+
+	/**
+	 * @brief All fingerprints saved by save_fingerprints().
+	 */
+	std::vector<std::uint64_t> load_fingerprints() override
+	{
+		std::vector<std::uint64_t> fingerprints;
+		for (const auto &fingerprint : fingerprints_)
+		{
+			fingerprints.push_back(fingerprint.first);
+		}
+		return fingerprints;
+	}
+
+	/**
+	 * @brief The given fingerprints that save_fingerprints() stored.
+	 */
+	std::vector<std::uint64_t> find_fingerprints(const std::vector<std::uint64_t> &fingerprints) override
+	{
+		std::vector<std::uint64_t> found;
+		for (const std::uint64_t fingerprint : fingerprints)
+		{
+			if (fingerprints_.count(fingerprint) > 0)
+			{
+				found.push_back(fingerprint);
+			}
+		}
+		return found;
+	}
+
+	/**
+	 * @brief Store fingerprints with their application ids in memory.
+	 */
+	void save_fingerprints(const std::vector<std::uint64_t> &fingerprints, const std::vector<int> &application_ids) override
+	{
+		for (std::size_t i = 0; i < fingerprints.size(); ++i)
+		{
+			fingerprints_.emplace(fingerprints[i], application_ids[i]);
+		}
+	}
+
+	/**
+	 * @brief Number of committed transactions, used by tests to check batching.
+	 */
+	int transactions_committed() const
+	{
+		return transactions_committed_;
+	}
+
+	/**
+	 * @brief Number of rolled back transactions.
+	 */
+	int transactions_rolled_back() const
+	{
+		return transactions_rolled_back_;
+	}
+
 private:
+	/// Number of begin_transaction() calls.
+	int transactions_begun_ = 0;
+
+	/// Number of commit_transaction() calls.
+	int transactions_committed_ = 0;
+
+	/// Number of rollback_transaction() calls.
+	int transactions_rolled_back_ = 0;
+
 	/// Next id to assign to applications whose id is initially 0.
 	int next_id_ = 1;
 
+	/// Checkpoints by source identity.
+	std::map<std::string, ImportCheckpoint> checkpoints_;
+
+	/// Fingerprints of imported records, with the id of the application inserted for each.
+	std::map<std::uint64_t, int> fingerprints_;
+
 	/// In-memory storage for application objects used by tests.
 	std::vector<Application> store_;
 };
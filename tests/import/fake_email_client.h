@@ -26,6 +26,11 @@ class FakeEmailClient : public IEmailClient
 		connected_ = false;
 	}
 
+	bool is_connected() const override
+	{
+		return connected_;
+	}
+
 	std::vector<EmailMessage> fetch_messages(const std::string &search_expression) override
 	{
 		(void)search_expression;
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "import/http_client.h"
 
@@ -11,6 +15,8 @@
 class FakeHttpClient : public IHttpClient
 {
 public:
+	using IHttpClient::get;
+
 	/**
 	 * @brief Configure the response returned for a given URL.
 	 *
@@ -25,11 +31,13 @@ class FakeHttpClient : public IHttpClient
 	/**
 	 * @brief Perform a GET request for the given URL.
 	 *
-	 * If no explicit response is configured for the URL, this returns a
-	 * 404 response with an empty body.
+	 * The request headers are recorded. If no explicit response is
+	 * configured for the URL, this returns a 404 response with an empty body.
 	 */
-	HttpResponse get(const std::string &url) override
+	HttpResponse get(const std::string &url, const HttpHeaders &headers) override
 	{
+		requests_.push_back(headers);
+
 		const auto it = responses_.find(url);
 		if (it != responses_.end())
 		{
@@ -42,6 +50,48 @@ class FakeHttpClient : public IHttpClient
 		return fallback;
 	}
 
+	/**
+	 * @brief Deliver streamed bodies in chunks of the given size (0 = one chunk).
+	 */
+	void set_chunk_size(std::size_t chunk_size)
+	{
+		chunk_size_ = chunk_size;
+	}
+
+	/**
+	 * @brief Stream the configured response, split into chunks of set_chunk_size() bytes.
+	 */
+	void get_streaming(const std::string &url, const HttpHeaders &headers, IHttpResponseHandler &handler) override
+	{
+		const HttpResponse response = get(url, headers);
+		if (!handler.on_head(response.status_code, response.headers))
+		{
+			return;
+		}
+
+		const std::string_view body(response.body);
+		const std::size_t step = chunk_size_ > 0 ? chunk_size_ : std::max<std::size_t>(body.size(), 1);
+		for (std::size_t pos = 0; pos < body.size(); pos += step)
+		{
+			if (!handler.on_body(body.substr(pos, step)))
+			{
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Request headers of every get() call, in call order.
+	 */
+	const std::vector<HttpHeaders> &requests() const
+	{
+		return requests_;
+	}
+
 private:
 	std::unordered_map<std::string, HttpResponse> responses_;
+
+	std::vector<HttpHeaders> requests_;
+
+	std::size_t chunk_size_ = 0;
 };
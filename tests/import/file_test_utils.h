@@ -0,0 +1,17 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Replace a file with the given contents; used only in tests.
+ *
+ * @param file_name Path of the file to create or truncate.
+ * @param content   New file contents, written as-is.
+ */
+inline void write_file(const std::string &file_name, std::string_view content)
+{
+	std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+	out << content;
+}
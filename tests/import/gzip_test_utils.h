@@ -0,0 +1,51 @@
+#pragma once
+
+#include <zlib.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Compress data into a single gzip member; used only in tests.
+ *
+ * @param data Bytes to compress.
+ * @return The gzip-encoded bytes.
+ */
+inline std::string gzip_compress(std::string_view data)
+{
+	z_stream stream{};
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		throw std::runtime_error("Failed to initialize gzip compression");
+	}
+
+	std::string compressed(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+	stream.avail_in = static_cast<uInt>(data.size());
+	stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+	stream.avail_out = static_cast<uInt>(compressed.size());
+
+	const int rc = deflate(&stream, Z_FINISH);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	if (rc != Z_STREAM_END)
+	{
+		throw std::runtime_error("Failed to compress test data");
+	}
+	return compressed;
+}
+
+/**
+ * @brief Write gzip-compressed data to a file; used only in tests.
+ *
+ * @param file_name Path of the file to create.
+ * @param data      Uncompressed file contents.
+ */
+inline void write_gzip_file(const std::string &file_name, std::string_view data)
+{
+	std::ofstream out(file_name, std::ios::binary);
+	out << gzip_compress(data);
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "import/http_client.h"
+
+/**
+ * @brief Minimal HTTP/1.1 server on 127.0.0.1 used only in tests.
+ *
+ * Serves every connection on its own background thread and keeps it open
+ * for further requests (HTTP/1.1 keep-alive). Every request is answered by a
+ * handler that receives the request headers (with lower-case names) and
+ * returns the status, headers and body to send. This lets tests exercise
+ * LibcurlHttpClient against real sockets without network access.
+ */
+class LocalHttpServer
+{
+public:
+	/// Produces the response for a request, given its request headers.
+	using Handler = std::function<HttpResponse(const HttpHeaders &)>;
+
+	/**
+	 * @brief Start listening on an ephemeral port.
+	 *
+	 * @param handler Handler producing the response of every request.
+	 */
+	explicit LocalHttpServer(Handler handler)
+		: handler_(std::move(handler))
+	{
+		listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (listen_fd_ < 0)
+		{
+			throw std::runtime_error("Failed to create test server socket");
+		}
+
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = 0;
+
+		socklen_t length = sizeof(address);
+		if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+			::listen(listen_fd_, 8) != 0 ||
+			::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+		{
+			::close(listen_fd_);
+			throw std::runtime_error("Failed to start test server");
+		}
+
+		port_ = ntohs(address.sin_port);
+		thread_ = std::thread([this]()
+		{
+			serve();
+		});
+	}
+
+	/**
+	 * @brief Stop the server and join its thread.
+	 */
+	~LocalHttpServer()
+	{
+		stopping_.store(true);
+		::shutdown(listen_fd_, SHUT_RDWR);
+		thread_.join();
+		::close(listen_fd_);
+	}
+
+	LocalHttpServer(const LocalHttpServer &) = delete;
+	LocalHttpServer &operator=(const LocalHttpServer &) = delete;
+
+	/**
+	 * @brief URL of the given path on this server (e.g. "/jobs.csv").
+	 */
+	std::string url(const std::string &path) const
+	{
+		return "http://127.0.0.1:" + std::to_string(port_) + path;
+	}
+
+	/**
+	 * @brief Request headers of every request served so far, in order.
+	 */
+	std::vector<HttpHeaders> requests() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return requests_;
+	}
+
+	/**
+	 * @brief Number of TCP connections accepted so far.
+	 */
+	std::size_t connections() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return connections_;
+	}
+
+private:
+	Handler handler_;
+	int listen_fd_ = -1;
+	unsigned short port_ = 0;
+	std::atomic<bool> stopping_{false};
+	std::thread thread_;
+
+	mutable std::mutex mutex_;
+	std::vector<HttpHeaders> requests_;
+	std::size_t connections_ = 0;
+	std::vector<int> client_fds_;
+
+	void serve()
+	{
+		std::vector<std::thread> workers;
+
+		while (!stopping_.load())
+		{
+			const int client = ::accept(listen_fd_, nullptr, nullptr);
+			if (client < 0)
+			{
+				continue;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				++connections_;
+				client_fds_.push_back(client);
+			}
+			workers.emplace_back([this, client]()
+			{
+				std::string pending;
+				while (handle(client, pending))
+				{
+				}
+			});
+		}
+
+		{
+			// Wakes the workers blocked on kept-alive connections.
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (const int client : client_fds_)
+			{
+				::shutdown(client, SHUT_RDWR);
+			}
+		}
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+		for (const int client : client_fds_)
+		{
+			::close(client);
+		}
+	}
+
+	/**
+	 * @brief Answer the next request on the connection.
+	 *
+	 * @param pending Bytes received past the previous request.
+	 * @return Whether the connection can serve another request.
+	 */
+	bool handle(int client, std::string &pending)
+	{
+		char buffer[4096];
+
+		std::size_t header_end = pending.find("\r\n\r\n");
+		while (header_end == std::string::npos)
+		{
+			const ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+			if (received <= 0)
+			{
+				return false;
+			}
+			pending.append(buffer, static_cast<std::size_t>(received));
+			header_end = pending.find("\r\n\r\n");
+		}
+
+		const std::string request = pending.substr(0, header_end + 4);
+		pending.erase(0, header_end + 4);
+
+		const HttpHeaders headers = parse_headers(request);
+		const auto connection = headers.find("connection");
+		const bool keep_alive = connection == headers.end() || connection->second != "close";
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			requests_.push_back(headers);
+		}
+
+		const HttpResponse response = handler_(headers);
+
+		std::string raw = "HTTP/1.1 " + std::to_string(response.status_code) + " Test\r\n";
+		for (const auto &[name, value] : response.headers)
+		{
+			raw += name + ": " + value + "\r\n";
+		}
+		raw += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+		raw += keep_alive ? "\r\n" : "Connection: close\r\n\r\n";
+		raw += response.body;
+
+		std::size_t sent = 0;
+		while (sent < raw.size())
+		{
+			const ssize_t written = ::send(client, raw.data() + sent, raw.size() - sent, MSG_NOSIGNAL);
+			if (written <= 0)
+			{
+				return false;
+			}
+			sent += static_cast<std::size_t>(written);
+		}
+
+		return keep_alive;
+	}
+
+	static HttpHeaders parse_headers(const std::string &request)
+	{
+		HttpHeaders headers;
+
+		std::size_t line_start = request.find("\r\n") + 2;
+		while (line_start < request.size())
+		{
+			const std::size_t line_end = request.find("\r\n", line_start);
+			if (line_end == std::string::npos || line_end == line_start)
+			{
+				break;
+			}
+
+			const std::string line = request.substr(line_start, line_end - line_start);
+			const std::size_t colon = line.find(':');
+			if (colon != std::string::npos)
+			{
+				std::string name = line.substr(0, colon);
+				for (auto &c : name)
+				{
+					c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+				}
+				std::size_t value_start = colon + 1;
+				while (value_start < line.size() && line[value_start] == ' ')
+				{
+					++value_start;
+				}
+				headers[name] = line.substr(value_start);
+			}
+			line_start = line_end + 2;
+		}
+
+		return headers;
+	}
+};
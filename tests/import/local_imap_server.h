@@ -0,0 +1,702 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Minimal scripted IMAP4rev1 server on 127.0.0.1 used only in tests.
+ *
+ * Holds one mailbox in memory and answers the commands ImapEmailClient uses
+ * (CAPABILITY, LOGIN, SELECT, UID SEARCH, UID FETCH, IDLE, NOOP, LOGOUT).
+ * UID FETCH serves UID, ENVELOPE, BODYSTRUCTURE, header fields, TEXT and
+ * (partial) body parts of single-part and multipart messages. Sessions in
+ * IDLE are sent `* n EXISTS` shortly after a message is appended. Commands
+ * are processed in the order they arrive, so pipelined commands are answered
+ * back to back. Every command is logged (without its tag), which lets tests
+ * check what the client sent.
+ */
+class LocalImapServer
+{
+public:
+	/**
+	 * @brief A MIME part of a stored message; parts other than text are attachments.
+	 */
+	struct Part
+	{
+		std::string type = "text";
+		std::string subtype = "plain";
+		std::string content;
+
+		/// Content-Transfer-Encoding the content is stored in.
+		std::string encoding = "7BIT";
+	};
+
+	/**
+	 * @brief A message stored in the mailbox.
+	 */
+	struct Message
+	{
+		std::uint32_t uid = 0;
+		std::string from;
+		std::string subject;
+
+		/// One part: a single-part message; more: multipart/mixed.
+		std::vector<Part> parts;
+	};
+
+	/**
+	 * @brief Start listening on an ephemeral port.
+	 *
+	 * @param condstore Whether to announce and answer CONDSTORE.
+	 */
+	explicit LocalImapServer(bool condstore = false)
+		: condstore_(condstore)
+	{
+		listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (listen_fd_ < 0)
+		{
+			throw std::runtime_error("Failed to create test server socket");
+		}
+
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = 0;
+
+		socklen_t length = sizeof(address);
+		if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+			::listen(listen_fd_, 8) != 0 ||
+			::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+		{
+			::close(listen_fd_);
+			throw std::runtime_error("Failed to start test server");
+		}
+
+		port_ = ntohs(address.sin_port);
+		thread_ = std::thread([this]()
+		{
+			serve();
+		});
+	}
+
+	/**
+	 * @brief Stop the server and join its thread.
+	 */
+	~LocalImapServer()
+	{
+		stopping_.store(true);
+		::shutdown(listen_fd_, SHUT_RDWR);
+		thread_.join();
+		::close(listen_fd_);
+	}
+
+	LocalImapServer(const LocalImapServer &) = delete;
+	LocalImapServer &operator=(const LocalImapServer &) = delete;
+
+	/**
+	 * @brief Port the server listens on.
+	 */
+	int port() const
+	{
+		return port_;
+	}
+
+	/**
+	 * @brief Add a message to the mailbox.
+	 *
+	 * @return The UID assigned to the message.
+	 */
+	std::uint32_t append(const std::string &from, const std::string &subject, const std::string &body)
+	{
+		Part part;
+		part.content = body;
+		return append_multipart(from, subject, {part});
+	}
+
+	/**
+	 * @brief Add a message made of the given MIME parts to the mailbox.
+	 *
+	 * @return The UID assigned to the message.
+	 */
+	std::uint32_t append_multipart(const std::string &from, const std::string &subject, const std::vector<Part> &parts)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		Message message;
+		message.uid = uid_next_++;
+		message.from = from;
+		message.subject = subject;
+		message.parts = parts;
+		messages_.push_back(std::move(message));
+		++highest_modseq_;
+		return messages_.back().uid;
+	}
+
+	/**
+	 * @brief Leave a gap of unused UIDs, as if that many messages had been expunged.
+	 */
+	void skip_uids(std::uint32_t count)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		uid_next_ += count;
+	}
+
+	/**
+	 * @brief Drop all messages and start a new UID epoch (as after a mailbox rebuild).
+	 */
+	void reset_uid_validity(std::uint32_t uid_validity)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		uid_validity_ = uid_validity;
+		uid_next_ = 1;
+		messages_.clear();
+		++highest_modseq_;
+	}
+
+	/**
+	 * @brief Replace the greeting sent to new connections (including its CRLF).
+	 */
+	void set_greeting(const std::string &greeting)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		greeting_ = greeting;
+	}
+
+	/**
+	 * @brief Cut every open connection, as a network failure would.
+	 */
+	void drop_connections()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (const int client : client_fds_)
+		{
+			::shutdown(client, SHUT_RDWR);
+		}
+	}
+
+	/**
+	 * @brief Every command received so far without its tag, in order.
+	 */
+	std::vector<std::string> commands() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return commands_;
+	}
+
+	/**
+	 * @brief Forget the logged commands.
+	 */
+	void clear_commands()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		commands_.clear();
+	}
+
+	/**
+	 * @brief Number of logged commands starting with the given prefix.
+	 */
+	std::size_t count_commands(const std::string &prefix) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return static_cast<std::size_t>(std::count_if(commands_.begin(), commands_.end(), [&](const std::string &command)
+		{
+			return command.rfind(prefix, 0) == 0;
+		}));
+	}
+
+private:
+	bool condstore_;
+	int listen_fd_ = -1;
+	int port_ = 0;
+	std::atomic<bool> stopping_{false};
+	std::thread thread_;
+
+	mutable std::mutex mutex_;
+	std::vector<Message> messages_;
+	std::uint32_t uid_validity_ = 1000;
+	std::uint32_t uid_next_ = 1;
+	std::uint64_t highest_modseq_ = 1;
+	std::vector<std::string> commands_;
+	std::vector<int> client_fds_;
+	std::string greeting_ = "* OK [CAPABILITY IMAP4rev1] Test server ready\r\n";
+
+	void serve()
+	{
+		std::vector<std::thread> workers;
+
+		while (!stopping_.load())
+		{
+			const int client = ::accept(listen_fd_, nullptr, nullptr);
+			if (client < 0)
+			{
+				continue;
+			}
+			// Like real servers, answer without waiting for delayed ACKs.
+			const int enable = 1;
+			::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				client_fds_.push_back(client);
+			}
+			workers.emplace_back([this, client]()
+			{
+				session(client);
+			});
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (const int client : client_fds_)
+			{
+				::shutdown(client, SHUT_RDWR);
+			}
+		}
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+		for (const int client : client_fds_)
+		{
+			::close(client);
+		}
+	}
+
+	std::string capabilities() const
+	{
+		return condstore_ ? "IMAP4rev1 IDLE CONDSTORE" : "IMAP4rev1 IDLE";
+	}
+
+	static bool send_all(int client, const std::string &data)
+	{
+		std::size_t sent = 0;
+		while (sent < data.size())
+		{
+			const ssize_t written = ::send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if (written <= 0)
+			{
+				return false;
+			}
+			sent += static_cast<std::size_t>(written);
+		}
+		return true;
+	}
+
+	void session(int client)
+	{
+		std::string greeting;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			greeting = greeting_;
+		}
+		if (!send_all(client, greeting))
+		{
+			return;
+		}
+
+		std::string pending;
+		char buffer[4096];
+		while (true)
+		{
+			const std::size_t line_end = pending.find("\r\n");
+			if (line_end == std::string::npos)
+			{
+				const ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+				if (received <= 0)
+				{
+					return;
+				}
+				pending.append(buffer, static_cast<std::size_t>(received));
+				continue;
+			}
+
+			const std::string line = pending.substr(0, line_end);
+			pending.erase(0, line_end + 2);
+
+			const std::size_t tag_end = line.find(' ');
+			if (tag_end != std::string::npos && line.compare(tag_end + 1, std::string::npos, "IDLE") == 0)
+			{
+				if (!idle(client, line.substr(0, tag_end), pending))
+				{
+					return;
+				}
+				continue;
+			}
+
+			bool keep_open = true;
+			if (!send_all(client, answer(line, keep_open)) || !keep_open)
+			{
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Serve an IDLE command until the client sends DONE.
+	 *
+	 * @return false if the connection was closed.
+	 */
+	bool idle(int client, const std::string &tag, std::string &pending)
+	{
+		std::size_t announced = 0;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			commands_.push_back("IDLE");
+			announced = messages_.size();
+		}
+		if (!send_all(client, "+ idling\r\n"))
+		{
+			return false;
+		}
+
+		char buffer[4096];
+		while (true)
+		{
+			const std::size_t done = pending.find("DONE\r\n");
+			if (done != std::string::npos)
+			{
+				pending.erase(0, done + 6);
+				return send_all(client, tag + " OK IDLE terminated\r\n");
+			}
+
+			pollfd waiter{client, POLLIN, 0};
+			if (::poll(&waiter, 1, 5) > 0)
+			{
+				const ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+				if (received <= 0)
+				{
+					return false;
+				}
+				pending.append(buffer, static_cast<std::size_t>(received));
+			}
+
+			std::string update;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (messages_.size() != announced)
+				{
+					announced = messages_.size();
+					update = "* " + std::to_string(announced) + " EXISTS\r\n";
+				}
+			}
+			if (!update.empty() && !send_all(client, update))
+			{
+				return false;
+			}
+		}
+	}
+
+	/**
+	 * @brief Produce the complete reply to one command line.
+	 */
+	std::string answer(const std::string &line, bool &keep_open)
+	{
+		const std::size_t tag_end = line.find(' ');
+		const std::string tag = line.substr(0, tag_end);
+		const std::string command = tag_end == std::string::npos ? std::string() : line.substr(tag_end + 1);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		commands_.push_back(command);
+
+		std::string upper = command;
+		for (auto &c : upper)
+		{
+			c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+		}
+
+		if (upper == "CAPABILITY")
+		{
+			return "* CAPABILITY " + capabilities() + "\r\n" + tag + " OK CAPABILITY completed\r\n";
+		}
+		if (upper.rfind("LOGIN ", 0) == 0)
+		{
+			if (command.find("\"wrong\"") != std::string::npos)
+			{
+				return tag + " NO [AUTHENTICATIONFAILED] Invalid credentials\r\n";
+			}
+			return tag + " OK [CAPABILITY " + capabilities() + "] Logged in\r\n";
+		}
+		if (upper.rfind("SELECT ", 0) == 0)
+		{
+			std::string reply = "* " + std::to_string(messages_.size()) + " EXISTS\r\n";
+			reply += "* OK [UIDVALIDITY " + std::to_string(uid_validity_) + "] UIDs valid\r\n";
+			reply += "* OK [UIDNEXT " + std::to_string(uid_next_) + "] Predicted next UID\r\n";
+			if (condstore_)
+			{
+				reply += "* OK [HIGHESTMODSEQ " + std::to_string(highest_modseq_) + "] Highest\r\n";
+			}
+			return reply + tag + " OK [READ-WRITE] SELECT completed\r\n";
+		}
+		if (upper.rfind("UID SEARCH UID ", 0) == 0)
+		{
+			return search(tag, command.substr(15));
+		}
+		if (upper.rfind("UID FETCH ", 0) == 0)
+		{
+			return fetch(tag, command.substr(10));
+		}
+		if (upper == "NOOP")
+		{
+			return tag + " OK NOOP completed\r\n";
+		}
+		if (upper == "LOGOUT")
+		{
+			keep_open = false;
+			return "* BYE Logging out\r\n" + tag + " OK LOGOUT completed\r\n";
+		}
+		return tag + " BAD Unknown command\r\n";
+	}
+
+	/// Inclusive UID ranges of a sequence set.
+	using UidRanges = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+	/**
+	 * @brief Parse a sequence set such as "1:4,7,9:*".
+	 */
+	UidRanges parse_set(const std::string &set) const
+	{
+		const std::uint32_t highest = messages_.empty() ? 0 : messages_.back().uid;
+		const auto bound = [&](const std::string &text)
+		{
+			return text == "*" ? highest : static_cast<std::uint32_t>(std::stoul(text));
+		};
+
+		UidRanges ranges;
+		std::size_t start = 0;
+		while (start <= set.size())
+		{
+			std::size_t end = set.find(',', start);
+			if (end == std::string::npos)
+			{
+				end = set.size();
+			}
+			const std::string range = set.substr(start, end - start);
+			const std::size_t colon = range.find(':');
+
+			std::uint32_t low = bound(range.substr(0, colon));
+			std::uint32_t high = colon == std::string::npos ? low : bound(range.substr(colon + 1));
+			ranges.emplace_back(std::min(low, high), std::max(low, high));
+			start = end + 1;
+		}
+		return ranges;
+	}
+
+	static bool in_set(std::uint32_t uid, const UidRanges &ranges)
+	{
+		return std::any_of(ranges.begin(), ranges.end(), [uid](const auto &range)
+		{
+			return uid >= range.first && uid <= range.second;
+		});
+	}
+
+	/**
+	 * @brief Index of the first message whose UID is not below the given one.
+	 */
+	std::size_t lower_bound(std::uint32_t uid) const
+	{
+		return static_cast<std::size_t>(std::lower_bound(messages_.begin(), messages_.end(), uid, [](const Message &message, std::uint32_t value)
+		{
+			return message.uid < value;
+		}) - messages_.begin());
+	}
+
+	/**
+	 * @brief Answer "UID SEARCH UID <set> [SUBJECT "text"]".
+	 */
+	std::string search(const std::string &tag, const std::string &arguments) const
+	{
+		const std::size_t set_end = arguments.find(' ');
+		const UidRanges set = parse_set(arguments.substr(0, set_end));
+
+		std::string subject;
+		const std::size_t subject_key = arguments.find("SUBJECT \"");
+		if (subject_key != std::string::npos)
+		{
+			const std::size_t start = subject_key + 9;
+			subject = arguments.substr(start, arguments.find('"', start) - start);
+		}
+
+		std::string reply = "* SEARCH";
+		for (const auto &message : messages_)
+		{
+			if (in_set(message.uid, set) && message.subject.find(subject) != std::string::npos)
+			{
+				reply += " " + std::to_string(message.uid);
+			}
+		}
+		return reply + "\r\n" + tag + " OK SEARCH completed\r\n";
+	}
+
+	static std::string literal(const std::string &text)
+	{
+		return "{" + std::to_string(text.size()) + "}\r\n" + text;
+	}
+
+	static std::string quoted(const std::string &text)
+	{
+		return "\"" + text + "\"";
+	}
+
+	/**
+	 * @brief ENVELOPE address list of "Name <mailbox@host>" or "mailbox@host".
+	 */
+	static std::string address(const std::string &from)
+	{
+		std::string name = "NIL";
+		std::string email = from;
+		const std::size_t open = from.find('<');
+		if (open != std::string::npos)
+		{
+			name = quoted(from.substr(0, from.find_last_not_of(' ', open - 1) + 1));
+			email = from.substr(open + 1, from.find('>') - open - 1);
+		}
+		const std::size_t at = email.find('@');
+		return "((" + name + " NIL " + quoted(email.substr(0, at)) + " " + quoted(email.substr(at + 1)) + "))";
+	}
+
+	static std::string part_structure(const Part &part)
+	{
+		std::string structure = "(" + quoted(part.type) + " " + quoted(part.subtype) + " ";
+		structure += part.type == "text" ? "(\"CHARSET\" \"utf-8\")" : "NIL";
+		structure += " NIL NIL " + quoted(part.encoding) + " " + std::to_string(part.content.size());
+		if (part.type == "text")
+		{
+			structure += " 1 NIL NIL NIL NIL)";
+		}
+		else
+		{
+			structure += " NIL (\"ATTACHMENT\" (\"FILENAME\" \"file\")) NIL NIL)";
+		}
+		return structure;
+	}
+
+	static std::string body_structure(const Message &message)
+	{
+		if (message.parts.size() == 1)
+		{
+			return part_structure(message.parts[0]);
+		}
+		std::string structure = "(";
+		for (const auto &part : message.parts)
+		{
+			structure += part_structure(part);
+		}
+		return structure + " \"MIXED\" (\"BOUNDARY\" \"b\") NIL NIL NIL)";
+	}
+
+	/**
+	 * @brief Content-Type and Content-Transfer-Encoding header lines of a message.
+	 */
+	static std::string content_type_header(const Message &message)
+	{
+		if (message.parts.size() != 1)
+		{
+			return "Content-Type: multipart/mixed;\r\n\tboundary=\"b\"\r\n";
+		}
+		const Part &part = message.parts[0];
+		return "Content-Type: " + part.type + "/" + part.subtype + "; charset=utf-8\r\nContent-Transfer-Encoding: " + part.encoding + "\r\n";
+	}
+
+	static std::string text(const Message &message)
+	{
+		if (message.parts.size() == 1)
+		{
+			return message.parts[0].content;
+		}
+		std::string text;
+		for (const auto &part : message.parts)
+		{
+			text += "--b\r\nContent-Type: " + part.type + "/" + part.subtype + "\r\nContent-Transfer-Encoding: " + part.encoding + "\r\n\r\n" +
+				part.content + "\r\n";
+		}
+		return text + "--b--\r\n";
+	}
+
+	/**
+	 * @brief Answer "UID FETCH <set> (items)".
+	 */
+	std::string fetch(const std::string &tag, const std::string &arguments) const
+	{
+		const std::size_t set_end = arguments.find(' ');
+		const UidRanges set = parse_set(arguments.substr(0, set_end));
+		const std::string items = arguments.substr(set_end + 1);
+
+		// BODY.PEEK[<part>]<origin.count> of a numbered part, if requested.
+		std::string part_section;
+		std::size_t origin = 0;
+		std::size_t count = std::string::npos;
+		const std::size_t part_key = items.find("BODY.PEEK[");
+		if (part_key != std::string::npos && std::isdigit(static_cast<unsigned char>(items[part_key + 10])))
+		{
+			const std::size_t section_end = items.find(']', part_key);
+			part_section = items.substr(part_key + 10, section_end - part_key - 10);
+			if (items[section_end + 1] == '<')
+			{
+				const std::size_t dot = items.find('.', section_end);
+				origin = std::stoul(items.substr(section_end + 2, dot - section_end - 2));
+				count = std::stoul(items.substr(dot + 1));
+			}
+		}
+
+		std::string reply;
+		for (const auto &[low, high] : set)
+		{
+			for (std::size_t i = lower_bound(low); i < messages_.size() && messages_[i].uid <= high; ++i)
+			{
+				const Message &message = messages_[i];
+				reply += "* " + std::to_string(i + 1) + " FETCH (UID " + std::to_string(message.uid);
+
+				if (items.find("ENVELOPE") != std::string::npos)
+				{
+					reply += " ENVELOPE (\"Mon, 6 Jan 2025 10:00:00 +0000\" " + quoted(message.subject) + " " + address(message.from) +
+						" NIL NIL ((NIL NIL \"me\" \"example.com\")) NIL NIL NIL \"<" + std::to_string(message.uid) + "@test>\")";
+				}
+				if (items.find("BODYSTRUCTURE") != std::string::npos)
+				{
+					reply += " BODYSTRUCTURE " + body_structure(message);
+				}
+				if (items.find("BODY.PEEK[HEADER.FIELDS") != std::string::npos)
+				{
+					const std::string headers =
+						"From: " + message.from + "\r\n"
+						"To: me@example.com\r\n"
+						"Subject: " + message.subject + "\r\n"
+						"Date: Mon, 6 Jan 2025 10:00:00 +0000\r\n" +
+						content_type_header(message) + "\r\n";
+					reply += " BODY[HEADER.FIELDS (FROM TO SUBJECT DATE CONTENT-TYPE CONTENT-TRANSFER-ENCODING)] " + literal(headers);
+				}
+				if (items.find("BODY.PEEK[TEXT]") != std::string::npos)
+				{
+					reply += " BODY[TEXT] " + literal(text(message));
+				}
+				if (!part_section.empty())
+				{
+					const std::size_t index = std::stoul(part_section) - 1;
+					const std::string content = index < message.parts.size() ? message.parts[index].content : std::string();
+					reply += " BODY[" + part_section + "]";
+					if (count != std::string::npos)
+					{
+						reply += "<" + std::to_string(origin) + ">";
+					}
+					reply += " " + literal(origin < content.size() ? content.substr(origin, count) : std::string());
+				}
+
+				reply += ")\r\n";
+			}
+		}
+		return reply + tag + " OK FETCH completed\r\n";
+	}
+};
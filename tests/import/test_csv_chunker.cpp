@@ -0,0 +1,100 @@
+#include <chrono>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/csv_chunker.h"
+#include "import/csv_tokenizer.h"
+#include "tests/util/benchmark_threads.h"
+#include "util/thread_pool.h"
+
+TEST_CASE("csv_chunker_aligns_chunks_to_record_boundaries")
+{
+	ThreadPool pool(2);
+	const std::string input = "aaaa,1\nbbbb,2\ncccc,3\ndddd,4\n";
+
+	// Two chunks of ~9 bytes: cuts at 9 and 18 move to the next record ends.
+	const auto chunks = csv_chunker::split(input, 0, 9, 2, pool);
+
+	REQUIRE(chunks.size() == 2);
+	REQUIRE(chunks[0].begin == 0);
+	REQUIRE(chunks[0].end == 14);
+	REQUIRE(chunks[1].begin == 14);
+	REQUIRE(chunks[1].end == 21);
+}
+
+TEST_CASE("csv_chunker_does_not_split_inside_quoted_line_breaks")
+{
+	ThreadPool pool(2);
+	const std::string input = "x,\"line\nline\nline\"\ny,2\n";
+
+	// The first cut lands inside the quoted field, after an embedded newline.
+	const auto chunks = csv_chunker::split(input, 0, 8, 3, pool);
+
+	REQUIRE_FALSE(chunks.empty());
+	REQUIRE(chunks[0].end == input.find("y,2"));
+	REQUIRE(chunks.back().end == input.size());
+}
+
+TEST_CASE("csv_chunker_find_record_end_handles_crlf_and_quotes")
+{
+	const std::string_view input = "a,\"b\r\nc\"\r\nd\r\n";
+
+	REQUIRE(csv_chunker::find_record_end(input, 0, false) == 10);
+	REQUIRE(csv_chunker::find_record_end(input, 5, true) == 10);
+	REQUIRE(csv_chunker::find_record_end(input, 10, false) == input.size());
+}
+
+/// Split + parallel tokenization from 1 thread up to JOBTRACKER_BENCH_THREADS.
+TEST_CASE("csv_chunker_scaling_with_thread_count", "[.benchmark]")
+{
+	constexpr std::size_t rows = 400000;
+	std::string buffer;
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		buffer += "Company " + std::to_string(i) + ",Senior C++ Engineer,Berlin,linkedin,applied,"
+			"2025-01-02,2025-01-09,\"Referred by a colleague,\nplatform team\"\n";
+	}
+
+	double single_thread_ms = 0.0;
+	for (const std::size_t threads : benchmark_thread_counts())
+	{
+		ThreadPool pool(threads);
+		const auto start = std::chrono::steady_clock::now();
+
+		const auto chunks = csv_chunker::split(buffer, 0, buffer.size() / threads + 1, threads, pool);
+		std::vector<std::future<std::size_t>> records;
+		for (const CsvChunk &chunk : chunks)
+		{
+			records.push_back(pool.submit([&buffer, chunk]()
+			{
+				CsvTokenizer tokenizer(std::string_view(buffer).substr(chunk.begin, chunk.end - chunk.begin));
+				std::vector<std::string_view> fields;
+				std::size_t count = 0;
+				while (tokenizer.next_record(fields))
+				{
+					++count;
+				}
+				return count;
+			}));
+		}
+		std::size_t total = 0;
+		for (auto &result : records)
+		{
+			total += result.get();
+		}
+
+		const double elapsed_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+		REQUIRE(total == rows);
+		if (threads == 1)
+		{
+			single_thread_ms = elapsed_ms;
+		}
+		WARN(threads << " thread(s): " << chunks.size() << " chunks in " << elapsed_ms << " ms ("
+			<< single_thread_ms / elapsed_ms << "x of 1 thread)");
+	}
+}
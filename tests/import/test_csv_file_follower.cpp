@@ -0,0 +1,243 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "import/csv_file_follower.h"
+#include "tests/core/fake_application_repository.h"
+#include "tests/import/file_test_utils.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	/// Header used by every test file.
+	const std::string header = "company,position,location\n";
+
+	/// Append `content` to the file, the way a writer adding rows would.
+	void append_file(const std::string &file_name, const std::string &content)
+	{
+		std::ofstream out(file_name, std::ios::binary | std::ios::app);
+		out << content;
+	}
+
+	/**
+	 * @brief Runs a follower on its own thread and records when each import committed.
+	 */
+	class FollowerThread
+	{
+	public:
+		explicit FollowerThread(CsvFileFollower &follower)
+			: follower_(follower)
+		{
+			thread_ = std::thread([this]()
+			{
+				follower_.run([this](const ImportResult &result)
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					imported_ += result.imported;
+					commit_times_.push_back(Clock::now());
+					changed_.notify_all();
+				});
+			});
+		}
+
+		~FollowerThread()
+		{
+			follower_.stop();
+			thread_.join();
+		}
+
+		/**
+		 * @brief Wait until the given number of applications was imported.
+		 *
+		 * @return Time of the commit that reached the count; Clock::time_point() on timeout.
+		 */
+		Clock::time_point wait_for_imported(std::size_t count)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (!changed_.wait_for(lock, std::chrono::seconds(10), [&]()
+			{
+				return imported_ >= count;
+			}))
+			{
+				return Clock::time_point();
+			}
+			return commit_times_.back();
+		}
+
+		/**
+		 * @brief Number of applications imported so far.
+		 */
+		std::size_t imported()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return imported_;
+		}
+
+	private:
+		CsvFileFollower &follower_;
+		std::thread thread_;
+		std::mutex mutex_;
+		std::condition_variable changed_;
+		std::size_t imported_ = 0;
+		std::vector<Clock::time_point> commit_times_;
+	};
+}
+
+TEST_CASE("CsvFileFollower imports existing rows, then rows appended later")
+{
+	const std::string file_name = "follow_appended.csv";
+	write_file(file_name, header + "Acme,Engineer,Berlin\nBeta,Analyst,Paris\n");
+
+	FakeApplicationRepository repository;
+	CsvFileFollower follower(file_name, repository);
+
+	std::vector<double> latencies_ms;
+	double idle_cpu_ms = 0.0;
+	{
+		FollowerThread thread(follower);
+		REQUIRE(thread.wait_for_imported(2) != Clock::time_point());
+
+		for (std::size_t i = 0; i < 5; ++i)
+		{
+			const auto appended = Clock::now();
+			append_file(file_name, "Company " + std::to_string(i) + ",Developer,Remote\n");
+			const auto committed = thread.wait_for_imported(3 + i);
+			REQUIRE(committed != Clock::time_point());
+			latencies_ms.push_back(std::chrono::duration<double, std::milli>(committed - appended).count());
+		}
+
+		// A line without its terminator is not a complete record yet.
+		append_file(file_name, "Gamma,Tester");
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		REQUIRE(thread.imported() == 7);
+
+		append_file(file_name, ",Lisbon\n");
+		REQUIRE(thread.wait_for_imported(8) != Clock::time_point());
+
+		// Nothing to do: the follower sleeps in poll().
+		const std::clock_t idle_start = std::clock();
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		idle_cpu_ms = 1000.0 * static_cast<double>(std::clock() - idle_start) / CLOCKS_PER_SEC;
+	}
+
+	const auto apps = repository.find_all();
+	REQUIRE(apps.size() == 8);
+	REQUIRE(apps[0].company == "Acme");
+	REQUIRE(apps[2].company == "Company 0");
+	REQUIRE(apps[7].company == "Gamma");
+	REQUIRE(apps[7].position == "Tester");
+	REQUIRE(apps[7].location == "Lisbon");
+	REQUIRE(apps[7].status == "applied");
+
+	const CsvFollowStats stats = follower.stats();
+	REQUIRE(stats.imported == 8);
+	REQUIRE(stats.failures == 0);
+	REQUIRE(stats.offset == header.size() + 40 + 5 * 27 + 20);
+
+	// Timings depend on the machine: report them instead of failing on a loaded runner.
+	std::sort(latencies_ms.begin(), latencies_ms.end());
+	WARN("Append-to-commit latency: median " << latencies_ms[latencies_ms.size() / 2] << " ms, max "
+		<< latencies_ms.back() << " ms; CPU while idle for 500 ms: " << idle_cpu_ms << " ms");
+
+	std::remove(file_name.c_str());
+}
+
+TEST_CASE("CsvFileFollower reads a truncated file again from its header")
+{
+	const std::string file_name = "follow_truncated.csv";
+	write_file(file_name, header + "Acme,Engineer,Berlin\nBeta,Analyst,Paris\n");
+
+	FakeApplicationRepository repository;
+	CsvFileFollower follower(file_name, repository);
+	{
+		FollowerThread thread(follower);
+		REQUIRE(thread.wait_for_imported(2) != Clock::time_point());
+
+		write_file(file_name, header + "Gamma,Tester,Rome\n");
+		REQUIRE(thread.wait_for_imported(3) != Clock::time_point());
+	}
+
+	const auto apps = repository.find_all();
+	REQUIRE(apps.size() == 3);
+	REQUIRE(apps[2].company == "Gamma");
+
+	const CsvFollowStats stats = follower.stats();
+	REQUIRE(stats.truncations == 1);
+	REQUIRE(stats.offset == header.size() + 18);
+
+	std::remove(file_name.c_str());
+}
+
+TEST_CASE("CsvFileFollower finishes a rotated file and follows its successor")
+{
+	const std::string file_name = "follow_rotated.csv";
+	const std::string rotated_name = "follow_rotated.csv.1";
+	std::remove(rotated_name.c_str());
+	write_file(file_name, header + "Acme,Engineer,Berlin\n");
+
+	FakeApplicationRepository repository;
+	CsvFileFollower follower(file_name, repository);
+	{
+		FollowerThread thread(follower);
+		REQUIRE(thread.wait_for_imported(1) != Clock::time_point());
+
+		// The last row of the old file may still be unread when it is renamed.
+		append_file(file_name, "Beta,Analyst,Paris\n");
+		REQUIRE(std::rename(file_name.c_str(), rotated_name.c_str()) == 0);
+		write_file(file_name, header + "Gamma,Tester,Rome\nDelta,Designer,Oslo\n");
+
+		REQUIRE(thread.wait_for_imported(4) != Clock::time_point());
+	}
+
+	std::vector<std::string> companies;
+	for (const auto &app : repository.find_all())
+	{
+		companies.push_back(app.company);
+	}
+	REQUIRE(companies == std::vector<std::string>{"Acme", "Beta", "Gamma", "Delta"});
+
+	const CsvFollowStats stats = follower.stats();
+	REQUIRE(stats.rotations == 1);
+	REQUIRE(stats.truncations == 0);
+
+	std::remove(file_name.c_str());
+	std::remove(rotated_name.c_str());
+}
+
+TEST_CASE("CsvFileFollower resumes after its last committed row when restarted")
+{
+	const std::string file_name = "follow_restarted.csv";
+	write_file(file_name, header + "Acme,Engineer,Berlin\nBeta,Analyst,Paris\n");
+
+	FakeApplicationRepository repository;
+	{
+		CsvFileFollower follower(file_name, repository);
+		FollowerThread thread(follower);
+		REQUIRE(thread.wait_for_imported(2) != Clock::time_point());
+	}
+
+	append_file(file_name, "Gamma,Tester,Rome\n");
+
+	CsvFileFollower follower(file_name, repository);
+	{
+		FollowerThread thread(follower);
+		REQUIRE(thread.wait_for_imported(1) != Clock::time_point());
+	}
+
+	const auto apps = repository.find_all();
+	REQUIRE(apps.size() == 3);
+	REQUIRE(apps[2].company == "Gamma");
+	REQUIRE(follower.stats().imported == 1);
+
+	std::remove(file_name.c_str());
+}
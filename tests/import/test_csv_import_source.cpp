@@ -1,7 +1,12 @@
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
+#include <cstdint>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "import/csv_import_source.h"
+#include "tests/import/gzip_test_utils.h"
 
 TEST_CASE("CsvImportSource_reads_applications_from_csv_file")
 {
@@ -67,3 +72,166 @@ TEST_CASE("CsvImportSource_returns_empty_vector_for_header_only_file")
 
 	REQUIRE(apps.empty());
 }
+
+TEST_CASE("CsvImportSource_keeps_quoted_commas_and_newlines_in_fields")
+{
+	const std::string file_name = "test_csv_import_source_quoted.csv";
+
+	{
+		std::ofstream out(file_name);
+		REQUIRE(out.is_open());
+
+		out << "company,position,notes\n";
+		out << "\"ACME, Inc.\",C++ Developer,\"Recruiter: Jane, \"\"JD\"\" Doe\nCall back Monday\"\n";
+	}
+
+	CsvImportSource source(file_name);
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == 1);
+	REQUIRE(apps[0].company == "ACME, Inc.");
+	REQUIRE(apps[0].position == "C++ Developer");
+	REQUIRE(apps[0].notes == "Recruiter: Jane, \"JD\" Doe\nCall back Monday");
+}
+
+TEST_CASE("CsvImportSource_streams_large_file_in_bounded_batches")
+{
+	const std::string file_name = "test_csv_import_source_large.csv";
+	const std::size_t row_count = 200000;
+
+	{
+		std::ofstream out(file_name);
+		REQUIRE(out.is_open());
+
+		out << "company,position,location,notes\n";
+		for (std::size_t i = 0; i < row_count; ++i)
+		{
+			out << "Company " << i << ",C++ Developer,Remote,\"Row " << i << ", synthetic\"\n";
+		}
+	}
+
+	CsvImportSource source(file_name);
+	const auto stream = source.open_stream();
+
+	const std::size_t batch_size = 1000;
+	std::vector<Application> batch;
+	std::size_t total = 0;
+	std::size_t largest_capacity = 0;
+
+	while (stream->next_batch(batch, batch_size))
+	{
+		REQUIRE(batch.size() <= batch_size);
+		REQUIRE(batch.front().company == "Company " + std::to_string(total));
+
+		total += batch.size();
+		largest_capacity = std::max(largest_capacity, batch.capacity());
+	}
+
+	// The stream never buffers more than one batch of decoded rows.
+	REQUIRE(total == row_count);
+	REQUIRE(largest_capacity <= 2 * batch_size);
+}
+
+TEST_CASE("CsvImportSource_parallel_decoding_preserves_row_order")
+{
+	const std::string file_name = "test_csv_import_source_parallel.csv";
+	const std::size_t row_count = 300000;
+
+	{
+		std::ofstream out(file_name);
+		REQUIRE(out.is_open());
+
+		out << "company,position,notes\n";
+		for (std::size_t i = 0; i < row_count; ++i)
+		{
+			out << "Company " << i << ",Engineer,\"Line one\nLine two, " << i << "\"\n";
+		}
+	}
+
+	CsvImportSource sequential(file_name);
+	CsvImportSource parallel(file_name, ',', 4);
+
+	const auto expected = sequential.fetch_applications();
+	const auto actual = parallel.fetch_applications();
+
+	REQUIRE(expected.size() == row_count);
+	REQUIRE(actual.size() == row_count);
+
+	bool all_equal = true;
+	for (std::size_t i = 0; i < row_count; ++i)
+	{
+		all_equal = all_equal && actual[i].company == expected[i].company && actual[i].notes == expected[i].notes;
+	}
+	REQUIRE(all_equal);
+}
+
+TEST_CASE("CsvImportSource_resumes_streams_at_a_committed_offset")
+{
+	const std::string file_name = "test_csv_import_source_resume.csv";
+	const std::size_t row_count = 5000;
+
+	{
+		std::ofstream out(file_name);
+		REQUIRE(out.is_open());
+
+		out << "company,position,notes\n";
+		for (std::size_t i = 0; i < row_count; ++i)
+		{
+			out << "Company " << i << ",Engineer,\"line\nbreak " << i << "\"\n";
+		}
+	}
+
+	for (const std::size_t thread_count : {std::size_t{1}, std::size_t{3}})
+	{
+		CsvImportSource source(file_name, ',', thread_count);
+
+		std::vector<Application> batch;
+		const auto first = source.open_stream();
+		REQUIRE(first->next_batch(batch, 1234));
+		REQUIRE(first->next_batch(batch, 1234));
+		const std::uint64_t offset = first->resume_offset();
+
+		const auto resumed = source.open_stream_at(offset);
+		const auto rest = drain_stream(*resumed);
+
+		REQUIRE(rest.size() == row_count - 2468);
+		REQUIRE(rest.front().company == "Company 2468");
+		REQUIRE(rest.back().company == "Company 4999");
+		REQUIRE(resumed->resume_offset() == source.checkpoint_identity()->source_size);
+	}
+}
+
+TEST_CASE("CsvImportSource_decodes_gzip_files_while_decompressing_and_resumes_inside_them")
+{
+	const std::string file_name = "test_csv_import_source.csv.gz";
+	const std::size_t row_count = 30000;
+
+	// Large enough to span several decompressed chunks, with records split across them.
+	std::string document = "company,position,notes\n";
+	for (std::size_t i = 0; i < row_count; ++i)
+	{
+		document += "Company " + std::to_string(i) + ",Engineer,\"line\nbreak, " + std::to_string(i) + "\"\n";
+	}
+	write_gzip_file(file_name, document);
+
+	// Parallel decoding is not available for gzip; the thread count is ignored.
+	CsvImportSource source(file_name, ',', 4);
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == row_count);
+	REQUIRE(apps.front().company == "Company 0");
+	REQUIRE(apps.back().company == "Company 29999");
+	REQUIRE(apps.back().notes == "line\nbreak, 29999");
+
+	std::vector<Application> batch;
+	const auto first = source.open_stream();
+	REQUIRE(first->next_batch(batch, 10000));
+	const std::uint64_t offset = first->resume_offset();
+
+	const auto resumed = source.open_stream_at(offset);
+	const auto rest = drain_stream(*resumed);
+
+	REQUIRE(rest.size() == row_count - 10000);
+	REQUIRE(rest.front().company == "Company 10000");
+	REQUIRE(resumed->resume_offset() == document.size());
+}
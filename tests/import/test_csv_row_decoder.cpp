@@ -0,0 +1,105 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/csv_row_decoder.h"
+#include "tests/util/allocation_counter.h"
+
+TEST_CASE("CsvRowDecoder_projects_columns_in_any_order_and_trims_values")
+{
+	const std::vector<std::string_view> header = {"notes", " Position ", "COMPANY", "unknown"};
+	const CsvRowDecoder decoder(header, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+
+	REQUIRE(decoder.column_of("company") == 2);
+	REQUIRE(decoder.column_of("position") == 1);
+	REQUIRE(decoder.column_of("notes") == 0);
+	REQUIRE(decoder.column_of("location") == CsvRowDecoder::no_column);
+
+	Application app;
+	app.location = "left over from a previous row";
+
+	REQUIRE(decoder.decode({"  first note ", "Engineer\t", " ACME ", "ignored"}, app));
+	REQUIRE(app.company == "ACME");
+	REQUIRE(app.position == "Engineer");
+	REQUIRE(app.notes == "first note");
+	REQUIRE(app.location.empty());
+}
+
+TEST_CASE("CsvRowDecoder_accepts_aliases_and_separator_variants")
+{
+	const std::vector<std::string_view> header = {"Employer", "Job Title", "Date-Applied", "Last Updated", "Comments"};
+	const CsvRowDecoder decoder(header, CsvRowDecoder::RequiredFields::CompanyAndPosition);
+
+	REQUIRE(decoder.column_of("company") == 0);
+	REQUIRE(decoder.column_of("position") == 1);
+	REQUIRE(decoder.column_of("applied_date") == 2);
+	REQUIRE(decoder.column_of("last_update") == 3);
+	REQUIRE(decoder.column_of("notes") == 4);
+
+	Application app;
+	REQUIRE(decoder.decode({"ACME", "C++ Developer", "2025-01-01", "2025-01-05", "Referral"}, app));
+	REQUIRE(app.applied_date == "2025-01-01");
+	REQUIRE(app.notes == "Referral");
+}
+
+TEST_CASE("CsvRowDecoder_prefers_canonical_names_over_aliases")
+{
+	const std::vector<std::string_view> header = {"company", "employer", "title"};
+	const CsvRowDecoder decoder(header, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+
+	REQUIRE(decoder.column_of("company") == 0);
+	REQUIRE(decoder.column_of("position") == 2);
+}
+
+TEST_CASE("CsvRowDecoder_rejects_blank_short_and_incomplete_rows")
+{
+	const std::vector<std::string_view> header = {"company", "position", "notes"};
+	const CsvRowDecoder strict(header, CsvRowDecoder::RequiredFields::CompanyAndPosition);
+	const CsvRowDecoder lenient(header, CsvRowDecoder::RequiredFields::CompanyOrPosition);
+
+	Application app;
+	REQUIRE_FALSE(lenient.decode({""}, app));
+	REQUIRE_FALSE(lenient.decode({}, app));
+
+	// Short rows leave the missing columns empty.
+	REQUIRE(lenient.decode({"ACME"}, app));
+	REQUIRE(app.position.empty());
+	REQUIRE_FALSE(strict.decode({"ACME"}, app));
+	REQUIRE_FALSE(strict.decode({"  ", "Engineer"}, app));
+}
+
+TEST_CASE("CsvRowDecoder_decodes_into_reused_strings_without_allocating")
+{
+	if (!AllocationCounter::supported())
+	{
+		WARN("Allocation counting is unavailable in sanitizer builds");
+		return;
+	}
+
+	const std::vector<std::string_view> header = {"company", "position", "location", "notes"};
+	const CsvRowDecoder decoder(header, CsvRowDecoder::RequiredFields::CompanyAndPosition);
+
+	const std::vector<std::string_view> row = {
+		"ACME Corporation International Holdings",
+		"Senior C++ Software Engineer (Storage Team)",
+		"Remote within the European Union timezone",
+		"Referred by a former colleague from the platform team"};
+
+	Application app;
+	REQUIRE(decoder.decode(row, app));
+
+	std::size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		for (int i = 0; i < 100; ++i)
+		{
+			decoder.decode(row, app);
+		}
+		allocations = counter.count();
+	}
+
+	REQUIRE(allocations == 0);
+	REQUIRE(app.notes == "Referred by a former colleague from the platform team");
+}
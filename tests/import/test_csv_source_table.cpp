@@ -0,0 +1,225 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "import/csv_import_source.h"
+#include "import/csv_source_table.h"
+#include "import/import_service.h"
+#include "storage/sqlite_application_repository.h"
+#include "tests/import/file_test_utils.h"
+#include "tests/import/gzip_test_utils.h"
+
+namespace
+{
+	/// Run a query and return its rows, every column converted to text ("NULL" for NULL).
+	std::vector<std::vector<std::string>> query(SqliteDatabase &database, const std::string &sql)
+	{
+		sqlite3 *db = database.handle();
+		sqlite3_stmt *stmt = nullptr;
+		if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+		{
+			throw std::runtime_error(sqlite3_errmsg(db));
+		}
+
+		std::vector<std::vector<std::string>> rows;
+		int rc = SQLITE_ROW;
+		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+		{
+			auto &row = rows.emplace_back();
+			for (int i = 0; i < sqlite3_column_count(stmt); ++i)
+			{
+				const auto *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, i));
+				row.emplace_back(text != nullptr ? text : "NULL");
+			}
+		}
+
+		const std::string error = sqlite3_errmsg(db);
+		sqlite3_finalize(stmt);
+		if (rc != SQLITE_DONE)
+		{
+			throw std::runtime_error(error);
+		}
+		return rows;
+	}
+}
+
+TEST_CASE("csv_source queries the records of a CSV file like CsvImportSource decodes them")
+{
+	const std::string file_name = "csv_source_query.csv";
+	write_file(file_name,
+		"Employer, Job Title ,salary,Status,comments\n"
+		"Acme, Engineer ,90000,applied,\"Call back, \"\"soon\"\"\"\n"
+		",,,,no company nor position\n"
+		"\n"
+		"Beta,Analyst,70000,rejected,\n"
+		"Gamma,\"Tester\nlead\",80000\n");
+
+	SqliteApplicationRepository repository(":memory:");
+	register_csv_source(repository.database().handle());
+
+	const auto rows = query(repository.database(),
+		"SELECT rowid, company, position, status, notes, location FROM csv_source('" + file_name + "')");
+
+	REQUIRE(rows.size() == 3);
+	REQUIRE(rows[0] == std::vector<std::string>{"1", "Acme", "Engineer", "applied", "Call back, \"soon\"", ""});
+	REQUIRE(rows[1] == std::vector<std::string>{"2", "Beta", "Analyst", "rejected", "", ""});
+	REQUIRE(rows[2] == std::vector<std::string>{"3", "Gamma", "Tester\nlead", "", "", ""});
+
+	const auto counts = query(repository.database(),
+		"SELECT status, count(*) FROM csv_source('" + file_name + "', ',') GROUP BY status ORDER BY status");
+	REQUIRE(counts == std::vector<std::vector<std::string>>{{"", "1"}, {"applied", "1"}, {"rejected", "1"}});
+
+	std::remove(file_name.c_str());
+}
+
+TEST_CASE("csv_source reads gzip-compressed files and other delimiters")
+{
+	const std::string file_name = "csv_source_query.csv.gz";
+	{
+		std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+		out << gzip_compress("company;position;location\nAcme;Engineer;Berlin\nBeta;Analyst;Paris\n");
+	}
+
+	SqliteApplicationRepository repository(":memory:");
+	register_csv_source(repository.database().handle());
+
+	const auto rows = query(repository.database(),
+		"SELECT location FROM csv_source('" + file_name + "', ';') WHERE company = 'Beta'");
+	REQUIRE(rows == std::vector<std::vector<std::string>>{{"Paris"}});
+
+	std::remove(file_name.c_str());
+}
+
+TEST_CASE("csv_source reports a missing file or path as an SQL error")
+{
+	SqliteApplicationRepository repository(":memory:");
+	register_csv_source(repository.database().handle());
+
+	REQUIRE_THROWS_AS(query(repository.database(), "SELECT company FROM csv_source('does_not_exist.csv')"),
+		std::runtime_error);
+	REQUIRE_THROWS_AS(query(repository.database(), "SELECT company FROM csv_source"), std::runtime_error);
+	REQUIRE_THROWS_AS(query(repository.database(), "SELECT company FROM csv_source('x.csv', ';;')"),
+		std::runtime_error);
+}
+
+TEST_CASE("import_csv_where inserts the matching records with the import defaults")
+{
+	const std::string file_name = "csv_source_import.csv";
+	write_file(file_name,
+		"company,position,status,applied_date,notes\n"
+		"Acme,Engineer,,2025-01-02,first\n"
+		"Beta,Analyst,rejected,,second\n"
+		"Gamma,Tester,interview,,third\n");
+
+	SqliteApplicationRepository repository(":memory:");
+	register_csv_source(repository.database().handle());
+
+	REQUIRE(import_csv_where(repository.database(), file_name, "status <> 'rejected'") == 2);
+
+	const auto apps = repository.find_all();
+	REQUIRE(apps.size() == 2);
+	REQUIRE(apps[0].company == "Acme");
+	REQUIRE(apps[0].status == "applied");
+	REQUIRE(apps[0].applied_date == "2025-01-02");
+	REQUIRE(apps[0].notes == "first");
+	REQUIRE(apps[1].company == "Gamma");
+	REQUIRE(apps[1].status == "interview");
+	REQUIRE_FALSE(apps[1].applied_date.empty());
+	REQUIRE(apps[1].last_update == apps[1].applied_date);
+
+	// A condition that is not a single expression is rejected; nothing is written.
+	REQUIRE_THROWS_AS(import_csv_where(repository.database(), file_name, "1; DELETE FROM applications"),
+		std::runtime_error);
+	REQUIRE_THROWS_AS(import_csv_where(repository.database(), file_name, "no_such_column = 1"), std::runtime_error);
+	REQUIRE_THROWS_AS(import_csv_where(repository.database(), "does_not_exist.csv", ""), std::runtime_error);
+	REQUIRE(repository.find_all().size() == 2);
+
+	REQUIRE(import_csv_where(repository.database(), file_name, "") == 3);
+	REQUIRE(repository.find_all().size() == 5);
+
+	std::remove(file_name.c_str());
+}
+
+TEST_CASE("import_csv_where without a condition stores the same rows as ImportService")
+{
+	const std::string file_name = "csv_source_compare.csv";
+	write_file(file_name,
+		"Employer,Job Title,location,source,status,applied_date,last_update,notes\n"
+		"Acme,Engineer,Berlin,linkedin,,,,\"Call back, \"\"soon\"\"\"\n"
+		"Beta,Analyst,,,rejected,2025-01-02,,\n"
+		",,,,,,,no company nor position\n"
+		"Gamma,\"Tester\nlead\",Paris,referral,interview,2025-02-03,2025-02-10,third\n");
+
+	SqliteApplicationRepository by_service(":memory:");
+	CsvImportSource source(file_name);
+	ImportService service(source, by_service);
+	REQUIRE(service.run_once().imported == 3);
+
+	SqliteApplicationRepository by_sql(":memory:");
+	register_csv_source(by_sql.database().handle());
+	REQUIRE(import_csv_where(by_sql.database(), file_name, "") == 3);
+
+	const std::string columns =
+		"SELECT id, company, position, location, source, status, applied_date, last_update, notes "
+		"FROM applications ORDER BY id";
+	const auto expected = query(by_service.database(), columns);
+	REQUIRE(expected.size() == 3);
+	REQUIRE(expected[0][5] == Application::default_status);
+	REQUIRE(query(by_sql.database(), columns) == expected);
+
+	std::remove(file_name.c_str());
+}
+
+TEST_CASE("import_csv_where is faster than importing through ImportService", "[.benchmark]")
+{
+	constexpr int rows = 200000;
+	const std::string file_name = "csv_source_benchmark.csv";
+	{
+		// Wide rows: the columns after notes are never decoded by csv_source.
+		std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+		out << "company,position,location,status,notes,description,requirements,benefits\n";
+		for (int i = 0; i < rows; ++i)
+		{
+			out << "Company " << i << ",Senior C++ Engineer,\"Berlin, Germany\","
+				<< (i % 4 == 0 ? "rejected" : "applied") << ",Referred by Alex,"
+				<< "\"We build \"\"fast\"\" things, and then some more of them\","
+				<< "C++20 and SQL and Linux and more,Remote and a budget for books\n";
+		}
+	}
+
+	using Clock = std::chrono::steady_clock;
+
+	SqliteApplicationRepository by_service(":memory:");
+	const auto service_start = Clock::now();
+	CsvImportSource source(file_name);
+	ImportService service(source, by_service);
+	const ImportResult service_result = service.run_once();
+	const std::chrono::duration<double> service_seconds = Clock::now() - service_start;
+
+	SqliteApplicationRepository by_sql(":memory:");
+	register_csv_source(by_sql.database().handle());
+	const auto sql_start = Clock::now();
+	const std::size_t sql_imported = import_csv_where(by_sql.database(), file_name, "");
+	const std::chrono::duration<double> sql_seconds = Clock::now() - sql_start;
+
+	const auto filter_start = Clock::now();
+	const std::size_t filtered = import_csv_where(by_sql.database(), file_name, "status <> 'rejected'");
+	const std::chrono::duration<double> filter_seconds = Clock::now() - filter_start;
+
+	REQUIRE(service_result.imported == static_cast<std::size_t>(rows));
+	REQUIRE(sql_imported == static_cast<std::size_t>(rows));
+	REQUIRE(filtered == static_cast<std::size_t>(rows - rows / 4));
+
+	WARN(rows << " wide CSV rows: ImportService " << service_seconds.count() << " s; INSERT ... SELECT FROM csv_source "
+		<< sql_seconds.count() << " s (" << service_seconds.count() / sql_seconds.count() << "x); with WHERE "
+		<< filter_seconds.count() << " s");
+
+	std::remove(file_name.c_str());
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/csv_stream_tokenizer.h"
+#include "import/csv_tokenizer.h"
+
+namespace
+{
+	using Records = std::vector<std::vector<std::string>>;
+
+	/// Tokenize the whole input at once, as the reference result.
+	Records tokenize_whole(std::string_view input)
+	{
+		CsvTokenizer tokenizer(input);
+
+		Records records;
+		std::vector<std::string_view> fields;
+		while (tokenizer.next_record(fields))
+		{
+			records.emplace_back(fields.begin(), fields.end());
+		}
+		return records;
+	}
+
+	/// Feed the input in chunks of `chunk_size` bytes, reading records whenever possible.
+	Records tokenize_chunked(std::string_view input, std::size_t chunk_size)
+	{
+		CsvStreamTokenizer tokenizer;
+
+		Records records;
+		std::vector<std::string_view> fields;
+
+		for (std::size_t pos = 0; pos < input.size(); pos += chunk_size)
+		{
+			tokenizer.append(input.substr(pos, chunk_size));
+			while (tokenizer.next_record(fields))
+			{
+				records.emplace_back(fields.begin(), fields.end());
+			}
+		}
+
+		tokenizer.finish();
+		while (tokenizer.next_record(fields))
+		{
+			records.emplace_back(fields.begin(), fields.end());
+		}
+
+		REQUIRE(tokenizer.exhausted());
+		REQUIRE(tokenizer.offset() == input.size());
+		return records;
+	}
+}
+
+TEST_CASE("CsvStreamTokenizer_matches_whole_buffer_tokenizing_for_any_chunk_size")
+{
+	const std::string input =
+		"company,position,notes\r\n"
+		"ACME,\"C++, Senior\",\"line one\nline two\"\r\n"
+		"\"Beta \"\"Labs\"\"\",DevOps,\r"
+		"Gamma,QA,\"ends with CR\r\"\r\n"
+		"\n"
+		"Delta,Data,no final newline";
+
+	const Records expected = tokenize_whole(input);
+	REQUIRE(expected.size() == 6);
+
+	for (std::size_t chunk_size = 1; chunk_size <= input.size(); ++chunk_size)
+	{
+		REQUIRE(tokenize_chunked(input, chunk_size) == expected);
+	}
+}
+
+TEST_CASE("CsvStreamTokenizer_returns_records_only_once_they_are_complete")
+{
+	CsvStreamTokenizer tokenizer;
+	std::vector<std::string_view> fields;
+
+	tokenizer.append("a,\"b\n");
+	REQUIRE_FALSE(tokenizer.next_record(fields));
+
+	tokenizer.append("c\"\r");
+	REQUIRE_FALSE(tokenizer.next_record(fields));
+
+	tokenizer.append("\nd,e\n");
+	REQUIRE(tokenizer.next_record(fields));
+	REQUIRE(fields.size() == 2);
+	REQUIRE(fields[1] == "b\nc");
+	REQUIRE(tokenizer.offset() == 9);
+
+	REQUIRE(tokenizer.next_record(fields));
+	REQUIRE(fields[0] == "d");
+	REQUIRE_FALSE(tokenizer.next_record(fields));
+	REQUIRE_FALSE(tokenizer.exhausted());
+
+	tokenizer.finish();
+	REQUIRE(tokenizer.exhausted());
+}
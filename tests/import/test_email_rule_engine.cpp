@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "import/email_rule_engine.h"
+
+namespace
+{
+	EmailMessage make_message(const std::string &from, const std::string &subject, const std::string &body)
+	{
+		EmailMessage message;
+		message.from = from;
+		message.subject = subject;
+		message.body_text = body;
+		return message;
+	}
+}
+
+TEST_CASE("EmailRuleEngine extracts company and position from subject templates")
+{
+	const EmailRuleEngine engine(EmailRuleSet::defaults());
+
+	const EmailExtraction first = engine.extract(make_message(
+		"ACME Recruiting <no-reply@us.greenhouse-mail.io>",
+		"Your application to ACME Corp for Senior C++ Developer",
+		"Thank you for applying. We will review your application."));
+	REQUIRE(first.company == "ACME Corp");
+	REQUIRE(first.position == "Senior C++ Developer");
+	REQUIRE(first.status == "applied");
+	REQUIRE(first.source == "greenhouse");
+
+	const EmailExtraction second = engine.extract(make_message(
+		"jobs@beta.example",
+		"RE: Interview invitation: Backend Engineer (Go) at Beta GmbH!",
+		"Please share your availability for next week."));
+	REQUIRE(second.company == "Beta GmbH");
+	REQUIRE(second.position == "Backend Engineer (Go)");
+	REQUIRE(second.status == "interview");
+	REQUIRE(second.source.empty());
+
+	const EmailExtraction third = engine.extract(make_message("hr@gamma.example", "Hello there", "Just saying hi."));
+	REQUIRE(third.company.empty());
+	REQUIRE(third.position.empty());
+	REQUIRE(third.status.empty());
+}
+
+TEST_CASE("EmailRuleEngine prefers rejection over earlier stages")
+{
+	const EmailRuleEngine engine(EmailRuleSet::defaults());
+
+	const EmailExtraction extraction = engine.extract(make_message(
+		"no-reply@hire.lever.co",
+		"Your application for Data Engineer at Delta",
+		"Thank you for taking the time to interview with us. Unfortunately, we have decided to move forward with other candidates."));
+
+	REQUIRE(extraction.company == "Delta");
+	REQUIRE(extraction.position == "Data Engineer");
+	REQUIRE(extraction.status == "rejected");
+	REQUIRE(extraction.source == "lever");
+}
+
+TEST_CASE("EmailRuleEngine uses configured rules")
+{
+	EmailRuleSet rules;
+	rules.ats_domains = {{"jobs.example", "example-ats"}};
+	rules.subject_templates = {"[{company}] {position} - next steps"};
+	rules.status_phrases = {{"coding challenge", "assessment"}};
+	const EmailRuleEngine engine(rules);
+
+	const EmailExtraction extraction = engine.extract(make_message(
+		"bot@mail.jobs.example",
+		"[Epsilon] QA Engineer - next steps",
+		"Your coding challenge is ready."));
+
+	REQUIRE(extraction.company == "Epsilon");
+	REQUIRE(extraction.position == "QA Engineer");
+	REQUIRE(extraction.status == "assessment");
+	REQUIRE(extraction.source == "example-ats");
+
+	EmailRuleSet bad;
+	bad.subject_templates = {"{company} {position}"};
+	REQUIRE_THROWS_AS(EmailRuleEngine(bad), std::runtime_error);
+	bad.subject_templates = {"Applied to {employer}"};
+	REQUIRE_THROWS_AS(EmailRuleEngine(bad), std::runtime_error);
+}
+
+TEST_CASE("EmailRuleEngine throughput over a synthetic 100k-message corpus", "[.benchmark]")
+{
+	const EmailRuleEngine engine(EmailRuleSet::defaults());
+
+	const std::vector<std::string> senders = {
+		"no-reply@greenhouse.io", "jobs@lever.co", "news@shop.example", "friend@mail.example"};
+	const std::vector<std::string> subjects = {
+		"Your application to Company {n} for Engineer {n}",
+		"Weekly deals: {n}% off everything",
+		"Interview invitation: Analyst {n} at Firm {n}",
+		"Re: dinner on Friday?"};
+	const std::string filler =
+		"Hello, this message contains a few paragraphs of ordinary text so that the body is about as long as "
+		"a typical notification email. It mentions nothing in particular and continues for a while longer, "
+		"with links, footers and an unsubscribe notice at the very end of the message. ";
+	const std::vector<std::string> endings = {
+		"We received your application.", "Unfortunately we will not proceed.", "Shop now!", "See you soon."};
+
+	std::vector<EmailMessage> corpus;
+	corpus.reserve(100000);
+	for (std::size_t i = 0; i < 100000; ++i)
+	{
+		std::string subject = subjects[i % subjects.size()];
+		for (std::size_t at = subject.find("{n}"); at != std::string::npos; at = subject.find("{n}"))
+		{
+			subject.replace(at, 3, std::to_string(i));
+		}
+		corpus.push_back(make_message(senders[i % senders.size()], subject, filler + endings[(i / 4) % endings.size()]));
+	}
+
+	std::size_t with_company = 0;
+	std::size_t with_status = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto &message : corpus)
+	{
+		const EmailExtraction extraction = engine.extract(message);
+		with_company += extraction.company.empty() ? 0 : 1;
+		with_status += extraction.status.empty() ? 0 : 1;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	REQUIRE(with_company == 50000);
+	REQUIRE(with_status == 62500);
+
+	const double messages_per_second = seconds > 0.0 ? static_cast<double>(corpus.size()) / seconds : 0.0;
+	WARN("EmailRuleEngine: " << static_cast<long long>(messages_per_second) << " messages/s");
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/gzip_file_reader.h"
+#include "tests/import/gzip_test_utils.h"
+
+namespace
+{
+	/// Decompress a whole file with the given chunk size.
+	std::string read_all(const std::string &file_name, std::size_t chunk_bytes)
+	{
+		GzipFileReader reader(file_name, chunk_bytes);
+		std::string all;
+		std::string chunk;
+		std::size_t largest = 0;
+		while (reader.read(chunk))
+		{
+			largest = std::max(largest, chunk.size());
+			all += chunk;
+		}
+		REQUIRE(largest <= chunk_bytes);
+		REQUIRE(reader.decompressed_offset() == all.size());
+		return all;
+	}
+}
+
+TEST_CASE("GzipFileReader_decompresses_in_bounded_chunks")
+{
+	std::string document;
+	for (int i = 0; i < 20000; ++i)
+	{
+		document += "Company " + std::to_string(i) + ",Engineer\n";
+	}
+
+	const std::string file_name = "test_gzip_file_reader.csv.gz";
+	write_gzip_file(file_name, document);
+
+	REQUIRE(read_all(file_name, 4096) == document);
+	REQUIRE(read_all(file_name, 7) == document);
+}
+
+TEST_CASE("GzipFileReader_reads_concatenated_members_as_one_stream")
+{
+	const std::string file_name = "test_gzip_file_reader_members.csv.gz";
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		out << gzip_compress("company,position\nACME,C++\n");
+		out << gzip_compress("Beta,DevOps\n");
+	}
+
+	REQUIRE(read_all(file_name, 1024) == "company,position\nACME,C++\nBeta,DevOps\n");
+}
+
+TEST_CASE("GzipFileReader_throws_on_truncated_and_invalid_files")
+{
+	const std::string compressed = gzip_compress("company,position\nACME,C++ Developer\n");
+
+	const std::string truncated_name = "test_gzip_file_reader_truncated.csv.gz";
+	{
+		std::ofstream out(truncated_name, std::ios::binary);
+		out << compressed.substr(0, compressed.size() - 6);
+	}
+	REQUIRE_THROWS_AS(read_all(truncated_name, 1024), std::runtime_error);
+
+	const std::string invalid_name = "test_gzip_file_reader_invalid.csv.gz";
+	{
+		std::ofstream out(invalid_name, std::ios::binary);
+		out << "company,position\n";
+	}
+	REQUIRE_THROWS_AS(read_all(invalid_name, 1024), std::runtime_error);
+}
+
+TEST_CASE("GzipFileReader_recognizes_gzip_paths")
+{
+	REQUIRE(GzipFileReader::is_gzip_path("exports/2025.csv.gz"));
+	REQUIRE_FALSE(GzipFileReader::is_gzip_path("exports/2025.csv"));
+	REQUIRE_FALSE(GzipFileReader::is_gzip_path("gz"));
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/http_client.h"
+#include "tests/import/gzip_test_utils.h"
+#include "tests/import/local_http_server.h"
+
+TEST_CASE("LibcurlHttpClient_sends_request_headers_and_returns_response_headers")
+{
+	LocalHttpServer server([](const HttpHeaders &)
+	{
+		HttpResponse response{};
+		response.status_code = 200;
+		response.body = "company,position\n";
+		response.headers["ETag"] = "\"v1\"";
+		response.headers["Last-Modified"] = "Wed, 21 Oct 2025 07:28:00 GMT";
+		return response;
+	});
+
+	LibcurlHttpClient client;
+
+	HttpHeaders headers;
+	headers["If-None-Match"] = "\"v0\"";
+	headers["Range"] = "bytes=10-";
+
+	const HttpResponse response = client.get(server.url("/jobs.csv"), headers);
+
+	REQUIRE(response.status_code == 200);
+	REQUIRE(response.body == "company,position\n");
+	REQUIRE(response.header("etag") == "\"v1\"");
+	REQUIRE(response.header("last-modified") == "Wed, 21 Oct 2025 07:28:00 GMT");
+	REQUIRE(response.header("x-missing").empty());
+
+	const auto requests = server.requests();
+	REQUIRE(requests.size() == 1);
+	REQUIRE(requests[0].at("if-none-match") == "\"v0\"");
+	REQUIRE(requests[0].at("range") == "bytes=10-");
+}
+
+TEST_CASE("LibcurlHttpClient_returns_not_modified_without_a_body")
+{
+	LocalHttpServer server([](const HttpHeaders &)
+	{
+		HttpResponse response{};
+		response.status_code = 304;
+		return response;
+	});
+
+	LibcurlHttpClient client;
+	const HttpResponse response = client.get(server.url("/jobs.csv"));
+
+	REQUIRE(response.status_code == 304);
+	REQUIRE(response.body.empty());
+}
+
+TEST_CASE("LibcurlHttpClient_reuses_one_connection_for_repeated_requests")
+{
+	LocalHttpServer server([](const HttpHeaders &)
+	{
+		HttpResponse response{};
+		response.status_code = 200;
+		response.body = "company,position\nACME,Engineer\n";
+		return response;
+	});
+
+	LibcurlHttpClient client;
+	for (int i = 0; i < 5; ++i)
+	{
+		REQUIRE(client.get(server.url("/jobs.csv")).status_code == 200);
+	}
+
+	REQUIRE(server.requests().size() == 5);
+	REQUIRE(server.connections() == 1);
+}
+
+TEST_CASE("LibcurlHttpClient_throws_when_the_total_timeout_expires")
+{
+	LocalHttpServer server([](const HttpHeaders &)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		HttpResponse response{};
+		response.status_code = 200;
+		return response;
+	});
+
+	HttpClientOptions options{};
+	options.total_timeout_ms = 100;
+
+	LibcurlHttpClient client(options);
+	REQUIRE_THROWS_AS(client.get(server.url("/slow.csv")), std::runtime_error);
+}
+
+TEST_CASE("LibcurlMultiHttpClient_runs_concurrent_requests_within_the_per_host_limit")
+{
+	std::atomic<int> active{0};
+	std::atomic<int> peak{0};
+
+	LocalHttpServer server([&](const HttpHeaders &)
+	{
+		const int now = ++active;
+		int seen = peak.load();
+		while (now > seen && !peak.compare_exchange_weak(seen, now))
+		{
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		--active;
+
+		HttpResponse response{};
+		response.status_code = 200;
+		response.body = "company,position\n";
+		return response;
+	});
+
+	LibcurlMultiHttpClient client(HttpClientOptions{}, 2);
+
+	std::vector<int> statuses(6, 0);
+	std::vector<std::thread> callers;
+	for (std::size_t i = 0; i < statuses.size(); ++i)
+	{
+		callers.emplace_back([&, i]()
+		{
+			statuses[i] = client.get(server.url("/jobs.csv")).status_code;
+		});
+	}
+	for (auto &caller : callers)
+	{
+		caller.join();
+	}
+
+	REQUIRE(std::all_of(statuses.begin(), statuses.end(), [](int status) { return status == 200; }));
+	REQUIRE(server.requests().size() == 6);
+	REQUIRE(peak.load() == 2);
+	REQUIRE(server.connections() == 2);
+}
+
+namespace
+{
+	/// Handler that refuses body chunks until the test lets it resume.
+	class PausingHandler : public IHttpResponseHandler
+	{
+	public:
+		bool on_head(int /*status_code*/, const HttpHeaders &/*headers*/) override
+		{
+			return true;
+		}
+
+		bool on_body(std::string_view chunk) override
+		{
+			body.append(chunk);
+			return true;
+		}
+
+		bool ready_for_body() override
+		{
+			asked.store(true);
+			return ready.load();
+		}
+
+		void set_resume(std::function<void()> resume) override
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			resume_ = std::move(resume);
+		}
+
+		/// Accept chunks from now on and resume the transfer.
+		void resume()
+		{
+			ready.store(true);
+			std::lock_guard<std::mutex> lock(mutex_);
+			REQUIRE(resume_);
+			resume_();
+		}
+
+		std::string body;
+		std::atomic<bool> asked{false};
+		std::atomic<bool> ready{false};
+
+	private:
+		std::function<void()> resume_;
+		std::mutex mutex_;
+	};
+}
+
+TEST_CASE("LibcurlMultiHttpClient_pauses_a_transfer_until_its_handler_resumes_it")
+{
+	const std::string document(1 << 20, 'x');
+	LocalHttpServer server([&](const HttpHeaders &)
+	{
+		HttpResponse response{};
+		response.status_code = 200;
+		response.body = document;
+		return response;
+	});
+
+	LibcurlMultiHttpClient client;
+	PausingHandler handler;
+
+	std::thread paused([&]()
+	{
+		client.get_streaming(server.url("/large.csv"), HttpHeaders{}, handler);
+	});
+
+	while (!handler.asked.load())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// The event loop is not blocked by the paused transfer.
+	REQUIRE(client.get(server.url("/small.csv")).status_code == 200);
+	REQUIRE(handler.body.empty());
+
+	handler.resume();
+	paused.join();
+
+	REQUIRE(handler.body == document);
+}
+
+TEST_CASE("LibcurlHttpClient_decodes_compressed_responses_but_not_ranges")
+{
+	const std::string document = "company,position\nACME,Engineer\nBeta,DevOps\n";
+
+	LocalHttpServer server([&](const HttpHeaders &request)
+	{
+		HttpResponse response{};
+		response.status_code = 200;
+		const auto accepted = request.find("accept-encoding");
+		if (accepted != request.end() && accepted->second.find("gzip") != std::string::npos)
+		{
+			response.headers["Content-Encoding"] = "gzip";
+			response.body = gzip_compress(document);
+		}
+		else
+		{
+			response.body = document;
+		}
+		return response;
+	});
+
+	LibcurlHttpClient client;
+
+	REQUIRE(client.get(server.url("/jobs.csv")).body == document);
+
+	HttpHeaders ranged;
+	ranged["Range"] = "bytes=0-";
+	REQUIRE(client.get(server.url("/jobs.csv"), ranged).body == document);
+
+	const auto requests = server.requests();
+	REQUIRE(requests.size() == 2);
+	REQUIRE(requests[0].count("accept-encoding") == 1);
+	REQUIRE(requests[1].count("accept-encoding") == 0);
+}
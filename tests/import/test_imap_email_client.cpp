@@ -0,0 +1,360 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "import/imap_email_client.h"
+#include "import/mime_decoder.h"
+#include "storage/sqlite_imap_sync_state_store.h"
+#include "local_imap_server.h"
+
+namespace
+{
+	ImapEmailClient::ConnectionSettings local_settings(const LocalImapServer &server)
+	{
+		ImapEmailClient::ConnectionSettings settings;
+		settings.host = "127.0.0.1";
+		settings.port = server.port();
+		settings.use_tls = false;
+		settings.timeout_seconds = 10;
+		settings.username = "me@example.com";
+		settings.password = "secret";
+		return settings;
+	}
+}
+
+TEST_CASE("ImapEmailClient fetches messages with their headers and text")
+{
+	LocalImapServer server;
+	server.append("Jobs <jobs@acme.example>", "Application received: C++ Developer", "Thanks for applying.\r\n");
+	server.append("hr@beta.example", "Interview invitation", "Please pick a slot.\r\n");
+
+	ImapEmailClient client(local_settings(server));
+	client.connect();
+	const auto messages = client.fetch_messages("ALL");
+	client.disconnect();
+
+	REQUIRE(messages.size() == 2);
+	REQUIRE(messages[0].id == "1");
+	REQUIRE(messages[0].from == "Jobs <jobs@acme.example>");
+	REQUIRE(messages[0].to == "me@example.com");
+	REQUIRE(messages[0].subject == "Application received: C++ Developer");
+	REQUIRE(messages[0].date == "Mon, 6 Jan 2025 10:00:00 +0000");
+	REQUIRE(messages[0].body_text == "Thanks for applying.\r\n");
+	REQUIRE(messages[1].subject == "Interview invitation");
+
+	const auto commands = server.commands();
+	REQUIRE(commands.front().rfind("LOGIN ", 0) == 0);
+	REQUIRE(messages[0].body_content_type == "text/plain");
+	REQUIRE(server.count_commands("UID FETCH 1:2 (UID ENVELOPE BODYSTRUCTURE)") == 1);
+	REQUIRE(server.count_commands("UID FETCH 1:2 (UID BODY.PEEK[1]<0.65536>)") == 1);
+	REQUIRE(commands.back() == "LOGOUT");
+}
+
+TEST_CASE("ImapEmailClient only fetches messages that arrived since the last committed sync")
+{
+	LocalImapServer server;
+	SqliteImapSyncStateStore sync_state(":memory:");
+	for (int i = 0; i < 3; ++i)
+	{
+		server.append("jobs@acme.example", "Old " + std::to_string(i), "body");
+	}
+
+	ImapEmailClient client(local_settings(server), &sync_state);
+	client.connect();
+	REQUIRE(client.fetch_messages("ALL").size() == 3);
+
+	// Not committed yet: the same messages are fetched again.
+	REQUIRE(client.fetch_messages("ALL").size() == 3);
+	client.on_messages_imported();
+	REQUIRE(sync_state.find(client.mailbox_key())->uid_next == 4);
+
+	server.append("jobs@acme.example", "New 1", "body");
+	server.append("jobs@acme.example", "New 2", "body");
+	server.clear_commands();
+
+	const auto messages = client.fetch_messages("ALL");
+	REQUIRE(messages.size() == 2);
+	REQUIRE(messages[0].subject == "New 1");
+	REQUIRE(messages[0].id == "4");
+	REQUIRE(server.count_commands("UID FETCH 4:5 (UID ENVELOPE BODYSTRUCTURE)") == 1);
+	REQUIRE_FALSE(client.last_sync_stats().unchanged);
+	client.on_messages_imported();
+
+	// Nothing new: one SELECT, no FETCH.
+	server.clear_commands();
+	REQUIRE(client.fetch_messages("ALL").empty());
+	REQUIRE(client.last_sync_stats().unchanged);
+	REQUIRE(server.commands().size() == 1);
+	REQUIRE(server.count_commands("SELECT ") == 1);
+	client.disconnect();
+}
+
+TEST_CASE("ImapEmailClient resyncs the mailbox when UIDVALIDITY changes")
+{
+	LocalImapServer server;
+	SqliteImapSyncStateStore sync_state(":memory:");
+	server.append("jobs@acme.example", "First", "body");
+	server.append("jobs@acme.example", "Second", "body");
+
+	ImapEmailClient client(local_settings(server), &sync_state);
+	client.connect();
+	REQUIRE(client.fetch_messages("ALL").size() == 2);
+	client.on_messages_imported();
+
+	// The mailbox was rebuilt: UIDs restart and old positions are meaningless.
+	server.reset_uid_validity(2000);
+	server.append("jobs@acme.example", "Rebuilt", "body");
+
+	const auto messages = client.fetch_messages("ALL");
+	REQUIRE(messages.size() == 1);
+	REQUIRE(messages[0].subject == "Rebuilt");
+	client.on_messages_imported();
+	REQUIRE(sync_state.find(client.mailbox_key())->uid_validity == 2000);
+	client.disconnect();
+}
+
+TEST_CASE("ImapEmailClient searches new messages and fetches the matches in UID sets")
+{
+	LocalImapServer server;
+	SqliteImapSyncStateStore sync_state(":memory:");
+	server.append("a@example.com", "Newsletter", "body");
+	server.append("b@example.com", "Application received", "body");
+	server.append("c@example.com", "Application received", "body");
+	server.append("d@example.com", "Newsletter", "body");
+	server.append("e@example.com", "Application received", "body");
+
+	ImapEmailClient client(local_settings(server), &sync_state);
+	client.connect();
+	const auto messages = client.fetch_messages("SUBJECT \"Application\"");
+	client.on_messages_imported();
+
+	REQUIRE(messages.size() == 3);
+	REQUIRE(messages[0].id == "2");
+	REQUIRE(messages[2].id == "5");
+	REQUIRE(server.count_commands("UID SEARCH UID 1:* SUBJECT \"Application\"") == 1);
+	REQUIRE(server.count_commands("UID FETCH 2:3,5 (UID ENVELOPE BODYSTRUCTURE)") == 1);
+
+	// Later syncs only search above the stored UIDNEXT.
+	server.append("f@example.com", "Application received", "body");
+	REQUIRE(client.fetch_messages("SUBJECT \"Application\"").size() == 1);
+	REQUIRE(server.count_commands("UID SEARCH UID 6:* ") == 1);
+	client.disconnect();
+}
+
+TEST_CASE("ImapEmailClient searches the UIDs of a sparse mailbox instead of walking UIDNEXT")
+{
+	LocalImapServer server;
+	server.append("a@example.com", "Application received", "body");
+	server.skip_uids(100000);
+	server.append("b@example.com", "Interview invitation", "body");
+
+	ImapEmailClient client(local_settings(server));
+	client.connect();
+	const auto messages = client.fetch_messages("ALL");
+	client.disconnect();
+
+	// Two messages below UIDNEXT 100003: one SEARCH and one FETCH, not 200 empty windows.
+	REQUIRE(messages.size() == 2);
+	REQUIRE(messages[1].id == "100002");
+	REQUIRE(server.count_commands("UID SEARCH UID 1:*") == 1);
+	REQUIRE(server.count_commands("UID FETCH 1,100002 (UID ENVELOPE BODYSTRUCTURE)") == 1);
+	REQUIRE(server.count_commands("UID FETCH") == 2);
+}
+
+TEST_CASE("ImapEmailClient uses CONDSTORE when the server supports it")
+{
+	LocalImapServer server(true);
+	SqliteImapSyncStateStore sync_state(":memory:");
+	server.append("jobs@acme.example", "First", "body");
+
+	ImapEmailClient client(local_settings(server), &sync_state);
+	client.connect();
+	REQUIRE(client.has_capability("condstore"));
+	REQUIRE(client.fetch_messages("ALL").size() == 1);
+	client.on_messages_imported();
+	client.disconnect();
+
+	REQUIRE(server.count_commands("SELECT \"INBOX\" (CONDSTORE)") == 1);
+	REQUIRE(sync_state.find(client.mailbox_key())->highest_modseq == 2);
+}
+
+TEST_CASE("ImapEmailClient full mode fetches headers and text in one pass")
+{
+	LocalImapServer server;
+	server.append("Jobs <jobs@acme.example>", "Application received", "Thanks.\r\n");
+
+	ImapFetchOptions fetch;
+	fetch.mode = ImapFetchMode::Full;
+	ImapEmailClient client(local_settings(server), nullptr, fetch);
+	client.connect();
+	const auto messages = client.fetch_messages("ALL");
+
+	REQUIRE(messages.size() == 1);
+	REQUIRE(messages[0].from == "Jobs <jobs@acme.example>");
+	REQUIRE(messages[0].body_text == "Thanks.\r\n");
+	REQUIRE(messages[0].body_content_type == "text/plain; charset=utf-8");
+	REQUIRE(messages[0].body_transfer_encoding == "7BIT");
+	REQUIRE(client.last_sync_stats().commands == 2);
+	REQUIRE(server.count_commands("UID FETCH 1:1 (UID BODY.PEEK[HEADER.FIELDS") == 1);
+	client.disconnect();
+}
+
+TEST_CASE("ImapEmailClient full mode fetches multipart bodies the MimeDecoder can read")
+{
+	LocalImapServer server;
+	LocalImapServer::Part html;
+	html.subtype = "html";
+	html.encoding = "BASE64";
+	html.content = "PHA+V2UgcmVjZWl2ZWQgeW91ciBhcHBsaWNhdGlvbi48L3A+";
+	LocalImapServer::Part pdf;
+	pdf.type = "application";
+	pdf.subtype = "pdf";
+	pdf.content = "%PDF-1.4";
+	server.append_multipart("Jobs <no-reply@greenhouse.io>", "Thanks for applying", {html, pdf});
+
+	ImapFetchOptions fetch;
+	fetch.mode = ImapFetchMode::Full;
+	ImapEmailClient client(local_settings(server), nullptr, fetch);
+	client.connect();
+	auto messages = client.fetch_messages("ALL");
+	client.disconnect();
+
+	// The folded Content-Type line is unfolded with its boundary parameter.
+	REQUIRE(messages.size() == 1);
+	REQUIRE(messages[0].body_content_type == "multipart/mixed; boundary=\"b\"");
+
+	MimeDecoder decoder;
+	decoder.decode_body(messages[0]);
+	REQUIRE(messages[0].body_text == "We received your application.");
+}
+
+TEST_CASE("ImapEmailClient fetches only the text part of messages passing the filter")
+{
+	LocalImapServer server;
+	const std::string newsletter(20000, 'n');
+	const std::string attachment(50000, 'a');
+
+	LocalImapServer::Part plain;
+	plain.content = "We received your application.";
+	LocalImapServer::Part html;
+	html.subtype = "html";
+	html.content = "<p>We received your application.</p>";
+	LocalImapServer::Part pdf;
+	pdf.type = "application";
+	pdf.subtype = "pdf";
+	pdf.content = attachment;
+
+	server.append("news@shop.example", "Weekly deals", newsletter);
+	server.append_multipart("Jobs <no-reply@greenhouse.io>", "Thanks for applying", {html, plain, pdf});
+	server.append("news@shop.example", "More deals", newsletter);
+	server.append("hr@beta.example", "Interview invitation", std::string(3000, 'i'));
+
+	ImapFetchOptions fetch;
+	fetch.filter.sender_domains = {"greenhouse.io"};
+	fetch.filter.subject_keywords = {"interview"};
+	fetch.max_body_bytes = 1000;
+
+	ImapEmailClient client(local_settings(server), nullptr, fetch);
+	client.connect();
+	const auto messages = client.fetch_messages("ALL");
+
+	REQUIRE(messages.size() == 2);
+	REQUIRE(client.last_sync_stats().messages_filtered_out == 2);
+
+	// text/plain is preferred over text/html; the attachment is never fetched.
+	REQUIRE(messages[0].from == "Jobs <no-reply@greenhouse.io>");
+	REQUIRE(messages[0].body_text == "We received your application.");
+	REQUIRE(messages[0].body_content_type == "text/plain");
+	REQUIRE(messages[0].body_charset == "utf-8");
+	REQUIRE(server.count_commands("UID FETCH 2 (UID BODY.PEEK[2]<0.1000>)") == 1);
+
+	// Only the first max_body_bytes of the text are fetched.
+	REQUIRE(messages[1].subject == "Interview invitation");
+	REQUIRE(messages[1].body_text.size() == 1000);
+
+	const std::uint64_t header_first_bytes = client.last_sync_stats().bytes_received;
+	client.disconnect();
+
+	fetch.mode = ImapFetchMode::Full;
+	ImapEmailClient full_client(local_settings(server), nullptr, fetch);
+	full_client.connect();
+	REQUIRE(full_client.fetch_messages("ALL").size() == 4);
+	const std::uint64_t full_bytes = full_client.last_sync_stats().bytes_received;
+	full_client.disconnect();
+
+	REQUIRE(header_first_bytes * 20 < full_bytes);
+	WARN("Header-first fetch received " << header_first_bytes << " bytes; full fetch received " << full_bytes << " bytes");
+}
+
+TEST_CASE("ImapMessageFilter matches sender domains and subject keywords")
+{
+	ImapMessageFilter filter;
+	REQUIRE(filter.matches("anyone@example.com", "anything"));
+
+	filter.sender_domains = {"greenhouse.io"};
+	filter.subject_keywords = {"Interview"};
+	REQUIRE(filter.matches("Jobs <no-reply@greenhouse.io>", "Hello"));
+	REQUIRE(filter.matches("jobs@mail.GREENHOUSE.io", "Hello"));
+	REQUIRE_FALSE(filter.matches("jobs@notgreenhouse.io", "Hello"));
+	REQUIRE(filter.matches("hr@beta.example", "Your interview on Monday"));
+	REQUIRE_FALSE(filter.matches("news@shop.example", "Weekly deals"));
+}
+
+TEST_CASE("ImapEmailClient reports rejected logins")
+{
+	LocalImapServer server;
+	auto settings = local_settings(server);
+	settings.password = "wrong";
+
+	ImapEmailClient client(settings);
+	REQUIRE_THROWS_AS(client.connect(), std::runtime_error);
+}
+
+TEST_CASE("ImapEmailClient rejects literals larger than the sane maximum")
+{
+	LocalImapServer server;
+
+	// Would overflow std::size_t if the digits were accumulated unchecked.
+	server.set_greeting("* OK {99999999999999999999999}\r\n");
+	ImapEmailClient overflowing(local_settings(server));
+	REQUIRE_THROWS_AS(overflowing.connect(), std::runtime_error);
+
+	server.set_greeting("* OK {268435457}\r\n");
+	ImapEmailClient oversized(local_settings(server));
+	REQUIRE_THROWS_AS(oversized.connect(), std::runtime_error);
+}
+
+TEST_CASE("ImapEmailClient syncs an unchanged 50k-message mailbox in one round trip", "[.benchmark]")
+{
+	LocalImapServer server;
+	SqliteImapSyncStateStore sync_state(":memory:");
+	for (int i = 0; i < 50000; ++i)
+	{
+		server.append("jobs@acme.example", "Message " + std::to_string(i), "x");
+	}
+
+	ImapEmailClient client(local_settings(server), &sync_state);
+	client.connect();
+
+	// The initial sync pipelines 100 envelope and 100 text UID FETCH commands behind the SELECT.
+	REQUIRE(client.fetch_messages("ALL").size() == 50000);
+	REQUIRE(client.last_sync_stats().commands == 201);
+	REQUIRE(client.last_sync_stats().round_trips == 3);
+	client.on_messages_imported();
+
+	const auto started = std::chrono::steady_clock::now();
+	REQUIRE(client.fetch_messages("ALL").empty());
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+
+	const ImapSyncStats &stats = client.last_sync_stats();
+	REQUIRE(stats.unchanged);
+	REQUIRE(stats.commands == 1);
+	REQUIRE(stats.round_trips == 1);
+	REQUIRE(stats.bytes_received < 512);
+	WARN("No-change sync of 50000 messages: " << elapsed.count() << " ms, "
+		<< stats.bytes_sent << " bytes sent, " << stats.bytes_received << " bytes received");
+	client.disconnect();
+}
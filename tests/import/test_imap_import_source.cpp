@@ -1,5 +1,11 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "import/imap_import_source.h"
 #include "import/email_message.h"
 #include "fake_email_client.h"
@@ -28,5 +34,146 @@ TEST_CASE("ImapImportSource_converts_emails_to_applications")
 
 	REQUIRE(apps.size() == 1);
 	REQUIRE(apps[0].source == "email");
+	REQUIRE(apps[0].status == "applied");
 	REQUIRE_FALSE(apps[0].notes.empty());
 }
+
+TEST_CASE("ImapImportSource_extracts_fields_with_the_rule_engine")
+{
+	auto fake_client = std::make_unique<FakeEmailClient>();
+
+	EmailMessage msg;
+	msg.id = "1";
+	msg.from = "ACME Talent <no-reply@greenhouse.io>";
+	msg.subject = "Your application to ACME for C++ Developer";
+	msg.body_text = "We would like to schedule a call with you.";
+	fake_client->add_message(msg);
+
+	ImapImportSource::Config config;
+	config.search_expression = "ALL";
+	ImapImportSource source(std::move(fake_client), config);
+
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == 1);
+	REQUIRE(apps[0].company == "ACME");
+	REQUIRE(apps[0].position == "C++ Developer");
+	REQUIRE(apps[0].status == "interview");
+	REQUIRE(apps[0].source == "greenhouse");
+}
+
+TEST_CASE("ImapImportSource_decodes_bodies_before_extracting")
+{
+	auto fake_client = std::make_unique<FakeEmailClient>();
+
+	// "<p>We would like to <b>schedule a call</b> with you.</p>" in base64.
+	EmailMessage msg;
+	msg.id = "1";
+	msg.from = "ACME Talent <no-reply@greenhouse.io>";
+	msg.subject = "Your application to ACME for C++ Developer";
+	msg.body_content_type = "text/html";
+	msg.body_transfer_encoding = "base64";
+	msg.body_text = "PHA+V2Ugd291bGQgbGlrZSB0byA8Yj5zY2hlZHVsZSBhIGNhbGw8L2I+IHdpdGggeW91LjwvcD4=";
+	fake_client->add_message(msg);
+
+	ImapImportSource::Config config;
+	config.search_expression = "ALL";
+	ImapImportSource source(std::move(fake_client), config);
+
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == 1);
+	REQUIRE(apps[0].status == "interview");
+}
+
+TEST_CASE("ImapImportSource_maps_messages_on_workers_in_uid_order")
+{
+	auto fake_client = std::make_unique<FakeEmailClient>();
+	for (int i = 0; i < 1000; ++i)
+	{
+		EmailMessage msg;
+		msg.id = std::to_string(i + 1);
+		msg.from = "jobs@acme.example";
+		msg.subject = "Your application to Company " + std::to_string(i) + " for Engineer";
+		fake_client->add_message(msg);
+	}
+
+	ImapImportSource::Config config;
+	config.search_expression = "ALL";
+	config.worker_count = 4;
+	ImapImportSource source(std::move(fake_client), config);
+
+	const auto stream = source.open_stream();
+	std::vector<Application> batch;
+	std::size_t next = 0;
+	while (stream->next_batch(batch, 300))
+	{
+		REQUIRE(batch.size() == std::min<std::size_t>(300, 1000 - next));
+		for (const auto &app : batch)
+		{
+			REQUIRE(app.company == "Company " + std::to_string(next));
+			REQUIRE(app.position == "Engineer");
+			++next;
+		}
+	}
+	REQUIRE(next == 1000);
+}
+
+TEST_CASE("ImapImportSource_reads_config_files")
+{
+	std::istringstream in(
+		"# Work mailbox\n"
+		"host = imap.example.com\n"
+		"username = me@example.com\n"
+		"password = app-password\n"
+		"mailbox = Jobs\n"
+		"search = FROM \"jobs@acme.example\"\n"
+		"\n"
+		"timeout = 5\n"
+		"sender_domains = greenhouse.io, lever.co\n"
+		"subject_keywords = application, interview,\n"
+		"max_body_bytes = 4096\n"
+		"workers = 4\n");
+
+	const ImapImportConfig config = parse_imap_config(in);
+	REQUIRE(config.connection.host == "imap.example.com");
+	REQUIRE(config.connection.port == 993);
+	REQUIRE(config.connection.use_tls);
+	REQUIRE(config.connection.timeout_seconds == 5);
+	REQUIRE(config.connection.mailbox == "Jobs");
+	REQUIRE(config.source.mailbox == "Jobs");
+	REQUIRE(config.source.search_expression == "FROM \"jobs@acme.example\"");
+	REQUIRE(config.fetch.mode == ImapFetchMode::HeadersFirst);
+	REQUIRE(config.fetch.filter.sender_domains == std::vector<std::string>{"greenhouse.io", "lever.co"});
+	REQUIRE(config.fetch.filter.subject_keywords == std::vector<std::string>{"application", "interview"});
+	REQUIRE(config.fetch.max_body_bytes == 4096);
+	REQUIRE(config.source.worker_count == 4);
+
+	REQUIRE(config.source.rules.subject_templates == EmailRuleSet::defaults().subject_templates);
+
+	std::istringstream rules(
+		"host = localhost\n"
+		"ats_domains = Jobs.Example, hire.example\n"
+		"subject_template = [{company}] {position}\n"
+		"subject_template = Re: {position} at {company}\n"
+		"status_phrase = Assessment: coding challenge\n");
+	const EmailRuleSet parsed = parse_imap_config(rules).source.rules;
+	REQUIRE(parsed.ats_domains == std::vector<std::pair<std::string, std::string>>{{"jobs.example", "jobs"}, {"hire.example", "hire"}});
+	REQUIRE(parsed.subject_templates == std::vector<std::string>{"[{company}] {position}", "Re: {position} at {company}"});
+	REQUIRE(parsed.status_phrases == std::vector<std::pair<std::string, std::string>>{{"coding challenge", "assessment"}});
+
+	std::istringstream bad_phrase("host = localhost\nstatus_phrase = no colon\n");
+	REQUIRE_THROWS_AS(parse_imap_config(bad_phrase), std::runtime_error);
+
+	std::istringstream full("host = localhost\nfetch = full\n");
+	REQUIRE(parse_imap_config(full).fetch.mode == ImapFetchMode::Full);
+
+	std::istringstream plain("host = localhost\ntls = false\n");
+	REQUIRE(parse_imap_config(plain).connection.port == 143);
+
+	std::istringstream unknown("host = localhost\nfolder = INBOX\n");
+	REQUIRE_THROWS_AS(parse_imap_config(unknown), std::runtime_error);
+
+	std::istringstream missing_host("username = me\n");
+	REQUIRE_THROWS_AS(parse_imap_config(missing_host), std::runtime_error);
+}
@@ -0,0 +1,194 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "import/imap_mailbox_watcher.h"
+#include "storage/sqlite_imap_sync_state_store.h"
+#include "tests/core/fake_application_repository.h"
+#include "local_imap_server.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	ImapImportConfig local_config(const LocalImapServer &server)
+	{
+		ImapImportConfig config;
+		config.connection.host = "127.0.0.1";
+		config.connection.port = server.port();
+		config.connection.use_tls = false;
+		config.connection.timeout_seconds = 10;
+		config.connection.username = "me@example.com";
+		config.connection.password = "secret";
+		config.source.search_expression = "ALL";
+		return config;
+	}
+
+	/**
+	 * @brief Runs a watcher on its own thread and records when each sync committed.
+	 */
+	class WatcherThread
+	{
+	public:
+		explicit WatcherThread(ImapMailboxWatcher &watcher)
+			: watcher_(watcher)
+		{
+			thread_ = std::thread([this]()
+			{
+				watcher_.run([this](const ImportResult &result, const ImapSyncStats &)
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					imported_ += result.imported;
+					commit_times_.push_back(Clock::now());
+					changed_.notify_all();
+				});
+			});
+		}
+
+		~WatcherThread()
+		{
+			watcher_.stop();
+			thread_.join();
+		}
+
+		/**
+		 * @brief Wait until the given number of applications was imported.
+		 *
+		 * @return Time of the commit that reached the count; Clock::time_point() on timeout.
+		 */
+		Clock::time_point wait_for_imported(std::size_t count)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (!changed_.wait_for(lock, std::chrono::seconds(10), [&]()
+			{
+				return imported_ >= count;
+			}))
+			{
+				return Clock::time_point();
+			}
+			return commit_times_.back();
+		}
+
+	private:
+		ImapMailboxWatcher &watcher_;
+		std::thread thread_;
+		std::mutex mutex_;
+		std::condition_variable changed_;
+		std::size_t imported_ = 0;
+		std::vector<Clock::time_point> commit_times_;
+	};
+}
+
+TEST_CASE("ImapMailboxWatcher imports new mail pushed through IDLE")
+{
+	LocalImapServer server;
+	server.append("jobs@acme.example", "Application received", "Thanks.\r\n");
+	server.append("hr@beta.example", "Interview invitation", "Pick a slot.\r\n");
+
+	SqliteImapSyncStateStore sync_state(":memory:");
+	FakeApplicationRepository repository;
+	ImapMailboxWatcher watcher(local_config(server), sync_state, repository);
+
+	std::vector<double> latencies_ms;
+	{
+		WatcherThread thread(watcher);
+		REQUIRE(thread.wait_for_imported(2) != Clock::time_point());
+
+		for (std::size_t i = 0; i < 5; ++i)
+		{
+			// Let the watcher re-enter IDLE before the next message arrives.
+			while (server.count_commands("IDLE") < i + 1)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			const auto arrived = Clock::now();
+			server.append("jobs@acme.example", "Application update " + std::to_string(i), "Status changed.\r\n");
+			const auto committed = thread.wait_for_imported(3 + i);
+			REQUIRE(committed != Clock::time_point());
+			latencies_ms.push_back(std::chrono::duration<double, std::milli>(committed - arrived).count());
+		}
+	}
+
+	const ImapWatchStats stats = watcher.stats();
+	REQUIRE(repository.find_all().size() == 7);
+	REQUIRE(stats.imported == 7);
+	REQUIRE(stats.idle_wakeups == 5);
+	REQUIRE(stats.failures == 0);
+
+	// One session for all of it; every sync after the first is one SELECT and the new UIDs.
+	REQUIRE(server.count_commands("LOGIN ") == 1);
+	REQUIRE(server.count_commands("SELECT ") == 6);
+	REQUIRE(server.count_commands("UID FETCH 7:7 (UID ENVELOPE BODYSTRUCTURE)") == 1);
+
+	std::sort(latencies_ms.begin(), latencies_ms.end());
+	const double median_ms = latencies_ms[latencies_ms.size() / 2];
+	const double max_ms = latencies_ms.back();
+	WARN("Arrival-to-commit latency: median " << median_ms << " ms, max " << max_ms << " ms");
+}
+
+TEST_CASE("ImapMailboxWatcher restarts IDLE before the refresh interval runs out")
+{
+	LocalImapServer server;
+	server.append("jobs@acme.example", "Application received", "Thanks.\r\n");
+
+	SqliteImapSyncStateStore sync_state(":memory:");
+	FakeApplicationRepository repository;
+	ImapWatchOptions options;
+	options.idle_refresh = std::chrono::milliseconds(30);
+	ImapMailboxWatcher watcher(local_config(server), sync_state, repository, options);
+
+	{
+		WatcherThread thread(watcher);
+		REQUIRE(thread.wait_for_imported(1) != Clock::time_point());
+		while (server.count_commands("IDLE") < 4)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+	}
+
+	REQUIRE(watcher.stats().idle_refreshes >= 3);
+	REQUIRE(server.count_commands("SELECT ") == 1);
+	REQUIRE(server.commands().back() == "LOGOUT");
+}
+
+TEST_CASE("ImapMailboxWatcher reconnects after the connection drops")
+{
+	LocalImapServer server;
+	server.append("jobs@acme.example", "Application received", "Thanks.\r\n");
+
+	SqliteImapSyncStateStore sync_state(":memory:");
+	FakeApplicationRepository repository;
+	ImapWatchOptions options;
+	options.reconnect_delay = std::chrono::milliseconds(10);
+	ImapMailboxWatcher watcher(local_config(server), sync_state, repository, options);
+
+	{
+		WatcherThread thread(watcher);
+		REQUIRE(thread.wait_for_imported(1) != Clock::time_point());
+		while (server.count_commands("IDLE") < 1)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		server.drop_connections();
+		server.append("hr@beta.example", "Interview invitation", "Pick a slot.\r\n");
+		REQUIRE(thread.wait_for_imported(2) != Clock::time_point());
+	}
+
+	const ImapWatchStats stats = watcher.stats();
+	REQUIRE(stats.reconnects == 1);
+	REQUIRE(stats.failures == 1);
+	REQUIRE(server.count_commands("LOGIN ") == 2);
+
+	// The second session only fetched the message that arrived meanwhile.
+	REQUIRE(repository.find_all().size() == 2);
+	REQUIRE(server.count_commands("UID FETCH 2:2 (UID ENVELOPE BODYSTRUCTURE)") == 1);
+}
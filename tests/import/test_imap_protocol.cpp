@@ -0,0 +1,102 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "import/imap_protocol.h"
+
+TEST_CASE("ImapProtocol_parses_status_responses_with_codes")
+{
+	const ImapResponse untagged = parse_imap_response("* OK [UIDNEXT 4392] Predicted next UID\r\n");
+	REQUIRE(untagged.tag == "*");
+	REQUIRE(untagged.status == "OK");
+	REQUIRE(untagged.code.size() == 2);
+	REQUIRE(untagged.code[0].is_atom("uidnext"));
+	REQUIRE(untagged.code[1].number() == 4392);
+	REQUIRE(untagged.text == "Predicted next UID");
+
+	const ImapResponse tagged = parse_imap_response("A7 no [AUTHENTICATIONFAILED] Bad (really) \"creds\r\n");
+	REQUIRE(tagged.tag == "A7");
+	REQUIRE(tagged.status == "NO");
+	REQUIRE(tagged.text == "Bad (really) \"creds");
+
+	const ImapResponse flags = parse_imap_response("* OK [PERMANENTFLAGS (\\Seen \\*)] Limited\r\n");
+	REQUIRE(flags.code[1].kind == ImapValue::Kind::List);
+	REQUIRE(flags.code[1].items.size() == 2);
+	REQUIRE(flags.code[1].items[1].text == "\\*");
+}
+
+TEST_CASE("ImapProtocol_parses_fetch_responses_with_literals_and_sections")
+{
+	const std::string raw =
+		"* 12 FETCH (UID 105 BODY[HEADER.FIELDS (FROM SUBJECT)] {26}\r\n"
+		"Subject: Hi (there)\r\n\r\n) x"
+		" BODY[TEXT]<0> \"say \\\"hi\\\"\" FLAGS (\\Seen) X NIL)\r\n";
+
+	const ImapResponse response = parse_imap_response(raw);
+	REQUIRE(response.status.empty());
+	REQUIRE(response.values.size() == 3);
+	REQUIRE(response.values[0].number() == 12);
+	REQUIRE(response.values[1].is_atom("FETCH"));
+
+	const auto &items = response.values[2].items;
+	REQUIRE(items.size() == 10);
+	REQUIRE(items[1].number() == 105);
+	REQUIRE(items[2].text == "BODY[HEADER.FIELDS (FROM SUBJECT)]");
+	REQUIRE(items[3].kind == ImapValue::Kind::String);
+	REQUIRE(items[3].text == "Subject: Hi (there)\r\n\r\n) x");
+	REQUIRE(items[4].text == "BODY[TEXT]<0>");
+	REQUIRE(items[5].text == "say \"hi\"");
+	REQUIRE(items[7].items[0].text == "\\Seen");
+	REQUIRE(items[9].kind == ImapValue::Kind::Nil);
+}
+
+TEST_CASE("ImapProtocol_compresses_uid_sets_and_quotes_strings")
+{
+	const std::vector<std::uint32_t> uids = {1, 2, 3, 4, 7, 9, 10, 11, 12, 20};
+	REQUIRE(imap_uid_sets(uids, 100) == std::vector<std::string>{"1:4,7,9:12,20"});
+	REQUIRE(imap_uid_sets(uids, 4) == std::vector<std::string>{"1:4", "7,9:11", "12,20"});
+	REQUIRE(imap_uid_sets({}, 10).empty());
+
+	REQUIRE(imap_quote("a \"b\" \\c") == "\"a \\\"b\\\" \\\\c\"");
+}
+
+TEST_CASE("ImapProtocol_formats_envelope_addresses")
+{
+	const ImapResponse response = parse_imap_response(
+		"* 1 FETCH (ENVELOPE (\"date\" \"subject\" ((\"Jobs\" NIL \"jobs\" \"acme.example\")(NIL NIL \"hr\" \"acme.example\")) NIL))\r\n");
+	const ImapValue &envelope = response.values[2].items[1];
+
+	REQUIRE(imap_format_addresses(envelope.items[2]) == "Jobs <jobs@acme.example>, hr@acme.example");
+	REQUIRE(imap_format_addresses(envelope.items[3]).empty());
+}
+
+TEST_CASE("ImapProtocol_finds_the_text_part_of_a_body_structure")
+{
+	const auto find = [](const std::string &structure)
+	{
+		return imap_find_text_part(parse_imap_response("* 1 FETCH (BODYSTRUCTURE " + structure + ")\r\n").values[2].items[1]);
+	};
+
+	const ImapTextPart single = find("(\"TEXT\" \"PLAIN\" (\"CHARSET\" \"UTF-8\") NIL NIL \"QUOTED-PRINTABLE\" 120 4)");
+	REQUIRE(single.section == "1");
+	REQUIRE(single.charset == "utf-8");
+	REQUIRE(single.encoding == "quoted-printable");
+	REQUIRE(single.size == 120);
+
+	// multipart/mixed (multipart/alternative (plain, html), pdf): plain wins.
+	const ImapTextPart nested = find(
+		"(((\"TEXT\" \"PLAIN\" NIL NIL NIL \"7BIT\" 10 1)(\"TEXT\" \"HTML\" NIL NIL NIL \"BASE64\" 20 1) \"ALTERNATIVE\")"
+		"(\"APPLICATION\" \"PDF\" NIL NIL NIL \"BASE64\" 5000 NIL (\"ATTACHMENT\" NIL) NIL) \"MIXED\")");
+	REQUIRE(nested.section == "1.1");
+	REQUIRE(nested.subtype == "plain");
+
+	const ImapTextPart html_only = find("((\"TEXT\" \"HTML\" NIL NIL NIL \"BASE64\" 20 1)(\"IMAGE\" \"PNG\" NIL NIL NIL \"BASE64\" 9 NIL) \"RELATED\")");
+	REQUIRE(html_only.section == "1");
+	REQUIRE(html_only.subtype == "html");
+
+	// A text attachment is not the message text.
+	const ImapTextPart attachment = find(
+		"((\"IMAGE\" \"PNG\" NIL NIL NIL \"BASE64\" 9 NIL)(\"TEXT\" \"PLAIN\" NIL NIL NIL \"7BIT\" 10 1 NIL (\"ATTACHMENT\" NIL) NIL NIL) \"MIXED\")");
+	REQUIRE(attachment.section.empty());
+}
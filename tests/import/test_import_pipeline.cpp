@@ -0,0 +1,90 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "tests/core/fake_application_repository.h"
+#include "tests/import/fake_import_source.h"
+
+#include "import/import_pipeline.h"
+#include "import/import_service.h"
+
+namespace
+{
+	/// Stream that yields one batch and then fails, used to check error propagation.
+	class FailingStream : public IApplicationStream
+	{
+	public:
+		bool next_batch(std::vector<Application> &batch, std::size_t /*max_count*/) override
+		{
+			batch.clear();
+			if (calls_++ > 0)
+			{
+				throw std::runtime_error("source broke");
+			}
+
+			Application app;
+			app.company = "ACME";
+			app.position = "C++ Developer";
+			batch.push_back(app);
+			return true;
+		}
+
+	private:
+		int calls_ = 0;
+	};
+}
+
+TEST_CASE("ImportPipeline_imports_all_rows_in_order_with_one_transaction_per_batch")
+{
+	FakeApplicationRepository repository;
+	FakeImportSource source;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		Application app;
+		app.company = "Company " + std::to_string(i);
+		app.position = "Engineer";
+		source.add_application_template(app);
+	}
+
+	ImportOptions options{};
+	options.batch_size = 100;
+	options.pipelined = true;
+	options.queue_capacity = 2;
+
+	ImportService service(source, repository, options);
+	const ImportResult result = service.run_once();
+
+	REQUIRE(result.total == 1000);
+	REQUIRE(result.imported == 1000);
+	REQUIRE(repository.transactions_committed() == 10);
+
+	const auto apps = repository.find_all();
+	REQUIRE(apps.front().company == "Company 0");
+	REQUIRE(apps.back().company == "Company 999");
+	REQUIRE(apps.back().status == "applied");
+	REQUIRE_FALSE(apps.back().applied_date.empty());
+
+	REQUIRE(result.pipeline.reader.items == 1000);
+	REQUIRE(result.pipeline.normalizer.batches == 10);
+	REQUIRE(result.pipeline.writer.items == 1000);
+	REQUIRE(result.pipeline.decoded_queue.capacity == 2);
+	REQUIRE(result.pipeline.decoded_queue.max_occupancy <= 2);
+	REQUIRE(result.pipeline.normalized_queue.max_occupancy <= 2);
+}
+
+TEST_CASE("ImportPipeline_rethrows_errors_raised_by_the_source")
+{
+	FakeApplicationRepository repository;
+	FailingStream stream;
+
+	ImportOptions options{};
+	options.pipelined = true;
+
+	ImportPipeline pipeline(stream, repository, options);
+
+	REQUIRE_THROWS_AS(pipeline.run(), std::runtime_error);
+}
@@ -1,12 +1,82 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 #include <catch2/catch_test_macros.hpp>
 
 #include "tests/import/fake_import_source.h"
 #include "tests/core/fake_application_repository.h"
+#include "tests/util/allocation_counter.h"
 
 #include "core/job_tracker.h"
+#include "import/csv_import_source.h"
 #include "import/import_service.h"
+#include "storage/sqlite_application_repository.h"
+
+namespace
+{
+	/// SQLite repository whose commits start failing after a given number of batches.
+	class CrashingRepository : public SqliteApplicationRepository
+	{
+	public:
+		explicit CrashingRepository(int commits_before_crash)
+			: SqliteApplicationRepository(":memory:")
+			, commits_left_(commits_before_crash)
+		{
+		}
+
+		void commit_transaction() override
+		{
+			if (crashing_ && commits_left_-- <= 0)
+			{
+				throw std::runtime_error("simulated crash");
+			}
+			SqliteApplicationRepository::commit_transaction();
+		}
+
+		/// Stop failing, as if the process was restarted.
+		void recover()
+		{
+			crashing_ = false;
+		}
+
+	private:
+		bool crashing_ = true;
+		int commits_left_;
+	};
+
+	/// Write a CSV file with the rows numbered `first` up to, not including, `last`.
+	void write_numbered_csv(const std::string &file_name, int first, int last)
+	{
+		std::ofstream out(file_name);
+		out << "company,position\n";
+		for (int i = first; i < last; ++i)
+		{
+			out << "Company " << i << ",Engineer\n";
+		}
+	}
+
+	/// Write a CSV file with `row_count` numbered rows.
+	void write_numbered_csv(const std::string &file_name, int row_count)
+	{
+		write_numbered_csv(file_name, 0, row_count);
+	}
+
+	/// Add `count` applications numbered from `first` to a fake source.
+	void add_numbered_applications(FakeImportSource &source, int first, int count)
+	{
+		for (int i = first; i < first + count; ++i)
+		{
+			Application app;
+			app.company = "Company " + std::to_string(i);
+			app.position = "Engineer";
+			source.add_application_template(app);
+		}
+	}
+}
 
 
 TEST_CASE("ImportService_imports_all_applications_from_source")
@@ -86,3 +156,372 @@ TEST_CASE("ImportService_returns_zero_when_source_has_no_applications")
 	const auto apps = tracker.list_all();
 	REQUIRE(apps.empty());
 }
+
+TEST_CASE("ImportService_imports_every_row_when_batch_size_is_smaller_than_source")
+{
+	auto repository = std::make_unique<FakeApplicationRepository>();
+	JobTracker tracker(*repository);
+
+	FakeImportSource source;
+	for (int i = 0; i < 5; ++i)
+	{
+		Application app;
+		app.company = "Company " + std::to_string(i);
+		app.position = "Engineer";
+		source.add_application_template(app);
+	}
+
+	ImportOptions options{};
+	options.batch_size = 2;
+
+	ImportService service(source, *repository, options);
+	ImportResult result = service.run_once();
+
+	REQUIRE(result.total == 5);
+	REQUIRE(result.imported == 5);
+
+	const auto apps = tracker.list_all();
+	REQUIRE(apps.size() == 5);
+	REQUIRE(apps[4].company == "Company 4");
+}
+
+TEST_CASE("ImportService_commits_one_transaction_per_batch")
+{
+	FakeApplicationRepository repository;
+	FakeImportSource source;
+
+	for (int i = 0; i < 5; ++i)
+	{
+		Application app;
+		app.company = "Company " + std::to_string(i);
+		app.position = "Engineer";
+		source.add_application_template(app);
+	}
+
+	ImportOptions options{};
+	options.batch_size = 2;
+
+	ImportService service(source, repository, options);
+	service.run_once();
+
+	REQUIRE(repository.transactions_committed() == 3);
+	REQUIRE(repository.transactions_rolled_back() == 0);
+}
+
+TEST_CASE("ImportService_resumes_interrupted_csv_import_without_duplicates")
+{
+	const std::string file_name = "test_import_service_resume.csv";
+	write_numbered_csv(file_name, 1000);
+
+	for (const bool pipelined : {false, true})
+	{
+		CrashingRepository repository(3);
+		CsvImportSource source(file_name);
+
+		ImportOptions options{};
+		options.batch_size = 100;
+		options.pipelined = pipelined;
+
+		ImportService first(source, repository, options);
+		REQUIRE_THROWS_AS(first.run_once(), std::runtime_error);
+		REQUIRE(repository.find_all().size() == 300);
+
+		repository.recover();
+		options.resume = true;
+
+		ImportService resumed(source, repository, options);
+		const ImportResult result = resumed.run_once();
+
+		REQUIRE(result.resumed_rows == 300);
+		REQUIRE(result.resumed_offset > 0);
+		REQUIRE(result.total == 700);
+		REQUIRE(result.imported == 700);
+
+		const auto all = repository.find_all();
+		REQUIRE(all.size() == 1000);
+		REQUIRE(all[299].company == "Company 299");
+		REQUIRE(all[300].company == "Company 300");
+		REQUIRE(all[999].company == "Company 999");
+
+		const auto checkpoint = repository.find_checkpoint(source.checkpoint_identity()->source);
+		REQUIRE(checkpoint->rows_committed == 1000);
+		REQUIRE(checkpoint->offset == checkpoint->source_size);
+	}
+}
+
+TEST_CASE("ImportService_refuses_to_resume_when_the_source_changed")
+{
+	const std::string file_name = "test_import_service_resume_changed.csv";
+	write_numbered_csv(file_name, 10);
+
+	SqliteApplicationRepository repository(":memory:");
+	CsvImportSource source(file_name);
+
+	ImportOptions options{};
+	options.resume = true;
+
+	ImportService(source, repository, options).run_once();
+
+	write_numbered_csv(file_name, 20);
+
+	ImportService resumed(source, repository, options);
+	REQUIRE_THROWS_AS(resumed.run_once(), std::runtime_error);
+	REQUIRE(repository.find_all().size() == 10);
+}
+
+TEST_CASE("ImportService_skips_records_imported_by_an_earlier_run")
+{
+	for (const bool pipelined : {false, true})
+	{
+		FakeApplicationRepository repository;
+
+		ImportOptions options{};
+		options.batch_size = 7;
+		options.pipelined = pipelined;
+		options.skip_known = true;
+
+		FakeImportSource first;
+		add_numbered_applications(first, 0, 30);
+		const ImportResult initial = ImportService(first, repository, options).run_once();
+		REQUIRE(initial.imported == 30);
+		REQUIRE(initial.skipped == 0);
+
+		// Same records with different spacing and case, plus ten new ones.
+		FakeImportSource second;
+		for (int i = 0; i < 30; ++i)
+		{
+			Application app;
+			app.company = "  COMPANY   " + std::to_string(i);
+			app.position = "engineer ";
+			second.add_application_template(app);
+		}
+		add_numbered_applications(second, 30, 10);
+
+		const ImportResult result = ImportService(second, repository, options).run_once();
+
+		REQUIRE(result.total == 40);
+		REQUIRE(result.skipped == 30);
+		REQUIRE(result.imported == 10);
+		REQUIRE(result.known_records.loaded >= 30);
+		REQUIRE(result.known_records.dropped == 30);
+
+		const auto all = repository.find_all();
+		REQUIRE(all.size() == 40);
+		REQUIRE(all[39].company == "Company 39");
+	}
+}
+
+TEST_CASE("ImportService_reimports_an_application_removed_after_its_import")
+{
+	for (const bool pipelined : {false, true})
+	{
+		FakeApplicationRepository repository;
+
+		ImportOptions options{};
+		options.batch_size = 2;
+		options.pipelined = pipelined;
+		options.skip_known = true;
+
+		FakeImportSource first;
+		add_numbered_applications(first, 0, 3);
+		REQUIRE(ImportService(first, repository, options).run_once().imported == 3);
+
+		const int removed_id = repository.find_all()[1].id;
+		REQUIRE(repository.remove(removed_id));
+
+		FakeImportSource second;
+		add_numbered_applications(second, 0, 3);
+		const ImportResult result = ImportService(second, repository, options).run_once();
+
+		REQUIRE(result.skipped == 2);
+		REQUIRE(result.imported == 1);
+		REQUIRE(repository.find_all().back().company == "Company 1");
+	}
+}
+
+TEST_CASE("ImportService_skips_records_repeated_within_one_import")
+{
+	FakeApplicationRepository repository;
+
+	FakeImportSource source;
+	add_numbered_applications(source, 0, 3);
+	add_numbered_applications(source, 1, 3);
+
+	ImportOptions options{};
+	options.batch_size = 2;
+	options.skip_known = true;
+
+	const ImportResult result = ImportService(source, repository, options).run_once();
+
+	REQUIRE(result.total == 6);
+	REQUIRE(result.imported == 4);
+	REQUIRE(result.skipped == 2);
+	REQUIRE(repository.find_all().size() == 4);
+	REQUIRE(repository.load_fingerprints().size() == 4);
+}
+
+TEST_CASE("ImportService_writes_every_record_without_skip_known")
+{
+	FakeApplicationRepository repository;
+
+	FakeImportSource source;
+	add_numbered_applications(source, 0, 5);
+
+	ImportService(source, repository).run_once();
+	const ImportResult result = ImportService(source, repository).run_once();
+
+	REQUIRE(result.imported == 5);
+	REQUIRE(result.skipped == 0);
+	REQUIRE(repository.find_all().size() == 10);
+	REQUIRE(repository.load_fingerprints().empty());
+}
+
+TEST_CASE("ImportService_skip_known_speeds_up_a_mostly_duplicate_reimport", "[.benchmark]")
+{
+	constexpr int rows = 100000;
+	constexpr int new_rows = rows / 10;
+
+	const std::string initial_csv = "test_import_service_known_initial.csv";
+	const std::string reimport_csv = "test_import_service_known_reimport.csv";
+	write_numbered_csv(initial_csv, rows);
+	// 90% of the rows were imported before; the last 10% are new.
+	write_numbered_csv(reimport_csv, new_rows, rows + new_rows);
+
+	using Clock = std::chrono::steady_clock;
+	const auto reimport = [&](const std::string &database, bool skip_known, ImportResult &result)
+	{
+		std::filesystem::remove(database);
+		SqliteApplicationRepository repository(database);
+
+		ImportOptions options{};
+		options.skip_known = skip_known;
+
+		CsvImportSource initial(initial_csv);
+		ImportService(initial, repository, options).run_once();
+
+		CsvImportSource source(reimport_csv);
+		const auto start = Clock::now();
+		result = ImportService(source, repository, options).run_once();
+		const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+		REQUIRE(repository.find_all().size() == static_cast<std::size_t>(skip_known ? rows + new_rows : 2 * rows));
+		return elapsed.count();
+	};
+
+	ImportResult plain{};
+	ImportResult known{};
+	const double plain_ms = reimport("test_import_service_plain.db", false, plain);
+	const double known_ms = reimport("test_import_service_known.db", true, known);
+
+	REQUIRE(plain.imported == static_cast<std::size_t>(rows));
+	REQUIRE(known.imported == static_cast<std::size_t>(new_rows));
+	REQUIRE(known.skipped == static_cast<std::size_t>(rows - new_rows));
+
+	const double false_positive_rate = known.known_records.false_positive_rate();
+	REQUIRE(false_positive_rate < 0.05);
+
+	WARN("Re-import of " << rows << " rows, 90% known: " << plain_ms << " ms plain, " << known_ms
+		<< " ms with skip_known (" << plain_ms - known_ms << " ms saved); Bloom filter false-positive rate "
+		<< false_positive_rate * 100.0 << "% over " << known.known_records.checked - known.known_records.dropped
+		<< " new rows");
+}
+
+TEST_CASE("ImportService_reuses_batch_storage_instead_of_allocating_per_row")
+{
+	if (!AllocationCounter::supported())
+	{
+		WARN("Allocation counting is unavailable in sanitizer builds");
+		return;
+	}
+
+	constexpr int rows = 50000;
+	const std::string csv = "test_import_service_allocations.csv";
+	{
+		// Every field is longer than the small-string buffer, so each one needs heap storage.
+		std::ofstream out(csv);
+		out << "company,position,location,source,notes\n";
+		for (int i = 0; i < rows; ++i)
+		{
+			out << "Company number " << i << " International,Senior C++ Software Engineer (Storage),"
+				<< "Remote within the European Union,company_careers_portal,Referred by a former colleague\n";
+		}
+	}
+
+	using Clock = std::chrono::steady_clock;
+	const auto import = [&](bool pipelined, std::size_t &allocations)
+	{
+		SqliteApplicationRepository repository(":memory:");
+		// Small batches keep the pipeline's warm-up (one fresh batch per queue slot) short.
+		ImportOptions options{250};
+		options.pipelined = pipelined;
+		CsvImportSource source(csv);
+
+		ImportResult result{};
+		const auto start = Clock::now();
+		{
+			AllocationCounter counter;
+			result = ImportService(source, repository, options).run_once();
+			allocations = counter.count();
+		}
+		const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+		REQUIRE(result.imported == static_cast<std::size_t>(rows));
+		const auto apps = repository.find_all();
+		REQUIRE(apps.back().company == "Company number " + std::to_string(rows - 1) + " International");
+		REQUIRE(apps.back().notes == "Referred by a former colleague");
+		return elapsed.count();
+	};
+
+	std::size_t sequential_allocations = 0;
+	std::size_t pipelined_allocations = 0;
+	const double sequential_ms = import(false, sequential_allocations);
+	const double pipelined_ms = import(true, pipelined_allocations);
+
+	// Only the first batches allocate; later ones decode into the strings of earlier ones.
+	const double sequential_per_row = static_cast<double>(sequential_allocations) / rows;
+	const double pipelined_per_row = static_cast<double>(pipelined_allocations) / rows;
+	REQUIRE(sequential_per_row < 0.5);
+	REQUIRE(pipelined_per_row < 0.5);
+
+	// Decoding alone, where allocation is a larger share of the work: a fresh
+	// vector per batch (how batches were filled before) against a reused one.
+	const auto decode = [&](bool reuse, std::size_t &allocations)
+	{
+		CsvImportSource source(csv);
+		const auto stream = source.open_stream();
+		std::size_t decoded = 0;
+
+		const auto start = Clock::now();
+		{
+			AllocationCounter counter;
+			std::vector<Application> batch;
+			while (stream->next_batch(batch, 250))
+			{
+				decoded += batch.size();
+				if (!reuse)
+				{
+					batch = std::vector<Application>();
+				}
+			}
+			allocations = counter.count();
+		}
+		const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+		REQUIRE(decoded == static_cast<std::size_t>(rows));
+		return elapsed.count();
+	};
+
+	std::size_t fresh_allocations = 0;
+	std::size_t reused_allocations = 0;
+	const double fresh_ms = decode(false, fresh_allocations);
+	const double reused_ms = decode(true, reused_allocations);
+	REQUIRE(reused_allocations * 10 < fresh_allocations);
+
+	WARN(rows << " rows with 5 heap-sized fields: " << sequential_per_row << " allocations/row sequential ("
+		<< sequential_ms << " ms), " << pipelined_per_row << " allocations/row pipelined (" << pipelined_ms << " ms); "
+		<< "decoding only: fresh batches " << static_cast<double>(fresh_allocations) / rows << " allocations/row ("
+		<< fresh_ms << " ms), reused batches " << static_cast<double>(reused_allocations) / rows << " allocations/row ("
+		<< reused_ms << " ms)");
+
+	std::filesystem::remove(csv);
+}
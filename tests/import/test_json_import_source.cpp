@@ -0,0 +1,222 @@
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/json_import_source.h"
+#include "import/json_sax_parser.h"
+#include "tests/import/file_test_utils.h"
+#include "util/mapped_file.h"
+
+namespace
+{
+	/// Handler that only counts events, to time the parser alone.
+	class CountingHandler : public JsonSaxHandler
+	{
+	public:
+		void start_object() override
+		{
+			++events;
+		}
+
+		void key(std::string_view) override
+		{
+			++events;
+		}
+
+		void end_object() override
+		{
+			++events;
+		}
+
+		void start_array() override
+		{
+			++events;
+		}
+
+		void end_array() override
+		{
+			++events;
+		}
+
+		void scalar(JsonScalarType, std::string_view) override
+		{
+			++events;
+		}
+
+		std::size_t events = 0;
+	};
+}
+
+TEST_CASE("JsonImportSource_reads_ndjson_records_with_the_default_mapping")
+{
+	const std::string file_name = "test_json_import_source.ndjson";
+	write_file(file_name,
+		"{\"company\": \" ACME \", \"position\": \"C++ Developer\", \"location\": \"Remote\", \"source\": \"linkedin\","
+		" \"status\": \"applied\", \"applied_date\": \"2025-01-01\", \"last_update\": \"2025-01-02\", \"notes\": \"First\\nline\"}\n"
+		"{\"company\": \"No position\", \"notes\": null, \"extra\": {\"company\": \"nested, not mapped\"}}\n"
+		"{\"location\": \"Berlin\"}\n"
+		"[\"not\", \"an\", \"object\"]\n"
+		"{\"position\": 42, \"notes\": true, \"company\": [\"ignored\"]}\n");
+
+	JsonImportSource source(file_name);
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == 3);
+
+	REQUIRE(apps[0].company == "ACME");
+	REQUIRE(apps[0].position == "C++ Developer");
+	REQUIRE(apps[0].location == "Remote");
+	REQUIRE(apps[0].source == "linkedin");
+	REQUIRE(apps[0].status == "applied");
+	REQUIRE(apps[0].applied_date == "2025-01-01");
+	REQUIRE(apps[0].last_update == "2025-01-02");
+	REQUIRE(apps[0].notes == "First\nline");
+
+	// Fields of an earlier record never leak into the next one.
+	REQUIRE(apps[1].company == "No position");
+	REQUIRE(apps[1].position.empty());
+	REQUIRE(apps[1].location.empty());
+	REQUIRE(apps[1].notes.empty());
+
+	REQUIRE(apps[2].company.empty());
+	REQUIRE(apps[2].position == "42");
+	REQUIRE(apps[2].notes == "true");
+}
+
+TEST_CASE("JsonImportSource_maps_nested_fields_of_a_top_level_array")
+{
+	const std::string file_name = "test_json_import_source_array.json";
+	write_file(file_name,
+		"[\n"
+		"  {\"title\": \"Engineer\", \"employer\": {\"name\": \"ACME\", \"address\": {\"city\": \"Berlin\"}},"
+		" \"recruiter\": {\"name\": \"Not the company\"}, \"company\": \"unmapped\"},\n"
+		"  {\"employer\": {\"address\": {\"city\": \"Paris\"}, \"name\": \"Beta\"}, \"title\": \"Manager\"}\n"
+		"]\n");
+
+	const JsonFieldMapping mapping = JsonFieldMapping::parse(
+		"company = employer.name, position=title, location=employer.address.city");
+	REQUIRE(mapping.status == "status");
+
+	JsonImportSource source(file_name, mapping);
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == 2);
+	REQUIRE(apps[0].company == "ACME");
+	REQUIRE(apps[0].position == "Engineer");
+	REQUIRE(apps[0].location == "Berlin");
+	REQUIRE(apps[1].company == "Beta");
+	REQUIRE(apps[1].position == "Manager");
+	REQUIRE(apps[1].location == "Paris");
+}
+
+TEST_CASE("JsonImportSource_rejects_unknown_fields_in_the_mapping")
+{
+	REQUIRE(JsonFieldMapping::parse("notes=").notes.empty());
+	REQUIRE(JsonFieldMapping::parse("").company == "company");
+	REQUIRE_THROWS_AS(JsonFieldMapping::parse("salary=pay"), std::runtime_error);
+	REQUIRE_THROWS_AS(JsonFieldMapping::parse("company"), std::runtime_error);
+}
+
+TEST_CASE("JsonImportSource_reports_malformed_json_and_missing_files")
+{
+	const std::string file_name = "test_json_import_source_malformed.ndjson";
+	write_file(file_name, "{\"company\": \"ACME\"}\n{\"company\": \"Beta\",}\n");
+
+	JsonImportSource source(file_name);
+	REQUIRE_THROWS_AS(source.fetch_applications(), std::runtime_error);
+
+	JsonImportSource missing("this_file_does_not_exist.json");
+	REQUIRE_THROWS_AS(missing.fetch_applications(), std::runtime_error);
+}
+
+TEST_CASE("JsonImportSource_resumes_streams_at_a_committed_offset")
+{
+	for (const bool array : {false, true})
+	{
+		const std::string file_name = array ? "test_json_import_source_resume.json" : "test_json_import_source_resume.ndjson";
+
+		std::string content = array ? "[\n" : "";
+		for (int i = 0; i < 10; ++i)
+		{
+			content += "{\"company\": \"Company " + std::to_string(i) + "\", \"position\": \"Engineer\"}";
+			content += array && i < 9 ? ",\n" : "\n";
+		}
+		content += array ? "]\n" : "";
+		write_file(file_name, content);
+
+		JsonImportSource source(file_name);
+		REQUIRE(source.checkpoint_identity().has_value());
+
+		std::uint64_t offset = 0;
+		{
+			const auto stream = source.open_stream();
+			std::vector<Application> batch;
+			REQUIRE(stream->next_batch(batch, 4));
+			REQUIRE(batch.size() == 4);
+			offset = stream->resume_offset();
+		}
+
+		const auto resumed = source.open_stream_at(offset);
+		std::vector<Application> rest;
+		REQUIRE(resumed->next_batch(rest, 100));
+		REQUIRE(rest.size() == 6);
+		REQUIRE(rest.front().company == "Company 4");
+		REQUIRE(rest.back().company == "Company 9");
+		REQUIRE_FALSE(resumed->next_batch(rest, 100));
+	}
+}
+
+TEST_CASE("JsonImportSource_throughput", "[.benchmark]")
+{
+	const std::string file_name = "test_json_import_source_throughput.ndjson";
+	constexpr int records = 100000;
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		for (int i = 0; i < records; ++i)
+		{
+			out << "{\"id\": " << i << ", \"company\": \"Company " << i << "\", \"position\": \"Senior C++ Engineer\","
+				<< " \"location\": \"Berlin, Germany\", \"status\": \"applied\", \"applied_date\": \"2025-01-01\","
+				<< " \"salary\": {\"min\": 70000, \"max\": 90000.5, \"currency\": \"EUR\"}, \"remote\": false,"
+				<< " \"tags\": [\"c++\", \"linux\", \"backend\"], \"notes\": \"Referred by \\\"Alex\\\"\\nCall back\"}\n";
+		}
+	}
+
+	using Clock = std::chrono::steady_clock;
+	const MappedFile file(file_name);
+	const double megabytes = static_cast<double>(file.size()) / (1024.0 * 1024.0);
+
+	const auto parse_start = Clock::now();
+	JsonSaxParser parser(file.view());
+	CountingHandler counter;
+	std::size_t parsed = 0;
+	while (parser.next_record(counter))
+	{
+		++parsed;
+	}
+	const std::chrono::duration<double> parse_seconds = Clock::now() - parse_start;
+
+	const auto import_start = Clock::now();
+	JsonImportSource source(file_name);
+	const auto stream = source.open_stream();
+	std::vector<Application> batch;
+	std::size_t imported = 0;
+	while (stream->next_batch(batch, 1000))
+	{
+		imported += batch.size();
+	}
+	const std::chrono::duration<double> import_seconds = Clock::now() - import_start;
+
+	REQUIRE(parsed == static_cast<std::size_t>(records));
+	REQUIRE(imported == static_cast<std::size_t>(records));
+
+	const double parse_rate = megabytes / parse_seconds.count();
+	const double import_rate = megabytes / import_seconds.count();
+	const auto records_per_second = static_cast<long long>(static_cast<double>(records) / import_seconds.count());
+	WARN("JSON " << megabytes << " MiB, " << counter.events << " events: SAX parse " << parse_rate
+		<< " MiB/s; JsonImportSource " << import_rate << " MiB/s (" << records_per_second << " records/s)");
+}
@@ -0,0 +1,198 @@
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "import/json_sax_parser.h"
+
+namespace
+{
+	/// Handler recording every event as a compact string, e.g. "{ k:a s:x }".
+	class RecordingHandler : public JsonSaxHandler
+	{
+	public:
+		void start_object() override
+		{
+			events.push_back("{");
+		}
+
+		void key(std::string_view name) override
+		{
+			events.push_back("k:" + std::string(name));
+		}
+
+		void end_object() override
+		{
+			events.push_back("}");
+		}
+
+		void start_array() override
+		{
+			events.push_back("[");
+		}
+
+		void end_array() override
+		{
+			events.push_back("]");
+		}
+
+		void scalar(JsonScalarType type, std::string_view text) override
+		{
+			static const char *const prefixes[] = {"s:", "n:", "t:", "f:", "null:"};
+			events.push_back(prefixes[static_cast<int>(type)] + std::string(text));
+			views.push_back(text);
+		}
+
+		/// Events joined with spaces.
+		std::string joined() const
+		{
+			std::string out;
+			for (const auto &event : events)
+			{
+				out += out.empty() ? event : " " + event;
+			}
+			return out;
+		}
+
+		std::vector<std::string> events;
+		std::vector<std::string_view> views;
+	};
+
+	/// Parse every record of the input, returning the events of each.
+	std::vector<std::string> parse_all(std::string_view input)
+	{
+		JsonSaxParser parser(input);
+		std::vector<std::string> records;
+		RecordingHandler handler;
+		while (parser.next_record(handler))
+		{
+			records.push_back(handler.joined());
+			handler.events.clear();
+		}
+		return records;
+	}
+}
+
+TEST_CASE("JsonSaxParser_reports_the_events_of_ndjson_records")
+{
+	const auto records = parse_all(
+		"{\"company\": \"ACME\", \"salary\": -12.5e3, \"remote\": true}\n"
+		"{\"tags\": [\"a\", {\"b\": null}], \"open\": false}\n"
+		"\n");
+
+	REQUIRE(records.size() == 2);
+	REQUIRE(records[0] == "{ k:company s:ACME k:salary n:-12.5e3 k:remote t:true }");
+	REQUIRE(records[1] == "{ k:tags [ s:a { k:b null:null } ] k:open f:false }");
+}
+
+TEST_CASE("JsonSaxParser_reports_the_elements_of_a_top_level_array_as_records")
+{
+	JsonSaxParser parser("\xEF\xBB\xBF [ {\"a\": 1} , {\"a\": [] }, 7 ]\n");
+	REQUIRE(parser.top_level_array());
+
+	RecordingHandler handler;
+	std::vector<std::string> records;
+	while (parser.next_record(handler))
+	{
+		records.push_back(handler.joined());
+		handler.events.clear();
+	}
+
+	REQUIRE(records == std::vector<std::string>{"{ k:a n:1 }", "{ k:a [ ] }", "n:7"});
+	REQUIRE_FALSE(parser.next_record(handler));
+
+	REQUIRE(parse_all("[]").empty());
+	REQUIRE(parse_all("  ").empty());
+}
+
+TEST_CASE("JsonSaxParser_returns_views_into_the_input_for_strings_without_escapes")
+{
+	const std::string input = "{\"plain\": \"C++ Developer with a rather long title\", \"escaped\": \"a\\\"b\"}";
+	JsonSaxParser parser(input);
+	RecordingHandler handler;
+	REQUIRE(parser.next_record(handler));
+
+	REQUIRE(handler.views.size() == 2);
+	REQUIRE(handler.views[0].data() >= input.data());
+	REQUIRE(handler.views[0].data() < input.data() + input.size());
+	REQUIRE(handler.events[2] == "s:C++ Developer with a rather long title");
+	REQUIRE(handler.events[4] == "s:a\"b");
+}
+
+TEST_CASE("JsonSaxParser_unescapes_strings_including_surrogate_pairs")
+{
+	const auto records = parse_all(
+		"[\"tab\\there\", \"\\/\\\\\\b\\f\\n\\r\", \"caf\\u00e9 \\u20AC \\ud83d\\ude00\", \"lone \\ud800 x\","
+		" \"a long prefix that crosses a sixteen byte block \\\" and more after it\"]");
+
+	REQUIRE(records.size() == 5);
+	REQUIRE(records[0] == "s:tab\there");
+	REQUIRE(records[1] == "s:/\\\b\f\n\r");
+	REQUIRE(records[2] == "s:caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80");
+	REQUIRE(records[3] == "s:lone \xEF\xBF\xBD x");
+	REQUIRE(records[4] == "s:a long prefix that crosses a sixteen byte block \" and more after it");
+}
+
+TEST_CASE("JsonSaxParser_rejects_malformed_json_with_the_offset")
+{
+	const std::vector<std::string> malformed = {
+		"{\"a\" 1}",
+		"{\"a\": 1,}",
+		"{a: 1}",
+		"[1, 2",
+		"[1 2]",
+		"[1,]",
+		"{\"a\": tru}",
+		"{\"a\": 01}",
+		"{\"a\": 1.}",
+		"{\"a\": -}",
+		"{\"a\": \"unterminated}",
+		"{\"a\": \"bad \\x escape\"}",
+		"{\"a\": \"\\u12G4\"}",
+		"[1] 2",
+		"{\"a\": 1} x",
+	};
+
+	for (const auto &input : malformed)
+	{
+		INFO(input);
+		REQUIRE_THROWS_AS(parse_all(input), std::runtime_error);
+	}
+
+	try
+	{
+		parse_all("{\"a\": 1,}");
+		FAIL("no exception");
+	}
+	catch (const std::runtime_error &ex)
+	{
+		REQUIRE(std::string(ex.what()) == "Invalid JSON at byte 8: expected string key");
+	}
+
+	REQUIRE_THROWS_AS(parse_all(std::string(200, '[') + std::string(200, ']')), std::runtime_error);
+	REQUIRE(parse_all(std::string(100, '[') + std::string(100, ']')).size() == 1);
+}
+
+TEST_CASE("JsonSaxParser_resumes_after_a_record_offset")
+{
+	const std::string array_input = "[{\"n\": 1}, {\"n\": 2},\n {\"n\": 3}]";
+	const std::string ndjson_input = "{\"n\": 1}\n{\"n\": 2}\n{\"n\": 3}\n";
+
+	for (const auto &input : {array_input, ndjson_input})
+	{
+		JsonSaxParser first(input);
+		RecordingHandler handler;
+		REQUIRE(first.next_record(handler));
+		REQUIRE(first.next_record(handler));
+		const std::size_t offset = first.offset();
+
+		JsonSaxParser resumed(input);
+		resumed.seek(offset);
+		handler.events.clear();
+		REQUIRE(resumed.next_record(handler));
+		REQUIRE(handler.joined() == "{ k:n n:3 }");
+		REQUIRE_FALSE(resumed.next_record(handler));
+	}
+}
@@ -0,0 +1,280 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "import/mime_decoder.h"
+
+namespace
+{
+	/**
+	 * @brief Quoted-printable encoding with soft line breaks after 75 characters.
+	 */
+	std::string encode_quoted_printable(std::string_view text)
+	{
+		static constexpr char digits[] = "0123456789ABCDEF";
+		std::string encoded;
+		std::size_t line_length = 0;
+		for (const char c : text)
+		{
+			const auto byte = static_cast<unsigned char>(c);
+			std::string piece;
+			if (c == '\n')
+			{
+				encoded += "\r\n";
+				line_length = 0;
+				continue;
+			}
+			if (byte >= 0x80 || c == '=')
+			{
+				piece = {'=', digits[byte >> 4], digits[byte & 0x0F]};
+			}
+			else
+			{
+				piece = std::string(1, c);
+			}
+			if (line_length + piece.size() > 75)
+			{
+				encoded += "=\r\n";
+				line_length = 0;
+			}
+			encoded += piece;
+			line_length += piece.size();
+		}
+		return encoded;
+	}
+
+	/**
+	 * @brief Base64 encoding in lines of 76 characters.
+	 */
+	std::string encode_base64(std::string_view bytes)
+	{
+		static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string encoded;
+		for (std::size_t i = 0; i < bytes.size(); i += 3)
+		{
+			std::uint32_t group = static_cast<unsigned char>(bytes[i]) << 16;
+			if (i + 1 < bytes.size())
+			{
+				group |= static_cast<unsigned char>(bytes[i + 1]) << 8;
+			}
+			if (i + 2 < bytes.size())
+			{
+				group |= static_cast<unsigned char>(bytes[i + 2]);
+			}
+			encoded += alphabet[(group >> 18) & 0x3F];
+			encoded += alphabet[(group >> 12) & 0x3F];
+			encoded += i + 1 < bytes.size() ? alphabet[(group >> 6) & 0x3F] : '=';
+			encoded += i + 2 < bytes.size() ? alphabet[group & 0x3F] : '=';
+			if (i % 57 == 54)
+			{
+				encoded += "\r\n";
+			}
+		}
+		return encoded;
+	}
+
+	/**
+	 * @brief A job-alert style HTML mail: a large style sheet and one table row per listing.
+	 */
+	std::string recruiter_html(std::size_t listings)
+	{
+		std::string html = "<!DOCTYPE html>\n<html><head><meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\">"
+			"<title>New jobs for you</title><style type=\"text/css\">\n";
+		for (int i = 0; i < 200; ++i)
+		{
+			html += ".c" + std::to_string(i) + " { font-family: Helvetica, Arial, sans-serif; color: #333333; padding: 0 8px; }\n";
+		}
+		html += "</style></head>\n<body style=\"margin:0;padding:0\"><table role=\"presentation\" width=\"100%\" cellpadding=\"0\" cellspacing=\"0\">\n";
+		for (std::size_t i = 0; i < listings; ++i)
+		{
+			html += "<tr><td class=\"c1\" style=\"padding:12px 24px;border-bottom:1px solid #e0e0e0\">"
+				"<a href=\"https://click.jobs.example/track?u=8f2a&amp;job=" + std::to_string(i) + "&amp;utm_source=alert\" "
+				"style=\"color:#0a66c2;text-decoration:none\"><b>Senior C++ Developer &ndash; M\xC3\xBCnchen</b></a><br>"
+				"<span class=\"c2\">ACME GmbH &middot; Full-time &middot; 80&nbsp;000&nbsp;&euro;</span></td>"
+				"<td align=\"right\"><!--[if mso]><v:roundrect arcsize=\"10%\"><![endif]-->"
+				"<a href=\"https://click.jobs.example/apply?job=" + std::to_string(i) + "\">Apply&nbsp;now</a></td></tr>\n";
+		}
+		html += "</table><p>We would like to invite you to an interview.</p>"
+			"<script type=\"text/javascript\">var pixel = '<img src=\"x\">';</script></body></html>\n";
+		return html;
+	}
+
+	/**
+	 * @brief Decode the same body repeatedly; returns decoded megabytes of input per second.
+	 */
+	double decode_throughput(MimeDecoder &decoder, std::string_view content_type, std::string_view encoding, std::string_view body, std::size_t &text_size)
+	{
+		constexpr int iterations = 40;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			text_size = decoder.decode_text(content_type, encoding, "", body).size();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return static_cast<double>(body.size()) * iterations / seconds / 1e6;
+	}
+}
+
+TEST_CASE("mime_decode_quoted_printable decodes escapes and soft line breaks")
+{
+	std::string out;
+	mime_decode_quoted_printable("Caf=C3=A9 l=C3=\r\n=A4uft, x=3Dy  =\nweiter =ZZ ende=", out);
+	REQUIRE(out == "Caf\xC3\xA9 l\xC3\xA4uft, x=y  weiter =ZZ ende");
+
+	// An escape cut off by a partial fetch is dropped.
+	out.clear();
+	mime_decode_quoted_printable("abc=C", out);
+	REQUIRE(out == "abc");
+}
+
+TEST_CASE("mime_decode_base64 skips line breaks and keeps complete bytes of a cut-off group")
+{
+	std::string out;
+	mime_decode_base64("SGVs\r\nbG8s\r\nIHdvcmxkIQ==", out);
+	REQUIRE(out == "Hello, world!");
+
+	out.clear();
+	mime_decode_base64("SGVsbG8", out);
+	REQUIRE(out == "Hello");
+
+	const std::string bytes(1000, '\xFE');
+	out.clear();
+	mime_decode_base64(encode_base64(bytes), out);
+	REQUIRE(out == bytes);
+}
+
+TEST_CASE("mime_convert_to_utf8 converts common and iconv charsets")
+{
+	std::string out;
+	REQUIRE(mime_convert_to_utf8("Caf\xE9", "ISO-8859-1", out));
+	REQUIRE(out == "Caf\xC3\xA9");
+
+	out.clear();
+	REQUIRE(mime_convert_to_utf8("\x93quoted\x94 \x80", "windows-1252", out));
+	REQUIRE(out == "\xE2\x80\x9Cquoted\xE2\x80\x9D \xE2\x82\xAC");
+
+	out.clear();
+	REQUIRE(mime_convert_to_utf8("\xA4 5", "iso-8859-15", out));
+	REQUIRE(out == "\xE2\x82\xAC 5");
+
+	out.clear();
+	REQUIRE_FALSE(mime_convert_to_utf8("as is", "x-no-such-charset", out));
+	REQUIRE(out == "as is");
+}
+
+TEST_CASE("mime_html_to_text keeps the readable text of a document")
+{
+	const std::string html =
+		"<html><head><title>Ignored</title><style>p { color: red; }</style></head>\n"
+		"<body><p>Hello&nbsp;<b>Jane</b>,</p>\n<p>Thanks &amp; regards<br/>ACME &#8212; &#x1F600; &unknown; 1 < 2</p>"
+		"<script>document.write(\"<p>no</p>\");</script><!-- <p>comment</p> -->"
+		"<table><tr><td>Role</td><td>Engineer</td></tr></table>"
+		"<a href=\"https://example.com/?a>b\" title='x>y'>link</a></body></html>";
+
+	std::string out;
+	mime_html_to_text(html, out);
+	REQUIRE(out ==
+		"Hello Jane,\n\n"
+		"Thanks & regards\n"
+		"ACME \xE2\x80\x94 \xF0\x9F\x98\x80 &unknown; 1 < 2\n\n"
+		"Role Engineer\n\n"
+		"link");
+
+	// A document cut off inside a tag loses only that tag.
+	out.clear();
+	mime_html_to_text("<p>Your interview is on <a href=\"https://exa", out);
+	REQUIRE(out == "Your interview is on");
+}
+
+TEST_CASE("MimeDecoder walks nested multiparts to the text part")
+{
+	const std::string body =
+		"This is a multi-part message in MIME format.\r\n"
+		"--outer\r\n"
+		"Content-Type: text/plain; name=\"cv.txt\"\r\n"
+		"Content-Disposition: attachment; filename=\"cv.txt\"\r\n"
+		"\r\n"
+		"Attached CV, not the message.\r\n"
+		"--outer\r\n"
+		"Content-Type: multipart/alternative;\r\n"
+		"\tboundary=\"inner\"\r\n"
+		"\r\n"
+		"--inner\r\n"
+		"Content-Type: text/html; charset=\"iso-8859-1\"\r\n"
+		"Content-Transfer-Encoding: quoted-printable\r\n"
+		"\r\n"
+		"<p>Wir m=F6chten Sie zum <b>Gespr=E4ch</b> einladen.</p>\r\n"
+		"--inner--\r\n"
+		"\r\n"
+		"--outer--\r\n";
+
+	MimeDecoder decoder;
+	REQUIRE(decoder.decode_text("multipart/mixed; boundary=outer", "7bit", "", body) == "Wir m\xC3\xB6" "chten Sie zum Gespr\xC3\xA4" "ch einladen.");
+
+	// text/plain is preferred over text/html and returned without copying.
+	const std::string alternative =
+		"--b\r\nContent-Type: text/plain\r\n\r\nPlain version.\r\n"
+		"--b\r\nContent-Type: text/html\r\n\r\n<p>HTML version.</p>\r\n"
+		"--b--\r\n";
+	const std::string_view text = decoder.decode_text("multipart/alternative; boundary=\"b\"", "", "", alternative);
+	REQUIRE(text == "Plain version.");
+	REQUIRE(text.data() == alternative.data() + alternative.find("Plain"));
+
+	// A multipart holding only attachments has no text.
+	REQUIRE(decoder.decode_text("multipart/mixed; boundary=b", "", "", "--b\r\nContent-Type: application/pdf\r\n\r\n%PDF\r\n--b--\r\n").empty());
+}
+
+TEST_CASE("MimeDecoder replaces message bodies with their text")
+{
+	MimeDecoder decoder;
+
+	EmailMessage html;
+	html.body_content_type = "text/html";
+	html.body_transfer_encoding = "base64";
+	html.body_charset = "windows-1252";
+	html.body_text = encode_base64("<p>Invitation \x96 interview</p>");
+	decoder.decode_body(html);
+	REQUIRE(html.body_text == "Invitation \xE2\x80\x93 interview");
+	REQUIRE(html.body_content_type == "text/plain");
+	REQUIRE(html.body_charset == "utf-8");
+	REQUIRE(html.body_transfer_encoding.empty());
+
+	// Decoding again changes nothing.
+	decoder.decode_body(html);
+	REQUIRE(html.body_text == "Invitation \xE2\x80\x93 interview");
+
+	// A multipart body is cut down to its text part in place.
+	EmailMessage multipart;
+	multipart.body_content_type = "multipart/alternative; boundary=b";
+	multipart.body_text = "--b\r\nContent-Type: text/plain\r\n\r\nPlain version.\r\n--b--\r\n";
+	decoder.decode_body(multipart);
+	REQUIRE(multipart.body_text == "Plain version.");
+}
+
+TEST_CASE("MimeDecoder throughput on large HTML recruiter mail", "[.benchmark]")
+{
+	const std::string html = recruiter_html(1500);
+	const std::string quoted_printable = encode_quoted_printable(html);
+	const std::string base64 = encode_base64(html);
+
+	MimeDecoder decoder;
+	std::size_t text_size = 0;
+	const double qp_mb_per_second = decode_throughput(decoder, "text/html; charset=utf-8", "quoted-printable", quoted_printable, text_size);
+	const std::size_t qp_text_size = text_size;
+	const double base64_mb_per_second = decode_throughput(decoder, "text/html; charset=utf-8", "base64", base64, text_size);
+
+	const std::string_view text = decoder.decode_text("text/html", "quoted-printable", "utf-8", quoted_printable);
+	REQUIRE(text.find("Senior C++ Developer \xE2\x80\x93 M\xC3\xBCnchen\nACME GmbH \xC2\xB7 Full-time \xC2\xB7 80 000 \xE2\x82\xAC Apply now") !=
+		std::string_view::npos);
+	REQUIRE(text.find("font-family") == std::string_view::npos);
+	const std::string_view closing = "We would like to invite you to an interview.";
+	REQUIRE(text.substr(text.size() - closing.size()) == closing);
+	REQUIRE(qp_text_size == text_size);
+
+	const std::size_t html_kib = html.size() / 1024;
+	const std::size_t text_kib = qp_text_size / 1024;
+	WARN("HTML mail of " << html_kib << " KiB -> " << text_kib << " KiB of text: quoted-printable "
+		<< qp_mb_per_second << " MB/s, base64 " << base64_mb_per_second << " MB/s");
+}
@@ -0,0 +1,186 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "tests/core/fake_application_repository.h"
+#include "tests/import/fake_import_source.h"
+#include "tests/import/local_http_server.h"
+
+#include "import/http_client.h"
+#include "import/multi_source_import.h"
+#include "import/remote_csv_import_source.h"
+#include "storage/sqlite_application_repository.h"
+
+namespace
+{
+	/// Source that fails when it is opened and records whether it was committed.
+	class FailingImportSource : public IImportSource
+	{
+	public:
+		std::vector<Application> fetch_applications() override
+		{
+			throw std::runtime_error("feed unavailable");
+		}
+
+		void on_import_committed() override
+		{
+			committed = true;
+		}
+
+		bool committed = false;
+	};
+
+	/// Fake source that records whether it was committed.
+	class CommittingImportSource : public FakeImportSource
+	{
+	public:
+		void on_import_committed() override
+		{
+			committed = true;
+		}
+
+		bool committed = false;
+	};
+
+	/// Fill a source with `count` applications named after `prefix`.
+	void add_applications(FakeImportSource &source, const std::string &prefix, int count)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			Application app;
+			app.company = prefix + " " + std::to_string(i);
+			app.position = "Engineer";
+			source.add_application_template(app);
+		}
+	}
+}
+
+TEST_CASE("MultiSourceImportService_imports_every_source_through_one_writer")
+{
+	FakeApplicationRepository repository;
+
+	CommittingImportSource first;
+	CommittingImportSource second;
+	add_applications(first, "First", 5);
+	add_applications(second, "Second", 3);
+
+	ImportOptions options{};
+	options.batch_size = 2;
+
+	MultiSourceImportService service({&first, &second}, repository, options);
+	const MultiSourceImportResult result = service.run_once();
+
+	REQUIRE(result.total.total == 8);
+	REQUIRE(result.total.imported == 8);
+	REQUIRE(result.sources.size() == 2);
+	REQUIRE(result.sources[0].result.imported == 5);
+	REQUIRE(result.sources[1].result.imported == 3);
+	REQUIRE(result.failed_sources() == 0);
+	REQUIRE(first.committed);
+	REQUIRE(second.committed);
+
+	// Batches of 3 + 2 transactions, and defaults applied by the readers.
+	REQUIRE(repository.transactions_committed() == 5);
+	const auto all = repository.find_all();
+	REQUIRE(all.size() == 8);
+	REQUIRE(all[0].status == "applied");
+}
+
+TEST_CASE("MultiSourceImportService_writes_a_record_emitted_by_two_sources_once")
+{
+	FakeApplicationRepository repository;
+
+	CommittingImportSource first;
+	CommittingImportSource second;
+	add_applications(first, "Shared", 4);
+	add_applications(second, "Shared", 4);
+	add_applications(second, "Second", 2);
+
+	ImportOptions options{};
+	options.batch_size = 3;
+	options.skip_known = true;
+
+	MultiSourceImportService service({&first, &second}, repository, options);
+	const MultiSourceImportResult result = service.run_once();
+
+	REQUIRE(result.total.total == 10);
+	REQUIRE(result.total.imported == 6);
+	REQUIRE(result.total.skipped == 4);
+	REQUIRE(result.total.known_records.dropped == 4);
+	REQUIRE(repository.find_all().size() == 6);
+	REQUIRE(repository.load_fingerprints().size() == 6);
+}
+
+TEST_CASE("MultiSourceImportService_reports_a_failing_source_and_imports_the_others")
+{
+	FakeApplicationRepository repository;
+
+	FailingImportSource failing;
+	CommittingImportSource working;
+	add_applications(working, "Working", 4);
+
+	MultiSourceImportService service({&failing, &working}, repository);
+	const MultiSourceImportResult result = service.run_once();
+
+	REQUIRE(result.failed_sources() == 1);
+	REQUIRE(result.sources[0].error == "feed unavailable");
+	REQUIRE_FALSE(failing.committed);
+	REQUIRE(result.sources[1].succeeded());
+	REQUIRE(working.committed);
+	REQUIRE(result.total.imported == 4);
+	REQUIRE(repository.find_all().size() == 4);
+}
+
+TEST_CASE("MultiSourceImportService_downloads_remote_feeds_concurrently")
+{
+	const auto make_feed = [](const std::string &prefix, int rows)
+	{
+		std::string document = "company,position\n";
+		for (int i = 0; i < rows; ++i)
+		{
+			document += prefix + " " + std::to_string(i) + ",Engineer\n";
+		}
+		return document;
+	};
+
+	std::vector<std::unique_ptr<LocalHttpServer>> servers;
+	for (const int rows : {1000, 2000, 3000})
+	{
+		const std::string document = make_feed("Feed" + std::to_string(rows), rows);
+		servers.push_back(std::make_unique<LocalHttpServer>([document](const HttpHeaders &)
+		{
+			HttpResponse response{};
+			response.status_code = 200;
+			response.body = document;
+			return response;
+		}));
+	}
+
+	LibcurlMultiHttpClient http_client;
+	SqliteApplicationRepository repository(":memory:");
+
+	std::vector<std::unique_ptr<RemoteCsvImportSource>> sources;
+	std::vector<IImportSource *> source_pointers;
+	for (const auto &server : servers)
+	{
+		RemoteCsvConfig config{};
+		config.url = server->url("/jobs.csv");
+		sources.push_back(std::make_unique<RemoteCsvImportSource>(http_client, config));
+		source_pointers.push_back(sources.back().get());
+	}
+
+	ImportOptions options{};
+	options.batch_size = 250;
+
+	MultiSourceImportService service(source_pointers, repository, options);
+	const MultiSourceImportResult result = service.run_once();
+
+	REQUIRE(result.failed_sources() == 0);
+	REQUIRE(result.sources[0].result.imported == 1000);
+	REQUIRE(result.sources[1].result.imported == 2000);
+	REQUIRE(result.sources[2].result.imported == 3000);
+	REQUIRE(repository.find_all().size() == 6000);
+}
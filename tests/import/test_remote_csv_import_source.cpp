@@ -1,7 +1,17 @@
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include "import/import_service.h"
 #include "import/remote_csv_import_source.h"
+#include "storage/sqlite_application_repository.h"
+#include "storage/sqlite_http_feed_state_store.h"
 #include "tests/import/fake_http_client.h"
+#include "tests/import/local_http_server.h"
 
 TEST_CASE("RemoteCsvImportSource imports applications from HTTP CSV")
 {
@@ -87,3 +97,278 @@ TEST_CASE("RemoteCsvImportSource returns empty list on empty body")
 
 	REQUIRE(apps.empty());
 }
+
+TEST_CASE("RemoteCsvImportSource parses records split across body chunks")
+{
+	FakeHttpClient http_client;
+	http_client.set_chunk_size(3);
+
+	const std::string url = "https://example.com/jobs.csv";
+
+	HttpResponse response{};
+	response.status_code = 200;
+	response.body =
+		"company,position,notes\r\n"
+		"ACME,Backend Engineer,\"multi\nline, quoted\"\r\n"
+		"Globex,DevOps Engineer,plain";
+	http_client.set_response(url, response);
+
+	RemoteCsvConfig config{};
+	config.url = url;
+
+	RemoteCsvImportSource source(http_client, config);
+	const auto apps = source.fetch_applications();
+
+	REQUIRE(apps.size() == 2);
+	REQUIRE(apps[0].notes == "multi\nline, quoted");
+	REQUIRE(apps[1].company == "Globex");
+	REQUIRE(apps[1].notes == "plain");
+}
+
+TEST_CASE("RemoteCsvImportSource streams large documents from a local server")
+{
+	std::string document = "company,position,notes\n";
+	for (int i = 0; i < 50000; ++i)
+	{
+		document += "Company " + std::to_string(i) + ",Engineer,\"note, " + std::to_string(i) + "\"\n";
+	}
+
+	LocalHttpServer server([&](const HttpHeaders &)
+	{
+		HttpResponse response{};
+		response.status_code = 200;
+		response.body = document;
+		return response;
+	});
+
+	LibcurlHttpClient http_client;
+
+	RemoteCsvConfig config{};
+	config.url = server.url("/jobs.csv");
+
+	RemoteCsvImportSource source(http_client, config);
+	const auto stream = source.open_stream();
+
+	std::vector<Application> batch;
+	std::size_t total = 0;
+	while (stream->next_batch(batch, 1000))
+	{
+		REQUIRE(batch.front().company == "Company " + std::to_string(total));
+		total += batch.size();
+	}
+
+	REQUIRE(total == 50000);
+}
+
+TEST_CASE("RemoteCsvImportSource pauses the shared event loop transfer while the parser falls behind")
+{
+	std::string document = "company,position,notes\n";
+	for (int i = 0; i < 50000; ++i)
+	{
+		document += "Company " + std::to_string(i) + ",Engineer,\"note, " + std::to_string(i) + "\"\n";
+	}
+
+	LocalHttpServer server([&](const HttpHeaders &)
+	{
+		HttpResponse response{};
+		response.status_code = 200;
+		response.body = document;
+		return response;
+	});
+
+	LibcurlMultiHttpClient http_client;
+
+	RemoteCsvConfig config{};
+	config.url = server.url("/jobs.csv");
+
+	RemoteCsvImportSource source(http_client, config);
+	const auto stream = source.open_stream();
+
+	std::vector<Application> batch;
+	REQUIRE(stream->next_batch(batch, 1000));
+	std::size_t total = batch.size();
+
+	// Let the download fill the chunk queue; other transfers keep running meanwhile.
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	REQUIRE(http_client.get(server.url("/other.csv")).status_code == 200);
+
+	while (stream->next_batch(batch, 1000))
+	{
+		REQUIRE(batch.front().company == "Company " + std::to_string(total));
+		total += batch.size();
+	}
+
+	REQUIRE(total == 50000);
+}
+
+TEST_CASE("RemoteCsvImportSource sends stored validators and skips unchanged feeds")
+{
+	FakeHttpClient http_client;
+	SqliteApplicationRepository repository(":memory:");
+	SqliteHttpFeedStateStore feed_state(":memory:");
+
+	const std::string url = "https://example.com/jobs.csv";
+
+	HttpResponse full{};
+	full.status_code = 200;
+	full.body = "company,position\nACME,Backend Engineer\n";
+	full.headers["etag"] = "\"v1\"";
+	full.headers["last-modified"] = "Wed, 21 Oct 2025 07:28:00 GMT";
+	http_client.set_response(url, full);
+
+	RemoteCsvConfig config{};
+	config.url = url;
+
+	RemoteCsvImportSource source(http_client, config, &feed_state);
+
+	// Without a committed import nothing is remembered.
+	REQUIRE(source.fetch_applications().size() == 1);
+	REQUIRE_FALSE(feed_state.find(url).has_value());
+
+	REQUIRE(ImportService(source, repository).run_once().imported == 1);
+	REQUIRE(feed_state.find(url)->etag == "\"v1\"");
+
+	HttpResponse not_modified{};
+	not_modified.status_code = 304;
+	http_client.set_response(url, not_modified);
+
+	const ImportResult second = ImportService(source, repository).run_once();
+
+	REQUIRE(second.total == 0);
+	REQUIRE(source.unchanged());
+	REQUIRE(http_client.requests().back().at("If-None-Match") == "\"v1\"");
+	REQUIRE(http_client.requests().back().at("If-Modified-Since") == "Wed, 21 Oct 2025 07:28:00 GMT");
+	REQUIRE(http_client.requests().back().count("Range") == 0);
+}
+
+TEST_CASE("RemoteCsvImportSource fetches only the appended tail of append-only feeds")
+{
+	FakeHttpClient http_client;
+	SqliteApplicationRepository repository(":memory:");
+	SqliteHttpFeedStateStore feed_state(":memory:");
+
+	const std::string url = "https://example.com/jobs.csv";
+	const std::string first_part = "company,position\r\nACME,Backend Engineer\r\n";
+	const std::string appended = "Globex,DevOps Engineer\r\n";
+
+	HttpResponse full{};
+	full.status_code = 200;
+	full.body = first_part;
+	full.headers["etag"] = "\"v1\"";
+	http_client.set_response(url, full);
+
+	RemoteCsvConfig config{};
+	config.url = url;
+	config.append_only = true;
+
+	RemoteCsvImportSource source(http_client, config, &feed_state);
+	REQUIRE(ImportService(source, repository).run_once().imported == 1);
+
+	HttpResponse tail{};
+	tail.status_code = 206;
+	tail.body = appended;
+	tail.headers["etag"] = "\"v2\"";
+	tail.headers["content-range"] = "bytes " + std::to_string(first_part.size()) + "-" +
+		std::to_string(first_part.size() + appended.size() - 1) + "/" +
+		std::to_string(first_part.size() + appended.size());
+	http_client.set_response(url, tail);
+
+	const ImportResult second = ImportService(source, repository).run_once();
+
+	REQUIRE(http_client.requests().back().at("Range") == "bytes=" + std::to_string(first_part.size()) + "-");
+	REQUIRE(second.imported == 1);
+
+	const auto all = repository.find_all();
+	REQUIRE(all.size() == 2);
+	REQUIRE(all[1].company == "Globex");
+	REQUIRE(feed_state.find(url)->imported_length == first_part.size() + appended.size());
+
+	// A server that ignores Range sends everything; the known prefix is skipped.
+	HttpResponse ignored_range{};
+	ignored_range.status_code = 200;
+	ignored_range.body = first_part + appended + "Initech,QA Engineer\r\n";
+	http_client.set_response(url, ignored_range);
+
+	REQUIRE(ImportService(source, repository).run_once().imported == 1);
+	REQUIRE(repository.find_all().back().company == "Initech");
+}
+
+TEST_CASE("RemoteCsvImportSource uses conditional and ranged requests against a local server")
+{
+	std::string document = "company,position\nACME,Backend Engineer\n";
+	std::string etag = "\"v1\"";
+
+	LocalHttpServer server([&](const HttpHeaders &headers)
+	{
+		HttpResponse response{};
+		response.headers["ETag"] = etag;
+
+		const auto if_none_match = headers.find("if-none-match");
+		if (if_none_match != headers.end() && if_none_match->second == etag)
+		{
+			response.status_code = 304;
+			return response;
+		}
+
+		const auto range = headers.find("range");
+		if (range != headers.end())
+		{
+			const std::size_t first = std::stoul(range->second.substr(6));
+			response.status_code = 206;
+			response.body = document.substr(first);
+			response.headers["Content-Range"] = "bytes " + std::to_string(first) + "-" +
+				std::to_string(document.size() - 1) + "/" + std::to_string(document.size());
+			return response;
+		}
+
+		response.status_code = 200;
+		response.body = document;
+		return response;
+	});
+
+	LibcurlHttpClient http_client;
+	SqliteApplicationRepository repository(":memory:");
+	SqliteHttpFeedStateStore feed_state(":memory:");
+
+	RemoteCsvConfig config{};
+	config.url = server.url("/jobs.csv");
+	config.append_only = true;
+
+	RemoteCsvImportSource source(http_client, config, &feed_state);
+
+	REQUIRE(ImportService(source, repository).run_once().imported == 1);
+
+	REQUIRE(ImportService(source, repository).run_once().total == 0);
+	REQUIRE(source.unchanged());
+
+	document += "Globex,DevOps Engineer\n";
+	etag = "\"v2\"";
+
+	REQUIRE(ImportService(source, repository).run_once().imported == 1);
+	REQUIRE(repository.find_all().size() == 2);
+
+	const auto requests = server.requests();
+	REQUIRE(requests.size() == 3);
+	REQUIRE(requests[0].count("if-none-match") == 0);
+	REQUIRE(requests[2].at("range") == "bytes=39-");
+}
+
+TEST_CASE("parse_remote_csv_feeds reads one feed per line")
+{
+	std::istringstream list(
+		"# recruiter agencies\n"
+		"https://agency-a.example/jobs.csv\n"
+		"\n"
+		"  https://agency-b.example/feed.csv   append-only\n");
+
+	const auto feeds = parse_remote_csv_feeds(list);
+
+	REQUIRE(feeds.size() == 2);
+	REQUIRE(feeds[0].url == "https://agency-a.example/jobs.csv");
+	REQUIRE_FALSE(feeds[0].append_only);
+	REQUIRE(feeds[1].url == "https://agency-b.example/feed.csv");
+	REQUIRE(feeds[1].append_only);
+
+	std::istringstream invalid("https://agency-c.example/jobs.csv gzip\n");
+	REQUIRE_THROWS_AS(parse_remote_csv_feeds(invalid), std::runtime_error);
+}
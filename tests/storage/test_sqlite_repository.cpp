@@ -1,7 +1,22 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include "storage/sqlite_application_repository.h"
+#include "storage/sqlite_database.h"
 #include "core/application.h"
+#include "import/csv_import_source.h"
+#include "import/import_service.h"
+#include "tests/util/allocation_counter.h"
 
 TEST_CASE("sqlite_repository_inserts_and_returns_application")
 {
@@ -81,3 +96,357 @@ TEST_CASE("sqlite_repository_computes_basic_statistics")
 	REQUIRE(stats.count_by_status.at("applied") == 2);
 	REQUIRE(stats.count_by_status.at("interview") == 1);
 }
+
+namespace
+{
+	/// Build an application whose strings are too long for the small-string buffer.
+	Application make_long_application()
+	{
+		Application app;
+		app.company = "ACME Corporation International Holdings";
+		app.position = "Senior C++ Software Engineer (Storage Team)";
+		app.location = "Remote within the European Union timezone";
+		app.source = "linkedin recruiter outreach campaign";
+		app.status = "applied and waiting for a response";
+		app.applied_date = "2025-01-01 (submitted through the portal)";
+		app.last_update = "2025-01-02 (confirmation email received)";
+		app.notes = "Referred by a former colleague from the platform team";
+		return app;
+	}
+}
+
+TEST_CASE("sqlite_repository_rvalue_insert_moves_application_without_copying_strings")
+{
+	if (!AllocationCounter::supported())
+	{
+		WARN("Allocation counting is unavailable in sanitizer builds");
+		return;
+	}
+
+	SqliteApplicationRepository repo(":memory:");
+
+	Application app = make_long_application();
+
+	std::size_t allocations = 0;
+	Application stored;
+	{
+		AllocationCounter counter;
+		stored = repo.insert(std::move(app));
+		allocations = counter.count();
+	}
+
+	// Only operator new is counted; SQLite's own sqlite3_malloc() calls are not.
+	REQUIRE(allocations == 0);
+	REQUIRE(stored.id != 0);
+	REQUIRE(stored.company == "ACME Corporation International Holdings");
+	REQUIRE(repo.find_all().size() == 1);
+}
+
+TEST_CASE("sqlite_repository_const_insert_copies_each_string_field")
+{
+	if (!AllocationCounter::supported())
+	{
+		WARN("Allocation counting is unavailable in sanitizer builds");
+		return;
+	}
+
+	SqliteApplicationRepository repo(":memory:");
+
+	const Application app = make_long_application();
+
+	std::size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		const Application stored = repo.insert(app);
+		allocations = counter.count();
+	}
+
+	// The copying overload pays one allocation per long string field.
+	REQUIRE(allocations >= 8);
+}
+
+TEST_CASE("sqlite_repository_rollback_discards_inserts_of_the_transaction")
+{
+	SqliteApplicationRepository repo(":memory:");
+
+	Application kept;
+	kept.company = "ACME";
+	kept.position = "C++";
+	kept.status = "applied";
+
+	repo.begin_transaction();
+	repo.insert(kept);
+	repo.commit_transaction();
+
+	repo.begin_transaction();
+	repo.insert(kept);
+	repo.insert(kept);
+	repo.rollback_transaction();
+
+	REQUIRE(repo.find_all().size() == 1);
+}
+
+TEST_CASE("sqlite_repository_stores_checkpoints_with_the_transaction")
+{
+	SqliteApplicationRepository repo(":memory:");
+
+	REQUIRE_FALSE(repo.find_checkpoint("data/import.csv").has_value());
+
+	ImportCheckpoint checkpoint;
+	checkpoint.source = "data/import.csv";
+	checkpoint.source_size = 5000000000ULL;
+	checkpoint.source_mtime = 1234567890123LL;
+	checkpoint.offset = 4000000000ULL;
+	checkpoint.rows_committed = 42;
+
+	repo.begin_transaction();
+	repo.save_checkpoint(checkpoint);
+	repo.commit_transaction();
+
+	ImportCheckpoint discarded = checkpoint;
+	discarded.offset = 4500000000ULL;
+
+	repo.begin_transaction();
+	repo.save_checkpoint(discarded);
+	repo.rollback_transaction();
+
+	const auto stored = repo.find_checkpoint("data/import.csv");
+	REQUIRE(stored.has_value());
+	REQUIRE(stored->same_source(checkpoint));
+	REQUIRE(stored->offset == 4000000000ULL);
+	REQUIRE(stored->rows_committed == 42);
+}
+
+TEST_CASE("sqlite_repository_stores_fingerprints_with_the_transaction")
+{
+	SqliteApplicationRepository repo(":memory:");
+
+	REQUIRE(repo.load_fingerprints().empty());
+
+	// Fingerprints use all 64 bits; the top ones must survive SQLite's signed integers.
+	repo.begin_transaction();
+	repo.save_fingerprints({1, 0xFFFFFFFFFFFFFFFFULL, 0x8000000000000000ULL, 1}, {1, 2, 3, 1});
+	repo.commit_transaction();
+
+	repo.begin_transaction();
+	repo.save_fingerprints({42}, {4});
+	repo.rollback_transaction();
+
+	const std::vector<std::uint64_t> found = repo.find_fingerprints({0x8000000000000000ULL, 42, 1, 0xFFFFFFFFFFFFFFFFULL});
+	REQUIRE(found == std::vector<std::uint64_t>{0x8000000000000000ULL, 1, 0xFFFFFFFFFFFFFFFFULL});
+	REQUIRE(repo.load_fingerprints().size() == 3);
+
+	// Lookups also work inside the transaction of a batch.
+	repo.begin_transaction();
+	REQUIRE(repo.find_fingerprints({1, 42}) == std::vector<std::uint64_t>{1});
+	repo.commit_transaction();
+}
+
+TEST_CASE("sqlite_repository_removes_the_fingerprints_of_a_removed_application")
+{
+	const std::string path = "test_sqlite_repository_fingerprint_ids.db";
+	std::remove(path.c_str());
+
+	// A fingerprint table written before application ids were recorded.
+	{
+		SqliteDatabase old_database(path);
+		old_database.execute_non_query(
+			"CREATE TABLE import_fingerprints (fingerprint INTEGER PRIMARY KEY);"
+			"INSERT INTO import_fingerprints VALUES (5);");
+	}
+
+	SqliteApplicationRepository repo(path);
+	Application app;
+	app.company = "Acme";
+	app.position = "Engineer";
+	app.status = "applied";
+	const int first = repo.insert(app).id;
+	const int second = repo.insert(app).id;
+
+	repo.save_fingerprints({1, 2}, {first, second});
+	REQUIRE(repo.load_fingerprints().size() == 3);
+
+	REQUIRE(repo.remove(first));
+	REQUIRE(repo.find_fingerprints({1, 2, 5}) == std::vector<std::uint64_t>{2, 5});
+
+	// Inside a caller's transaction both deletes are rolled back together.
+	repo.begin_transaction();
+	REQUIRE(repo.remove(second));
+	repo.rollback_transaction();
+	REQUIRE(repo.find_all().size() == 1);
+	REQUIRE(repo.find_fingerprints({2}) == std::vector<std::uint64_t>{2});
+
+	REQUIRE_FALSE(repo.remove(first));
+	std::remove(path.c_str());
+}
+
+TEST_CASE("sqlite_repository_merges_another_database_on_the_natural_key")
+{
+	const std::string source_path = "test_sqlite_repository_merge_source.db";
+	std::remove(source_path.c_str());
+
+	const auto make_app = [](const char *company, const char *position, const char *applied_date, const char *status)
+	{
+		Application app;
+		app.company = company;
+		app.position = position;
+		app.applied_date = applied_date;
+		app.status = status;
+		return app;
+	};
+
+	{
+		SqliteApplicationRepository source(source_path);
+		source.insert(make_app("Filler", "Removed", "2024-12-01", "applied"));
+		source.remove(1);
+		source.insert(make_app("ACME", "c++ developer", "2025-01-01", "interview"));
+		source.insert(make_app("Beta", "Backend", "2025-01-02", "applied"));
+		source.insert(make_app("Beta", "Backend", "2025-01-02", "offer"));
+		source.insert(make_app("Acme", "C++ Developer", "2025-02-01", "applied"));
+		source.save_fingerprints({7, 8, 9}, {3, 5, 2});
+	}
+
+	SqliteApplicationRepository repo(":memory:");
+	repo.insert(make_app("Acme", "C++ Developer", "2025-01-01", "applied"));
+	repo.insert(make_app("Gamma", "DevOps", "2025-01-03", "applied"));
+	repo.save_fingerprints({8}, {2});
+
+	const DatabaseMergeResult result = repo.merge_database(source_path);
+
+	REQUIRE(result.source_rows == 4);
+	REQUIRE(result.imported == 2);
+	REQUIRE(result.duplicates == 2);
+
+	// Existing rows win over their duplicates; new rows continue the id sequence in source order.
+	const auto all = repo.find_all();
+	REQUIRE(all.size() == 4);
+	REQUIRE(all[0].status == "applied");
+	REQUIRE(all[2].id == 3);
+	REQUIRE(all[2].company == "Beta");
+	REQUIRE(all[2].status == "applied");
+	REQUIRE(all[3].id == 4);
+	REQUIRE(all[3].applied_date == "2025-02-01");
+	REQUIRE(repo.load_fingerprints().size() == 3);
+
+	// Merging again finds nothing new.
+	const DatabaseMergeResult again = repo.merge_database(source_path);
+	REQUIRE(again.imported == 0);
+	REQUIRE(again.duplicates == 4);
+	REQUIRE(repo.find_all().size() == 4);
+
+	// Merged fingerprints follow their record: 7 to the merged Beta row, 9 to the existing Acme row.
+	REQUIRE(repo.remove(3));
+	REQUIRE(repo.find_fingerprints({7, 8, 9}) == std::vector<std::uint64_t>{8, 9});
+	REQUIRE(repo.remove(1));
+	REQUIRE(repo.find_fingerprints({7, 8, 9}) == std::vector<std::uint64_t>{8});
+
+	std::remove(source_path.c_str());
+}
+
+TEST_CASE("sqlite_repository_merge_rejects_missing_and_foreign_databases")
+{
+	const std::string missing_path = "test_sqlite_repository_merge_missing.db";
+	const std::string foreign_path = "test_sqlite_repository_merge_foreign.db";
+	std::remove(missing_path.c_str());
+	std::remove(foreign_path.c_str());
+
+	{
+		SqliteDatabase foreign(foreign_path);
+		foreign.execute_non_query("CREATE TABLE notes (text TEXT);");
+	}
+
+	SqliteApplicationRepository repo(":memory:");
+	Application app;
+	app.company = "Acme";
+	app.position = "Engineer";
+	app.status = "applied";
+	repo.insert(app);
+
+	REQUIRE_THROWS_AS(repo.merge_database(missing_path), std::runtime_error);
+	REQUIRE_FALSE(std::filesystem::exists(missing_path));
+	REQUIRE_THROWS_AS(repo.merge_database(foreign_path), std::runtime_error);
+
+	// A failed merge leaves the connection usable and detached.
+	REQUIRE(repo.find_all().size() == 1);
+	repo.begin_transaction();
+	repo.insert(app);
+	repo.commit_transaction();
+	REQUIRE(repo.find_all().size() == 2);
+
+	std::remove(foreign_path.c_str());
+}
+
+TEST_CASE("sqlite_repository_merge_throughput", "[.benchmark]")
+{
+	const std::string source_path = "test_sqlite_repository_merge_bench_source.db";
+	const std::string merged_path = "test_sqlite_repository_merge_bench_merged.db";
+	const std::string csv_path = "test_sqlite_repository_merge_bench.csv";
+	const std::string round_trip_path = "test_sqlite_repository_merge_bench_csv.db";
+	for (const auto &path : {source_path, merged_path, csv_path, round_trip_path})
+	{
+		std::remove(path.c_str());
+	}
+
+	constexpr int rows = 100000;
+	{
+		SqliteApplicationRepository source(source_path);
+		source.begin_transaction();
+		Application app;
+		app.position = "Senior C++ Engineer";
+		app.location = "Berlin";
+		app.source = "linkedin";
+		app.status = "applied";
+		app.applied_date = "2025-01-01";
+		app.last_update = "2025-01-02";
+		app.notes = "Referred by a former colleague";
+		for (int i = 0; i < rows; ++i)
+		{
+			app.company = "Company " + std::to_string(i);
+			source.insert(app);
+		}
+		source.commit_transaction();
+	}
+
+	using Clock = std::chrono::steady_clock;
+
+	const auto merge_start = Clock::now();
+	DatabaseMergeResult merged;
+	{
+		SqliteApplicationRepository target(merged_path);
+		merged = target.merge_database(source_path);
+	}
+	const std::chrono::duration<double> merge_seconds = Clock::now() - merge_start;
+
+	// The round trip the merge replaces: export every row to CSV, then import the file.
+	const auto round_trip_start = Clock::now();
+	ImportResult imported;
+	{
+		SqliteApplicationRepository source(source_path);
+		std::ofstream out(csv_path, std::ios::binary);
+		out << "company,position,location,source,status,applied_date,last_update,notes\n";
+		for (const auto &app : source.find_all())
+		{
+			out << app.company << ',' << app.position << ',' << app.location << ',' << app.source << ','
+				<< app.status << ',' << app.applied_date << ',' << app.last_update << ',' << app.notes << '\n';
+		}
+	}
+	{
+		SqliteApplicationRepository target(round_trip_path);
+		CsvImportSource csv(csv_path);
+		ImportService service(csv, target, ImportOptions{});
+		imported = service.run_once();
+	}
+	const std::chrono::duration<double> round_trip_seconds = Clock::now() - round_trip_start;
+
+	REQUIRE(merged.imported == static_cast<std::size_t>(rows));
+	REQUIRE(imported.imported == static_cast<std::size_t>(rows));
+
+	WARN("Merging " << rows << " rows: ATTACH + INSERT ... SELECT " << merge_seconds.count() << " s ("
+		<< static_cast<long long>(rows / merge_seconds.count()) << " rows/s); CSV export + import-csv "
+		<< round_trip_seconds.count() << " s (" << static_cast<long long>(rows / round_trip_seconds.count()) << " rows/s)");
+
+	for (const auto &path : {source_path, merged_path, csv_path, round_trip_path})
+	{
+		std::remove(path.c_str());
+	}
+}
@@ -0,0 +1,189 @@
+/// \file
+/// \brief Replacement global operator new/delete that feed AllocationCounter.
+
+#include "tests/util/allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define JOBTRACKER_ALLOCATION_COUNTER_DISABLED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define JOBTRACKER_ALLOCATION_COUNTER_DISABLED 1
+#endif
+#endif
+
+namespace
+{
+	std::atomic<bool> counting{false};
+	std::atomic<std::size_t> allocations{0};
+}
+
+#if !defined(JOBTRACKER_ALLOCATION_COUNTER_DISABLED)
+
+// Every form of operator new and delete is replaced, so memory is always
+// released by the allocator family that produced it.
+namespace
+{
+	void count_allocation()
+	{
+		if (counting.load(std::memory_order_relaxed))
+		{
+			allocations.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void *counted_allocate(std::size_t size) noexcept
+	{
+		count_allocation();
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void *counted_allocate_aligned(std::size_t size, std::align_val_t alignment) noexcept
+	{
+		count_allocation();
+
+		// aligned_alloc() needs a size that is a multiple of the alignment.
+		const auto align = static_cast<std::size_t>(alignment);
+		const std::size_t rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+		return std::aligned_alloc(align, rounded);
+	}
+
+	void *throw_if_null(void *ptr)
+	{
+		if (ptr == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return ptr;
+	}
+}
+
+void *operator new(std::size_t size)
+{
+	return throw_if_null(counted_allocate(size));
+}
+
+void *operator new[](std::size_t size)
+{
+	return throw_if_null(counted_allocate(size));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	return counted_allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return counted_allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+	return throw_if_null(counted_allocate_aligned(size, alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return throw_if_null(counted_allocate_aligned(size, alignment));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+	return counted_allocate_aligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+	return counted_allocate_aligned(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t /*alignment*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t /*alignment*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t /*alignment*/, const std::nothrow_t &) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t /*alignment*/, const std::nothrow_t &) noexcept
+{
+	std::free(ptr);
+}
+
+#endif
+
+AllocationCounter::AllocationCounter()
+{
+	allocations.store(0, std::memory_order_relaxed);
+	counting.store(true, std::memory_order_relaxed);
+}
+
+AllocationCounter::~AllocationCounter()
+{
+	counting.store(false, std::memory_order_relaxed);
+}
+
+std::size_t AllocationCounter::count() const
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+bool AllocationCounter::supported()
+{
+	#if defined(JOBTRACKER_ALLOCATION_COUNTER_DISABLED)
+	return false;
+	#else
+	return true;
+	#endif
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Counts global operator new calls, used only in tests.
+ *
+ * The replacement operators live in allocation_counter.cpp and are linked
+ * into the whole test runner. Counting is off by default and only enabled
+ * while an AllocationCounter is alive, so unrelated tests are unaffected.
+ * C libraries allocating through malloc() (SQLite, zlib) are not counted.
+ *
+ * AddressSanitizer builds (Debug) keep the sanitizer's own operators, so
+ * counting is unavailable there; tests should check supported() first.
+ */
+class AllocationCounter
+{
+public:
+	/**
+	 * @brief Reset the global counter and start counting allocations.
+	 */
+	AllocationCounter();
+
+	/**
+	 * @brief Stop counting allocations.
+	 */
+	~AllocationCounter();
+
+	AllocationCounter(const AllocationCounter &) = delete;
+	AllocationCounter &operator=(const AllocationCounter &) = delete;
+
+	/**
+	 * @brief Number of operator new calls observed since construction.
+	 */
+	std::size_t count() const;
+
+	/**
+	 * @brief Whether this build counts allocations at all.
+	 */
+	static bool supported();
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Thread counts a scaling benchmark should run with, used only in tests.
+ *
+ * The largest count comes from the JOBTRACKER_BENCH_THREADS environment
+ * variable, or the number of hardware threads when it is unset or invalid.
+ * Counts double from 1 up to that maximum, which is always included.
+ */
+inline std::vector<std::size_t> benchmark_thread_counts()
+{
+	std::size_t max_threads = std::thread::hardware_concurrency();
+	if (const char *value = std::getenv("JOBTRACKER_BENCH_THREADS"))
+	{
+		try
+		{
+			const long parsed = std::stol(value);
+			if (parsed > 0)
+			{
+				max_threads = static_cast<std::size_t>(parsed);
+			}
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+	if (max_threads == 0)
+	{
+		max_threads = 1;
+	}
+
+	std::vector<std::size_t> counts;
+	for (std::size_t count = 1; count < max_threads; count *= 2)
+	{
+		counts.push_back(count);
+	}
+	counts.push_back(max_threads);
+	return counts;
+}
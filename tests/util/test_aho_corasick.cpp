@@ -0,0 +1,56 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "util/aho_corasick.h"
+
+namespace
+{
+	/// (pattern index, end offset) of every match, in scan order.
+	std::vector<std::pair<std::size_t, std::size_t>> all_matches(const AhoCorasick &automaton, const std::string &text)
+	{
+		std::vector<std::pair<std::size_t, std::size_t>> matches;
+		automaton.scan(text, [&](std::size_t pattern, std::size_t end)
+		{
+			matches.emplace_back(pattern, end);
+		});
+		return matches;
+	}
+}
+
+/// Verifies that overlapping patterns and patterns that are suffixes of
+/// others are all reported where they end.
+TEST_CASE("aho_corasick_reports_overlapping_matches")
+{
+	const AhoCorasick automaton({"he", "she", "his", "hers"});
+
+	const auto matches = all_matches(automaton, "ushers");
+
+	const std::vector<std::pair<std::size_t, std::size_t>> expected = {{1, 4}, {0, 4}, {3, 6}};
+	REQUIRE(matches == expected);
+	REQUIRE(automaton.pattern_count() == 4);
+}
+
+/// Verifies that matching ignores ASCII case in both patterns and text.
+TEST_CASE("aho_corasick_ignores_case")
+{
+	const AhoCorasick automaton({"Interview", "offer"});
+
+	const auto matches = all_matches(automaton, "INTERVIEW and Offer");
+
+	const std::vector<std::pair<std::size_t, std::size_t>> expected = {{0, 9}, {1, 19}};
+	REQUIRE(matches == expected);
+}
+
+/// Verifies that empty patterns never match and texts without pattern
+/// bytes produce no matches.
+TEST_CASE("aho_corasick_handles_empty_patterns_and_foreign_bytes")
+{
+	const AhoCorasick automaton({"", "ab"});
+
+	REQUIRE(all_matches(automaton, "xyz\xff\x01").empty());
+	REQUIRE(all_matches(automaton, "xaab") == std::vector<std::pair<std::size_t, std::size_t>>{{1, 4}});
+	REQUIRE(all_matches(AhoCorasick({}), "anything").empty());
+}
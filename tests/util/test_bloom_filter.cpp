@@ -0,0 +1,70 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "util/bloom_filter.h"
+
+namespace
+{
+	/// Well mixed 64-bit key number `i` (splitmix64), standing in for record fingerprints.
+	std::uint64_t key(std::uint64_t i)
+	{
+		std::uint64_t z = i * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+}
+
+/// Every inserted key is reported, so a miss always means "certainly new".
+TEST_CASE("bloom_filter_never_reports_false_negatives")
+{
+	BloomFilter filter(10000, 0.01);
+
+	for (std::uint64_t i = 0; i < 10000; ++i)
+	{
+		filter.insert(key(i));
+	}
+
+	for (std::uint64_t i = 0; i < 10000; ++i)
+	{
+		REQUIRE(filter.may_contain(key(i)));
+	}
+}
+
+/// At its sized capacity, the measured false-positive rate stays near the target.
+TEST_CASE("bloom_filter_false_positive_rate_matches_target")
+{
+	constexpr std::uint64_t keys = 50000;
+	BloomFilter filter(keys, 0.01);
+
+	for (std::uint64_t i = 0; i < keys; ++i)
+	{
+		filter.insert(key(i));
+	}
+
+	std::size_t false_positives = 0;
+	constexpr std::uint64_t probes = 200000;
+	for (std::uint64_t i = keys; i < keys + probes; ++i)
+	{
+		false_positives += filter.may_contain(key(i)) ? 1 : 0;
+	}
+
+	const double rate = static_cast<double>(false_positives) / static_cast<double>(probes);
+	REQUIRE(rate < 0.02);
+	REQUIRE(filter.hash_count() == 7);
+}
+
+/// Tiny or empty filters still get a usable minimum size.
+TEST_CASE("bloom_filter_empty_filter_contains_nothing")
+{
+	const BloomFilter filter(0, 0.01);
+
+	REQUIRE(filter.bit_count() >= 1024);
+	REQUIRE(filter.hash_count() >= 1);
+	for (std::uint64_t i = 0; i < 1000; ++i)
+	{
+		REQUIRE_FALSE(filter.may_contain(key(i)));
+	}
+}
@@ -0,0 +1,43 @@
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "util/mapped_file.h"
+
+TEST_CASE("MappedFile_exposes_file_contents")
+{
+	const std::string file_name = "test_mapped_file.txt";
+
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		REQUIRE(out.is_open());
+		out << "hello\nworld\n";
+	}
+
+	const MappedFile file(file_name);
+
+	REQUIRE(file.size() == 12);
+	REQUIRE(file.view() == "hello\nworld\n");
+}
+
+TEST_CASE("MappedFile_maps_empty_file_to_empty_view")
+{
+	const std::string file_name = "test_mapped_file_empty.txt";
+
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		REQUIRE(out.is_open());
+	}
+
+	const MappedFile file(file_name);
+
+	REQUIRE(file.size() == 0);
+	REQUIRE(file.view().empty());
+}
+
+TEST_CASE("MappedFile_throws_when_file_does_not_exist")
+{
+	REQUIRE_THROWS_AS(MappedFile("this_file_does_not_exist.txt"), std::runtime_error);
+}
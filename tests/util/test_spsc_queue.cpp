@@ -0,0 +1,63 @@
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "util/spsc_queue.h"
+
+TEST_CASE("BoundedSpscQueue_rejects_pushes_when_full_and_pops_in_order")
+{
+	BoundedSpscQueue<int> queue(2);
+
+	REQUIRE(queue.try_push(1));
+	REQUIRE(queue.try_push(2));
+	REQUIRE_FALSE(queue.try_push(3));
+	REQUIRE(queue.size() == 2);
+
+	int value = 0;
+	REQUIRE(queue.try_pop(value));
+	REQUIRE(value == 1);
+	REQUIRE(queue.try_pop(value));
+	REQUIRE(value == 2);
+	REQUIRE_FALSE(queue.try_pop(value));
+}
+
+TEST_CASE("BoundedSpscQueue_transfers_all_items_between_threads")
+{
+	BoundedSpscQueue<int> queue(8);
+	const int item_count = 100000;
+
+	std::thread producer([&]()
+	{
+		for (int i = 0; i < item_count; ++i)
+		{
+			while (!queue.try_push(int{i}))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	std::vector<int> received;
+	received.reserve(item_count);
+	while (static_cast<int>(received.size()) < item_count)
+	{
+		int value = 0;
+		if (queue.try_pop(value))
+		{
+			received.push_back(value);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	bool in_order = true;
+	for (int i = 0; i < item_count; ++i)
+	{
+		in_order = in_order && received[static_cast<std::size_t>(i)] == i;
+	}
+	REQUIRE(in_order);
+}
@@ -1,7 +1,32 @@
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include "tests/util/allocation_counter.h"
 #include "util/string_utils.h"
 
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	/// Milliseconds spent running `work` `repeat` times.
+	template <typename Work>
+	double time_ms(int repeat, Work work)
+	{
+		const auto start = Clock::now();
+		for (int i = 0; i < repeat; ++i)
+		{
+			work();
+		}
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+}
+
 /// Verifies that split() splits the string into multiple parts using
 /// the given delimiter.
 TEST_CASE("split_splits_string_by_delimiter")
@@ -49,3 +74,176 @@ TEST_CASE("to_lower_converts_all_characters_to_lowercase")
 
 	REQUIRE(result == "hello world");
 }
+
+/// Verifies that trim_view() returns a view into the input without surrounding whitespace.
+TEST_CASE("trim_view_removes_whitespace_without_copying")
+{
+	const std::string input = " \t Software Engineer \r\n";
+
+	const std::string_view result = string_utils::trim_view(input);
+
+	REQUIRE(result == "Software Engineer");
+	REQUIRE(result.data() == input.data() + 3);
+	REQUIRE(string_utils::trim_view(" \t ").empty());
+	REQUIRE(string_utils::trim_view("").empty());
+}
+
+/// Verifies that split_view() yields the same segments as split(), as views into the input.
+TEST_CASE("split_view_matches_split_across_simd_block_boundaries")
+{
+	// Delimiters at block edges (offsets 15, 16, 31, 32, 63) and runs of empty segments.
+	std::string input(80, 'x');
+	for (const std::size_t offset : {0, 15, 16, 31, 32, 33, 34, 63, 79})
+	{
+		input[offset] = ';';
+	}
+
+	const auto expected = string_utils::split(input, ';');
+	std::vector<std::string_view> parts;
+	string_utils::split_view(input, ';', parts);
+
+	REQUIRE(expected.size() == 10);
+	REQUIRE(parts.size() == expected.size());
+	for (std::size_t i = 0; i < parts.size(); ++i)
+	{
+		REQUIRE(parts[i] == expected[i]);
+	}
+	REQUIRE(parts[1].data() == input.data() + 1);
+	REQUIRE(parts.back().empty());
+
+	string_utils::split_view("", ',', parts);
+	REQUIRE(parts == std::vector<std::string_view>{""});
+}
+
+/// Verifies that split_view() into a fixed array keeps the unsplit remainder in its last slot.
+TEST_CASE("split_view_into_span_keeps_the_remainder_in_the_last_slot")
+{
+	std::array<std::string_view, 3> parts{};
+
+	REQUIRE(string_utils::split_view("a,b", ',', parts) == 2);
+	REQUIRE(parts[0] == "a");
+	REQUIRE(parts[1] == "b");
+
+	REQUIRE(string_utils::split_view("key=value=with=equals", '=', std::span(parts).first(2)) == 2);
+	REQUIRE(parts[0] == "key");
+	REQUIRE(parts[1] == "value=with=equals");
+
+	const std::string long_input = std::string(40, 'a') + "," + std::string(40, 'b') + "," + std::string(40, 'c') + ",d";
+	REQUIRE(string_utils::split_view(long_input, ',', parts) == 3);
+	REQUIRE(parts[2] == std::string(40, 'c') + ",d");
+
+	REQUIRE(string_utils::split_view("a,b", ',', std::span<std::string_view>()) == 0);
+}
+
+/// Verifies that the ASCII lowercasing leaves every byte outside A-Z unchanged.
+TEST_CASE("to_lower_in_place_only_changes_ascii_capitals")
+{
+	std::string all_bytes;
+	for (int byte = 0; byte < 256; ++byte)
+	{
+		all_bytes.push_back(static_cast<char>(byte));
+	}
+	// Three copies: the vector kernels, then the scalar tail, see every byte.
+	const std::string input = all_bytes + all_bytes + all_bytes.substr(0, 70);
+
+	std::string expected;
+	for (const unsigned char ch : input)
+	{
+		expected.push_back(static_cast<char>(std::tolower(ch)));
+	}
+
+	std::string in_place = input;
+	string_utils::to_lower_in_place(in_place);
+	REQUIRE(in_place == expected);
+	REQUIRE(string_utils::to_lower(input) == expected);
+
+	std::string buffer = "previous contents";
+	string_utils::to_lower_into("Senior ENGINEER \xC3\x84rger", buffer);
+	REQUIRE(buffer == "senior engineer \xC3\x84rger");
+}
+
+/// Verifies that the view-based helpers do not allocate once their buffers are warm.
+TEST_CASE("split_view_and_to_lower_into_reuse_caller_buffers_without_allocating")
+{
+	if (!AllocationCounter::supported())
+	{
+		WARN("Allocation counting is unavailable in sanitizer builds");
+		return;
+	}
+
+	const std::string line = "Recruiter Name,ACME Corporation International,Senior C++ Software Engineer,Remote";
+	std::vector<std::string_view> parts;
+	std::string lower;
+	string_utils::split_view(line, ',', parts);
+	string_utils::to_lower_into(line, lower);
+
+	std::size_t allocations = 0;
+	{
+		AllocationCounter counter;
+		for (int i = 0; i < 100; ++i)
+		{
+			string_utils::split_view(line, ',', parts);
+			string_utils::to_lower_into(line, lower);
+			REQUIRE(string_utils::trim_view(parts[2]) == "Senior C++ Software Engineer");
+		}
+		allocations = counter.count();
+	}
+
+	REQUIRE(allocations == 0);
+	REQUIRE(parts.size() == 4);
+	REQUIRE(lower == "recruiter name,acme corporation international,senior c++ software engineer,remote");
+}
+
+/// Micro-benchmark: view-based helpers against the copying API and the per-byte std::tolower loop.
+TEST_CASE("string_utils_view_helpers_are_faster_than_copying_helpers", "[.benchmark]")
+{
+	constexpr int repeat = 20000;
+	const std::string line =
+		"  Company Number 12345 International,Senior C++ Software Engineer (Storage),Remote within the EU,"
+		"company_careers_portal,APPLIED,2025-01-02,2025-01-09,Referred by a former colleague  ";
+
+	std::size_t sink = 0;
+
+	const double split_ms = time_ms(repeat, [&]()
+	{
+		sink += string_utils::split(line, ',').size();
+	});
+	std::vector<std::string_view> parts;
+	const double split_view_ms = time_ms(repeat, [&]()
+	{
+		string_utils::split_view(line, ',', parts);
+		sink += parts.size();
+	});
+
+	// The former to_lower: one locale-aware std::tolower call and push_back per byte.
+	const double tolower_ms = time_ms(repeat, [&]()
+	{
+		std::string result;
+		result.reserve(line.size());
+		for (const unsigned char ch : line)
+		{
+			result.push_back(static_cast<char>(std::tolower(ch)));
+		}
+		sink += result.size();
+	});
+	std::string lower;
+	const double lower_into_ms = time_ms(repeat, [&]()
+	{
+		string_utils::to_lower_into(line, lower);
+		sink += lower.size();
+	});
+
+	const double trim_ms = time_ms(repeat, [&]()
+	{
+		sink += string_utils::trim(line).size();
+	});
+	const double trim_view_ms = time_ms(repeat, [&]()
+	{
+		sink += string_utils::trim_view(line).size();
+	});
+
+	REQUIRE(sink > 0);
+	WARN(repeat << " x " << line.size() << "-byte line: split " << split_ms << " ms vs split_view " << split_view_ms
+		<< " ms; per-byte std::tolower " << tolower_ms << " ms vs to_lower_into " << lower_into_ms
+		<< " ms; trim " << trim_ms << " ms vs trim_view " << trim_view_ms << " ms");
+}
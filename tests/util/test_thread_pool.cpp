@@ -0,0 +1,38 @@
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "util/thread_pool.h"
+
+TEST_CASE("ThreadPool_runs_tasks_and_returns_results")
+{
+	ThreadPool pool(4);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 100; ++i)
+	{
+		results.push_back(pool.submit([i]()
+		{
+			return i * i;
+		}));
+	}
+
+	for (int i = 0; i < 100; ++i)
+	{
+		REQUIRE(results[static_cast<std::size_t>(i)].get() == i * i);
+	}
+}
+
+TEST_CASE("ThreadPool_propagates_task_exceptions_through_future")
+{
+	ThreadPool pool(2);
+
+	auto result = pool.submit([]() -> int
+	{
+		throw std::runtime_error("boom");
+	});
+
+	REQUIRE_THROWS_AS(result.get(), std::runtime_error);
+}
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "tests/util/benchmark_threads.h"
+#include "util/work_stealing_pool.h"
+
+TEST_CASE("WorkStealingPool_runs_submitted_tasks_and_returns_results")
+{
+	WorkStealingPool pool(4);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 100; ++i)
+	{
+		results.push_back(pool.submit([i]()
+		{
+			return i * i;
+		}));
+	}
+
+	for (int i = 0; i < 100; ++i)
+	{
+		REQUIRE(results[static_cast<std::size_t>(i)].get() == i * i);
+	}
+	REQUIRE(pool.size() == 4);
+}
+
+TEST_CASE("WorkStealingPool_parallel_for_visits_every_index_once")
+{
+	WorkStealingPool pool(3);
+
+	std::vector<int> visits(10007, 0);
+	pool.parallel_for(visits.size(), 7, [&](std::size_t i)
+	{
+		++visits[i];
+	});
+
+	for (const int count : visits)
+	{
+		REQUIRE(count == 1);
+	}
+
+	// Empty ranges return at once; the pool stays usable.
+	pool.parallel_for(0, 1, [](std::size_t)
+	{
+		throw std::logic_error("not called");
+	});
+	REQUIRE(pool.submit([]()
+	{
+		return 42;
+	}).get() == 42);
+}
+
+TEST_CASE("WorkStealingPool_idle_workers_steal_from_a_busy_one")
+{
+	WorkStealingPool pool(4);
+
+	// Every index blocks its worker for a while; one worker alone would need 64 ms.
+	std::mutex mutex;
+	std::set<std::thread::id> workers;
+	pool.parallel_for(64, 1, [&](std::size_t)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		const std::lock_guard<std::mutex> lock(mutex);
+		workers.insert(std::this_thread::get_id());
+	});
+
+	REQUIRE(workers.size() > 1);
+}
+
+TEST_CASE("WorkStealingPool_parallel_for_rethrows_the_first_exception_after_finishing")
+{
+	WorkStealingPool pool(2);
+
+	std::atomic<std::size_t> visited{0};
+	REQUIRE_THROWS_AS(pool.parallel_for(100, 4, [&](std::size_t i)
+	{
+		++visited;
+		if (i == 50)
+		{
+			throw std::runtime_error("boom");
+		}
+	}), std::runtime_error);
+
+	// Only the chunk that threw stops early; every other index was visited.
+	REQUIRE(visited.load() >= 97);
+}
+
+/// Uneven CPU-bound parallel_for from 1 thread up to JOBTRACKER_BENCH_THREADS.
+TEST_CASE("WorkStealingPool_scaling_with_thread_count", "[.benchmark]")
+{
+	constexpr std::size_t items = 20000;
+
+	// Later indices cost more, so a static split would leave workers idle.
+	const auto work = [](std::size_t i)
+	{
+		std::uint64_t hash = 1469598103934665603ULL;
+		for (std::size_t round = 0; round < 2000 + i / 4; ++round)
+		{
+			hash = (hash ^ round) * 1099511628211ULL;
+		}
+		return hash;
+	};
+
+	std::vector<std::uint64_t> expected(items);
+	for (std::size_t i = 0; i < items; ++i)
+	{
+		expected[i] = work(i);
+	}
+
+	double single_thread_ms = 0.0;
+	for (const std::size_t threads : benchmark_thread_counts())
+	{
+		WorkStealingPool pool(threads);
+		std::vector<std::uint64_t> results(items, 0);
+
+		const auto start = std::chrono::steady_clock::now();
+		pool.parallel_for(items, 16, [&](std::size_t i)
+		{
+			results[i] = work(i);
+		});
+		const double elapsed_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+
+		REQUIRE(results == expected);
+		if (threads == 1)
+		{
+			single_thread_ms = elapsed_ms;
+		}
+		WARN(threads << " thread(s): " << items << " items in " << elapsed_ms << " ms ("
+			<< single_thread_ms / elapsed_ms << "x of 1 thread)");
+	}
+}